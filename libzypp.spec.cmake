@@ -40,8 +40,6 @@ Provides:       libzypp(repovarexpand) = 1.1
 
 %if 0%{?suse_version}
 Recommends:     logrotate
-# lsof is used for 'zypper ps':
-Recommends:     lsof
 %endif
 BuildRequires:  cmake
 BuildRequires:  openssl-devel
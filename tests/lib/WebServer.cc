@@ -1,5 +1,12 @@
+#include <cstdio>
+#include <fstream>
 #include <sstream>
 #include <string>
+#include <list>
+#include <set>
+#include <mutex>
+#include <thread>
+#include <chrono>
 #include "boost/version.hpp"
 
 #if BOOST_VERSION >= 106800
@@ -13,6 +20,7 @@
 #include "zypp/base/String.h"
 #include "zypp/base/Exception.h"
 #include "zypp/ExternalProgram.h"
+#include "zypp/PathInfo.h"
 #include "WebServer.h"
 
 #include "mongoose.h"
@@ -88,7 +96,23 @@ public:
         return 0;
     }
 
+    virtual void addRequestHandler( const string & path, const WebServer::RequestHandler & handler )
+    {}
+
+    virtual void setDelay( unsigned msec, const string & path )
+    {}
+
+    virtual unsigned requests( const string & path ) const
+    { return 0; }
+
+    virtual unsigned connections() const
+    { return 0; }
+
+    virtual unsigned maxConcurrentRequests() const
+    { return 0; }
 
+    virtual void resetCounters()
+    {}
 
 private:
     friend Impl * rwcowClone<Impl>( const Impl * rhs );
@@ -175,6 +199,34 @@ public:
     std::string _log;
 };
 
+namespace
+{
+    /** Whether \a path is \a prefix or below it. */
+    bool isBelow( const string & path, const string & prefix )
+    {
+        if ( str::hasSuffix( prefix, "/" ) )
+            return str::hasPrefix( path, prefix );
+        return path == prefix || str::hasPrefix( path, prefix + "/" );
+    }
+
+    const char * reasonPhrase( unsigned status )
+    {
+        switch ( status )
+        {
+            case 200: return "OK";
+            case 206: return "Partial Content";
+            case 301: return "Moved Permanently";
+            case 400: return "Bad Request";
+            case 401: return "Unauthorized";
+            case 403: return "Forbidden";
+            case 404: return "Not Found";
+            case 416: return "Range Not Satisfiable";
+            case 500: return "Internal Server Error";
+        }
+        return "Unknown";
+    }
+}
+
 class WebServerMongooseImpl : public WebServer::Impl
 {
 public:
@@ -182,6 +234,7 @@ public:
         : _ctx(0L), _docroot(root)
         , _port(port)
         , _stopped(true)
+        , _active(0), _maxActive(0)
     {
     }
 
@@ -205,6 +258,10 @@ public:
         _log.clear();
         _ctx = mg_start();
 
+        mg_set_request_hook(_ctx, &WebServerMongooseImpl::requestHook, this);
+        for ( Handler & handler : _handlers )
+            bindHandler( handler );
+
         int ret = 0;
         ret = mg_set_option(_ctx, "ports", str::form("%d", _port).c_str());
         if (  ret != 1 )
@@ -238,14 +295,193 @@ public:
         _stopped = true;
     }
 
+    virtual void addRequestHandler( const string & path, const WebServer::RequestHandler & handler )
+    {
+        _handlers.push_back( Handler{ path, handler } );
+        if ( _ctx )
+            bindHandler( _handlers.back() );
+    }
+
+    virtual void setDelay( unsigned msec, const string & path )
+    {
+        std::lock_guard<std::mutex> lock( _mutex );
+        _delays[path] = msec;
+    }
+
+    virtual unsigned requests( const string & path ) const
+    {
+        std::lock_guard<std::mutex> lock( _mutex );
+        unsigned ret = 0;
+        for ( const auto & el : _requests )
+        {
+            if ( isBelow( el.first, path ) )
+                ret += el.second;
+        }
+        return ret;
+    }
+
+    virtual unsigned connections() const
+    {
+        std::lock_guard<std::mutex> lock( _mutex );
+        return _connections.size();
+    }
+
+    virtual unsigned maxConcurrentRequests() const
+    {
+        std::lock_guard<std::mutex> lock( _mutex );
+        return _maxActive;
+    }
+
+    virtual void resetCounters()
+    {
+        std::lock_guard<std::mutex> lock( _mutex );
+        _requests.clear();
+        _maxActive = _active;
+        _connections.clear();
+    }
+
+private:
+    struct Handler
+    {
+        string path;
+        WebServer::RequestHandler handler;
+    };
+
+    void bindHandler( Handler & handler )
+    {
+        mg_bind_to_uri(_ctx, handler.path.c_str(), &WebServerMongooseImpl::handlerCallback, &handler);
+        if ( ! str::hasSuffix( handler.path, "/" ) )
+            mg_bind_to_uri(_ctx, (handler.path+"/*").c_str(), &WebServerMongooseImpl::handlerCallback, &handler);
+        else
+            mg_bind_to_uri(_ctx, (handler.path+"*").c_str(), &WebServerMongooseImpl::handlerCallback, &handler);
+    }
+
+    /** Count the requests, delay them if asked to. */
+    static void requestHook(mg_connection *conn, const mg_request_info *info, int done, void *data)
+    {
+        WebServerMongooseImpl & self( *static_cast<WebServerMongooseImpl *>(data) );
+        unsigned delay = 0;
+        {
+            std::lock_guard<std::mutex> lock( self._mutex );
+            if ( done )
+            {
+                --self._active;
+                return;
+            }
+            string path( info->uri );
+            path = path.substr( 0, path.find( '?' ) );
+
+            ++self._requests[path];
+            self._maxActive = std::max( self._maxActive, ++self._active );
+            self._connections.insert( std::make_pair( info->remote_ip, info->remote_port ) );
+            string::size_type matched = 0;
+            for ( const auto & el : self._delays )
+            {
+                if ( isBelow( path, el.first ) && el.first.size() >= matched )
+                {
+                    matched = el.first.size();
+                    delay = el.second;
+                }
+            }
+        }
+        if ( delay )
+            std::this_thread::sleep_for( std::chrono::milliseconds( delay ) );
+    }
+
+    /** Let the \ref Handler in \a data answer the request. */
+    static void handlerCallback(mg_connection *conn, const mg_request_info *info, void *data)
+    {
+        const Handler & handler( *static_cast<Handler *>(data) );
+
+        WebServer::Request request;
+        request.method = info->request_method;
+        request.path = info->uri;
+        if ( info->query_string )
+            request.query = info->query_string;
+        for ( int i = 0; i < info->num_headers; ++i )
+            request.headers[str::toLower( info->http_headers[i].name )] = info->http_headers[i].value;
+
+        WebServer::Response response( 500 );
+        try
+        {
+            response = handler.handler( request );
+        }
+        catch ( const std::exception & excpt )
+        {
+            ERR << "Request handler for " << handler.path << " failed: " << excpt.what() << endl;
+            response = WebServer::Response( 500 );
+        }
+
+        str::Str head;
+        head << "HTTP/1.1 " << response.status << " " << reasonPhrase( response.status ) << "\r\n";
+        for ( const auto & el : response.headers )
+            head << el.first << ": " << el.second << "\r\n";
+        head << "Content-Length: " << response.body.size() << "\r\n"
+             << "Connection: close\r\n"
+             << "\r\n";
+        string reply( head );
+        if ( request.method != "HEAD" )
+            reply += response.body;
+        mg_write(conn, reply.data(), reply.size());
+    }
+
     mg_context *_ctx;
     zypp::Pathname _docroot;
     unsigned int _port;
     bool _stopped;
     std::string _log;
+
+    std::list<Handler> _handlers;
+    mutable std::mutex _mutex;
+    std::map<string,unsigned> _delays;
+    std::map<string,unsigned> _requests;	///< per path
+    unsigned _active;
+    unsigned _maxActive;
+    std::set<std::pair<long,int> > _connections;
 };
 
 
+std::string WebServer::Request::header( const std::string & name_r ) const
+{
+    std::map<std::string,std::string>::const_iterator it( headers.find( str::toLower( name_r ) ) );
+    return it == headers.end() ? std::string() : it->second;
+}
+
+WebServer::Response WebServer::fileResponse( const Request & request_r, const Pathname & file_r )
+{
+    if ( ! PathInfo( file_r ).isFile() )
+        return Response( 404 );
+
+    std::ifstream in( file_r.c_str(), std::ios::binary );
+    std::ostringstream str;
+    str << in.rdbuf();
+    std::string body( str.str() );
+
+    std::string range( request_r.header( "Range" ) );
+    if ( range.empty() )
+    {
+        Response ret( 200, body );
+        ret.headers["Accept-Ranges"] = "bytes";
+        return ret;
+    }
+
+    unsigned long long first = 0;
+    unsigned long long last = 0;
+    int n = ::sscanf( range.c_str(), "bytes=%llu-%llu", &first, &last );
+    if ( n < 1 || first >= body.size() )
+    {
+        Response ret( 416 );
+        ret.headers["Content-Range"] = str::form( "bytes */%zu", body.size() );
+        return ret;
+    }
+    if ( n < 2 || last >= body.size() )
+        last = body.size() - 1;
+
+    Response ret( 206, body.substr( first, last - first + 1 ) );
+    ret.headers["Content-Range"] = str::form( "bytes %llu-%llu/%zu", first, last, body.size() );
+    return ret;
+}
+
 WebServer::WebServer(const Pathname &root, unsigned int port)
 #if WEBRICK
     : _pimpl(new WebServerWebrickImpl(root, port))
@@ -286,6 +522,36 @@ void WebServer::stop()
     _pimpl->stop();
 }
 
+void WebServer::addRequestHandler( const std::string & path_r, const RequestHandler & handler_r )
+{
+    _pimpl->addRequestHandler( path_r, handler_r );
+}
+
+void WebServer::setDelay( unsigned msec_r, const std::string & path_r )
+{
+    _pimpl->setDelay( msec_r, path_r );
+}
+
+unsigned WebServer::requests( const std::string & path_r ) const
+{
+    return _pimpl->requests( path_r );
+}
+
+unsigned WebServer::connections() const
+{
+    return _pimpl->connections();
+}
+
+unsigned WebServer::maxConcurrentRequests() const
+{
+    return _pimpl->maxConcurrentRequests();
+}
+
+void WebServer::resetCounters()
+{
+    _pimpl->resetCounters();
+}
+
 WebServer::~WebServer()
 {
 }
@@ -2,9 +2,13 @@
 #ifndef ZYPP_TEST_WEBSERVER_H
 #define ZYPP_TEST_WEBSERVER_H
 
+#include <map>
+#include <string>
+
 #include "zypp/Url.h"
 #include "zypp/Pathname.h"
 #include "zypp/base/PtrTypes.h"
+#include "zypp/base/Function.h"
 
 /**
  *
@@ -29,9 +33,47 @@
  *     web.stop();
  *
  * \endcode
+ *
+ * Files below \c root are served with \c Range support. A \ref RequestHandler
+ * may answer the requests for a path instead. The server counts the requests
+ * and the connections it served and may delay the replies.
  */
 class WebServer
 {
+ public:
+  /** A request passed to a \ref RequestHandler. */
+  struct Request
+  {
+    std::string method;
+    std::string path;	//!< decoded, without query
+    std::string query;
+    std::map<std::string,std::string> headers;	//!< lowercased names
+
+    /** The value of header \a name_r (case insensitive) or an empty string. */
+    std::string header( const std::string & name_r ) const;
+  };
+
+  /** The reply of a \ref RequestHandler. The \c Content-Length is added. */
+  struct Response
+  {
+    Response( unsigned status_r = 200, const std::string & body_r = std::string() )
+    : status( status_r ), body( body_r )
+    {}
+
+    unsigned status;
+    std::map<std::string,std::string> headers;
+    std::string body;
+  };
+
+  /** Answers a request. Called concurrently by the server threads. */
+  typedef zypp::function<Response( const Request & )> RequestHandler;
+
+  /**
+   * The reply serving \a file_r: \c 200, \c 206 if a \c Range was requested,
+   * \c 416 if it is not satisfiable or \c 404 if there is no such file.
+   */
+  static Response fileResponse( const Request & request_r, const zypp::Pathname & file_r );
+
  public:
   /**
    * creates a web server on \ref root and \port
@@ -62,6 +104,39 @@ class WebServer
    */
   std::string log() const;
 
+  /**
+   * Let \a handler_r answer the requests for \a path_r and below.
+   * Handlers added first take precedence. The connection is closed
+   * after the reply.
+   */
+  void addRequestHandler( const std::string & path_r, const RequestHandler & handler_r );
+
+  /**
+   * Delay the replies to requests for \a path_r and below by \a msec_r.
+   */
+  void setDelay( unsigned msec_r, const std::string & path_r = "/" );
+
+  /**
+   * The number of requests for \a path_r and below since start
+   * or \ref resetCounters.
+   */
+  unsigned requests( const std::string & path_r = "/" ) const;
+
+  /**
+   * The number of client connections the requests came in.
+   */
+  unsigned connections() const;
+
+  /**
+   * The max. number of requests served at the same time.
+   */
+  unsigned maxConcurrentRequests() const;
+
+  /**
+   * Reset \ref requests, \ref connections and \ref maxConcurrentRequests.
+   */
+  void resetCounters();
+
   class Impl;
 private:
   /** Pointer to implementation */
@@ -0,0 +1,49 @@
+#include <fstream>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/Logger.h"
+#include "zypp/base/String.h"
+#include "zypp/TmpPath.h"
+#include "zypp/PathInfo.h"
+#include "zypp/media/MediaManager.h"
+
+#include "WebServer.h"
+
+using boost::unit_test::test_case;
+using namespace std;
+using namespace zypp;
+using namespace zypp::media;
+
+namespace
+{
+  /** Attach a new media for \a url_r and provide \a file_r. */
+  bool provide( const Url & url_r, const Pathname & file_r )
+  {
+    MediaManager mm;
+    MediaAccessId id = mm.open( url_r );
+    mm.attach( id );
+    mm.provideFile( id, file_r );
+    bool ret = PathInfo( mm.localPath( id, file_r ) ).isFile();
+    mm.release( id );
+    mm.close( id );
+    return ret;
+  }
+}
+
+// Media attached one after the other reuse the connection to the server.
+BOOST_AUTO_TEST_CASE(connection_reused)
+{
+  filesystem::TmpDir docroot;
+  std::ofstream( (docroot.path()/"file.txt").c_str() ) << "content" << endl;
+
+  WebServer web( docroot.path(), 10031 );
+  web.start();
+  Url url( str::form( "http://127.0.0.1:%d/", web.port() ) );
+
+  BOOST_CHECK( provide( url, "/file.txt" ) );
+  BOOST_CHECK( provide( url, "/file.txt" ) );
+  BOOST_CHECK_EQUAL( web.requests( "/file.txt" ), 2 );
+  BOOST_CHECK_EQUAL( web.connections(), 1 );
+  web.stop();
+}
@@ -0,0 +1,69 @@
+#include <poll.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <vector>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/media/DnsCheckPool.h"
+
+using namespace std;
+using namespace zypp;
+using namespace zypp::media;
+
+namespace
+{
+  /** Wait for the result posted to \a fd_r (0 on timeout). */
+  uint64_t result( int fd_r, int timeout_r = 60000 )
+  {
+    struct pollfd pfd = { fd_r, POLLIN, 0 };
+    if ( ::poll( &pfd, 1, timeout_r ) != 1 )
+      return 0;
+    uint64_t ret = 0;
+    if ( ::read( fd_r, &ret, sizeof(ret) ) != sizeof(ret) )
+      return 0;
+    return ret;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(dnscheck_result)
+{
+  DnsCheckPool pool;
+  AutoDispose<int> ok( pool.check( "localhost" ) );
+  AutoDispose<int> failed( pool.check( "host.invalid" ) );	// RFC 6761: never resolves
+  BOOST_REQUIRE( ok != -1 );
+  BOOST_REQUIRE( failed != -1 );
+  BOOST_CHECK_EQUAL( result( ok ), DnsCheckPool::DNS_OK );
+  BOOST_CHECK_EQUAL( result( failed ), DnsCheckPool::DNS_FAILED );
+}
+
+// More lookups than threads are queued and all get their result.
+BOOST_AUTO_TEST_CASE(dnscheck_bounded)
+{
+  DnsCheckPool pool( 2 );
+  vector<AutoDispose<int>> fds;
+  for ( unsigned i = 0; i < 20; ++i )
+    fds.push_back( pool.check( "localhost" ) );
+  for ( const AutoDispose<int> & fd : fds )
+  {
+    BOOST_REQUIRE( fd != -1 );
+    BOOST_CHECK_EQUAL( result( fd ), DnsCheckPool::DNS_OK );
+  }
+}
+
+// The dtor joins the threads and drops the queued lookups; their eventfds stay valid.
+BOOST_AUTO_TEST_CASE(dnscheck_shutdown)
+{
+  vector<AutoDispose<int>> fds;
+  {
+    DnsCheckPool pool( 1 );
+    for ( unsigned i = 0; i < 20; ++i )
+      fds.push_back( pool.check( "localhost" ) );
+  }
+  for ( const AutoDispose<int> & fd : fds )
+  {
+    BOOST_REQUIRE( fd != -1 );
+    uint64_t res = result( fd, 0 );
+    BOOST_CHECK( res == 0 || res == DnsCheckPool::DNS_OK );
+  }
+}
@@ -0,0 +1,100 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/media/MediaBlockList.h"
+#include "zypp/AutoDispose.h"
+#include "zypp/TmpPath.h"
+#include "zypp/Digest.h"
+
+using namespace std;
+using namespace zypp;
+using namespace zypp::media;
+
+namespace
+{
+  /** Some pseudo random data. */
+  string randomData( size_t size_r, unsigned seed_r )
+  {
+    string ret( size_r, '\0' );
+    for ( char & ch : ret )
+    {
+      seed_r = seed_r * 1103515245 + 12345;
+      ch = seed_r >> 16;
+    }
+    return ret;
+  }
+
+  /** Block list for \a data_r (rsums and \a chksumlen_r bytes of the sha1 per block). */
+  MediaBlockList blockList( const string & data_r, size_t blksize_r, int chksumlen_r )
+  {
+    MediaBlockList bl( data_r.size() );
+    for ( size_t off = 0; off < data_r.size(); off += blksize_r )
+    {
+      size_t size = min( blksize_r, data_r.size() - off );
+      size_t blkno = bl.addBlock( off, size );
+      Digest dig;
+      dig.create( "SHA1" );
+      dig.update( data_r.data() + off, size );
+      vector<unsigned char> sum( dig.digestVector() );
+      bl.setChecksum( blkno, "SHA1", chksumlen_r, &sum[0] );
+      bl.setRsum( blkno, 4, bl.updateRsum( 0, data_r.data() + off, size ) );
+    }
+    return bl;
+  }
+
+  void writeFile( const Pathname & file_r, const string & data_r )
+  { ofstream( file_r.c_str() ) << data_r; }
+
+  string readFile( const Pathname & file_r )
+  {
+    ifstream str( file_r.c_str() );
+    return string( istreambuf_iterator<char>( str ), istreambuf_iterator<char>() );
+  }
+
+  void reuse( MediaBlockList & bl_r, const vector<string> & seeds_r, const Pathname & out_r )
+  {
+    AutoDispose<FILE*> out( ::fopen( out_r.c_str(), "w+" ), ::fclose );
+    bl_r.reuseBlocks( out, seeds_r );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(reuse_blocks_from_seeds)
+{
+  string data( randomData( 64 * 1024, 1 ) );
+  filesystem::TmpDir tmp;
+  // the first half shifted and the second half in another file
+  writeFile( tmp.path()/"seed1", randomData( 100, 2 ) + data.substr( 0, 32 * 1024 ) );
+  writeFile( tmp.path()/"seed2", randomData( 3, 3 ) + data.substr( 32 * 1024 ) );
+  vector<string> seeds = { (tmp.path()/"seed1").asString(), (tmp.path()/"seed2").asString() };
+
+  for ( int chksumlen : { 20, 8 } )	// one or two consecutive blocks checked
+  {
+    MediaBlockList bl( blockList( data, 1024, chksumlen ) );
+    reuse( bl, seeds, tmp.path()/"out" );
+    BOOST_CHECK_EQUAL( bl.numBlocks(), 0 );
+    BOOST_CHECK( readFile( tmp.path()/"out" ) == data );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(reuse_blocks_large_seed)
+{
+  // large enough to be scanned in slices; a changed block must be fetched
+  string data( randomData( 8 * 1024 * 1024 + 1000, 4 ) );
+  filesystem::TmpDir tmp;
+  string seed( data );
+  seed[5 * 1024 * 1024 + 10] ^= 1;
+  seed.insert( 2 * 1024 * 1024, "inserted" );
+  writeFile( tmp.path()/"seed", seed );
+
+  MediaBlockList bl( blockList( data, 4096, 20 ) );
+  reuse( bl, { (tmp.path()/"seed").asString() }, tmp.path()/"out" );
+  BOOST_REQUIRE_EQUAL( bl.numBlocks(), 1 );
+  BOOST_CHECK_EQUAL( bl.getBlock( 0 ).off, 5 * 1024 * 1024 );
+  string out( readFile( tmp.path()/"out" ) );
+  BOOST_REQUIRE_EQUAL( out.size(), data.size() );
+  BOOST_CHECK( out.substr( 0, 5 * 1024 * 1024 ) == data.substr( 0, 5 * 1024 * 1024 ) );
+  BOOST_CHECK( out.substr( 5 * 1024 * 1024 + 4096 ) == data.substr( 5 * 1024 * 1024 + 4096 ) );
+}
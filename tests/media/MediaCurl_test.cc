@@ -0,0 +1,54 @@
+#include <fstream>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/Logger.h"
+#include "zypp/TmpPath.h"
+#include "zypp/media/MediaCurl.h"
+#include "zypp/media/TransferSettings.h"
+
+using boost::unit_test::test_case;
+using namespace std;
+using namespace zypp;
+using namespace zypp::media;
+
+namespace zypp
+{
+  void reconfigureZConfig( const Pathname & );
+}
+
+namespace
+{
+  /** Use a zypp.conf in \a dir_r containing \a settings_r. */
+  void useZyppConf( const Pathname & dir_r, const string & settings_r )
+  {
+    Pathname conf( dir_r/"zypp.conf" );
+    std::ofstream( conf.c_str() ) << "[main]" << endl << settings_r << endl;
+    reconfigureZConfig( conf );
+  }
+
+  /** The HTTP version curl is told to use for \a url_r. */
+  long httpVersion( const Url & url_r )
+  {
+    TransferSettings settings;
+    MediaCurl::fillSettings( url_r, settings );
+    return MediaCurl::httpVersion( url_r, settings );
+  }
+}
+
+#if LIBCURL_VERSION_NUM >= 0x073c00
+// HTTP/2 is offered over TLS unless disabled by zypp.conf or the url.
+BOOST_AUTO_TEST_CASE(http_version)
+{
+  filesystem::TmpDir tmp;
+  useZyppConf( tmp, "" );
+  BOOST_CHECK_EQUAL( httpVersion( Url( "https://example.org/repo" ) ), CURL_HTTP_VERSION_2TLS );
+  BOOST_CHECK_EQUAL( httpVersion( Url( "https://example.org/repo?http2=no" ) ), CURL_HTTP_VERSION_1_1 );
+  BOOST_CHECK_EQUAL( httpVersion( Url( "https://example.org/repo?http2=yes" ) ), CURL_HTTP_VERSION_2TLS );
+  BOOST_CHECK_EQUAL( httpVersion( Url( "http://example.org/repo" ) ), CURL_HTTP_VERSION_NONE );
+
+  useZyppConf( tmp, "download.use_http2 = false" );
+  BOOST_CHECK( ! TransferSettings().http2Enabled() );
+  BOOST_CHECK_EQUAL( httpVersion( Url( "https://example.org/repo" ) ), CURL_HTTP_VERSION_1_1 );
+}
+#endif
@@ -0,0 +1,286 @@
+#include <stdio.h>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <mutex>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/Logger.h"
+#include "zypp/base/String.h"
+#include "zypp/TmpPath.h"
+#include "zypp/PathInfo.h"
+#include "zypp/ZConfig.h"
+#include "zypp/media/MediaManager.h"
+#include "zypp/media/MediaMultiCurl.h"
+#include "zypp/media/TransferSettings.h"
+
+#include "WebServer.h"
+
+using boost::unit_test::test_case;
+using namespace std;
+using namespace zypp;
+using namespace zypp::media;
+
+namespace zypp
+{
+  void reconfigureZConfig( const Pathname & );
+}
+
+namespace
+{
+  const size_t KiB = 1024;
+  const size_t MiB = 1024 * KiB;
+
+  ///////////////////////////////////////////////////////////////////
+  /// A WebServer providing \c /file.bin as a metalink pointing to the
+  /// mirrors \c /m0/file.bin ... \c /m3/file.bin. The mirrors serve the
+  /// range requests. They may be delayed or broken and record what they
+  /// were asked for.
+  ///////////////////////////////////////////////////////////////////
+  class MirrorSite
+  {
+  public:
+    static const unsigned mirrors = 4;
+
+    struct Range
+    {
+      unsigned mirror;
+      size_t off;
+      size_t len;
+    };
+
+    MirrorSite( size_t size_r, unsigned port_r )
+    : _web( _docroot.path(), port_r )
+    {
+      unsigned seed = 4711;
+      _body.reserve( size_r );
+      for ( size_t i = 0; i < size_r; ++i )
+      {
+        seed = seed * 1103515245 + 12345;
+        _body += char( seed >> 16 );
+      }
+      std::ofstream( (_docroot.path()/"file.bin").c_str() ) << _body;
+
+      _web.addRequestHandler( "/file.bin", [this]( const WebServer::Request & request_r ) {
+        if ( request_r.header( "Accept" ).find( "metalink" ) == string::npos )
+          return WebServer::fileResponse( request_r, _docroot.path()/"file.bin" );
+        WebServer::Response ret( 200, metaLink() );
+        ret.headers["Content-Type"] = "application/metalink4+xml";
+        return ret;
+      } );
+      for ( unsigned i = 0; i < mirrors; ++i )
+      {
+        _web.addRequestHandler( str::form( "/m%u", i ), [this,i]( const WebServer::Request & request_r ) {
+          return mirror( i, request_r );
+        } );
+      }
+      _web.start();
+    }
+
+    ~MirrorSite()
+    { _web.stop(); }
+
+    Url url() const
+    { return Url( str::form( "http://127.0.0.1:%d/", _web.port() ) ); }
+
+    const string & body() const
+    { return _body; }
+
+    /** Mirror \a mirror_r waits \a delay_r ms before each reply. */
+    void setDelay( unsigned mirror_r, unsigned delay_r )
+    { _web.setDelay( delay_r, str::form( "/m%u", mirror_r ) ); }
+
+    /** Mirror \a mirror_r answers 404. */
+    void setBroken( unsigned mirror_r )
+    { std::lock_guard<std::mutex> lock( _mutex ); _broken.insert( mirror_r ); }
+
+    /** The range requests answered. */
+    vector<Range> ranges() const
+    { std::lock_guard<std::mutex> lock( _mutex ); return _ranges; }
+
+    /** The mirrors asked for a range (incl. the broken and the delayed ones). */
+    set<unsigned> mirrorsAsked() const
+    {
+      set<unsigned> ret;
+      for ( unsigned i = 0; i < mirrors; ++i )
+      {
+        if ( _web.requests( str::form( "/m%u", i ) ) )
+          ret.insert( i );
+      }
+      return ret;
+    }
+
+    /** The bytes sent by mirror \a mirror_r. */
+    size_t served( unsigned mirror_r ) const
+    {
+      size_t ret = 0;
+      for ( const Range & range : ranges() )
+      {
+        if ( range.mirror == mirror_r )
+          ret += range.len;
+      }
+      return ret;
+    }
+
+  private:
+    WebServer::Response mirror( unsigned mirror_r, const WebServer::Request & request_r )
+    {
+      {
+        std::lock_guard<std::mutex> lock( _mutex );
+        if ( _broken.count( mirror_r ) || request_r.path != str::form( "/m%u/file.bin", mirror_r ) )
+          return WebServer::Response( 404 );
+      }
+      WebServer::Response ret( WebServer::fileResponse( request_r, _docroot.path()/"file.bin" ) );
+      unsigned long long first = 0;
+      unsigned long long last = 0;
+      if ( ret.status == 206 && sscanf( ret.headers["Content-Range"].c_str(), "bytes %llu-%llu", &first, &last ) == 2 )
+      {
+        std::lock_guard<std::mutex> lock( _mutex );
+        _ranges.push_back( Range{ mirror_r, size_t(first), size_t(last - first + 1) } );
+      }
+      return ret;
+    }
+
+    string metaLink() const
+    {
+      str::Str ret;
+      ret << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+          << "<metalink xmlns=\"urn:ietf:params:xml:ns:metalink\">\n"
+          << "  <file name=\"file.bin\">\n"
+          << "    <size>" << _body.size() << "</size>\n";
+      for ( unsigned i = 0; i < mirrors; ++i )
+        ret << "    <url priority=\"" << i + 1 << "\">" << url() << str::form( "m%u/file.bin", i ) << "</url>\n";
+      ret << "  </file>\n"
+          << "</metalink>\n";
+      return ret;
+    }
+
+  private:
+    filesystem::TmpDir _docroot;
+    WebServer _web;
+    string _body;
+    mutable std::mutex _mutex;
+    set<unsigned> _broken;
+    vector<Range> _ranges;
+  };
+
+  /** Use a zypp.conf in \a dir_r setting \c download.max_mirrors (unless 0). */
+  void useMaxMirrors( const Pathname & dir_r, long maxMirrors_r )
+  {
+    Pathname conf( dir_r/"zypp.conf" );
+    {
+      std::ofstream o( conf.c_str() );
+      o << "[main]" << endl;
+      if ( maxMirrors_r )
+        o << "download.max_mirrors = " << maxMirrors_r << endl;
+    }
+    reconfigureZConfig( conf );
+  }
+
+  /** Download \c /file.bin from \a server_r, return its content. */
+  string download( const MirrorSite & server_r )
+  {
+    MediaManager mm;
+    MediaAccessId id = mm.open( server_r.url() );
+    mm.attach( id );
+    mm.provideFile( id, "/file.bin", ByteCount( server_r.body().size() ) );
+    std::ifstream in( mm.localPath( id, "/file.bin" ).c_str() );
+    std::ostringstream str;
+    str << in.rdbuf();
+    mm.release( id );
+    mm.close( id );
+    return str.str();
+  }
+}
+
+// Blocks are aimed at .5s, but stay within bounds and leave work for the others.
+BOOST_AUTO_TEST_CASE(blocksize_adapts_to_speed)
+{
+  // speed not yet known
+  BOOST_CHECK_EQUAL( MediaMultiCurl::blockSize( 0, off_t(-1), 1 ), 128 * KiB );
+  BOOST_CHECK_EQUAL( MediaMultiCurl::blockSize( 0, 100 * MiB, 4 ), 128 * KiB );
+  // slow and fast mirrors
+  BOOST_CHECK_EQUAL( MediaMultiCurl::blockSize( 10 * KiB, off_t(-1), 1 ), 128 * KiB );
+  BOOST_CHECK_EQUAL( MediaMultiCurl::blockSize( 1000 * MiB, off_t(-1), 1 ), 16 * MiB );
+  BOOST_CHECK_EQUAL( MediaMultiCurl::blockSize( 4 * MiB, off_t(-1), 1 ), 2 * MiB );
+  // rounded down to 128 KiB
+  BOOST_CHECK_EQUAL( MediaMultiCurl::blockSize( 3 * MiB, off_t(-1), 1 ), 1536 * KiB );
+  BOOST_CHECK_EQUAL( MediaMultiCurl::blockSize( 3 * MiB + 200 * KiB, off_t(-1), 1 ), 1536 * KiB );
+  // faster mirrors get larger blocks
+  size_t last = 0;
+  for ( double speed = 64 * KiB; speed < 64 * MiB; speed *= 1.5 )
+  {
+    size_t size = MediaMultiCurl::blockSize( speed, off_t(-1), 1 );
+    BOOST_CHECK_EQUAL( size % ( 128 * KiB ), 0 );
+    BOOST_CHECK( size >= last );
+    last = size;
+  }
+  // the rest of the file is shared by the active workers
+  BOOST_CHECK_EQUAL( MediaMultiCurl::blockSize( 1000 * MiB, 8 * MiB, 4 ), 2 * MiB );
+  BOOST_CHECK_EQUAL( MediaMultiCurl::blockSize( 1000 * MiB, 8 * MiB, 1 ), 16 * MiB );
+  BOOST_CHECK_EQUAL( MediaMultiCurl::blockSize( 1000 * MiB, 64 * KiB, 4 ), 128 * KiB );
+  BOOST_CHECK_EQUAL( MediaMultiCurl::blockSize( 1000 * MiB, 0, 4 ), 16 * MiB );
+  BOOST_CHECK_EQUAL( MediaMultiCurl::blockSize( 1 * MiB, 100 * MiB, 4 ), 512 * KiB );
+}
+
+// download.max_mirrors from zypp.conf is the default of the transfer settings.
+BOOST_AUTO_TEST_CASE(max_mirrors_setting)
+{
+  filesystem::TmpDir tmp;
+  useMaxMirrors( tmp, 0 );
+  BOOST_CHECK_EQUAL( ZConfig::instance().download_max_mirrors(), 10 );
+  BOOST_CHECK_EQUAL( TransferSettings().maxMirrors(), 10 );
+
+  useMaxMirrors( tmp, 3 );
+  BOOST_CHECK_EQUAL( ZConfig::instance().download_max_mirrors(), 3 );
+  TransferSettings settings;
+  BOOST_CHECK_EQUAL( settings.maxMirrors(), 3 );
+  settings.setMaxMirrors( 1 );
+  BOOST_CHECK_EQUAL( settings.maxMirrors(), 1 );
+}
+
+// Only download.max_mirrors of the metalink mirrors are used and the
+// blocks grow once the speed of the mirrors is known.
+BOOST_AUTO_TEST_CASE(multifetch_max_mirrors)
+{
+  filesystem::TmpDir tmp;
+  MirrorSite server( 4 * MiB, 10021 );
+
+  useMaxMirrors( tmp, 2 );
+  BOOST_REQUIRE( download( server ) == server.body() );
+  vector<MirrorSite::Range> ranges( server.ranges() );
+  BOOST_CHECK_EQUAL( server.mirrorsAsked().size(), 2 );
+  BOOST_CHECK_EQUAL( server.mirrorsAsked().count( 0 ), 1 );
+  BOOST_CHECK_EQUAL( server.mirrorsAsked().count( 1 ), 1 );
+  size_t maxlen = 0;
+  for ( const MirrorSite::Range & range : ranges )
+    maxlen = std::max( maxlen, range.len );
+  BOOST_CHECK_MESSAGE( maxlen > 128 * KiB, "largest block " << maxlen );
+  BOOST_CHECK_MESSAGE( ranges.size() < server.body().size() / ( 128 * KiB ), ranges.size() << " blocks" );
+
+  useMaxMirrors( tmp, 1 );
+  MirrorSite single( 4 * MiB, 10022 );
+  BOOST_REQUIRE( download( single ) == single.body() );
+  BOOST_CHECK_EQUAL( single.mirrorsAsked().size(), 1 );
+  BOOST_CHECK_EQUAL( single.served( 0 ), single.body().size() );
+}
+
+// A broken mirror is dropped, a slow one does not hold up the download.
+BOOST_AUTO_TEST_CASE(multifetch_slow_and_broken_mirrors)
+{
+  filesystem::TmpDir tmp;
+  useMaxMirrors( tmp, 3 );
+
+  MirrorSite server( 4 * MiB, 10023 );
+  server.setBroken( 0 );
+  server.setDelay( 1, 300 );
+  BOOST_REQUIRE( download( server ) == server.body() );
+  BOOST_CHECK_EQUAL( server.mirrorsAsked().size(), 3 );
+  BOOST_CHECK_EQUAL( server.served( 0 ), 0 );
+  BOOST_CHECK_MESSAGE( server.served( 2 ) > server.body().size() / 2, "fast mirror served " << server.served( 2 ) << ", slow one " << server.served( 1 ) );
+}
@@ -2,6 +2,7 @@
 #include <sstream>
 #include <fstream>
 #include <list>
+#include <vector>
 #include <string>
 
 #include <boost/test/auto_unit_test.hpp>
@@ -10,6 +11,7 @@
 #include "zypp/base/Exception.h"
 #include "zypp/RepoManager.h"
 #include "zypp/ResPool.h"
+#include "zypp/ResPoolProxy.h"
 #include "zypp/sat/Pool.h"
 #include "zypp/PoolQuery.h"
 
@@ -111,3 +113,64 @@ BOOST_AUTO_TEST_CASE(dudata)
   ins.status().setTransact( false, ResStatus::USER );
   up3.status().setTransact( false, ResStatus::USER );
 }
+
+BOOST_AUTO_TEST_CASE(dudata_incremental)
+{
+  Pathname repodir( TEST_DIR );
+  TestSetup test( Arch_x86_64 );
+  test.loadTargetRepo( repodir/"system" );
+  test.loadRepo( repodir/"repo", "repo" );
+
+  ResPool pool( ResPool::instance() );
+  PoolItem ins( piFind( "dutest", "1.0", true ) );
+  PoolItem up1( piFind( "dutest", "1.0" ) );
+  PoolItem up2( piFind( "dutest", "2.0" ) );
+  PoolItem up3( piFind( "dutest", "3.0" ) );
+
+  DiskUsageCounter duc( { DiskUsageCounter::MountPoint( "/grow", DiskUsageCounter::MountPoint::Hint_growonly ),
+                          DiskUsageCounter::MountPoint( "/norm" ) } );
+  DiskUsageCounter iduc( duc );
+  iduc.setIncremental( true );
+  BOOST_CHECK( iduc.incremental() );
+  BOOST_CHECK( ! duc.incremental() );
+
+  // the results must not differ, whatever the order of changes
+  std::vector<PoolItem> items( { ins, up1, up2, up3 } );
+  BOOST_CHECK_EQUAL( getSize( iduc, pool ), getSize( duc, pool ) );
+  for ( unsigned mask = 1; mask < 32; ++mask )
+  {
+    for ( unsigned i = 0; i < items.size(); ++i )
+    {
+      if ( mask & (1<<i) )
+      {
+        PoolItem pi( items[(i+mask)%items.size()] );
+        pi.status().setTransact( ! pi.status().transacts(), ResStatus::USER );
+        BOOST_CHECK_EQUAL( getSize( iduc, pool ), getSize( duc, pool ) );
+      }
+    }
+  }
+  for ( PoolItem & pi : items )
+    pi.status().setTransact( false, ResStatus::USER );
+  BOOST_CHECK_EQUAL( getSize( iduc, pool ), mkByteSet( 0, 0 ) );
+
+  // changing the mountpoints rebuilds
+  iduc.setMountPoints( { DiskUsageCounter::MountPoint( "/grow" ), DiskUsageCounter::MountPoint( "/norm" ) } );
+  ins.status().setTransact( true, ResStatus::USER );
+  BOOST_CHECK_EQUAL( getSize( iduc, pool ), mkByteSet( -5, -5 ) );
+  ins.status().setTransact( false, ResStatus::USER );
+  BOOST_CHECK_EQUAL( getSize( iduc, pool ), mkByteSet( 0, 0 ) );
+
+  // status changes not made by the setters are noticed as well
+  ResPoolProxy proxy( pool.proxy() );
+  proxy.saveState();
+  up2.status().setTransact( true, ResStatus::USER );
+  ins.status().setTransact( true, ResStatus::USER );
+  BOOST_CHECK_EQUAL( getSize( iduc, pool ), getSize( duc, pool ) );
+  proxy.restoreState();
+  BOOST_CHECK_EQUAL( getSize( iduc, pool ), mkByteSet( 0, 0 ) );
+  ResStatus saved( up2.status() );
+  up2.status().setTransact( true, ResStatus::USER );
+  BOOST_CHECK_EQUAL( getSize( iduc, pool ), getSize( duc, pool ) );
+  up2.status() = saved;
+  BOOST_CHECK_EQUAL( getSize( iduc, pool ), mkByteSet( 0, 0 ) );
+}
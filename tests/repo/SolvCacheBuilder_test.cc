@@ -0,0 +1,135 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/Logger.h"
+#include "zypp/base/String.h"
+#include "zypp/base/Easy.h"
+#include "zypp/ExternalProgram.h"
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+#include "zypp/sat/Pool.h"
+#include "zypp/sat/LookupAttr.h"
+#include "zypp/repo/RepoException.h"
+#include "zypp/repo/SolvCacheBuilder.h"
+
+using std::endl;
+using namespace zypp;
+using namespace zypp::repo;
+
+#define YUM_DIR      TESTS_SRC_DIR "/repo/yum/data/10.2-updates-subset"
+#define SUSETAGS_DIR TESTS_SRC_DIR "/repo/susetags/data/stable-x86-subset"
+#define YUMEXT_DIR   TESTS_SRC_DIR "/repo/yum/data/extensions"
+
+namespace
+{
+  /** Run repo2solv like RepoManager used to do. */
+  bool repo2solv( const Pathname & metadata_r, const Pathname & out_r )
+  {
+    const char* argv[] = { "repo2solv", "-o", out_r.c_str(), "-X", metadata_r.c_str(), NULL };
+    ExternalProgram prog( argv, ExternalProgram::Stderr_To_Stdout );
+    for ( std::string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() )
+      MIL << "  " << output;
+    return prog.close() == 0;
+  }
+
+  /** A sorted dump of all solvables, their dependencies and attributes (incl. the filelist). */
+  std::vector<std::string> dump( const Pathname & solvfile_r )
+  {
+    std::vector<std::string> ret;
+    Repository repo( sat::Pool::instance().addRepoSolv( solvfile_r, "dump" ) );
+    for ( sat::Solvable solv : repo.solvables() )
+    {
+      std::vector<std::string> attrs;
+      for ( Dep dep : { Dep::PROVIDES, Dep::REQUIRES, Dep::CONFLICTS, Dep::OBSOLETES, Dep::RECOMMENDS, Dep::SUGGESTS, Dep::ENHANCES, Dep::SUPPLEMENTS } )
+      {
+	for ( const Capability & cap : solv.dep( dep ) )
+	  attrs.push_back( dep.asString() + "=" + cap.asString() );
+      }
+      sat::LookupAttr q( sat::SolvAttr::allAttr, solv );
+      for_( it, q.begin(), q.end() )
+	attrs.push_back( it.inSolvAttr().asString() + "=" + it.asString() );
+      std::sort( attrs.begin(), attrs.end() );
+      ret.push_back( str::Str() << solv.ident() << "-" << solv.edition() << "." << solv.arch() << "(" << solv.vendor() << "): " << str::join( attrs, "|" ) );
+    }
+    repo.eraseFromPool();
+    std::sort( ret.begin(), ret.end() );
+    return ret;
+  }
+
+  /** Check the solvables built by SolvCacheBuilder and repo2solv are the same. */
+  void compareToRepo2solv( const RepoType & type_r, const Pathname & metadata_r )
+  {
+    filesystem::TmpDir tmp;
+    Pathname expected( tmp.path() / "repo2solv" );
+    Pathname built( tmp.path() / "built" );
+    if ( ! repo2solv( metadata_r, expected ) )
+    {
+      BOOST_TEST_MESSAGE( "repo2solv not available; skipped" );
+      return;
+    }
+    SolvCacheBuilder( type_r, metadata_r ).build( built );
+
+    std::vector<std::string> edump( dump( expected ) );
+    std::vector<std::string> bdump( dump( built ) );
+    BOOST_CHECK( ! edump.empty() );
+    BOOST_CHECK_EQUAL( edump.size(), bdump.size() );
+    for ( unsigned i = 0; i < std::min( edump.size(), bdump.size() ); ++i )
+    {
+      if ( edump[i] != bdump[i] )
+      {
+	BOOST_CHECK_EQUAL( edump[i], bdump[i] );	// show the first difference
+	break;
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(build_rpmmd)
+{
+  filesystem::TmpDir tmp;
+  Pathname solvfile( tmp.path() / "solv" );
+
+  SolvCacheBuilder( RepoType::RPMMD, YUM_DIR ).build( solvfile );
+  BOOST_CHECK( PathInfo( solvfile ).isFile() );
+  BOOST_CHECK( PathInfo( solvfile.extend( ".idx" ) ).isFile() );
+  BOOST_CHECK( ! PathInfo( solvfile.extend( ".new" ) ).isExist() );
+
+  Repository repo( sat::Pool::instance().addRepoSolv( solvfile, "rpmmd" ) );
+  BOOST_CHECK_EQUAL( repo.solvablesSize(), 22 );
+  repo.eraseFromPool();
+}
+
+BOOST_AUTO_TEST_CASE(build_susetags)
+{
+  filesystem::TmpDir tmp;
+  Pathname solvfile( tmp.path() / "solv" );
+
+  SolvCacheBuilder( RepoType::YAST2, SUSETAGS_DIR ).build( solvfile );
+  BOOST_CHECK( PathInfo( solvfile ).isFile() );
+
+  Repository repo( sat::Pool::instance().addRepoSolv( solvfile, "susetags" ) );
+  BOOST_CHECK( repo.solvablesSize() > 5 );	// 5 packages and the pattern
+  repo.eraseFromPool();
+}
+
+// The solvables must be the same repo2solv creates.
+BOOST_AUTO_TEST_CASE(build_equals_repo2solv)
+{
+  compareToRepo2solv( RepoType::RPMMD, YUM_DIR );
+  compareToRepo2solv( RepoType::RPMMD, YUMEXT_DIR );
+  compareToRepo2solv( RepoType::YAST2, SUSETAGS_DIR );
+}
+
+BOOST_AUTO_TEST_CASE(build_errors)
+{
+  filesystem::TmpDir tmp;
+  Pathname solvfile( tmp.path() / "solv" );
+
+  BOOST_CHECK_THROW( SolvCacheBuilder( RepoType::RPMMD, tmp.path() / "nonexistent" ).build( solvfile ), RepoException );
+  BOOST_CHECK_THROW( SolvCacheBuilder( RepoType::NONE, YUM_DIR ).build( solvfile ), RepoException );
+  BOOST_CHECK( ! PathInfo( solvfile ).isExist() );
+}
@@ -0,0 +1,74 @@
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <climits>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/String.h"
+#include "zypp/AutoDispose.h"
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+#include "zypp/misc/CheckAccessDeleted.h"
+
+using namespace std;
+using namespace zypp;
+
+namespace
+{
+  /** Our own entry in \a check_r. */
+  const CheckAccessDeleted::ProcInfo * self( const CheckAccessDeleted & check_r )
+  {
+    auto it = find_if( check_r.begin(), check_r.end(),
+		       []( const CheckAccessDeleted::ProcInfo & pinfo_r )
+		       { return pinfo_r.pid == str::numstring( ::getpid() ); } );
+    return( it == check_r.end() ? nullptr : &*it );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(check_mapped_deleted_file)
+{
+  // Files in /tmp or /var are not reported, so use the build directory.
+  char cwd[PATH_MAX];
+  BOOST_REQUIRE( ::getcwd( cwd, sizeof(cwd) ) );
+  for ( const char * prefix : { "/tmp/", "/var/", "/dev/", "/proc/" } )
+  {
+    if ( str::hasPrefix( cwd, prefix ) )
+    {
+      BOOST_TEST_MESSAGE( "Skip test in " << cwd );
+      return;
+    }
+  }
+
+  filesystem::TmpDir tmp( cwd );
+  Pathname lib( tmp.path()/"libdeleted.so.1" );
+  ofstream( lib.c_str() ) << "some library";
+  AutoDispose<int> fd( ::open( lib.c_str(), O_RDONLY ), ::close );
+  BOOST_REQUIRE( fd >= 0 );
+  void * map = ::mmap( nullptr, 4096, PROT_READ, MAP_PRIVATE, fd, 0 );
+  BOOST_REQUIRE( map != MAP_FAILED );
+  AutoDispose<void*> unmap( map, []( void * p ) { ::munmap( p, 4096 ); } );
+  filesystem::unlink( lib );
+
+  CheckAccessDeleted check( false );
+  check.setDebugOutputFile( tmp.path()/"debug" );
+  check.check();
+  const CheckAccessDeleted::ProcInfo * pinfo = self( check );
+  BOOST_REQUIRE( pinfo );
+  BOOST_CHECK( find( pinfo->files.begin(), pinfo->files.end(), lib.asString() ) != pinfo->files.end() );
+  BOOST_CHECK_EQUAL( pinfo->ppid, str::numstring( ::getppid() ) );
+  BOOST_CHECK_EQUAL( pinfo->puid, str::numstring( ::geteuid() ) );
+  BOOST_CHECK( ! pinfo->command.empty() );
+  BOOST_CHECK( ! pinfo->login.empty() );
+
+  // The debug output file reproduces the result
+  CheckAccessDeleted replay( false );
+  replay.check( tmp.path()/"debug" );
+  const CheckAccessDeleted::ProcInfo * rinfo = self( replay );
+  BOOST_REQUIRE( rinfo );
+  BOOST_CHECK( rinfo->files == pinfo->files );
+  BOOST_CHECK_EQUAL( rinfo->command, pinfo->command );
+  BOOST_CHECK_EQUAL( rinfo->login, pinfo->login );
+}
@@ -0,0 +1,289 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <chrono>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/Logger.h"
+#include "zypp/base/String.h"
+#include "zypp/TmpPath.h"
+#include "zypp/PathInfo.h"
+#include "zypp/CheckSum.h"
+#include "zypp/ResPool.h"
+#include "zypp/Package.h"
+#include "zypp/media/CredentialManager.h"
+#include "zypp/media/MediaUserAuth.h"
+#include "zypp/target/CommitPackageCachePrefetch.h"
+
+#include "TestSetup.h"
+#include "WebServer.h"
+
+using boost::unit_test::test_case;
+using namespace std;
+using namespace zypp;
+using namespace zypp::target;
+
+namespace
+{
+  ///////////////////////////////////////////////////////////////////
+  /// WebServer request handler recording the max. number of concurrent
+  /// requests per Host header and per repository (1st path component).
+  /// Files below /secure/ need basic authentication as user:pass.
+  ///////////////////////////////////////////////////////////////////
+  class RequestRecorder
+  {
+  public:
+    RequestRecorder( const Pathname & docroot_r )
+    : _docroot( docroot_r )
+    {}
+
+    void reset()
+    {
+      std::lock_guard<std::mutex> lock( _mutex );
+      _max = Count();
+      _unauthorized = 0;
+    }
+
+    unsigned maxPerHost() const
+    { std::lock_guard<std::mutex> lock( _mutex ); return maxOf( _max.host ); }
+
+    unsigned maxPerRepo() const
+    { std::lock_guard<std::mutex> lock( _mutex ); return maxOf( _max.repo ); }
+
+    unsigned unauthorized() const
+    { std::lock_guard<std::mutex> lock( _mutex ); return _unauthorized; }
+
+    WebServer::Response operator()( const WebServer::Request & request_r )
+    {
+      string path( request_r.path );
+      if ( str::hasPrefix( path, "/secure/" ) )
+      {
+        if ( request_r.header( "Authorization" ) != "Basic dXNlcjpwYXNz" )	// user:pass
+        {
+          { std::lock_guard<std::mutex> lock( _mutex ); ++_unauthorized; }
+          WebServer::Response ret( 401 );
+          ret.headers["WWW-Authenticate"] = "Basic realm=\"test\"";
+          return ret;
+        }
+        path.erase( 0, 7 );
+      }
+      string host( request_r.header( "Host" ) );
+      string repo( path.substr( 1, path.find( '/', 1 ) - 1 ) );
+
+      {
+        std::lock_guard<std::mutex> lock( _mutex );
+        _max.host[host] = std::max( _max.host[host], ++_active.host[host] );
+        _max.repo[repo] = std::max( _max.repo[repo], ++_active.repo[repo] );
+      }
+      std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );	// let the requests overlap
+      WebServer::Response ret( WebServer::fileResponse( request_r, _docroot / path ) );
+      {
+        std::lock_guard<std::mutex> lock( _mutex );
+        --_active.host[host];
+        --_active.repo[repo];
+      }
+      return ret;
+    }
+
+  private:
+    struct Count
+    {
+      map<string,unsigned> host;
+      map<string,unsigned> repo;
+    };
+
+    static unsigned maxOf( const map<string,unsigned> & map_r )
+    {
+      unsigned ret = 0;
+      for ( const auto & el : map_r )
+        ret = std::max( ret, el.second );
+      return ret;
+    }
+
+  private:
+    Pathname _docroot;
+    mutable std::mutex _mutex;
+    Count _active;
+    Count _max;
+    unsigned _unauthorized = 0;
+  };
+
+  Url serverUrl( const WebServer & server_r, const string & host_r, const string & path_r )
+  { return Url( str::form( "http://%s:%d%s", host_r.c_str(), server_r.port(), path_r.c_str() ) ); }
+
+  /** Create an rpm-md repo with \a count_r (fake) packages in \a dir_r. */
+  void makeRepo( const Pathname & dir_r, const string & name_r, unsigned count_r )
+  {
+    filesystem::assert_dir( dir_r/"repodata" );
+    filesystem::assert_dir( dir_r/"pkgs" );
+    std::ofstream primary( (dir_r/"repodata/primary.xml").c_str() );
+    primary << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+            << "<metadata xmlns=\"http://linux.duke.edu/metadata/common\" xmlns:rpm=\"http://linux.duke.edu/metadata/rpm\" packages=\"" << count_r << "\">\n";
+    for ( unsigned i = 0; i < count_r; ++i )
+    {
+      string name( str::form( "%s-%u", name_r.c_str(), i ) );
+      Pathname rpm( dir_r/"pkgs"/(name+".rpm") );
+      {
+        std::ofstream o( rpm.c_str() );
+        for ( unsigned l = 0; l < 1000; ++l )
+          o << name << " " << l << "\n";
+      }
+      primary << "<package type=\"rpm\">\n"
+              << "  <name>" << name << "</name>\n"
+              << "  <arch>noarch</arch>\n"
+              << "  <version epoch=\"0\" ver=\"1\" rel=\"1\"/>\n"
+              << "  <checksum type=\"sha256\" pkgid=\"YES\">" << CheckSum::sha256( std::ifstream( rpm.c_str() ) ).checksum() << "</checksum>\n"
+              << "  <summary>" << name << "</summary>\n"
+              << "  <description>" << name << "</description>\n"
+              << "  <size package=\"" << PathInfo( rpm ).size() << "\" installed=\"0\" archive=\"0\"/>\n"
+              << "  <location href=\"pkgs/" << name << ".rpm\"/>\n"
+              << "</package>\n";
+    }
+    primary << "</metadata>\n";
+    primary.close();
+    std::ofstream( (dir_r/"repodata/repomd.xml").c_str() )
+      << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+      << "<repomd xmlns=\"http://linux.duke.edu/metadata/repo\">\n"
+      << "  <data type=\"primary\">\n"
+      << "    <location href=\"repodata/primary.xml\"/>\n"
+      << "    <checksum type=\"sha256\">" << CheckSum::sha256( std::ifstream( (dir_r/"repodata/primary.xml").c_str() ) ).checksum() << "</checksum>\n"
+      << "  </data>\n"
+      << "</repomd>\n";
+  }
+
+  /** Let the loaded repo \a alias_r download from \a urls_r into \a packages_r. */
+  void useUrls( const string & alias_r, const vector<Url> & urls_r, const Pathname & packages_r )
+  {
+    Repository repo( sat::Pool::instance().reposFind( alias_r ) );
+    RepoInfo info( repo.info() );
+    info.setBaseUrl( urls_r.front() );
+    for ( unsigned i = 1; i < urls_r.size(); ++i )
+      info.addBaseUrl( urls_r[i] );
+    info.setPackagesPath( packages_r );
+    info.setKeepPackages( true );
+    repo.setInfo( info );
+  }
+
+  /** Install all packages of the repos \a aliases_r and prefetch them. */
+  vector<PoolItem> prefetch( const set<string> & aliases_r, const CommitPackageCachePrefetch::Limits & limits_r )
+  {
+    vector<PoolItem> ret;
+    vector<sat::Solvable> commitList;
+    for ( const PoolItem & pi : ResPool::instance() )
+    {
+      if ( pi->isKind<Package>() && aliases_r.count( pi.repository().alias() ) )
+      {
+        pi.status().setToBeInstalled( ResStatus::USER );
+        commitList.push_back( pi.satSolvable() );
+        ret.push_back( pi );
+      }
+    }
+    {
+      CommitPackageCachePrefetch cache( []( const PoolItem &, bool ) { return ManagedFile(); }, limits_r );
+      cache.setCommitList( commitList );
+      cache.prefetch();
+    }	// keepPackages: the files stay
+    for ( const PoolItem & pi : ret )
+      pi.status().resetTransact( ResStatus::USER );
+    return ret;
+  }
+
+  /** Whether \a pi_r was prefetched into \a packages_r. */
+  bool prefetched( const PoolItem & pi_r, const Pathname & packages_r )
+  {
+    OnMediaLocation loc( pi_r->asKind<Package>()->location() );
+    Pathname file( packages_r / loc.filename() );
+    return PathInfo( file ).isFile() && CheckSum::sha256( std::ifstream( file.c_str() ) ) == loc.checksum();
+  }
+}
+
+// The global, per host and per repository connection limits are kept.
+BOOST_AUTO_TEST_CASE(prefetch_limits)
+{
+  filesystem::TmpDir docroot;
+  makeRepo( docroot/"r1", "r1", 6 );
+  makeRepo( docroot/"r2", "r2", 6 );
+  makeRepo( docroot/"r3", "r3", 6 );
+  RequestRecorder recorder( docroot );
+  WebServer server( docroot, 10012 );
+  server.addRequestHandler( "/", boost::ref( recorder ) );
+  server.start();
+
+  TestSetup test;
+  test.loadRepo( docroot/"r1", "r1" );
+  test.loadRepo( docroot/"r2", "r2" );
+  test.loadRepo( docroot/"r3", "r3" );
+
+  // connections, per host, per repo
+  for ( const vector<unsigned> & limit : vector<vector<unsigned>>{ { 4, 3, 2 }, { 6, 0, 1 }, { 2, 0, 0 }, { 8, 2, 0 } } )
+  {
+    filesystem::TmpDir packages;
+    useUrls( "r1", { serverUrl( server, "127.0.0.1", "/r1" ) }, packages/"r1" );
+    useUrls( "r2", { serverUrl( server, "127.0.0.1", "/r2" ) }, packages/"r2" );
+    useUrls( "r3", { serverUrl( server, "localhost", "/r3" ) }, packages/"r3" );
+    server.resetCounters();
+    recorder.reset();
+
+    CommitPackageCachePrefetch::Limits limits = { 0, ByteCount(), limit[0], limit[1], limit[2] };
+    vector<PoolItem> items( prefetch( { "r1", "r2", "r3" }, limits ) );
+    BOOST_CHECK_EQUAL( items.size(), 18 );
+    for ( const PoolItem & pi : items )
+      BOOST_CHECK_MESSAGE( prefetched( pi, packages/pi.repository().alias() ), pi << " prefetched" );
+
+    BOOST_CHECK_MESSAGE( server.maxConcurrentRequests() > 1, "concurrent downloads with limits " << str::join( limit, "/" ) );
+    BOOST_CHECK_MESSAGE( server.maxConcurrentRequests() <= limit[0], "max. " << server.maxConcurrentRequests() << " connections with limits " << str::join( limit, "/" ) );
+    if ( limit[1] )
+      BOOST_CHECK_MESSAGE( recorder.maxPerHost() <= limit[1], "max. " << recorder.maxPerHost() << " per host with limits " << str::join( limit, "/" ) );
+    if ( limit[2] )
+      BOOST_CHECK_MESSAGE( recorder.maxPerRepo() <= limit[2], "max. " << recorder.maxPerRepo() << " per repo with limits " << str::join( limit, "/" ) );
+  }
+  test.satpool().reposEraseAll();
+  server.stop();
+}
+
+// All download urls of a repo are tried, stored credentials are used.
+BOOST_AUTO_TEST_CASE(prefetch_fallback_and_credentials)
+{
+  filesystem::TmpDir docroot;
+  makeRepo( docroot/"fallback", "fallback", 3 );
+  makeRepo( docroot/"auth", "auth", 3 );
+  makeRepo( docroot/"noauth", "noauth", 3 );
+  RequestRecorder recorder( docroot );
+  WebServer server( docroot, 10013 );
+  server.addRequestHandler( "/", boost::ref( recorder ) );
+  server.start();
+
+  TestSetup test;
+  test.loadRepo( docroot/"fallback", "fallback" );
+  test.loadRepo( docroot/"auth", "auth" );
+  test.loadRepo( docroot/"noauth", "noauth" );
+
+  filesystem::TmpDir packages;
+  useUrls( "fallback", { serverUrl( server, "127.0.0.1", "/nonexistent" ), serverUrl( server, "127.0.0.1", "/fallback" ) }, packages/"fallback" );
+  useUrls( "auth", { serverUrl( server, "127.0.0.1", "/secure/auth" ) }, packages/"auth" );
+  useUrls( "noauth", { serverUrl( server, "127.0.0.1", "/secure/noauth" ) }, packages/"noauth" );
+
+  media::CredentialManager cm( media::CredManagerOptions( ZConfig::instance().repoManagerRoot() ) );
+  media::AuthData cred( "user", "pass" );
+  cred.setUrl( serverUrl( server, "127.0.0.1", "/secure/auth" ) );
+  cm.saveInGlobal( cred );
+
+  CommitPackageCachePrefetch::Limits limits = { 0, ByteCount(), 4, 0, 0 };
+  for ( const PoolItem & pi : prefetch( { "fallback", "auth", "noauth" }, limits ) )
+  {
+    if ( pi.repository().alias() == "noauth" )
+      BOOST_CHECK_MESSAGE( ! prefetched( pi, packages/"noauth" ), pi << " not prefetched without credentials" );
+    else
+      BOOST_CHECK_MESSAGE( prefetched( pi, packages/pi.repository().alias() ), pi << " prefetched" );
+  }
+  BOOST_CHECK( recorder.unauthorized() > 0 );
+  test.satpool().reposEraseAll();
+  server.stop();
+}
@@ -3,6 +3,7 @@
 #include <fstream>
 #include <list>
 #include <string>
+#include <chrono>
 
 #include <boost/test/auto_unit_test.hpp>
 
@@ -14,6 +15,7 @@
 #include "zypp/sat/Pool.h"
 #include "zypp/repo/DeltaCandidates.h"
 #include "zypp/repo/PackageDelta.h"
+#include "zypp/repo/Applydeltarpm.h"
 #include "KeyRingTestReceiver.h"
 
 using boost::unit_test::test_case;
@@ -50,6 +52,11 @@ BOOST_AUTO_TEST_CASE(delta)
   repo::DeltaCandidates dc(list<Repository>(pool.reposBegin(),pool.reposEnd()), "libzypp");
 
   std::list<packagedelta::DeltaRpm> deltas = dc.deltaRpms(0);
+  BOOST_CHECK( ! deltas.empty() );
+  // the name index is reused and covers all deltas
+  BOOST_CHECK_EQUAL( dc.deltaRpms(0).size(), deltas.size() );
+  BOOST_CHECK( repo::DeltaCandidates(list<Repository>(pool.reposBegin(),pool.reposEnd()), "nosuchpackage").deltaRpms(0).empty() );
+  BOOST_CHECK( repo::DeltaCandidates(list<Repository>(pool.reposBegin(),pool.reposEnd())).deltaRpms(0).size() >= deltas.size() );
   for_ (it,deltas.begin(),deltas.end())
   {
     BOOST_CHECK(it->name() == "libzypp");
@@ -67,3 +74,61 @@ BOOST_AUTO_TEST_CASE(delta)
     cout << (it->edition().match("4.21.3-2") == 0) << endl;          // match returns -1,0,1
   }
 }
+
+// As long as a rate is unknown deltas are used.
+BOOST_AUTO_TEST_CASE(costmodel_unknown_rates)
+{
+  using namespace applydeltarpm;
+  resetRates();
+  BOOST_CHECK( worthwhile( 1000000, 1000000 ) );
+
+  noteApply( 10000000, 1.0 );			// 10MB/s
+  BOOST_CHECK( worthwhile( 1000000, 1000000 ) );
+
+  // samples w/o size or time are ignored
+  noteDownload( 0, 1.0 );
+  noteDownload( 1000000, 0.0 );
+  BOOST_CHECK( worthwhile( 1000000, 1000000 ) );
+
+  // files provided w/o or with a single progress report were not transferred
+  DownloadTimer().note( 1000000 );
+  std::chrono::steady_clock::time_point start;
+  DownloadTimer timer;
+  timer.tick( start );
+  timer.note( 1000000 );
+  BOOST_CHECK( worthwhile( 1000000, 1000000 ) );
+
+  // a timed transfer of unknown size is ignored
+  timer.tick( start + std::chrono::milliseconds( 10 ) );
+  timer.note( 0 );
+  BOOST_CHECK( worthwhile( 1000000, 1000000 ) );
+
+  // the timed transfer is noted: 1MB in 10ms makes re-creating slower than downloading
+  timer.note( 1000000 );
+  BOOST_CHECK( ! worthwhile( 900000, 1000000 ) );
+}
+
+BOOST_AUTO_TEST_CASE(costmodel_worthwhile)
+{
+  using namespace applydeltarpm;
+  resetRates();
+  // let the moving averages settle at 1MB/s download and 10MB/s re-creation
+  for ( unsigned i = 0; i < 100; ++i )
+  {
+    noteDownload( 1000000, 1.0 );
+    noteApply( 10000000, 1.0 );
+  }
+  // full: 1s; delta: 0.1s download + 0.1s re-creation
+  BOOST_CHECK( worthwhile( 100000, 1000000 ) );
+  // full: 1s; delta: 0.95s download + 0.1s re-creation
+  BOOST_CHECK( ! worthwhile( 950000, 1000000 ) );
+  // with 4 concurrent re-creations only 0.025s count
+  BOOST_CHECK( worthwhile( 950000, 1000000, 4 ) );
+  // 0 workers count as 1
+  BOOST_CHECK( ! worthwhile( 950000, 1000000, 0 ) );
+
+  // a slow link makes deltas pay
+  for ( unsigned i = 0; i < 100; ++i )
+    noteDownload( 100000, 1.0 );
+  BOOST_CHECK( worthwhile( 950000, 1000000 ) );
+}
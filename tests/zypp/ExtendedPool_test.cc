@@ -7,6 +7,7 @@
 
 #include <zypp/ResObjects.h>
 #include <zypp/ResPool.h>
+#include <zypp/ResPoolProxy.h>
 
 using boost::unit_test::test_case;
 using std::cin;
@@ -83,3 +84,56 @@ BOOST_AUTO_TEST_CASE(t_1)	{ testcase_init(); }
 BOOST_AUTO_TEST_CASE(t_2)	{ repocheck(); }
 BOOST_AUTO_TEST_CASE(t_4)	{ testcase_init2(); }
 BOOST_AUTO_TEST_CASE(t_5)	{ repocheck(); }
+
+///////////////////////////////////////////////////////////////////
+// The status is kept per solvable id, not per PoolItem copy.
+// Saving/restoring the state covers the whole pool.
+///////////////////////////////////////////////////////////////////
+
+void statuscheck()
+{
+  ResPool pool( ResPool::instance() );
+  ResPoolProxy proxy( pool.proxy() );
+  PoolItem pi( *pool.begin() );
+  BOOST_REQUIRE( pi );
+  BOOST_CHECK( PoolItem( pi.satSolvable() ) == pi );
+  BOOST_CHECK( ! pi.status().transacts() );
+
+  proxy.saveState();
+  pi.status().setTransact( true, ResStatus::USER );
+  BOOST_CHECK( PoolItem( pi.satSolvable() ).status().transacts() );
+  BOOST_CHECK( proxy.diffState() );
+
+  proxy.restoreState();
+  BOOST_CHECK( ! pi.status().transacts() );
+  BOOST_CHECK( ! proxy.diffState() );
+}
+
+BOOST_AUTO_TEST_CASE(t_6)	{ statuscheck(); }
+
+///////////////////////////////////////////////////////////////////
+// A PoolItem outliving its solvable must not share the status of
+// the item reusing the id.
+///////////////////////////////////////////////////////////////////
+
+void stalecheck()
+{
+  PoolItem old( *ResPool::instance().begin() );
+  BOOST_REQUIRE( old );
+  old.status().setTransact( true, ResStatus::USER );
+
+  sat::Pool::instance().reposEraseAll();
+  test.loadTestcaseRepos( TESTS_SRC_DIR"/data/PoolReuseIds/SeqA" );
+
+  PoolItem now( old.satSolvable() );	// reusing the id
+  BOOST_REQUIRE( now );
+  BOOST_CHECK( ! now.status().transacts() );
+
+  old.status().setLock( true, ResStatus::USER );
+  BOOST_CHECK( ! now.status().isLocked() );
+  now.status().setTransact( true, ResStatus::USER );
+  BOOST_CHECK( ! old.status().transacts() );
+  now.status().setTransact( false, ResStatus::USER );
+}
+
+BOOST_AUTO_TEST_CASE(t_7)	{ stalecheck(); }
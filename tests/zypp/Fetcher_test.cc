@@ -1,7 +1,9 @@
+#include <fstream>
 #include "TestSetup.h"
 
 #include "zypp/MediaSetAccess.h"
 #include "zypp/Fetcher.h"
+#include "zypp/ZYppCallbacks.h"
 
 #include "WebServer.h"
 
@@ -11,6 +13,26 @@
 
 BOOST_AUTO_TEST_SUITE( fetcher_test );
 
+namespace
+{
+  /** Records the max. number of downloads in progress, may abort them. */
+  struct DownloadReceiver : public callback::ReceiveReport<media::DownloadProgressReport>
+  {
+    virtual void start( const Url & file_r, Pathname localfile_r )
+    { _max = std::max( _max, ++_active ); }
+
+    virtual bool progress( int value_r, const Url & file_r, double dbps_avg, double dbps_current )
+    { return ! _abort; }
+
+    virtual void finish( const Url & file_r, Error error_r, const std::string & reason_r )
+    { --_active; }
+
+    unsigned _active = 0;
+    unsigned _max = 0;
+    bool _abort = false;
+  };
+}
+
 BOOST_AUTO_TEST_CASE(fetcher_enqueuedir_noindex)
 {
   MediaSetAccess media( ( DATADIR).asUrl(), "/" );
@@ -371,6 +393,90 @@ BOOST_AUTO_TEST_CASE(enqueuedir_http)
   web.stop();
 }
 
+BOOST_AUTO_TEST_CASE(enqueuefiles_http)
+{
+  WebServer web((Pathname(TESTS_SRC_DIR) + "/zypp/data/Fetcher/remote-site").c_str(), 10001);
+  web.start();
+
+  MediaSetAccess media( web.url(), "/" );
+  filesystem::TmpDir dest;
+  {
+    // attach the media, so the next files can be prefetched
+    Fetcher fetcher;
+    fetcher.enqueue(OnMediaLocation("/file-current.txt"));
+    fetcher.start( dest.path(), media );
+  }
+  {
+    // files transferred concurrently are still validated one by one
+    DownloadReceiver receiver;
+    receiver.connect();
+    web.setDelay( 200 );
+    web.resetCounters();
+    Fetcher fetcher;
+    for ( const std::string & file : { "/file-1.txt", "/file-2.txt", "/file-3.txt", "/file-4.txt" } )
+      fetcher.enqueue(OnMediaLocation(file));
+    fetcher.enqueue(OnMediaLocation("/file-missing.txt").setOptional(true));
+    fetcher.start( dest.path(), media );
+    for ( const std::string & file : { "/file-1.txt", "/file-2.txt", "/file-3.txt", "/file-4.txt" } )
+      BOOST_CHECK( PathInfo(dest.path() + file).isFile() );
+    BOOST_CHECK( ! PathInfo(dest.path() + "/file-missing.txt").isExist() );
+    BOOST_CHECK_MESSAGE( web.maxConcurrentRequests() > 1, "max. " << web.maxConcurrentRequests() << " concurrent requests" );
+    BOOST_CHECK_MESSAGE( receiver._max > 1, "max. " << receiver._max << " downloads reported at a time" );
+    BOOST_CHECK_EQUAL( receiver._active, 0 );
+    web.setDelay( 0 );
+  }
+  {
+    // the user may abort the transfers
+    DownloadReceiver receiver;
+    receiver._abort = true;
+    receiver.connect();
+    filesystem::TmpDir dest2;
+    Fetcher fetcher;
+    for ( const std::string & file : { "/file-1.txt", "/file-2.txt", "/file-3.txt", "/file-4.txt" } )
+      fetcher.enqueue(OnMediaLocation(file));
+    BOOST_CHECK_THROW( fetcher.start( dest2.path(), media ), Exception );
+    BOOST_CHECK( ! PathInfo(dest2.path() + "/file-1.txt").isExist() );
+    BOOST_CHECK_EQUAL( receiver._active, 0 );
+  }
+  {
+    filesystem::TmpDir dest2;
+    Fetcher fetcher;
+    OnMediaLocation loc("/file-2.txt");
+    loc.setChecksum(CheckSum::sha1("0000000000000000000000000000000000000000"));
+    fetcher.enqueue(OnMediaLocation("/file-1.txt"));
+    fetcher.enqueueDigested(loc);
+    fetcher.enqueue(OnMediaLocation("/file-3.txt"));
+    BOOST_CHECK_THROW( fetcher.start( dest2.path(), media ), Exception );
+    BOOST_CHECK( PathInfo(dest2.path() + "/file-1.txt").isFile() );
+    BOOST_CHECK( ! PathInfo(dest2.path() + "/file-2.txt").isExist() );
+    BOOST_CHECK( ! PathInfo(dest2.path() + "/file-3.txt").isExist() );
+  }
+  {
+    // files already below the attach point are prefetched only if modified
+    filesystem::TmpDir dest2;
+    Fetcher fetcher;
+    for ( const std::string & file : { "/file-1.txt", "/file-2.txt", "/file-3.txt", "/file-4.txt" } )
+      fetcher.enqueue(OnMediaLocation(file));
+    fetcher.start( dest2.path(), media );
+    for ( const std::string & file : { "/file-1.txt", "/file-2.txt", "/file-3.txt", "/file-4.txt" } )
+      BOOST_CHECK_EQUAL( CheckSum::sha1(std::ifstream((dest2.path() + file).c_str())),
+                         CheckSum::sha1(std::ifstream((DATADIR + file).c_str())) );
+  }
+  {
+    // prefetched files exceeding the expected size are rejected like downloads
+    filesystem::TmpDir dest2;
+    Fetcher fetcher;
+    fetcher.enqueue(OnMediaLocation("/complexdir/subdir1/SHA1SUMS"));
+    fetcher.enqueue(OnMediaLocation("/complexdir/subdir1/SHA1SUMS.key").setDownloadSize(ByteCount(1000)));
+    fetcher.enqueue(OnMediaLocation("/complexdir/subdir1/SHA1SUMS.asc"));
+    BOOST_CHECK_THROW( fetcher.start( dest2.path(), media ), Exception );
+    BOOST_CHECK( PathInfo(dest2.path() + "/complexdir/subdir1/SHA1SUMS").isFile() );
+    BOOST_CHECK( ! PathInfo(dest2.path() + "/complexdir/subdir1/SHA1SUMS.key").isExist() );
+  }
+
+  web.stop();
+}
+
 BOOST_AUTO_TEST_SUITE_END();
 
 // vim: set ts=2 sts=2 sw=2 ai et:
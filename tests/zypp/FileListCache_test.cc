@@ -0,0 +1,164 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <map>
+#include <set>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/String.h"
+#include "zypp/TmpPath.h"
+#include "zypp/PathInfo.h"
+#include "zypp/target/FileListCache.h"
+
+using boost::unit_test::test_case;
+using namespace std;
+using namespace zypp;
+using namespace zypp::target;
+
+namespace
+{
+  /** Fake rpmdb: the file list header of \c hdrNum is "hdr-<hdrNum>-<generation>". */
+  struct FakeRpmDb
+  {
+    FileListCache::HeaderReader reader()
+    {
+      return [this]( unsigned hdrNum_r )->string {
+	++reads[hdrNum_r];
+	if ( broken.count( hdrNum_r ) )
+	  return string();
+	return str::Str() << "hdr-" << hdrNum_r << "-" << generation[hdrNum_r];
+      };
+    }
+
+    map<unsigned,unsigned> reads;
+    map<unsigned,unsigned> generation;
+    set<unsigned> broken;
+  };
+
+  /** The cached header, without the rpm lead and signature wrapped around it. */
+  string header( const FileListCache::Blob & blob_r )
+  {
+    static const size_t wrapper = 96 + 16;
+    if ( ! blob_r || blob_r.size < wrapper )
+      return string();
+    return string( blob_r.data + wrapper, blob_r.size - wrapper );
+  }
+
+  FileListCache::Installed installed( unsigned count_r )
+  {
+    FileListCache::Installed ret;
+    for ( unsigned hdrNum = 1; hdrNum <= count_r; ++hdrNum )
+      ret[hdrNum] = str::Str() << "pkg" << hdrNum << "-1-1.x86_64@1000";
+    return ret;
+  }
+}
+
+// Misses are read once and written back, later caches read from the file.
+BOOST_AUTO_TEST_CASE(filelistcache_reuse)
+{
+  filesystem::TmpDir tmp;
+  Pathname file( tmp.path()/"filelists" );
+  FakeRpmDb rpmdb;
+  {
+    FileListCache cache( file, installed( 3 ), rpmdb.reader() );
+    FileListCache::Blob blob( cache.get( 2 ) );
+    BOOST_CHECK_EQUAL( header( blob ), "hdr-2-0" );
+    BOOST_CHECK_EQUAL( string( blob.data, 4 ), string( "\xed\xab\xee\xdb", 4 ) );	// rpm lead
+    BOOST_CHECK_EQUAL( header( cache.get( 2 ) ), "hdr-2-0" );
+    BOOST_CHECK_EQUAL( header( cache.get( 3 ) ), "hdr-3-0" );
+    BOOST_CHECK( ! cache.get( 4 ) );	// not installed
+    cache.save();
+  }
+  BOOST_CHECK_EQUAL( rpmdb.reads[2], 1 );
+  BOOST_CHECK_EQUAL( rpmdb.reads[3], 1 );
+  BOOST_CHECK_EQUAL( rpmdb.reads[4], 0 );
+  BOOST_REQUIRE( PathInfo( file ).isFile() );
+
+  rpmdb.reads.clear();
+  {
+    FileListCache cache( file, installed( 3 ), rpmdb.reader() );
+    BOOST_CHECK_EQUAL( header( cache.get( 2 ) ), "hdr-2-0" );
+    BOOST_CHECK_EQUAL( header( cache.get( 3 ) ), "hdr-3-0" );
+    BOOST_CHECK_EQUAL( header( cache.get( 1 ) ), "hdr-1-0" );
+    cache.save();
+  }
+  BOOST_CHECK_EQUAL( rpmdb.reads[1], 1 );
+  BOOST_CHECK_EQUAL( rpmdb.reads[2], 0 );
+  BOOST_CHECK_EQUAL( rpmdb.reads[3], 0 );
+
+  // up to date: no rewrite
+  PathInfo before( file );
+  {
+    FileListCache cache( file, installed( 3 ), rpmdb.reader() );
+    cache.get( 1 );
+    cache.save();
+  }
+  BOOST_CHECK_EQUAL( PathInfo( file ).ino(), before.ino() );
+}
+
+// Entries of updated or removed packages are not used and are dropped.
+BOOST_AUTO_TEST_CASE(filelistcache_invalidation)
+{
+  filesystem::TmpDir tmp;
+  Pathname file( tmp.path()/"filelists" );
+  FakeRpmDb rpmdb;
+  {
+    FileListCache cache( file, installed( 3 ), rpmdb.reader() );
+    for ( unsigned hdrNum = 1; hdrNum <= 3; ++hdrNum )
+      cache.get( hdrNum );
+    cache.save();
+  }
+
+  // package 2 updated (same header number, new identity), package 3 removed
+  FileListCache::Installed now( installed( 2 ) );
+  now[2] = "pkg2-2-1.x86_64@2000";
+  rpmdb.generation[2] = 1;
+  rpmdb.reads.clear();
+  {
+    FileListCache cache( file, now, rpmdb.reader() );
+    BOOST_CHECK_EQUAL( header( cache.get( 1 ) ), "hdr-1-0" );
+    BOOST_CHECK_EQUAL( header( cache.get( 2 ) ), "hdr-2-1" );
+    BOOST_CHECK( ! cache.get( 3 ) );
+    cache.save();
+  }
+  BOOST_CHECK_EQUAL( rpmdb.reads[1], 0 );
+  BOOST_CHECK_EQUAL( rpmdb.reads[2], 1 );
+  BOOST_CHECK_EQUAL( rpmdb.reads[3], 0 );
+
+  // package 3 is back with its old identity: it was dropped from the file
+  rpmdb.reads.clear();
+  {
+    FileListCache cache( file, installed( 3 ), rpmdb.reader() );
+    BOOST_CHECK_EQUAL( header( cache.get( 3 ) ), "hdr-3-0" );
+    BOOST_CHECK_EQUAL( header( cache.get( 2 ) ), "hdr-2-1" );	// read again, identity changed back
+  }
+  BOOST_CHECK_EQUAL( rpmdb.reads[3], 1 );
+  BOOST_CHECK_EQUAL( rpmdb.reads[2], 1 );
+}
+
+// Unreadable headers are not cached, a damaged cache file is ignored.
+BOOST_AUTO_TEST_CASE(filelistcache_errors)
+{
+  filesystem::TmpDir tmp;
+  Pathname file( tmp.path()/"filelists" );
+  FakeRpmDb rpmdb;
+  rpmdb.broken.insert( 1 );
+  {
+    FileListCache cache( file, installed( 2 ), rpmdb.reader() );
+    BOOST_CHECK( ! cache.get( 1 ) );
+    BOOST_CHECK( ! cache.get( 1 ) );
+    BOOST_CHECK_EQUAL( header( cache.get( 2 ) ), "hdr-2-0" );
+    cache.save();
+  }
+  BOOST_CHECK_EQUAL( rpmdb.reads[1], 2 );
+
+  for ( const string & garbage : { string( "ZYPPFLC1" ), string( 4096, 'x' ) } )
+  {
+    ofstream( file.c_str() ) << garbage;
+    rpmdb.reads.clear();
+    FileListCache cache( file, installed( 2 ), rpmdb.reader() );
+    BOOST_CHECK_EQUAL( header( cache.get( 2 ) ), "hdr-2-0" );
+    BOOST_CHECK_EQUAL( rpmdb.reads[2], 1 );
+  }
+}
@@ -8,6 +8,7 @@
 #include "zypp/base/Exception.h"
 #include "zypp/KeyRing.h"
 #include "zypp/PublicKey.h"
+#include "zypp/PathInfo.h"
 #include "zypp/TmpPath.h"
 
 #include <boost/test/auto_unit_test.hpp>
@@ -293,3 +294,31 @@ BOOST_AUTO_TEST_CASE(keyring_delete)
   }
 }
 
+
+BOOST_AUTO_TEST_CASE(keyring_save_restore)
+{
+  PublicKey key( Pathname(DATADIR) + "public.asc" );
+  TmpDir tmp_dir;
+  Pathname saved( tmp_dir.path()/"saved" );
+  {
+    KeyRing keyring( tmp_dir.path() );
+    BOOST_CHECK( ! keyring.restoreTrustedKeyRing( saved ) );
+    keyring.importKey( key, true );
+    keyring.saveTrustedKeyRing( saved );
+  }
+  {
+    KeyRing keyring( tmp_dir.path() );
+    BOOST_CHECK_EQUAL( keyring.trustedPublicKeys().size(), (unsigned) 0 );
+    BOOST_CHECK( keyring.restoreTrustedKeyRing( saved ) );
+    BOOST_CHECK_EQUAL( keyring.trustedPublicKeys().size(), (unsigned) 1 );
+    BOOST_CHECK( keyring.isKeyTrusted( key.id() ) );
+    BOOST_CHECK( keyring.verifyFileTrustedSignature( DATADIR + "repomd.xml", DATADIR + "repomd.xml.asc" ) );
+  }
+  {
+    // a saved keyring writable by others is not trusted
+    filesystem::chmod( saved, 0777 );
+    KeyRing keyring( tmp_dir.path() );
+    BOOST_CHECK( ! keyring.restoreTrustedKeyRing( saved ) );
+    BOOST_CHECK_EQUAL( keyring.trustedPublicKeys().size(), (unsigned) 0 );
+  }
+}
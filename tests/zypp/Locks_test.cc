@@ -8,6 +8,8 @@
 #include "zypp/PoolQueryUtil.tcc"
 #include "zypp/TmpPath.h"
 #include "zypp/Locks.h"
+#include "zypp/PoolQueryResult.h"
+#include "zypp/pool/HardLockIndex.h"
 #include "TestSetup.h"
 
 #define BOOST_TEST_MODULE Locks
@@ -113,3 +115,65 @@ BOOST_AUTO_TEST_CASE( locks_empty )
   locks.removeEmpty();
   BOOST_CHECK( locks.size() == 0 );
 }
+
+BOOST_AUTO_TEST_CASE( hardlock_index )
+{
+  cout << "****compiled hard locks****"  << endl;
+  pool::PoolTraits::HardLockQueries simple;
+  {
+    PoolQuery q;	// as stored by zypper
+    q.addAttribute( sat::SolvAttr::name, "zypper" );
+    q.setMatchGlob();
+    q.setCaseSensitive( true );
+    simple.push_back( q );
+  }
+  {
+    PoolQuery q;
+    q.addAttribute( sat::SolvAttr::name, "libzypp" );
+    q.addKind( ResKind::package );
+    q.setMatchExact();
+    q.setCaseSensitive( true );
+    q.setEdition( Edition("5"), Rel::GE );
+    simple.push_back( q );
+  }
+  {
+    PoolQuery q;
+    q.addAttribute( sat::SolvAttr::name, "glibc" );
+    q.setMatchExact();
+    q.setCaseSensitive( true );
+    q.setStatusFilterFlags( PoolQuery::INSTALLED_ONLY );
+    simple.push_back( q );
+  }
+  pool::PoolTraits::HardLockQueries complex;
+  {
+    PoolQuery q;
+    q.addString( "zypper" );
+    complex.push_back( q );
+  }
+  {
+    PoolQuery q;
+    q.addAttribute( sat::SolvAttr::name, "zyp*" );
+    q.setMatchGlob();
+    q.setCaseSensitive( true );
+    complex.push_back( q );
+  }
+  {
+    PoolQuery q;
+    q.addDependency( sat::SolvAttr::name, "zypper", Rel::GT, Edition("1") );
+    complex.push_back( q );
+  }
+
+  pool::HardLockIndex index( simple );
+  BOOST_CHECK_EQUAL( index.simpleSize(), simple.size() );
+  BOOST_CHECK( index.complex().empty() );
+  pool::HardLockIndex cindex( complex );
+  BOOST_CHECK_EQUAL( cindex.simpleSize(), 0 );
+  BOOST_CHECK_EQUAL( cindex.complex().size(), complex.size() );
+
+  PoolQueryResult locked;
+  for ( const PoolQuery & q : simple )
+    locked += q;
+  BOOST_CHECK( ! locked.empty() );
+  for ( const PoolItem & pi : ResPool::instance() )
+    BOOST_CHECK_EQUAL( index.matches( pi.satSolvable() ), locked.contains( pi ) );
+}
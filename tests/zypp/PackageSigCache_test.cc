@@ -0,0 +1,162 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+#include "zypp/target/rpm/PackageSigCache.h"
+
+using namespace std;
+using namespace zypp;
+using zypp::target::rpm::PackageSigCache;
+
+namespace
+{
+  void writeFile( const Pathname & file_r, const string & data_r )
+  { ofstream( file_r.c_str() ) << data_r; }
+
+  PackageSigCache::Result result( int res_r, const string & log_r )
+  {
+    PackageSigCache::Result ret;
+    ret.res = res_r;
+    ret.log = log_r;
+    return ret;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(sigcache_store_lookup)
+{
+  filesystem::TmpDir tmp;
+  Pathname cachefile( tmp.path()/".sigcache" );
+  Pathname pkg( tmp.path()/"some package.rpm" );
+  writeFile( pkg, "package" );
+  string log( "some package.rpm:\n    Header V3 RSA/SHA256 Signature, key ID 3dbdc284: OK\n" );
+
+  {
+    PackageSigCache cache( cachefile );
+    cache.setKeyring( "3dbdc284-53674dd4" );
+    string digest( cache.digest( pkg ) );
+    BOOST_CHECK_EQUAL( digest, filesystem::checksum( pkg, "sha256" ) );
+    PackageSigCache::Result res;
+    BOOST_CHECK( ! cache.lookup( digest, res ) );
+    cache.store( pkg, digest, result( 0, log ) );
+    BOOST_REQUIRE( cache.lookup( digest, res ) );
+    BOOST_CHECK_EQUAL( res.log, log );
+  }	// saved
+  BOOST_REQUIRE( PathInfo( cachefile ).isFile() );
+
+  {
+    PackageSigCache cache( cachefile );
+    cache.setKeyring( "3dbdc284-53674dd4" );
+    PackageSigCache::Result res;
+    // a copy of the package has the same result
+    Pathname copy( tmp.path()/"copy.rpm" );
+    filesystem::copy( pkg, copy );
+    BOOST_REQUIRE( cache.lookup( cache.digest( copy ), res ) );
+    BOOST_CHECK_EQUAL( res.res, 0 );
+    BOOST_CHECK_EQUAL( res.log, log );
+    // a modified package not
+    writeFile( pkg, "modified package" );
+    BOOST_CHECK( ! cache.lookup( cache.digest( pkg ), res ) );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(sigcache_invalidate)
+{
+  filesystem::TmpDir tmp;
+  Pathname cachefile( tmp.path()/".sigcache" );
+  Pathname pkg( tmp.path()/"pkg.rpm" );
+  Pathname gone( tmp.path()/"gone.rpm" );
+  writeFile( pkg, "package" );
+  writeFile( gone, "removed package" );
+  string digest( filesystem::checksum( pkg, "sha256" ) );
+  string gonedigest( filesystem::checksum( gone, "sha256" ) );
+
+  {
+    PackageSigCache cache( cachefile );
+    cache.setKeyring( "keys1" );
+    cache.store( pkg, digest, result( 0, "ok" ) );
+    cache.store( gone, gonedigest, result( 0, "ok" ) );
+  }
+  filesystem::unlink( gone );
+  {
+    PackageSigCache cache( cachefile );
+    cache.setKeyring( "keys1" );
+    PackageSigCache::Result res;
+    BOOST_CHECK( cache.lookup( digest, res ) );
+    BOOST_CHECK( cache.lookup( gonedigest, res ) );
+    cache.store( pkg, digest, result( 0, "ok" ) );
+  }	// drops the entry of the removed file
+  {
+    PackageSigCache cache( cachefile );
+    cache.setKeyring( "keys1" );
+    PackageSigCache::Result res;
+    BOOST_CHECK( cache.lookup( digest, res ) );
+    BOOST_CHECK( ! cache.lookup( gonedigest, res ) );
+    // a changed keyring invalidates all entries
+    cache.setKeyring( "keys1 keys2" );
+    BOOST_CHECK( ! cache.lookup( digest, res ) );
+  }
+  {
+    PackageSigCache cache( cachefile );
+    cache.setKeyring( "keys1" );
+    PackageSigCache::Result res;
+    BOOST_CHECK( ! cache.lookup( digest, res ) );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(sigcache_untrusted)
+{
+  filesystem::TmpDir tmp;
+  Pathname cachefile( tmp.path()/".sigcache" );
+  Pathname pkg( tmp.path()/"pkg.rpm" );
+  writeFile( pkg, "package" );
+  string digest( filesystem::checksum( pkg, "sha256" ) );
+
+  auto cached = [&]() {
+    PackageSigCache cache( cachefile );
+    cache.setKeyring( "keys1" );
+    PackageSigCache::Result res;
+    return cache.lookup( digest, res );
+  };
+  auto store = [&]() {
+    PackageSigCache cache( cachefile );
+    cache.setKeyring( "keys1" );
+    cache.store( pkg, digest, result( 0, "ok" ) );
+  };
+
+  store();
+  BOOST_CHECK( cached() );
+  BOOST_CHECK_EQUAL( PathInfo( cachefile.extend( ".key" ) ).perm() & 0777, 0600 );
+
+  // a cache file or directory writable by others is ignored
+  filesystem::chmod( cachefile, 0666 );
+  BOOST_CHECK( ! cached() );
+  filesystem::chmod( cachefile, 0644 );
+  BOOST_CHECK( cached() );
+  filesystem::chmod( tmp.path(), 0777 );
+  BOOST_CHECK( ! cached() );
+  filesystem::chmod( tmp.path(), 0700 );
+  BOOST_CHECK( cached() );
+
+  // a key readable by others too
+  filesystem::chmod( cachefile.extend( ".key" ), 0644 );
+  BOOST_CHECK( ! cached() );
+  filesystem::unlink( cachefile.extend( ".key" ) );
+  BOOST_CHECK( ! cached() );
+
+  // a modified entry fails to verify
+  store();
+  BOOST_REQUIRE( cached() );
+  string data;
+  {
+    ifstream in( cachefile.c_str() );
+    data.assign( istreambuf_iterator<char>( in ), istreambuf_iterator<char>() );
+  }
+  string::size_type pos = data.find( "\n" + digest + " 0 " );
+  BOOST_REQUIRE( pos != string::npos );
+  data[pos + 1 + digest.size() + 1] = '1';
+  writeFile( cachefile, data );
+  BOOST_CHECK( ! cached() );
+}
@@ -47,6 +47,33 @@ BOOST_AUTO_TEST_CASE(pathinfo_checksum_test)
   BOOST_REQUIRE( is_checksum( file.path(), file_md5 ) );
 }
 
+/**
+ * Test case for
+ * void rememberChecksum( const Pathname & file, const CheckSum & checksum_r );
+ */
+BOOST_AUTO_TEST_CASE(pathinfo_remember_checksum_test)
+{
+  TmpFile file;
+  {
+    ofstream str( file.path().c_str() );
+    str << "I will test the checksum of this";
+  }
+  // a remembered checksum is not recomputed...
+  CheckSum fake( "sha1", "0000000000000000000000000000000000000000" );
+  rememberChecksum( file.path(), fake );
+  BOOST_CHECK_EQUAL( checksum( file.path(), "sha1" ), fake.checksum() );
+  BOOST_CHECK( is_checksum( file.path(), fake ) );
+  // ...only for the remembered type...
+  BOOST_CHECK_EQUAL( checksum( file.path(), "md5" ), "f139a810b84d82d1f29fc53c5e59beae" );
+  // ...and as long as the file is unchanged
+  {
+    ofstream str( file.path().c_str(), ofstream::app );
+    str << "!";
+  }
+  BOOST_CHECK( checksum( file.path(), "sha1" ) != fake.checksum() );
+  BOOST_CHECK( ! is_checksum( file.path(), fake ) );
+}
+
 BOOST_AUTO_TEST_CASE(pathinfo_is_exist_test)
 {
   TmpDir dir;
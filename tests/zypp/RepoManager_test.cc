@@ -10,6 +10,7 @@
 #include "zypp/PublicKey.h"
 #include "zypp/TmpPath.h"
 #include "zypp/PathInfo.h"
+#include "zypp/CheckSum.h"
 #include "zypp/ServiceInfo.h"
 
 #include "zypp/RepoManager.h"
@@ -272,6 +273,118 @@ BOOST_AUTO_TEST_CASE(repomanager_test)
 
 }
 
+BOOST_AUTO_TEST_CASE(buildcaches_test)
+{
+  TmpDir tmpCachePath;
+  RepoManagerOptions opts( RepoManagerOptions::makeTestSetup( tmpCachePath ) ) ;
+  RepoManager manager(opts);
+
+  KeyRingTestReceiver keyring_callbacks;
+  KeyRingTestSignalReceiver receiver;
+
+  // disable sgnature checking
+  keyring_callbacks.answerAcceptKey(KeyRingReport::KEY_TRUST_TEMPORARILY);
+  keyring_callbacks.answerAcceptVerFailed(true);
+  keyring_callbacks.answerAcceptUnknownKey(true);
+
+  std::list<RepoInfo> infos;
+  for ( const std::string & alias : { "yum1", "yum2", "yum3" } )
+  {
+    RepoInfo repo;
+    repo.setAlias( alias );
+    repo.setBaseUrl( (Pathname(TESTS_SRC_DIR) / "/repo/yum/data/10.2-updates-subset").asDirUrl() );
+    infos.push_back( repo );
+  }
+  RepoInfo susetags;
+  susetags.setAlias( "susetags" );
+  susetags.setBaseUrl( (Pathname(TESTS_SRC_DIR) / "/repo/susetags/data/stable-x86-subset").asDirUrl() );
+  infos.push_back( susetags );
+
+  unsigned reports = 0;
+  manager.buildCaches( infos, RepoManager::BuildIfNeeded, 2, [&reports]( const ProgressData & ) { ++reports; return true; } );
+  BOOST_CHECK( reports > 0 );
+
+  for ( const RepoInfo & repo : infos )
+  {
+    BOOST_CHECK_MESSAGE( manager.isCached( repo ), "Repo should be cached now: " + repo.alias() );
+    BOOST_CHECK_MESSAGE( manager.cacheStatus( repo ) == manager.metadataStatus( repo ), "Cookie written: " + repo.alias() );
+  }
+
+}
+
+BOOST_AUTO_TEST_CASE(buildcaches_failing_repo)
+{
+  KeyRingTestReceiver keyring_callbacks;
+  KeyRingTestSignalReceiver receiver;
+  keyring_callbacks.answerAcceptKey(KeyRingReport::KEY_TRUST_TEMPORARILY);
+  keyring_callbacks.answerAcceptVerFailed(true);
+  keyring_callbacks.answerAcceptUnknownKey(true);
+  keyring_callbacks.answerAcceptUnsignedFile(true);
+
+  // A repo whose metadata can be downloaded but not parsed fails in the build.
+  TmpDir tmpRepo;
+  filesystem::assert_dir( tmpRepo.path()/"repodata" );
+  std::ofstream( (tmpRepo.path()/"repodata/primary.xml").c_str() ) << "<metadata><package type=\"rpm\"><name>";
+  CheckSum primary( CheckSum::sha256( std::ifstream( (tmpRepo.path()/"repodata/primary.xml").c_str() ) ) );
+  std::ofstream( (tmpRepo.path()/"repodata/repomd.xml").c_str() )
+    << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    << "<repomd xmlns=\"http://linux.duke.edu/metadata/repo\">\n"
+    << "  <data type=\"primary\">\n"
+    << "    <location href=\"repodata/primary.xml\"/>\n"
+    << "    <checksum type=\"sha256\">" << primary.checksum() << "</checksum>\n"
+    << "  </data>\n"
+    << "</repomd>\n";
+
+  RepoInfo good;
+  good.setAlias( "good" );
+  good.setBaseUrl( (Pathname(TESTS_SRC_DIR) / "/repo/yum/data/10.2-updates-subset").asDirUrl() );
+  RepoInfo missing;	// fails when preparing the build
+  missing.setAlias( "missing" );
+  missing.setBaseUrl( (Pathname(TESTS_SRC_DIR) / "/repo/nonexistent").asDirUrl() );
+  RepoInfo broken;	// fails when building
+  broken.setAlias( "broken" );
+  broken.setType( repo::RepoType::RPMMD );
+  broken.setBaseUrl( tmpRepo.path().asDirUrl() );
+  RepoInfo after( good );
+  after.setAlias( "after" );
+
+  // Same rule for serial and parallel builds: all repos that can be built
+  // are built, the 1st error in list order is rethrown.
+  for ( unsigned jobs : { 1U, 2U } )
+  {
+    TmpDir tmpCachePath;
+    RepoManager manager( RepoManagerOptions::makeTestSetup( tmpCachePath ) );
+
+    std::list<RepoInfo> infos { good, broken, missing, after };
+    std::string what;
+    try
+    {
+      manager.buildCaches( infos, RepoManager::BuildForced, jobs );
+    }
+    catch ( const Exception & excpt )
+    {
+      what = excpt.asString();
+    }
+    BOOST_CHECK_MESSAGE( ! what.empty(), "Exception expected with jobs " << jobs );
+    BOOST_CHECK_MESSAGE( manager.isCached( good ), "good cached with jobs " << jobs );
+    BOOST_CHECK_MESSAGE( ! manager.isCached( broken ), "broken not cached with jobs " << jobs );
+    BOOST_CHECK_MESSAGE( ! manager.isCached( missing ), "missing not cached with jobs " << jobs );
+    BOOST_CHECK_MESSAGE( manager.isCached( after ), "after cached with jobs " << jobs );
+
+    // The error of 'broken' precedes the one of 'missing'.
+    std::string brokenWhat;
+    try
+    {
+      manager.buildCaches( { broken }, RepoManager::BuildForced, jobs );
+    }
+    catch ( const Exception & excpt )
+    {
+      brokenWhat = excpt.asString();
+    }
+    BOOST_CHECK_EQUAL( what, brokenWhat );
+  }
+}
+
 BOOST_AUTO_TEST_CASE(repo_seting_test)
 {
   RepoInfo repo;
@@ -0,0 +1,218 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/Logger.h"
+#include "zypp/base/String.h"
+#include "zypp/ExternalProgram.h"
+#include "zypp/TmpPath.h"
+#include "zypp/PathInfo.h"
+#include "zypp/ZConfig.h"
+#include "zypp/Callback.h"
+#include "zypp/target/rpm/RpmDb.h"
+#include "zypp/target/rpm/RpmCallbacks.h"
+
+using boost::unit_test::test_case;
+using namespace std;
+using namespace zypp;
+using namespace zypp::target::rpm;
+
+namespace
+{
+  /** Build a noarch rpm \c name_r-1-1 owning \c /usr/share/zypptest/name_r. */
+  Pathname buildRpm( const Pathname & topdir_r, const string & name_r, const string & requires_r = string() )
+  {
+    Pathname spec( topdir_r/(name_r+".spec") );
+    {
+      ofstream o( spec.c_str() );
+      o << "Name: " << name_r << endl
+        << "Version: 1" << endl
+        << "Release: 1" << endl
+        << "Summary: " << name_r << endl
+        << "License: GPL-2.0+" << endl
+        << "BuildArch: noarch" << endl;
+      if ( ! requires_r.empty() )
+        o << "Requires: " << requires_r << endl;
+      o << "%description" << endl
+        << name_r << endl
+        << "%install" << endl
+        << "mkdir -p %{buildroot}/usr/share/zypptest" << endl
+        << "echo " << name_r << " > %{buildroot}/usr/share/zypptest/" << name_r << endl
+        << "%files" << endl
+        << "/usr/share/zypptest/" << name_r << endl;
+    }
+    string topdir( "_topdir " + topdir_r.asString() );
+    const char* argv[] = {
+      "rpmbuild", "-bb", "--quiet",
+      "--define", topdir.c_str(),
+      "--define", "_build_id_links none",
+      spec.c_str(),
+      NULL
+    };
+    ExternalProgram prog( argv, ExternalProgram::Stderr_To_Stdout );
+    for ( string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() )
+      MIL << "  " << output;
+    Pathname ret( topdir_r/"RPMS/noarch"/(name_r+"-1-1.noarch.rpm") );
+    return ( prog.close() == 0 && PathInfo( ret ).isFile() ) ? ret : Pathname();
+  }
+
+  /** A copy of \a rpm_r with the end of the payload cut off. */
+  Pathname truncatedRpm( const Pathname & rpm_r )
+  {
+    Pathname ret( rpm_r.extend( ".broken" ) );
+    PathInfo pi( rpm_r );
+    if ( filesystem::copy( rpm_r, ret ) != 0 || ::truncate( ret.c_str(), pi.size() - 64 ) != 0 )
+      return Pathname();
+    return ret;
+  }
+
+  bool canTest()
+  {
+    if ( ::geteuid() != 0 )
+    {
+      BOOST_TEST_MESSAGE( "installing into a root requires root privileges; skipped" );
+      return false;
+    }
+    return true;
+  }
+
+  /** Record what is reported and let the failed items be aborted. */
+  struct InstallReceiver : public callback::ReceiveReport<RpmInstallReport>
+  {
+    InstallReceiver() { connect(); }
+    ~InstallReceiver() { disconnect(); }
+
+    virtual void start( const Pathname & name_r )
+    { started.push_back( name_r.basename() ); }
+
+    virtual Action problem( Exception & excpt_r )
+    { ++problems; return ABORT; }
+
+    vector<string> started;
+    unsigned problems = 0;
+  };
+
+  struct Batch
+  {
+    Batch( const vector<RpmDb::InstallItem> & items_r, RpmInstFlags flags_r )
+    {
+      db.initDatabase( root );
+      db.installPackages( items_r, flags_r,
+                          [this]( unsigned idx_r ) { begin.push_back( idx_r ); },
+                          [this]( unsigned idx_r, bool success_r ) { end.push_back( make_pair( idx_r, success_r ) ); } );
+    }
+    ~Batch()
+    { db.closeDatabase(); }
+
+    filesystem::TmpDir root;
+    RpmDb db;
+    vector<unsigned> begin;
+    vector<pair<unsigned,bool>> end;
+  };
+}
+
+// The batch is installed in the given order, even if rpm would order it differently.
+BOOST_AUTO_TEST_CASE(installpackages_keeps_order)
+{
+  if ( ! canTest() )
+    return;
+  filesystem::TmpDir topdir;
+  Pathname a( buildRpm( topdir, "zypptest-a", "zypptest-b" ) );
+  Pathname b( buildRpm( topdir, "zypptest-b" ) );
+  if ( a.empty() || b.empty() )
+  {
+    BOOST_TEST_MESSAGE( "rpmbuild not available; skipped" );
+    return;
+  }
+
+  InstallReceiver receiver;
+  Batch batch( { a, b }, RPMINST_NOSIGNATURE );	// dependency check on
+
+  BOOST_CHECK_EQUAL( batch.begin.size(), 2 );
+  BOOST_CHECK_EQUAL( batch.begin[0], 0 );	// zypptest-a although it requires zypptest-b
+  BOOST_CHECK_EQUAL( batch.begin[1], 1 );
+  BOOST_REQUIRE_EQUAL( receiver.started.size(), 2 );
+  BOOST_CHECK_EQUAL( receiver.started[0], a.basename() );
+  BOOST_CHECK_EQUAL( receiver.started[1], b.basename() );
+  BOOST_CHECK_EQUAL( receiver.problems, 0 );
+  BOOST_CHECK( batch.db.hasPackage( "zypptest-a" ) );
+  BOOST_CHECK( batch.db.hasPackage( "zypptest-b" ) );
+}
+
+// A failing item is reported as failed, the others are installed.
+BOOST_AUTO_TEST_CASE(installpackages_failing_item)
+{
+  if ( ! canTest() )
+    return;
+  filesystem::TmpDir topdir;
+  Pathname a( buildRpm( topdir, "zypptest-a" ) );
+  Pathname b( truncatedRpm( buildRpm( topdir, "zypptest-b" ) ) );
+  Pathname c( buildRpm( topdir, "zypptest-c" ) );
+  if ( a.empty() || b.empty() || c.empty() )
+  {
+    BOOST_TEST_MESSAGE( "rpmbuild not available; skipped" );
+    return;
+  }
+
+  InstallReceiver receiver;
+  Batch batch( { a, b, c }, RPMINST_NODEPS|RPMINST_NODIGEST|RPMINST_NOSIGNATURE );
+
+  // every item ends exactly once, only zypptest-b failed
+  BOOST_REQUIRE_EQUAL( batch.end.size(), 3 );
+  vector<int> success( 3, -1 );
+  for ( const auto & end : batch.end )
+  {
+    BOOST_CHECK_EQUAL( success[end.first], -1 );
+    success[end.first] = end.second;
+  }
+  BOOST_CHECK_EQUAL( success[0], 1 );
+  BOOST_CHECK_EQUAL( success[1], 0 );
+  BOOST_CHECK_EQUAL( success[2], 1 );
+  BOOST_CHECK_EQUAL( receiver.problems, 1 );
+
+  BOOST_CHECK( batch.db.hasPackage( "zypptest-a" ) );
+  BOOST_CHECK( batch.db.hasPackage( "zypptest-c" ) );
+  BOOST_CHECK( PathInfo( batch.root.path()/"usr/share/zypptest/zypptest-a" ).isFile() );
+  BOOST_CHECK( PathInfo( batch.root.path()/"usr/share/zypptest/zypptest-c" ).isFile() );
+}
+
+// Checking many signatures concurrently yields the same as checking them one by one.
+BOOST_AUTO_TEST_CASE(checkpackagesignatures_concurrent)
+{
+  filesystem::TmpDir topdir;
+  vector<Pathname> paths;
+  for ( const char * name : { "zypptest-a", "zypptest-b", "zypptest-c", "zypptest-d", "zypptest-e", "zypptest-f" } )
+    paths.push_back( buildRpm( topdir, name ) );
+  if ( paths[0].empty() )
+  {
+    BOOST_TEST_MESSAGE( "rpmbuild not available; skipped" );
+    return;
+  }
+  paths.push_back( truncatedRpm( paths[1] ) );
+  paths.push_back( topdir.path()/"zypptest-a.spec" );	// not an rpm
+  paths.push_back( topdir.path()/"nosuchfile.rpm" );
+
+  // use a signature cache of our own
+  Pathname packagesPath( ZConfig::instance().repoPackagesPath() );
+  ZConfig::instance().setRepoPackagesPath( topdir.path() );
+
+  filesystem::TmpDir root;
+  RpmDb db;
+  db.initDatabase( root );
+  vector<RpmDb::CheckPackageResult> results( db.checkPackageSignatures( paths ) );
+  BOOST_REQUIRE_EQUAL( results.size(), paths.size() );
+  for ( unsigned idx = 0; idx < paths.size(); ++idx )
+  {
+    RpmDb::CheckPackageDetail detail;
+    BOOST_CHECK_MESSAGE( results[idx] == db.checkPackageSignature( paths[idx], detail ), paths[idx] << ": " << results[idx] );
+  }
+  BOOST_CHECK_EQUAL( results[0], RpmDb::CHK_NOSIG );	// unsigned
+  BOOST_CHECK_EQUAL( results.back(), RpmDb::CHK_ERROR );
+  db.closeDatabase();
+  BOOST_CHECK( PathInfo( topdir.path()/".sigcache" ).isFile() );
+  ZConfig::instance().setRepoPackagesPath( packagesPath );
+}
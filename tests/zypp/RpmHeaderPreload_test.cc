@@ -0,0 +1,116 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <stdexcept>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/String.h"
+#include "zypp/TmpPath.h"
+#include "zypp/target/RpmHeaderPreload.h"
+
+using boost::unit_test::test_case;
+using namespace std;
+using namespace zypp;
+using namespace zypp::target;
+
+namespace
+{
+  /** An rpm header structure with \a il_r index entries and \a dl_r bytes of data. */
+  string rpmHeader( unsigned il_r, unsigned dl_r )
+  {
+    string ret( "\x8e\xad\xe8\x01\0\0\0\0", 8 );
+    for ( unsigned val : { il_r, dl_r } )
+      for ( int shift = 24; shift >= 0; shift -= 8 )
+	ret += char( ( val >> shift ) & 0xff );
+    ret += string( il_r * 16 + dl_r, 'h' );
+    return ret;
+  }
+
+  /** Lead, signature (padded to 8), main header and payload of an rpm file. */
+  string rpmFile( const string & payload_r = string( 4096, 'p' ) )
+  {
+    string ret( 96, 'l' );
+    ret += rpmHeader( 1, 3 );	// 35 bytes
+    ret += string( 5, '\0' );
+    ret += rpmHeader( 2, 10 );
+    ret += payload_r;
+    return ret;
+  }
+
+  Pathname writeFile( const Pathname & file_r, const string & data_r )
+  {
+    ofstream( file_r.c_str() ) << data_r;
+    return file_r;
+  }
+
+  /** Throw on any progress report, like a user abort does. */
+  struct AbortingReceiver
+  {
+    bool operator()( const ProgressData & )
+    { throw std::runtime_error( "abort" ); }
+  };
+}
+
+// Only lead, signature and main header are read.
+BOOST_AUTO_TEST_CASE(readheaders)
+{
+  filesystem::TmpDir tmp;
+  string data( rpmFile() );
+  string blob;
+  BOOST_REQUIRE( RpmHeaderPreload::readHeaders( writeFile( tmp.path()/"a.rpm", data ), blob ) );
+  BOOST_CHECK_EQUAL( blob.size(), 96 + 40 + 16 + 2*16 + 10 );
+  BOOST_CHECK( blob == data.substr( 0, blob.size() ) );
+
+  // header only, no payload
+  BOOST_CHECK( RpmHeaderPreload::readHeaders( writeFile( tmp.path()/"b.rpm", rpmFile( "" ) ), blob ) );
+  // not an rpm, truncated header, missing file
+  BOOST_CHECK( ! RpmHeaderPreload::readHeaders( writeFile( tmp.path()/"c.rpm", string( 4096, 'x' ) ), blob ) );
+  BOOST_CHECK( ! RpmHeaderPreload::readHeaders( writeFile( tmp.path()/"d.rpm", data.substr( 0, 180 ) ), blob ) );
+  BOOST_CHECK( ! RpmHeaderPreload::readHeaders( tmp.path()/"nosuchfile.rpm", blob ) );
+}
+
+// All queued files are loaded by the threads and counted in the progress.
+BOOST_AUTO_TEST_CASE(load)
+{
+  filesystem::TmpDir tmp;
+  string data( rpmFile() );
+  RpmHeaderPreload headers;
+  for ( int id = 2; id < 42; ++id )
+    headers.add( id, writeFile( tmp.path()/(str::numstring(id)+".rpm"), data ) );
+  headers.add( 42, tmp.path()/"nosuchfile.rpm" );
+  headers.add( 43, writeFile( tmp.path()/"broken.rpm", data.substr( 0, 180 ) ) );
+  BOOST_CHECK_EQUAL( headers.size(), 42 );
+
+  ProgressData progress( 100 );
+  progress.set( 10 );
+  headers.load( 3, progress );
+  BOOST_CHECK_EQUAL( progress.val(), 52 );
+
+  for ( int id = 2; id < 42; ++id )
+  {
+    const RpmHeaderPreload::Header * header( headers.find( id ) );
+    BOOST_REQUIRE( header );
+    BOOST_CHECK_EQUAL( header->file, tmp.path()/(str::numstring(id)+".rpm") );
+    BOOST_CHECK( header->blob == data.substr( 0, header->blob.size() ) );
+    BOOST_CHECK( header->blob.size() < data.size() );
+  }
+  BOOST_CHECK( ! headers.find( 42 ) );
+  BOOST_CHECK( ! headers.find( 43 ) );
+  BOOST_CHECK( ! headers.find( 44 ) );	// not queued
+}
+
+// An exception from the progress receiver stops the threads and is passed on.
+BOOST_AUTO_TEST_CASE(load_abort)
+{
+  filesystem::TmpDir tmp;
+  string data( rpmFile() );
+  RpmHeaderPreload headers;
+  for ( int id = 2; id < 200; ++id )
+    headers.add( id, writeFile( tmp.path()/(str::numstring(id)+".rpm"), data ) );
+
+  ProgressData progress( 1000 );
+  progress.sendTo( AbortingReceiver() );
+  BOOST_CHECK_THROW( headers.load( 4, progress ), std::runtime_error );
+  progress.noSend();	// no final report from the dtor
+}
@@ -0,0 +1,106 @@
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/Logger.h"
+#include "zypp/base/String.h"
+#include "zypp/base/Easy.h"
+#include "zypp/ExternalProgram.h"
+#include "zypp/TmpPath.h"
+#include "zypp/PathInfo.h"
+#include "zypp/ResObjects.h"
+#include "zypp/Repository.h"
+#include "zypp/sat/Pool.h"
+#include "zypp/sat/LookupAttr.h"
+#include "zypp/target/TargetImpl.h"
+
+using boost::unit_test::test_case;
+using namespace std;
+using namespace zypp;
+
+namespace
+{
+  /** Run rpmdb2solv like TargetImpl::buildCache does (w/o products). */
+  bool rpmdb2solv( const Pathname & root_r, const Pathname & out_r )
+  {
+    const char* argv[] = { "rpmdb2solv", "-r", root_r.c_str(), "-X", "-o", out_r.c_str(), NULL };
+    ExternalProgram prog( argv, ExternalProgram::Stderr_To_Stdout );
+    for ( string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() )
+      MIL << "  " << output;
+    return prog.close() == 0;
+  }
+
+  /** A sorted dump of all solvables and all their attributes. */
+  vector<string> dump( Repository repo_r )
+  {
+    vector<string> ret;
+    for ( sat::Solvable solv : repo_r.solvables() )
+    {
+      vector<string> attrs;
+      sat::LookupAttr q( sat::SolvAttr::allAttr, solv );
+      for_( it, q.begin(), q.end() )
+	attrs.push_back( it.inSolvAttr().asString() + "=" + it.asString() );
+      sort( attrs.begin(), attrs.end() );
+      ret.push_back( str::Str() << solv.ident() << "-" << solv.edition() << "." << solv.arch() << ": " << str::join( attrs, "|" ) );
+    }
+    sort( ret.begin(), ret.end() );
+    return ret;
+  }
+}
+
+// The incrementally patched @System solv file must equal a full rebuild.
+BOOST_AUTO_TEST_CASE(patch_equals_rebuild)
+{
+  filesystem::TmpDir tmp;
+  Pathname full( tmp.path()/"full" );
+  Pathname patched( tmp.path()/"patched" );
+  Pathname root( "/" );
+
+  if ( ! rpmdb2solv( root, full ) )
+  {
+    BOOST_TEST_MESSAGE( "rpmdb2solv not available or no rpm database; skipped" );
+    return;
+  }
+  BOOST_REQUIRE_EQUAL( filesystem::copy( full, patched ), 0 );
+
+  sat::Pool satpool( sat::Pool::instance() );
+  set<string> names;
+  {
+    Repository repo( satpool.addRepoSolv( full, "full" ) );
+    for ( sat::Solvable solv : repo.solvables() )
+    {
+      if ( solv.isKind<Package>() )
+	names.insert( solv.name() );
+    }
+    repo.eraseFromPool();
+  }
+  if ( names.empty() )
+  {
+    BOOST_TEST_MESSAGE( "no installed packages; skipped" );
+    return;
+  }
+
+  // re-read every installed package (incl. their triggers) into the copy
+  BOOST_REQUIRE( target::TargetImpl::patchSolvFile( root, patched, names ) );
+
+  Repository frepo( satpool.addRepoSolv( full, "full" ) );
+  Repository prepo( satpool.addRepoSolv( patched, "patched" ) );
+  vector<string> fdump( dump( frepo ) );
+  vector<string> pdump( dump( prepo ) );
+  BOOST_CHECK_EQUAL( fdump.size(), pdump.size() );
+  BOOST_CHECK( fdump == pdump );
+  for ( unsigned i = 0; i < std::min( fdump.size(), pdump.size() ); ++i )
+  {
+    if ( fdump[i] != pdump[i] )
+    {
+      BOOST_CHECK_EQUAL( fdump[i], pdump[i] );	// show the first difference
+      break;
+    }
+  }
+  frepo.eraseFromPool();
+  prepo.eraseFromPool();
+}
@@ -0,0 +1,88 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <cstdlib>
+#include <fcntl.h>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/String.h"
+#include "zypp/AutoDispose.h"
+#include "zypp/ExternalProgram.h"
+
+using namespace std;
+using namespace zypp;
+
+namespace
+{
+  /** Stdout of \a argv_r (stderr merged). */
+  string output( const ExternalProgram::Arguments & argv_r, const ExternalProgram::Environment & env_r = ExternalProgram::Environment(),
+		 bool defaultLocale_r = false, int * status_r = nullptr )
+  {
+    ExternalProgram prog( argv_r, env_r, ExternalProgram::Stderr_To_Stdout, false, -1, defaultLocale_r );
+    ostringstream str;
+    prog >> str;
+    int status = prog.close();
+    if ( status_r )
+      *status_r = status;
+    return str.str();
+  }
+
+  /** Run \a test_r using the default spawn and the fork/exec backend. */
+  template <class Test>
+  void bothBackends( Test test_r )
+  {
+    ::unsetenv( "ZYPP_EXEC_FORK" );
+    test_r();
+    ::setenv( "ZYPP_EXEC_FORK", "1", 1 );
+    test_r();
+    ::unsetenv( "ZYPP_EXEC_FORK" );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(exec_io)
+{
+  bothBackends( []() {
+    BOOST_CHECK_EQUAL( output( { "echo", "hello" } ), "hello\n" );
+    BOOST_CHECK_EQUAL( output( { "sh", "-c", "echo err >&2" } ), "err\n" );
+    BOOST_CHECK_EQUAL( output( { "</dev/null", "cat" } ), "" );
+    BOOST_CHECK_EQUAL( output( { "#/", "pwd" } ), "/\n" );
+
+    ExternalProgram::Environment env;
+    env["ZYPP_TEST_VAR"] = "value";
+    env["LC_ALL"] = "de_DE";
+    BOOST_CHECK_EQUAL( output( { "sh", "-c", "echo $ZYPP_TEST_VAR $LC_ALL" }, env ), "value de_DE\n" );
+    BOOST_CHECK_EQUAL( output( { "sh", "-c", "echo $ZYPP_TEST_VAR $LC_ALL" }, env, true ), "value C\n" );
+  } );
+}
+
+BOOST_AUTO_TEST_CASE(exec_fds_closed)
+{
+  AutoDispose<int> fd( ::open( "/dev/null", O_RDONLY ), ::close );	// no O_CLOEXEC
+  BOOST_REQUIRE( fd >= 3 );
+  bothBackends( []() {
+    // just stdin, stdout, stderr and the directory being listed
+    string fds( output( { "ls", "/proc/self/fd" } ) );
+    BOOST_CHECK_EQUAL( str::trim( fds ), "0\n1\n2\n3" );
+  } );
+}
+
+BOOST_AUTO_TEST_CASE(exec_error)
+{
+  bothBackends( []() {
+    int status = 0;
+    output( { "/no/such/program" }, ExternalProgram::Environment(), false, &status );
+    BOOST_CHECK_EQUAL( status, 129 );
+
+    ExternalProgram nodir( ExternalProgram::Arguments{ "#/no/such/dir", "pwd" }, ExternalProgram::Stderr_To_Stdout );
+    ostringstream out;
+    nodir >> out;
+    BOOST_CHECK_EQUAL( nodir.close(), 128 );
+    // the forked child reports on stderr, the spawn path in execError
+    string msg( out.str() + nodir.execError() );
+    BOOST_CHECK_MESSAGE( msg.find( "Can't chdir to '/no/such/dir'" ) != string::npos, msg );
+
+    ExternalProgram prog( { "sh", "-c", "exit 3" } );
+    BOOST_CHECK_EQUAL( prog.close(), 3 );
+    BOOST_CHECK_EQUAL( prog.execError(), "Command exited with status 3." );
+  } );
+}
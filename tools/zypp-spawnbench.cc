@@ -0,0 +1,100 @@
+#include <sys/resource.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <zypp/base/String.h>
+#include <zypp/Pathname.h>
+#include <zypp/ExternalProgram.h>
+
+/** Mean latency in microseconds to start and wait for \c /bin/true. */
+double measure( unsigned runs_r )
+{
+  const char * argv[] = { "/bin/true", nullptr };
+  auto start = std::chrono::steady_clock::now();
+  for ( unsigned i = 0; i < runs_r; ++i )
+  {
+    zypp::ExternalProgram prog( argv );
+    prog.close();
+  }
+  std::chrono::duration<double, std::micro> elapsed( std::chrono::steady_clock::now() - start );
+  return elapsed.count() / runs_r;
+}
+
+void usage( const std::string & appname )
+{
+  std::cout << "Usage: " << appname << " [--help] [--runs <n>] [--nofile <n>] [--memory <MB>]" << std::endl;
+  std::cout << "Compare the latency of starting an ExternalProgram via posix_spawn" << std::endl;
+  std::cout << "and via fork/exec (ZYPP_EXEC_FORK)." << std::endl;
+  std::cout << std::endl;
+  std::cout << "  --runs <n>     Number of programs started per backend (100)." << std::endl;
+  std::cout << "  --nofile <n>   Raise RLIMIT_NOFILE to <n> (hard limit)." << std::endl;
+  std::cout << "  --memory <MB>  Touch <MB> of memory to simulate a large process (0)." << std::endl;
+}
+
+int main( int argc, char * argv[] )
+{
+  std::string progname( zypp::Pathname::basename( argv[0] ) );
+  unsigned runs = 100;
+  rlim_t nofile = 0;
+  unsigned memory = 0;
+  argv++;
+  argc--;
+
+  while( argc > 0 ) {
+    if ( strcmp( argv[0], "--help" ) == 0 )
+    {
+      usage( progname );
+      return 0;
+    } else if ( argc > 1 && strcmp( argv[0], "--runs" ) == 0 ) {
+      argv++;
+      argc--;
+      runs = zypp::str::strtonum<unsigned>( argv[0] );
+    } else if ( argc > 1 && strcmp( argv[0], "--nofile" ) == 0 ) {
+      argv++;
+      argc--;
+      nofile = zypp::str::strtonum<rlim_t>( argv[0] );
+    } else if ( argc > 1 && strcmp( argv[0], "--memory" ) == 0 ) {
+      argv++;
+      argc--;
+      memory = zypp::str::strtonum<unsigned>( argv[0] );
+    } else {
+      std::cerr << progname << ": unexpected argument '" << argv[0] << "'" << std::endl;
+      std::cerr << "Try `" << progname << " --help' for more information." << std::endl;
+      return 1;
+    }
+
+    argv++;
+    argc--;
+  }
+  if ( ! runs )
+    runs = 1;
+
+  struct rlimit rl;
+  ::getrlimit( RLIMIT_NOFILE, &rl );
+  if ( nofile )
+  {
+    rl.rlim_cur = nofile;
+    if ( rl.rlim_max < nofile )
+      rl.rlim_max = nofile;
+    if ( ::setrlimit( RLIMIT_NOFILE, &rl ) != 0 )
+    {
+      std::cerr << progname << ": can't set RLIMIT_NOFILE to " << nofile << ": " << strerror(errno) << std::endl;
+      return 2;
+    }
+  }
+
+  std::vector<char> ballast( size_t(memory) * 1024 * 1024, '\1' );
+
+  std::cout << "RLIMIT_NOFILE " << rl.rlim_cur << ", " << memory << " MB, " << runs << " runs" << std::endl;
+  ::unsetenv( "ZYPP_EXEC_FORK" );
+  double spawn = measure( runs );
+  ::setenv( "ZYPP_EXEC_FORK", "1", 1 );
+  double fork = measure( runs );
+  printf( "posix_spawn: %10.1f us\n", spawn );
+  printf( "fork/exec:   %10.1f us\n", fork );
+  return 0;
+}
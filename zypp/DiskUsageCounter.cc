@@ -21,10 +21,13 @@ extern "C"
 #include "zypp/base/LogTools.h"
 #include "zypp/base/DtorReset.h"
 #include "zypp/base/String.h"
+#include "zypp/base/SerialNumber.h"
+#include "zypp/base/NonCopyable.h"
 
 #include "zypp/DiskUsageCounter.h"
 #include "zypp/ExternalProgram.h"
 #include "zypp/sat/Pool.h"
+#include "zypp/sat/LookupAttr.h"
 #include "zypp/sat/detail/PoolImpl.h"
 
 using std::endl;
@@ -37,22 +40,19 @@ namespace zypp
   namespace
   { /////////////////////////////////////////////////////////////////
 
-    DiskUsageCounter::MountPointSet calcDiskUsage( DiskUsageCounter::MountPointSet result, const Bitmap & installedmap_r )
-    {
-      if ( result.empty() )
-      {
-        // partitioning is not set
-        return result;
-      }
+    typedef std::vector< ::DUChanges> DuChanges;
 
+    /** The libsolv disk usage changes per mountpoint in \a mps_r. */
+    DuChanges calcDuChanges( const DiskUsageCounter::MountPointSet & mps_r, const Bitmap & installedmap_r )
+    {
       sat::Pool satpool( sat::Pool::instance() );
 
       // init libsolv result vector with mountpoints
       static const ::DUChanges _initdu = { 0, 0, 0, 0 };
-      std::vector< ::DUChanges> duchanges( result.size(), _initdu );
+      DuChanges duchanges( mps_r.size(), _initdu );
       {
         unsigned idx = 0;
-        for_( it, result.begin(), result.end() )
+        for_( it, mps_r.begin(), mps_r.end() )
         {
           duchanges[idx].path = it->dir.c_str();
 	  if ( it->growonly )
@@ -65,44 +65,224 @@ namespace zypp
                              const_cast<Bitmap &>(installedmap_r),
                              &duchanges[0],
                              duchanges.size() );
+      return duchanges;
+    }
 
-      // and process the result
+    /** Set the mountpoints \c pkg_size according to \a duchanges_r. */
+    DiskUsageCounter::MountPointSet applyDuChanges( DiskUsageCounter::MountPointSet result, const DuChanges & duchanges_r )
+    {
+      unsigned idx = 0;
+      for_( it, result.begin(), result.end() )
       {
-        unsigned idx = 0;
-        for_( it, result.begin(), result.end() )
-        {
-	  // Limit estimated waste (half block per file) as it does not apply to
-	  // btrfs, which reports up to 64K blocksize (bsc#974275,bsc#965322)
-	  static const ByteCount blockAdjust( 2, ByteCount::K ); // (files * blocksize) / 2 / 1K; result value in K!
+	// Limit estimated waste (half block per file) as it does not apply to
+	// btrfs, which reports up to 64K blocksize (bsc#974275,bsc#965322)
+	static const ByteCount blockAdjust( 2, ByteCount::K ); // (files * blocksize) / 2 / 1K; result value in K!
+
+        it->pkg_size = it->used_size          // current usage
+                     + duchanges_r[idx].kbytes  // package data size
+                     + ( duchanges_r[idx].files * ( it->fstype == "btrfs" ? 4096 : it->block_size ) / blockAdjust ); // half block per file
+        ++idx;
+      }
+      return result;
+    }
 
-          it->pkg_size = it->used_size          // current usage
-                       + duchanges[idx].kbytes  // package data size
-                       + ( duchanges[idx].files * ( it->fstype == "btrfs" ? 4096 : it->block_size ) / blockAdjust ); // half block per file
-          ++idx;
-        }
+    DiskUsageCounter::MountPointSet calcDiskUsage( DiskUsageCounter::MountPointSet result, const Bitmap & installedmap_r )
+    {
+      if ( result.empty() )
+      {
+        // partitioning is not set
+        return result;
       }
+      DuChanges duchanges( calcDuChanges( result, installedmap_r ) );
+      return applyDuChanges( std::move(result), duchanges );
+    }
 
-      return result;
+    /** The installedmap for \ref DiskUsageCounter::disk_usage (installed != transact). */
+    Bitmap installedMap( const ResPool & pool_r )
+    {
+      Bitmap bitmap( Bitmap::poolSize );
+      // stays installed or gets installed
+      for_( it, pool_r.begin(), pool_r.end() )
+      {
+        if ( it->status().isInstalled() != it->status().transacts() )
+        {
+          bitmap.set( sat::asSolvable()(*it).id() );
+        }
+      }
+      return bitmap;
     }
 
     /////////////////////////////////////////////////////////////////
   } // namespace
   ///////////////////////////////////////////////////////////////////
 
-  DiskUsageCounter::MountPointSet DiskUsageCounter::disk_usage( const ResPool & pool_r ) const
+  ///////////////////////////////////////////////////////////////////
+  /// \class DiskUsageCounter::Incremental
+  /// \brief Running disk usage totals updated by the items that changed.
+  ///
+  /// The totals are the libsolv disk usage changes of the last full
+  /// computation. \c _inMap remembers the installedmap they refer to. On
+  /// \ref disk_usage the pool is scanned for items now leaving or entering
+  /// the installedmap (a cheap status test per item). Just their disk usage
+  /// is computed (with the \c @System repo unset, as for the per solvable
+  /// disk usage) and applied to the totals. Installed items are subtracted
+  /// unless the mountpoint is growonly, like libsolv does.
+  ///////////////////////////////////////////////////////////////////
+  class DiskUsageCounter::Incremental : private base::NonCopyable
   {
-    Bitmap bitmap( Bitmap::poolSize );
+  public:
+    MountPointSet disk_usage( const MountPointSet & mps_r, const ResPool & pool_r )
+    {
+      if ( mps_r.empty() )
+        return mps_r;	// partitioning is not set
+
+      if ( ! _valid || _watcher.remember( pool_r.serial() ) || ! sameMountPoints( mps_r ) )
+        return rebuild( mps_r, pool_r );
+
+      Bitmap plus( Bitmap::poolSize );	// entering the installedmap
+      Bitmap minus( Bitmap::poolSize );	// leaving the installedmap
+      Bitmap iplus( Bitmap::poolSize );	// installed ones...
+      Bitmap iminus( Bitmap::poolSize );
+      unsigned changed[4] = { 0, 0, 0, 0 };	// set in plus, minus, iplus, iminus
+      for_( it, pool_r.begin(), pool_r.end() )
+      {
+        const ResStatus & status( it->status() );
+        sat::detail::SolvableIdType solv( sat::asSolvable()(*it).id() );
+        bool inMap = ( status.isInstalled() != status.transacts() );
+        if ( inMap == _inMap.test( solv ) )
+          continue;
+        _inMap.assign( solv, inMap );
+        if ( status.isInstalled() )
+        {
+          ( inMap ? iplus : iminus ).set( solv );
+          ++changed[inMap ? 2 : 3];
+        }
+        else
+        {
+          ( inMap ? plus : minus ).set( solv );
+          ++changed[inMap ? 0 : 1];
+          if ( hasNonlinearEffect( solv ) )
+          {
+            if ( inMap ) ++_nonlinear; else --_nonlinear;
+          }
+        }
+      }
+
+      if ( changed[0] || changed[1] || changed[2] || changed[3] )
+      {
+        // temp. unset @System Repo
+        DtorReset tmp( sat::Pool::instance().get()->installed );
+        sat::Pool::instance().get()->installed = nullptr;
+
+        if ( changed[0] ) apply( mps_r, plus,   +1, true );
+        if ( changed[1] ) apply( mps_r, minus,  -1, true );
+        if ( changed[2] ) apply( mps_r, iplus,  +1, false );
+        if ( changed[3] ) apply( mps_r, iminus, -1, false );
+      }
+
+      if ( _nonlinear )
+      {
+        // libsolv ignores the installed packages replaced by a package
+        // without disk usage data. Not a per item delta, so compute it all.
+        _valid = false;
+        return calcDiskUsage( mps_r, _inMap );
+      }
+      return applyDuChanges( mps_r, _totals );
+    }
+
+  private:
+    MountPointSet rebuild( const MountPointSet & mps_r, const ResPool & pool_r )
+    {
+      _nonlinear = 0;
+      _mountPoints.clear();
+      for ( const MountPoint & mp : mps_r )
+        _mountPoints.push_back( std::make_pair( mp.dir, mp.growonly ) );
+
+      _inMap = installedMap( pool_r );
+      for_( it, pool_r.begin(), pool_r.end() )
+      {
+        sat::detail::SolvableIdType solv( sat::asSolvable()(*it).id() );
+        if ( _inMap.test( solv ) && ! it->status().isInstalled() && hasNonlinearEffect( solv ) )
+          ++_nonlinear;
+      }
+      _totals = calcDuChanges( mps_r, _inMap );
+      _valid = ( _nonlinear == 0 );
+      _watcher.remember( pool_r.serial() );
+      return applyDuChanges( mps_r, _totals );
+    }
 
-    // build installedmap (installed != transact)
-    // stays installed or gets installed
-    for_( it, pool_r.begin(), pool_r.end() )
+    bool sameMountPoints( const MountPointSet & mps_r ) const
     {
-      if ( it->status().isInstalled() != it->status().transacts() )
+      if ( mps_r.size() != _mountPoints.size() )
+        return false;
+      unsigned idx = 0;
+      for ( const MountPoint & mp : mps_r )
       {
-        bitmap.set( sat::asSolvable()(*it).id() );
+        if ( _mountPoints[idx].first != mp.dir || _mountPoints[idx].second != mp.growonly )
+          return false;
+        ++idx;
       }
+      return true;
     }
-    return calcDiskUsage( _mps, bitmap );
+
+    /** A to be installed package without disk usage data (while there is an @System repo). */
+    bool hasNonlinearEffect( sat::detail::SolvableIdType solv_r ) const
+    {
+      return( sat::Pool::instance().get()->installed
+              && sat::LookupAttr( sat::SolvAttr::diskusage, sat::Solvable( solv_r ) ).empty() );
+    }
+
+    /** Add (\a sign_r \c +1) or subtract (\c -1) the disk usage of the items in \a bitmap_r. */
+    void apply( const MountPointSet & mps_r, Bitmap & bitmap_r, int sign_r, bool growonlyToo_r )
+    {
+      DuChanges delta( calcDuChanges( mps_r, bitmap_r ) );
+      for ( unsigned idx = 0; idx < delta.size(); ++idx )
+      {
+        if ( ! growonlyToo_r && _mountPoints[idx].second )
+          continue;
+        _totals[idx].kbytes += sign_r * delta[idx].kbytes;
+        _totals[idx].files  += sign_r * delta[idx].files;
+      }
+    }
+
+  private:
+    bool _valid = false;
+    SerialNumberWatcher _watcher;
+    std::vector<std::pair<std::string,bool>> _mountPoints;	///< (dir,growonly) the totals refer to
+    DuChanges _totals;
+    Bitmap _inMap;		///< the installedmap the totals refer to
+    unsigned _nonlinear = 0;	///< selected items \ref hasNonlinearEffect
+  };
+  ///////////////////////////////////////////////////////////////////
+
+  DiskUsageCounter::DiskUsageCounter( const DiskUsageCounter & rhs )
+  : _mps( rhs._mps )
+  { setIncremental( rhs.incremental() ); }
+
+  DiskUsageCounter & DiskUsageCounter::operator=( const DiskUsageCounter & rhs )
+  {
+    if ( this != &rhs )
+    {
+      _mps = rhs._mps;
+      setIncremental( rhs.incremental() );
+    }
+    return *this;
+  }
+
+  DiskUsageCounter::~DiskUsageCounter()
+  {}
+
+  void DiskUsageCounter::setIncremental( bool yesno_r )
+  {
+    if ( yesno_r != incremental() )
+      _incremental.reset( yesno_r ? new Incremental : nullptr );
+  }
+
+  DiskUsageCounter::MountPointSet DiskUsageCounter::disk_usage( const ResPool & pool_r ) const
+  {
+    if ( _incremental )
+      return _incremental->disk_usage( _mps, pool_r );
+    return calcDiskUsage( _mps, installedMap( pool_r ) );
   }
 
   DiskUsageCounter::MountPointSet DiskUsageCounter::disk_usage( sat::Solvable solv_r ) const
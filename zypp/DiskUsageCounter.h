@@ -160,6 +160,15 @@ namespace zypp
     : _mps( mps_r )
     {}
 
+    /** Copy ctor (the incremental state is not shared). */
+    DiskUsageCounter( const DiskUsageCounter & rhs );
+
+    /** Assignment (the incremental state is not shared). */
+    DiskUsageCounter & operator=( const DiskUsageCounter & rhs );
+
+    /** Dtor */
+    ~DiskUsageCounter();
+
     /** Set a MountPointSet to compute */
     void setMountPoints( const MountPointSet & mps_r )
     { _mps = mps_r; }
@@ -179,9 +188,28 @@ namespace zypp
     static MountPointSet justRootPartition();
 
 
-    /** Compute disk usage if the current transaction woud be commited. */
+    /** Compute disk usage if the current transaction woud be commited.
+     * \see \ref setIncremental
+     */
     MountPointSet disk_usage( const ResPool & pool ) const;
 
+    /** Whether \ref disk_usage(const ResPool&) is computed incrementally. */
+    bool incremental() const
+    { return bool(_incremental); }
+
+    /** Compute \ref disk_usage(const ResPool&) incrementally.
+     * The counter keeps running totals per \ref MountPoint. On each call
+     * just the disk usage of the items whose transact status changed since
+     * the last call is applied. The result is the same as computed without
+     * incremental mode.
+     *
+     * The totals are rebuilt if the pool content or the mount points
+     * change. While a package without disk usage data is selected, libsolv
+     * ignores the disk usage of the installed packages it replaces. As this
+     * is not a per item delta, the full computation is done then.
+     */
+    void setIncremental( bool yesno_r );
+
     /** Compute disk usage of a single Solvable */
     MountPointSet disk_usage( sat::Solvable solv_r ) const;
     /** \overload for PoolItem */
@@ -205,7 +233,9 @@ namespace zypp
     }
 
   private:
+    class Incremental;
     MountPointSet _mps;
+    shared_ptr<Incremental> _incremental;
   };
   ///////////////////////////////////////////////////////////////////
 
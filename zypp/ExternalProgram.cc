@@ -15,13 +15,19 @@
 #include <errno.h>
 #include <unistd.h>
 #include <sys/wait.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
 #include <fcntl.h>
 #include <pty.h> // openpty
+#include <spawn.h>
 #include <stdlib.h> // setenv
 
+#include <cstddef> // offsetof
+
 #include <cstring> // strsignal
 #include <iostream>
 #include <sstream>
+#include <vector>
 
 #include "zypp/base/Logger.h"
 #include "zypp/base/String.h"
@@ -34,8 +40,68 @@ using namespace std;
 #undef  ZYPP_BASE_LOGGER_LOGGROUP
 #define ZYPP_BASE_LOGGER_LOGGROUP "zypp::exec"
 
+#if defined(__GLIBC__) && defined(__GLIBC_PREREQ)
+#if __GLIBC_PREREQ(2,34)	// posix_spawn_file_actions_addclosefrom_np
+#define ZYPP_HAVE_SPAWN_CLOSEFROM 1
+#endif
+#endif
+
+extern char ** environ;
+
 namespace zypp {
 
+  namespace
+  {
+    /** Close all file descriptors >= \a lowfd_r.
+     * Used in the forked child, so only async-signal-safe calls here. With a high
+     * \c RLIMIT_NOFILE, closing every fd up to \c getdtablesize() costs a syscall
+     * per possible fd. So try \c close_range, then just the fds listed in
+     * \c /proc/self/fd.
+     */
+    void closeFrom( int lowfd_r )
+    {
+#ifdef SYS_close_range
+      if ( ::syscall( SYS_close_range, lowfd_r, ~0U, 0 ) == 0 )
+	return;
+#endif
+      int dirfd = ::open( "/proc/self/fd", O_RDONLY|O_DIRECTORY|O_CLOEXEC );
+      if ( dirfd != -1 )
+      {
+	struct Dirent64	// linux_dirent64 as returned by getdents64
+	{
+	  uint64_t       d_ino;
+	  int64_t        d_off;
+	  unsigned short d_reclen;
+	  unsigned char  d_type;
+	  char           d_name[256];
+	};
+	char buf[4096] __attribute__((aligned(8)));
+	for ( long n; ( n = ::syscall( SYS_getdents64, dirfd, buf, sizeof(buf) ) ) > 0; )
+	{
+	  for ( long off = 0; off < n; )
+	  {
+	    const char * entry = buf + off;
+	    const char * name = entry + offsetof( Dirent64, d_name );
+	    off += reinterpret_cast<const Dirent64 *>(entry)->d_reclen;
+	    int fd = 0;
+	    for ( ; *name >= '0' && *name <= '9'; ++name )
+	      fd = fd * 10 + ( *name - '0' );
+	    if ( *name == '\0' && fd >= lowfd_r && fd != dirfd )
+	      ::close( fd );
+	  }
+	}
+	::close( dirfd );
+	return;
+      }
+      for ( int i = ::getdtablesize() - 1; i >= lowfd_r; --i )
+	::close( i );
+    }
+
+    /** Whether \c ZYPP_EXEC_FORK requests the fork/exec backend (e.g. for comparison). */
+    inline bool forceFork()
+    { return ::getenv( "ZYPP_EXEC_FORK" ); }
+  } // namespace
+
     ExternalProgram::ExternalProgram()
       : use_pty (false)
       , pid( -1 )
@@ -284,7 +350,105 @@ namespace zypp {
       }
 
       // Create module process
-      if ((pid = fork()) == 0)
+      // posix_spawn uses clone(CLONE_VM|CLONE_VFORK) in glibc and thus does not copy
+      // our page tables. It can't chroot, and it searches the PATH of the parent.
+      int spawnError = -1;	// -1: not spawned, 0: spawned, else the errno
+      int chdirError = 0;	// the errno if the spawned child could not chdir
+#ifdef ZYPP_HAVE_SPAWN_CLOSEFROM
+      bool lowFds = use_pty ? ( master_tty < 3 || slave_tty < 3 )
+                            : ( to_external[0] < 3 || to_external[1] < 3 || from_external[0] < 3 || from_external[1] < 3 );
+      if ( ! root && ! lowFds && environment.find( "PATH" ) == environment.end() && ! forceFork() )
+      {
+	posix_spawn_file_actions_t actions;
+	posix_spawnattr_t attr;
+	::posix_spawn_file_actions_init( &actions );
+	::posix_spawnattr_init( &attr );
+	short flags = 0;
+
+	if ( use_pty )
+	{
+	  flags |= POSIX_SPAWN_SETSID;
+	  ::posix_spawn_file_actions_adddup2( &actions, slave_tty, 1 );	// set new stdout
+	  ::posix_spawn_file_actions_adddup2( &actions, slave_tty, 0 );	// set new stdin
+	  // After setsid the first tty we open becomes the controlling terminal.
+	  // It's closed along with all fds above stderr.
+	  char name[512];
+	  if ( ttyname_r( slave_tty, name, sizeof(name) ) == 0 )
+	    ::posix_spawn_file_actions_addopen( &actions, 3, name, O_RDONLY, 0 );
+	}
+	else
+	{
+	  if ( switch_pgid )
+	  {
+	    flags |= POSIX_SPAWN_SETPGROUP;
+	    ::posix_spawnattr_setpgroup( &attr, 0 );
+	  }
+	  ::posix_spawn_file_actions_adddup2( &actions, to_external[0], 0 );	// set new stdin
+	  ::posix_spawn_file_actions_adddup2( &actions, from_external[1], 1 );	// set new stdout
+	}
+
+	if ( redirectStdin )
+	  ::posix_spawn_file_actions_addopen( &actions, 0, redirectStdin, O_RDONLY, 0 );
+	if ( redirectStdout )
+	  ::posix_spawn_file_actions_addopen( &actions, 1, redirectStdout, O_WRONLY|O_CREAT|O_APPEND, 0600 );
+
+	// Handle stderr
+	if ( stderr_disp == Discard_Stderr )
+	  ::posix_spawn_file_actions_addopen( &actions, 2, "/dev/null", O_WRONLY, 0 );
+	else if ( stderr_disp == Stderr_To_Stdout )
+	  ::posix_spawn_file_actions_adddup2( &actions, 1, 2 );
+	else if ( stderr_disp == Stderr_To_FileDesc )
+	  ::posix_spawn_file_actions_adddup2( &actions, stderr_fd, 2 );
+
+	if ( chdirTo )
+	  ::posix_spawn_file_actions_addchdir_np( &actions, chdirTo );
+
+	// close all filedesctiptors above stderr
+	::posix_spawn_file_actions_addclosefrom_np( &actions, 3 );
+	::posix_spawnattr_setflags( &attr, flags );
+
+	// our environment with the additional variables overwriting existing ones
+	std::vector<std::string> envstr;
+	for ( char ** env = environ; env && *env; ++env )
+	{
+	  const char * sep = ::strchr( *env, '=' );
+	  std::string name( *env, sep ? sep - *env : ::strlen( *env ) );
+	  if ( environment.find( name ) == environment.end() && ! ( default_locale && name == "LC_ALL" ) )
+	    envstr.push_back( *env );
+	}
+	for ( Environment::const_iterator it = environment.begin(); it != environment.end(); ++it )
+	  envstr.push_back( it->first + "=" + it->second );
+	if ( default_locale )
+	  envstr.push_back( "LC_ALL=C" );
+	std::vector<char *> envp;
+	envp.reserve( envstr.size() + 1 );
+	for ( std::string & el : envstr )
+	  envp.push_back( &el[0] );
+	envp.push_back( nullptr );
+
+	spawnError = ::posix_spawnp( &pid, argv[0], &actions, &attr, const_cast<char *const *>(argv), &envp[0] );
+	if ( spawnError )
+	{
+	  pid = -1;
+	  // posix_spawn reports a failing chdir just like a failing exec
+	  if ( chdirTo )
+	  {
+	    struct stat st;
+	    if ( ::stat( chdirTo, &st ) == -1 )
+	      chdirError = errno;
+	    else if ( ! S_ISDIR( st.st_mode ) )
+	      chdirError = ENOTDIR;
+	    else if ( ::access( chdirTo, X_OK ) == -1 )
+	      chdirError = errno;
+	  }
+	}
+
+	::posix_spawnattr_destroy( &attr );
+	::posix_spawn_file_actions_destroy( &actions );
+      }
+#endif
+
+      if ( spawnError == -1 && (pid = fork()) == 0 )
       {
         //////////////////////////////////////////////////////////////////////
         // Don't write to the logfile after fork!
@@ -376,9 +540,7 @@ namespace zypp {
 	}
 
     	// close all filedesctiptors above stderr
-    	for ( int i = ::getdtablesize() - 1; i > 2; --i ) {
-    	  ::close( i );
-    	}
+    	closeFrom( 3 );
 
     	execvp(argv[0], const_cast<char *const *>(argv));
         // don't want to get here
@@ -390,8 +552,22 @@ namespace zypp {
 
       else if (pid == -1)	 // Fork failed, close everything.
       {
-        _execError = str::form( _("Can't fork (%s)."), strerror(errno) );
-        _exitStatus = 127;
+        if ( chdirError )
+        {
+          // as the forked child does
+          _execError = str::form( _("Can't chdir to '%s' (%s)."), chdirTo, strerror(chdirError) );
+          _exitStatus = 128;
+        }
+        else if ( spawnError > 0 )
+        {
+          _execError = str::form( _("Can't exec '%s' (%s)."), argv[0], strerror(spawnError) );
+          _exitStatus = 129;
+        }
+        else
+        {
+          _execError = str::form( _("Can't fork (%s)."), strerror(errno) );
+          _exitStatus = 127;
+        }
         ERR << _execError << endl;
 
    	if (use_pty) {
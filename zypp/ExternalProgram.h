@@ -28,9 +28,10 @@ namespace zypp {
     /**
      * @short Execute a program and give access to its io
      * An object of this class encapsulates the execution of
-     * an external program. It starts the program using fork
-     * and some exec.. call, gives you access to the program's
-     * stdio and closes the program after use.
+     * an external program. It starts the program using posix_spawn
+     * (or fork and some exec.. call if it needs to chroot), gives you
+     * access to the program's stdio and closes the program after use.
+     * Setting \c ZYPP_EXEC_FORK in the environment enforces fork/exec.
      *
      * \code
      *
@@ -175,6 +176,7 @@ namespace zypp {
        * \li <tt>Can't open pty (%s).</tt>
        * \li <tt>Can't open pipe (%s).</tt>
        * \li <tt>Can't fork (%s).</tt>
+       * \li <tt>Can't exec '%s' (%s).</tt>
        * \li <tt>Command exited with status %d.</tt>
        * \li <tt>Command was killed by signal %d (%s).</tt>
       */
@@ -13,6 +13,7 @@
 #include <fstream>
 #include <list>
 #include <map>
+#include <vector>
 
 #include "zypp/base/Easy.h"
 #include "zypp/base/LogControl.h"
@@ -189,6 +190,11 @@ namespace zypp
        * location of the cached file or an empty \ref Pathname.
        */
       Pathname locateInCache( const OnMediaLocation & resource_r, const Pathname & destDir_r );
+      /**
+       * Whether \ref locateInCache may find the file (checksum is not
+       * checked here).
+       */
+      bool maybeInCache( const OnMediaLocation & resource_r, const Pathname & destDir_r ) const;
       /**
        * Validates the provided file against its checkers.
        * \throws Exception
@@ -359,6 +365,22 @@ namespace zypp
     return ret;
   }
 
+  bool Fetcher::Impl::maybeInCache( const OnMediaLocation & resource_r, const Pathname & destDir_r ) const
+  {
+    if ( resource_r.checksum().empty() )
+      return false;
+
+    if ( PathInfo( destDir_r / resource_r.filename() ).isExist() )
+      return true;
+
+    for( const Pathname & cacheDir : _caches )
+    {
+      if ( PathInfo( cacheDir / resource_r.filename() ).isExist() )
+	return true;
+    }
+    return false;
+  }
+
   void Fetcher::Impl::validate( const Pathname & localfile_r, const std::list<FileChecker> & checkers_r )
   {
     try
@@ -722,6 +744,23 @@ namespace zypp
 
     downloadAndReadIndexList(media, dest_dir);
 
+    // Let the media transfer the files concurrently ahead. They are
+    // still provided and validated one by one in the loop below, so
+    // checks, results and progress are the same. Files which might be
+    // found in a cache are not prefetched, as well as files needing
+    // index auto discovery or a deltafile.
+    if ( ! ( _options & ( AutoAddChecksumsIndexes | AutoAddContentFileIndexes ) ) )
+    {
+      std::vector<OnMediaLocation> prefetch;
+      for ( const FetcherJob_Ptr & jobp : _resources )
+      {
+        if ( ! ( jobp->flags & FetcherJob::Directory ) && jobp->deltafile.empty() && ! maybeInCache( jobp->location, dest_dir ) )
+          prefetch.push_back( jobp->location );
+      }
+      if ( prefetch.size() > 1 )
+        media.prefetchFiles( prefetch );
+    }
+
     for ( const FetcherJob_Ptr & jobp : _resources )
     {
       if ( jobp->flags & FetcherJob::Directory )
@@ -14,6 +14,7 @@
 #include <sys/file.h>
 #include <cstdio>
 #include <unistd.h>
+#include <unordered_set>
 
 #include "zypp/TmpPath.h"
 #include "zypp/ZYppFactory.h"
@@ -198,6 +199,9 @@ namespace zypp
     void multiKeyImport( const Pathname & keyfile_r, bool trusted_r = false );
     void deleteKey( const std::string & id, bool trusted );
 
+    void saveTrustedKeyRing( const Pathname & dir_r );
+    bool restoreTrustedKeyRing( const Pathname & dir_r );
+
     std::string readSignatureKeyId( const Pathname & signature );
 
     bool isKeyTrusted( const std::string & id )
@@ -236,6 +240,9 @@ namespace zypp
     bool provideAndImportKeyFromRepositoryWorkflow (const std::string &id_r , const RepoInfo &info_r );
 
   private:
+    /** Long-lived gpgme context using \a keyring (\c nullptr on error). */
+    KeyManagerCtx::Ptr keyManagerCtx( const Pathname & keyring );
+
     bool verifyFile( const Pathname & file, const Pathname & signature, const Pathname & keyring );
     void importKey( const Pathname & keyfile, const Pathname & keyring );
 
@@ -273,6 +280,12 @@ namespace zypp
      * \endcode
      */
     CachedPublicKeyData cachedPublicKeyData;
+
+    /** Files verified by \ref verifyFile (content, signature and keyring state). */
+    std::unordered_set<std::string> _verified;
+
+    /** \ref keyManagerCtx per keyring. */
+    std::map<Pathname,KeyManagerCtx::Ptr> _keyManagerCtx;
   };
   ///////////////////////////////////////////////////////////////////
 
@@ -329,6 +342,102 @@ namespace zypp
     importKey( keyfile_r, trusted_r ? trustedKeyRing() : generalKeyRing() );
   }
 
+  namespace
+  {
+    /** The files in a gpg homedir making up the keyring. */
+    const char * keyRingFiles[] = { "pubring.kbx", "pubring.gpg", "trustdb.gpg" };
+
+    /** Whether the keys are held by a keyboxd, which can't be copied. */
+    bool usesKeyboxd( const Pathname & keyring_r )
+    { return PathInfo( keyring_r/"common.conf" ).isExist() || PathInfo( keyring_r/"public-keys.d" ).isExist(); }
+  }
+
+  void KeyRing::Impl::saveTrustedKeyRing( const Pathname & dir_r )
+  {
+    if ( usesKeyboxd( trustedKeyRing() ) )
+    {
+      DBG << "Keyboxd keyring is not saved" << endl;
+      return;
+    }
+    // Copy to a sibling and exchange, so nobody reads a partially written keyring.
+    // The modes are set explicitly, as restoreTrustedKeyRing checks them.
+    if ( filesystem::assert_dir( dir_r.dirname() ) != 0 )
+    {
+      WAR << "Can't save trusted keyring to " << dir_r << endl;
+      return;
+    }
+    filesystem::TmpDir tmpdir( filesystem::TmpDir::makeSibling( dir_r ) );
+    if ( ! tmpdir || filesystem::chmod( tmpdir.path(), 0755 ) != 0 )
+    {
+      WAR << "Can't save trusted keyring to " << dir_r << endl;
+      return;
+    }
+    for ( const char * file : keyRingFiles )
+    {
+      if ( PathInfo( trustedKeyRing()/file ).isFile()
+	&& ( filesystem::copy( trustedKeyRing()/file, tmpdir.path()/file ) != 0
+	  || filesystem::chmod( tmpdir.path()/file, 0644 ) != 0 ) )
+      {
+	WAR << "Can't save trusted keyring to " << dir_r << endl;
+	return;
+      }
+    }
+    if ( filesystem::exchange( tmpdir.path(), dir_r ) != 0 )
+    {
+      WAR << "Can't save trusted keyring to " << dir_r << endl;
+      return;
+    }
+    MIL << "Saved trusted keyring to " << dir_r << endl;
+  }
+
+  bool KeyRing::Impl::restoreTrustedKeyRing( const Pathname & dir_r )
+  {
+    // We'll trust the keys, so they must be ours and not writable by others.
+    auto safe = []( const PathInfo & pi_r )->bool
+    { return pi_r.owner() == ::geteuid() && ! ( pi_r.perm() & (S_IWGRP|S_IWOTH) ); };
+
+    PathInfo dir( dir_r, PathInfo::LSTAT );
+    if ( ! dir.isDir() )
+      return false;
+    if ( ! safe( dir ) )
+    {
+      WAR << "Ignore saved trusted keyring " << dir << endl;
+      return false;
+    }
+    std::vector<const char *> files;
+    for ( const char * file : keyRingFiles )
+    {
+      PathInfo pi( dir_r/file, PathInfo::LSTAT );
+      if ( ! pi.isExist() )
+	continue;
+      if ( ! ( pi.isFile() && safe( pi ) ) )
+      {
+	WAR << "Ignore saved trusted keyring " << pi << endl;
+	return false;
+      }
+      files.push_back( file );
+    }
+    if ( files.empty() || usesKeyboxd( trustedKeyRing() ) )
+      return false;
+
+    // Files gpg already created here may take precedence (e.g. pubring.kbx over pubring.gpg).
+    cachedPublicKeyData.setDirty( trustedKeyRing() );
+    for ( const char * file : keyRingFiles )
+      filesystem::unlink( trustedKeyRing()/file );
+    for ( const char * file : files )
+    {
+      if ( filesystem::copy( dir_r/file, trustedKeyRing()/file ) != 0 )
+      {
+	WAR << "Can't restore trusted keyring from " << dir_r << endl;
+	for ( const char * f : keyRingFiles )
+	  filesystem::unlink( trustedKeyRing()/f );
+	return false;
+      }
+    }
+    MIL << "Restored trusted keyring from " << dir_r << endl;
+    return true;
+  }
+
   void KeyRing::Impl::deleteKey( const std::string & id, bool trusted )
   {
     PublicKeyData keyDataToDel( publicKeyExists( id, trusted ? trustedKeyRing() : generalKeyRing() ) );
@@ -392,8 +501,8 @@ namespace zypp
 
   void KeyRing::Impl::dumpPublicKey( const std::string & id, const Pathname & keyring, std::ostream & stream )
   {
-    KeyManagerCtx::Ptr ctx = KeyManagerCtx::createForOpenPGP();
-    if (!ctx || !ctx->setHomedir(keyring))
+    KeyManagerCtx::Ptr ctx = keyManagerCtx( keyring );
+    if (!ctx)
       return;
     ctx->exportKey(id, stream);
   }
@@ -600,8 +709,8 @@ namespace zypp
 				   % keyfile.asString()
 				   % keyring.asString() ));
 
-    KeyManagerCtx::Ptr ctx = KeyManagerCtx::createForOpenPGP();
-    if(!ctx || !ctx->setHomedir(keyring))
+    KeyManagerCtx::Ptr ctx = keyManagerCtx( keyring );
+    if(!ctx)
       ZYPP_THROW(KeyRingException(_("Failed to import key.")));
 
     cachedPublicKeyData.setDirty( keyring );
@@ -611,15 +720,11 @@ namespace zypp
 
   void KeyRing::Impl::deleteKey( const std::string & id, const Pathname & keyring )
   {
-    KeyManagerCtx::Ptr ctx = KeyManagerCtx::createForOpenPGP();
+    KeyManagerCtx::Ptr ctx = keyManagerCtx( keyring );
     if(!ctx) {
       ZYPP_THROW(KeyRingException(_("Failed to delete key.")));
     }
 
-    if(!ctx->setHomedir(keyring)) {
-      ZYPP_THROW(KeyRingException(_("Failed to delete key.")));
-    }
-
     if(!ctx->deleteKey(id)){
       ZYPP_THROW(KeyRingException(_("Failed to delete key.")));
     }
@@ -648,13 +753,40 @@ namespace zypp
     return std::string();
   }
 
+  KeyManagerCtx::Ptr KeyRing::Impl::keyManagerCtx( const Pathname & keyring )
+  {
+    KeyManagerCtx::Ptr & ctx( _keyManagerCtx[keyring] );
+    if ( ! ctx )
+    {
+      ctx = KeyManagerCtx::createForOpenPGP();
+      if ( ctx && ! ctx->setHomedir( keyring ) )
+	ctx.reset();
+    }
+    return ctx;
+  }
+
   bool KeyRing::Impl::verifyFile( const Pathname & file, const Pathname & signature, const Pathname & keyring )
   {
-    KeyManagerCtx::Ptr ctx = KeyManagerCtx::createForOpenPGP();
-    if (!ctx || !ctx->setHomedir(keyring))
+    // The same file is often verified more than once. Digests are cheap
+    // compared to a gpg verification, esp. if remembered when downloading.
+    str::Str verified;
+    verified << keyring << " " << filesystem::checksum( file, "sha256" ) << " " << filesystem::checksum( signature, "sha256" );
+    for ( const PublicKeyData & key : publicKeyData( keyring ) )
+      verified << " " << key.fingerprint() << "-" << key.created();
+    if ( _verified.count( verified ) )
+    {
+      DBG << "Signature " << signature << " of " << file << " already verified" << endl;
+      return true;
+    }
+
+    KeyManagerCtx::Ptr ctx = keyManagerCtx( keyring );
+    if (!ctx)
       return false;
 
-    return ctx->verify(file, signature);
+    if ( ! ctx->verify(file, signature) )
+      return false;
+    _verified.insert( verified );
+    return true;
   }
 
   ///////////////////////////////////////////////////////////////////
@@ -679,6 +811,12 @@ namespace zypp
   void KeyRing::multiKeyImport( const Pathname & keyfile_r, bool trusted_r )
   { _pimpl->multiKeyImport( keyfile_r, trusted_r ); }
 
+  void KeyRing::saveTrustedKeyRing( const Pathname & dir_r )
+  { _pimpl->saveTrustedKeyRing( dir_r ); }
+
+  bool KeyRing::restoreTrustedKeyRing( const Pathname & dir_r )
+  { return _pimpl->restoreTrustedKeyRing( dir_r ); }
+
   std::string KeyRing::readSignatureKeyId( const Pathname & signature )
   { return _pimpl->readSignatureKeyId( signature ); }
 
@@ -216,6 +216,17 @@ namespace zypp
     /** Initial import from \ref RpmDb. */
     void multiKeyImport( const Pathname & keyfile_r, bool trusted_r = false );
 
+    /** Save the trusted keyring in \a dir_r, replacing a previously saved one.
+     * Used by \ref RpmDb to avoid importing all rpm keys on each start.
+     */
+    void saveTrustedKeyRing( const Pathname & dir_r );
+
+    /** Replace the trusted keyring by the one saved in \a dir_r.
+     * No signals are emitted for the restored keys. Returns \c false if there is
+     * no saved keyring, or it is not owned by us or writable by others.
+     */
+    bool restoreTrustedKeyRing( const Pathname & dir_r );
+
     void dumpTrustedPublicKey( const std::string &id, std::ostream &stream )
     { dumpPublicKey(id, true, stream); }
 
@@ -9,6 +9,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <map>
 
 #include "zypp/base/LogTools.h"
 #include "zypp/base/Regex.h"
@@ -254,16 +255,21 @@ IMPL_PTR_TYPE(MediaSetAccess);
         if ( ! media_mgr.isAttached(media) )
           media_mgr.attach(media);
 	media_mgr.setDeltafile(media, deltafile);
+	media_mgr.setChecksumType(media, resource.checksum().type());
 	deltafileset = true;
         op(media, file);
 	media_mgr.setDeltafile(media, Pathname());
+	media_mgr.setChecksumType(media, std::string());
         break;
       }
       catch ( media::MediaException & excp )
       {
         ZYPP_CAUGHT(excp);
 	if (deltafileset)
+	{
 	  media_mgr.setDeltafile(media, Pathname());
+	  media_mgr.setChecksumType(media, std::string());
+	}
         media::MediaChangeReport::Action user = media::MediaChangeReport::ABORT;
         unsigned int devindex = 0;
         vector<string> devices;
@@ -400,6 +406,29 @@ IMPL_PTR_TYPE(MediaSetAccess);
     return op.result;
   }
 
+  void MediaSetAccess::prefetchFiles( const std::vector<OnMediaLocation> & resources )
+  {
+    std::map<media::MediaNr, std::vector<OnMediaLocation> > files;
+    for ( const OnMediaLocation & resource : resources )
+      files[resource.medianr()].push_back( resource );
+
+    media::MediaManager media_mgr;
+    for ( const auto & mediafiles : files )
+    {
+      try
+      {
+        media::MediaAccessId media = getMediaAccessId( mediafiles.first );
+        if ( media_mgr.isAttached( media ) )
+          media_mgr.prefetchFiles( media, mediafiles.second );
+      }
+      catch ( const Exception & excpt )
+      {
+        ZYPP_CAUGHT( excpt );
+        WAR << "Can't prefetch files from media " << mediafiles.first << endl;
+      }
+    }
+  }
+
   media::MediaAccessId MediaSetAccess::getMediaAccessId (media::MediaNr medianr)
   {
     if ( _medias.find( medianr ) != _medias.end() )
@@ -172,6 +172,18 @@ namespace zypp
        */
       Pathname provideFile(const Pathname & file, unsigned media_nr = 1, ProvideFileOptions options = PROVIDE_DEFAULT );
 
+      /**
+       * Hint that the \a resources will be provided next (in this order).
+       *
+       * Media handlers downloading files may transfer them concurrently
+       * ahead, so the following \ref provideFile calls are served locally.
+       * Only media already attached are considered. Errors are ignored;
+       * they show up when the file is provided.
+       *
+       * \see zypp::media::MediaManager::prefetchFiles()
+       */
+      void prefetchFiles( const std::vector<OnMediaLocation> & resources );
+
       /**
        * Provides an optional \a file from media \a media_nr.
        *
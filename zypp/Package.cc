@@ -48,13 +48,15 @@ namespace zyppintern
 	return Pathname();	// same name but no checksum to verify
 
       // for local repos compare with the checksum in repo
-      if ( CheckSum( CheckSum::md5Type(), std::ifstream( (url.getPathName() / repo_r.path() / loc_r.filename()).c_str() ) )
-	!= CheckSum( CheckSum::md5Type(), std::ifstream( pi.c_str() ) ) )
+      // (the remembered checksums spare reading a just downloaded file again)
+      std::string cached( filesystem::checksum( pi.path(), CheckSum::md5Type() ) );
+      if ( cached.empty()
+	|| ! filesystem::is_checksum( url.getPathName() / repo_r.path() / loc_r.filename(), CheckSum( CheckSum::md5Type(), cached ) ) )
 	return Pathname();	// same name but wrong checksum
     }
     else
     {
-      if ( loc_r.checksum() != CheckSum( loc_r.checksum().type(), std::ifstream( pi.c_str() ) ) )
+      if ( ! filesystem::is_checksum( pi.path(), loc_r.checksum() ) )
 	return Pathname();	// same name but wrong checksum
     }
 
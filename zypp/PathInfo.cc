@@ -17,6 +17,8 @@
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <map>
+#include <mutex>
 
 #include "zypp/base/LogTools.h"
 #include "zypp/base/String.h"
@@ -996,6 +998,81 @@ namespace zypp
       return checksum(file, "SHA1");
     }
 
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      /** Checksums remembered by \ref rememberChecksum. */
+      class RememberedChecksums
+      {
+      public:
+        static RememberedChecksums & instance()
+        {
+          static RememberedChecksums _instance;
+          return _instance;
+        }
+
+        void remember( const Pathname & file_r, const CheckSum & checksum_r )
+        {
+          struct stat st;
+          if ( checksum_r.empty() || ::stat( file_r.c_str(), &st ) != 0 || ! S_ISREG( st.st_mode ) )
+            return;
+          std::lock_guard<std::mutex> lock( _mutex );
+          if ( _files.size() >= _maxFiles )
+            _files.clear();	// plain bound; files are usually checked right after the download
+          Entry & entry( _files[Key( st.st_dev, st.st_ino )] );
+          if ( ! entry.sameFile( st ) )
+          {
+            entry = Entry( st );
+          }
+          entry.checksums[str::toLower( checksum_r.type() )] = checksum_r.checksum();
+        }
+
+        std::string lookup( const Pathname & file_r, const std::string & algorithm_r ) const
+        {
+          struct stat st;
+          if ( ::stat( file_r.c_str(), &st ) != 0 )
+            return std::string();
+          std::lock_guard<std::mutex> lock( _mutex );
+          auto it = _files.find( Key( st.st_dev, st.st_ino ) );
+          if ( it == _files.end() || ! it->second.sameFile( st ) )
+            return std::string();
+          auto sum = it->second.checksums.find( str::toLower( algorithm_r ) );
+          return( sum == it->second.checksums.end() ? std::string() : sum->second );
+        }
+
+      private:
+        typedef std::pair<dev_t,ino_t> Key;
+
+        struct Entry
+        {
+          Entry()
+          {}
+          Entry( const struct stat & st_r )
+          : size( st_r.st_size ), mtime( st_r.st_mtim ), ctime( st_r.st_ctim )
+          {}
+          bool sameFile( const struct stat & st_r ) const
+          {
+            return( size == st_r.st_size
+                    && mtime.tv_sec == st_r.st_mtim.tv_sec && mtime.tv_nsec == st_r.st_mtim.tv_nsec
+                    && ctime.tv_sec == st_r.st_ctim.tv_sec && ctime.tv_nsec == st_r.st_ctim.tv_nsec );
+          }
+
+          off_t size = -1;
+          struct timespec mtime = { 0, 0 };
+          struct timespec ctime = { 0, 0 };
+          std::map<std::string,std::string> checksums;	///< type to checksum
+        };
+
+        static const unsigned _maxFiles = 4096;
+        mutable std::mutex _mutex;
+        std::map<Key,Entry> _files;
+      };
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    void rememberChecksum( const Pathname & file, const CheckSum & checksum_r )
+    { RememberedChecksums::instance().remember( file, checksum_r ); }
+
     ///////////////////////////////////////////////////////////////////
     //
     //  METHOD NAME : checksum
@@ -1006,6 +1083,11 @@ namespace zypp
       if ( ! PathInfo( file ).isFile() ) {
         return string();
       }
+      std::string remembered( RememberedChecksums::instance().lookup( file, algorithm ) );
+      if ( ! remembered.empty() ) {
+        DBG << "checksum " << algorithm << " of " << file << " computed while writing it" << endl;
+        return remembered;
+      }
       std::ifstream istr( file.asString().c_str() );
       if ( ! istr ) {
         return string();
@@ -727,6 +727,9 @@ namespace zypp
     /**
      * Compute a files checksum
      *
+     * A checksum remembered by \ref rememberChecksum is returned
+     * without reading the file.
+     *
      * @return the files checksum on success, otherwise an empty string..
      **/
     std::string checksum( const Pathname & file, const std::string &algorithm );
@@ -738,6 +741,14 @@ namespace zypp
      **/
     bool is_checksum( const Pathname & file, const CheckSum &checksum );
 
+    /**
+     * Remember the \a checksum_r of \a file, computed while the file was
+     * written (e.g. downloaded). \ref checksum and \ref is_checksum use it
+     * instead of reading the file again, as long as the file is unchanged
+     * (same inode, size, mtime and ctime).
+     **/
+    void rememberChecksum( const Pathname & file, const CheckSum & checksum_r );
+
     ///////////////////////////////////////////////////////////////////
     /** \name Changing permissions. */
     //@{
@@ -10,6 +10,9 @@
  *
 */
 #include <iostream>
+#include <deque>
+#include <vector>
+#include <algorithm>
 #include "zypp/base/Logger.h"
 #include "zypp/base/DefaultIntegral.h"
 
@@ -24,11 +27,71 @@ using std::endl;
 namespace zypp
 { /////////////////////////////////////////////////////////////////
 
+  namespace
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class StatusStore
+    /// \brief The \ref ResStatus of all PoolItems indexed by solvable id.
+    ///
+    /// Dense arrays rather than a status per PoolItem::Impl, so whole pool
+    /// scans do not chase a pointer per item and saving/restoring the state
+    /// of the whole pool is a plain copy. A deque, as references to a status
+    /// must stay valid if the pool grows. Slot \c 0 is used by \c PoolItem().
+    ///
+    /// Solvable ids are reused after the pool was cleared. Each slot has a
+    /// generation, which changes whenever the slot is handed to a new item
+    /// or its solvable is gone. A PoolItem copy outliving its solvable is
+    /// \c stale then and must not access the slot.
+    ///////////////////////////////////////////////////////////////////
+    struct StatusStore
+    {
+      StatusStore()
+      : status( 1 )
+      , saved( 1 )
+      , generation( 1, 0 )
+      {}
+
+      /** Initial status for a new PoolItem. */
+      void init( sat::detail::SolvableIdType id_r, const ResStatus & status_r )
+      {
+	if ( id_r >= status.size() )
+	{
+	  status.resize( id_r + 1 );
+	  saved.resize( id_r + 1 );
+	  generation.resize( id_r + 1, 0 );
+	}
+	clear( id_r );
+	status[id_r] = status_r;
+      }
+
+      /** Reset the slot of a solvable that is gone. */
+      void clear( sat::detail::SolvableIdType id_r )
+      {
+	if ( id_r && id_r < status.size() )
+	{
+	  status[id_r] = ResStatus();
+	  saved[id_r] = ResStatus();
+	  ++generation[id_r];
+	}
+      }
+
+      std::deque<ResStatus> status;
+      std::vector<ResStatus> saved;		///< \ref PoolItem::saveState
+      std::vector<unsigned> generation;	///< of the item using a slot
+    };
+
+    inline StatusStore & statusStore()
+    { static StatusStore _store; return _store; }
+  } // namespace
+
   ///////////////////////////////////////////////////////////////////
   //
   //	CLASS NAME : PoolItem::Impl
   //
   /** PoolItem implementation.
+   * The status is kept in the \ref StatusStore and the \ref ResObject is
+   * created on demand.
+   *
    * \c _buddy handling:
    * \li \c ==0 no buddy
    * \li \c >0 this uses \c _buddy status
@@ -39,14 +102,25 @@ namespace zypp
     public:
       Impl() {}
 
-      Impl( ResObject::constPtr res_r,
-            const ResStatus & status_r )
-      : _status( status_r )
-      , _resolvable( res_r )
+      Impl( const sat::Solvable & solvable_r )
+      : _solvable( solvable_r )
+      , _generation( statusStore().generation[solvable_r.id()] )
       {}
 
+      /** Index of our status (maybe the buddies one) in the \ref StatusStore. */
+      sat::detail::SolvableIdType statusId() const
+      { return _buddy > 0 ? sat::detail::SolvableIdType(_buddy) : _solvable.id(); }
+
+      /** Whether our solvable (or buddy) is gone and the slot may be used by a new item. */
+      bool stale() const
+      {
+	const std::vector<unsigned> & generation( statusStore().generation );
+	return( generation[_solvable.id()] != _generation
+	        || ( _buddy > 0 && generation[_buddy] != _buddyGeneration ) );
+      }
+
       ResStatus & status() const
-      { return _buddy > 0 ? PoolItem(buddy()).status() : _status; }
+      { return stale() ? _staleStatus[0] : statusStore().status[statusId()]; }
 
       sat::Solvable buddy() const
       {
@@ -59,14 +133,22 @@ namespace zypp
 
       void setBuddy( const sat::Solvable & solv_r );
 
+      sat::Solvable satSolvable() const
+      { return _solvable; }
+
       ResObject::constPtr resolvable() const
-      { return _resolvable; }
+      {
+	if ( ! _resolvable && _solvable )
+	  _resolvable = makeResObject( _solvable );
+	return _resolvable;
+      }
 
       ResStatus & statusReset() const
       {
-        _status.setLock( false, zypp::ResStatus::USER );
-        _status.resetTransact( zypp::ResStatus::USER );
-        return _status;
+	ResStatus & mystatus( stale() ? _staleStatus[0] : statusStore().status[_solvable.id()] );
+        mystatus.setLock( false, zypp::ResStatus::USER );
+        mystatus.resetTransact( zypp::ResStatus::USER );
+        return mystatus;
       }
 
     public:
@@ -101,35 +183,39 @@ namespace zypp
       }
 
     private:
-      mutable ResStatus     _status;
-      ResObject::constPtr   _resolvable;
+      sat::Solvable                 _solvable;
+      unsigned                      _generation = 0;	///< of our slot in the \ref StatusStore
+      mutable ResObject::constPtr   _resolvable;
       DefaultIntegral<sat::detail::IdType,sat::detail::noId> _buddy;
+      unsigned                      _buddyGeneration = 0;	///< of the buddies slot
+      mutable ResStatus             _staleStatus[2];	///< status and saved status once \ref stale
 
     /** \name Poor man's save/restore state.
        * \todo There may be better save/restore state strategies.
      */
     //@{
     public:
+      ResStatus & savedStatus() const
+      { return stale() ? _staleStatus[1] : statusStore().saved[statusId()]; }
       void saveState() const
-      { _savedStatus = status(); }
+      { savedStatus() = status(); }
       void restoreState() const
-      { status() = _savedStatus; }
+      { status() = savedStatus(); }
       bool sameState() const
       {
-        if ( status() == _savedStatus )
+        const ResStatus & savedStatus( this->savedStatus() );
+        if ( status() == savedStatus )
           return true;
         // some bits changed...
-        if ( status().getTransactValue() != _savedStatus.getTransactValue()
+        if ( status().getTransactValue() != savedStatus.getTransactValue()
              && ( ! status().isBySolver() // ignore solver state changes
                   // removing a user lock also goes to bySolver
-                  || _savedStatus.getTransactValue() == ResStatus::LOCKED ) )
+                  || savedStatus.getTransactValue() == ResStatus::LOCKED ) )
           return false;
-        if ( status().isLicenceConfirmed() != _savedStatus.isLicenceConfirmed() )
+        if ( status().isLicenceConfirmed() != savedStatus.isLicenceConfirmed() )
           return false;
         return true;
       }
-    private:
-      mutable ResStatus _savedStatus;
     //@}
 
     public:
@@ -163,8 +249,9 @@ namespace zypp
 	ERR <<  *this << " would be buddy2 in " << myBuddy << endl;
 	return;
       }
-      myBuddy._pimpl->_buddy = -resolvable()->satSolvable().id();
+      myBuddy._pimpl->_buddy = -_solvable.id();
       _buddy = myBuddy.satSolvable().id();
+      _buddyGeneration = statusStore().generation[_buddy];
       DBG << *this << " has buddy " << myBuddy << endl;
     }
   }
@@ -191,7 +278,8 @@ namespace zypp
 
   PoolItem PoolItem::makePoolItem( const sat::Solvable & solvable_r )
   {
-    return PoolItem( new Impl( makeResObject( solvable_r ), solvable_r.isSystem() ) );
+    statusStore().init( solvable_r.id(), ResStatus( solvable_r.isSystem() ) );
+    return PoolItem( new Impl( solvable_r ) );
   }
 
   PoolItem::~PoolItem()
@@ -215,6 +303,22 @@ namespace zypp
   void PoolItem::restoreState() const			{ _pimpl->restoreState(); }
   bool PoolItem::sameState() const			{ return _pimpl->sameState(); }
   ResObject::constPtr PoolItem::resolvable() const	{ return _pimpl->resolvable(); }
+  PoolItem::operator sat::Solvable() const		{ return _pimpl->satSolvable(); }
+
+  void PoolItem::dropPoolItem( sat::detail::SolvableIdType id_r )
+  { statusStore().clear( id_r ); }
+
+  void PoolItem::saveStates()
+  {
+    StatusStore & store( statusStore() );
+    std::copy( store.status.begin(), store.status.end(), store.saved.begin() );
+  }
+
+  void PoolItem::restoreStates()
+  {
+    StatusStore & store( statusStore() );
+    std::copy( store.saved.begin(), store.saved.end(), store.status.begin() );
+  }
 
 
   std::ostream & operator<<( std::ostream & str, const PoolItem & obj )
@@ -112,8 +112,7 @@ namespace zypp
       ResPool pool() const;
 
       /** This is a \ref sat::SolvableType. */
-      explicit operator sat::Solvable() const
-      { return resolvable() ? resolvable()->satSolvable() : sat::Solvable::noSolvable; }
+      explicit operator sat::Solvable() const;
 
       /** Return the buddy we share our status object with.
        * A \ref Product e.g. may share it's status with an associated reference \ref Package.
@@ -121,7 +120,7 @@ namespace zypp
       sat::Solvable buddy() const;
 
     public:
-      /** Returns the ResObject::constPtr.
+      /** Returns the ResObject::constPtr (created on demand).
        * \see \ref operator->
        */
       ResObject::constPtr resolvable() const;
@@ -140,6 +139,11 @@ namespace zypp
       friend class pool::PoolImpl;
       /** \ref PoolItem generator for \ref pool::PoolImpl. */
       static PoolItem makePoolItem( const sat::Solvable & solvable_r );
+      /** \ref pool::PoolImpl tells the solvable \a id_r is gone.
+       * Its status is reset. Remaining copies of the PoolItem get a status
+       * of their own, so they do not alter an item reusing the id.
+       */
+      static void dropPoolItem( sat::detail::SolvableIdType id_r );
       /** Buddies are set by \ref pool::PoolImpl.*/
       void setBuddy( const sat::Solvable & solv_r );
       /** internal ctor */
@@ -158,6 +162,10 @@ namespace zypp
       void saveState() const;
       void restoreState() const;
       bool sameState() const;
+      /** \ref saveState of all items at once. */
+      static void saveStates();
+      /** \ref restoreState of all items at once. */
+      static void restoreStates();
       //@}
   };
   ///////////////////////////////////////////////////////////////////
@@ -168,7 +176,7 @@ namespace zypp
 
   /** \relates PoolItem Required to disambiguate vs. (PoolItem,ResObject::constPtr) due to implicit PoolItem::operator ResObject::constPtr  */
   inline bool operator==( const PoolItem & lhs, const PoolItem & rhs )
-  { return lhs.resolvable() == rhs.resolvable(); }
+  { return lhs.satSolvable() == rhs.satSolvable(); }
 
   /** \relates PoolItem Convenience compare */
   inline bool operator==( const PoolItem & lhs, const ResObject::constPtr & rhs )
@@ -16,7 +16,13 @@
 #include <sstream>
 #include <list>
 #include <map>
+#include <vector>
 #include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
 
 #include <solv/solvversion.h>
 
@@ -27,6 +33,7 @@
 #include "zypp/base/DefaultIntegral.h"
 #include "zypp/base/Function.h"
 #include "zypp/base/Regex.h"
+#include "zypp/base/UserRequestException.h"
 #include "zypp/PathInfo.h"
 #include "zypp/TmpPath.h"
 
@@ -47,6 +54,7 @@
 #include "zypp/repo/yum/Downloader.h"
 #include "zypp/repo/susetags/Downloader.h"
 #include "zypp/repo/PluginServices.h"
+#include "zypp/repo/SolvCacheBuilder.h"
 
 #include "zypp/Target.h" // for Target::targetDistribution() for repo index services
 #include "zypp/ZYppFactory.h" // to get the Target from ZYpp instance
@@ -75,6 +83,13 @@ namespace zypp
       const char * env = getenv("ZYPP_PLUGIN_APPDATA_FORCE_COLLECT");
       return( env && str::strToBool( env, true ) );
     }
+
+    /** To build the solv cache by forking repo2solv rather than in-process */
+    inline bool ZYPP_REPO2SOLV_EXTERNAL()
+    {
+      const char * env = getenv("ZYPP_REPO2SOLV_EXTERNAL");
+      return( env && str::strToBool( env, true ) );
+    }
   } // namespace env
   ///////////////////////////////////////////////////////////////////
 
@@ -188,6 +203,26 @@ namespace zypp
     };
     ///////////////////////////////////////////////////////////////////
 
+    ///////////////////////////////////////////////////////////////////
+    /// \class CacheBuildJob
+    /// \brief What's needed to build a repos solv file.
+    ///
+    /// Checks, cleanup and media access are done when preparing the job
+    /// (not thread safe). Building the solv file from it may be done in
+    /// a worker thread.
+    ///////////////////////////////////////////////////////////////////
+    struct CacheBuildJob
+    {
+      RepoInfo info;
+      RepoStatus rawStatus;			///< raw metadata status to remember on success
+      bool needsCleaning = false;		///< whether an outdated cache needs to be removed first
+      repo::RepoType repokind;
+      Pathname solvfile;
+      Pathname metadatapath;			///< raw metadata or plaindir to read
+      shared_ptr<MediaMounter> forPlainDirs;	///< keeps plaindir media attached
+    };
+    ///////////////////////////////////////////////////////////////////
+
     /** Check if alias_r is present in repo/service container. */
     template <class Iterator>
     inline bool foundAliasIn( const std::string & alias_r, Iterator begin_r, Iterator end_r )
@@ -607,6 +642,8 @@ namespace zypp
 
     void buildCache( const RepoInfo & info, CacheBuildPolicy policy, OPT_PROGRESS );
 
+    void buildCaches( const std::list<RepoInfo> & infos, CacheBuildPolicy policy, unsigned jobs, OPT_PROGRESS );
+
     repo::RepoType probe( const Url & url, const Pathname & path = Pathname() ) const;
     repo::RepoType probeCache( const Pathname & path_r ) const;
 
@@ -687,6 +724,13 @@ namespace zypp
 
     void touchIndexFile( const RepoInfo & info );
 
+    /** Whether the cache needs to be built; refreshes missing raw metadata. */
+    bool needsCacheBuild( const RepoInfo & info, CacheBuildPolicy policy, CacheBuildJob & job_r, const ProgressData::ReceiverFnc & progressrcv );
+    /** Remove an outdated cache, probe the type and attach plaindir media. */
+    void prepareCacheBuild( CacheBuildJob & job_r );
+    /** Build the solv file (may be called from worker threads). */
+    void runCacheBuild( const CacheBuildJob & job_r, const ProgressData::ReceiverFnc & progressrcv ) const;
+
     template<typename OutputIterator>
     void getRepositoriesInService( const std::string & alias, OutputIterator out ) const
     {
@@ -1243,12 +1287,9 @@ namespace zypp
   }
 
 
-  void RepoManager::Impl::buildCache( const RepoInfo & info, CacheBuildPolicy policy, const ProgressData::ReceiverFnc & progressrcv )
+  bool RepoManager::Impl::needsCacheBuild( const RepoInfo & info, CacheBuildPolicy policy, CacheBuildJob & job_r, const ProgressData::ReceiverFnc & progressrcv )
   {
     assert_alias(info);
-    Pathname mediarootpath = rawcache_path_for_repoinfo( _options, info );
-    Pathname productdatapath = rawproductdata_path_for_repoinfo( _options, info );
-
     if( filesystem::assert_dir(_options.repoCachePath) )
     {
       Exception ex(str::form( _("Can't create %s"), _options.repoCachePath.c_str()) );
@@ -1264,7 +1305,10 @@ namespace zypp
       raw_metadata_status = metadataStatus(info);
     }
 
-    bool needs_cleaning = false;
+    job_r.info = info;
+    job_r.rawStatus = raw_metadata_status;
+    job_r.needsCleaning = false;
+
     if ( isCached( info ) )
     {
       MIL << info.alias() << " is already cached." << endl;
@@ -1280,23 +1324,23 @@ namespace zypp
 	  if ( ! PathInfo(base/"solv.idx").isExist() )
 	    sat::updateSolvFileIndex( base/"solv" );
 
-	  return;
+	  return false;
         }
         else {
           MIL << info.alias() << " cache rebuild is forced" << endl;
         }
       }
 
-      needs_cleaning = true;
+      job_r.needsCleaning = true;
     }
+    return true;
+  }
 
-    ProgressData progress(100);
-    callback::SendReport<ProgressReport> report;
-    progress.sendTo( ProgressReportAdaptor( progressrcv, report ) );
-    progress.name(str::form(_("Building repository '%s' cache"), info.label().c_str()));
-    progress.toMin();
+  void RepoManager::Impl::prepareCacheBuild( CacheBuildJob & job_r )
+  {
+    const RepoInfo & info( job_r.info );
 
-    if (needs_cleaning)
+    if ( job_r.needsCleaning )
     {
       cleanCache(info);
     }
@@ -1316,7 +1360,9 @@ namespace zypp
       Exception ex(str::form( _("Can't create cache at %s - no writing permissions."), base.c_str()) );
       ZYPP_THROW(ex);
     }
-    Pathname solvfile = base / "solv";
+    job_r.solvfile = base / "solv";
+
+    Pathname productdatapath = rawproductdata_path_for_repoinfo( _options, info );
 
     // do we have type?
     repo::RepoType repokind = info.type();
@@ -1340,64 +1386,260 @@ namespace zypp
       case RepoType::YAST2_e :
       case RepoType::RPMPLAINDIR_e :
       {
-        // Take care we unlink the solvfile on exception
-        ManagedFile guard( solvfile, filesystem::unlink );
-        scoped_ptr<MediaMounter> forPlainDirs;
-
-        ExternalProgram::Arguments cmd;
-        cmd.push_back( PathInfo( "/usr/bin/repo2solv" ).isFile() ? "repo2solv" : "repo2solv.sh" );
-        // repo2solv expects -o as 1st arg!
-        cmd.push_back( "-o" );
-        cmd.push_back( solvfile.asString() );
-	cmd.push_back( "-X" );	// autogenerate pattern from pattern-package
-        // bsc#1104415: no more application support // cmd.push_back( "-A" );	// autogenerate application pseudo packages
-
+        job_r.repokind = repokind;
+        job_r.metadatapath = productdatapath;
         if ( repokind == RepoType::RPMPLAINDIR )
         {
-          forPlainDirs.reset( new MediaMounter( info.url() ) );
-          // recusive for plaindir as 2nd arg!
-          cmd.push_back( "-R" );
+          job_r.forPlainDirs.reset( new MediaMounter( info.url() ) );
           // FIXME this does only work form dir: URLs
-          cmd.push_back( forPlainDirs->getPathName( info.path() ).c_str() );
+          job_r.metadatapath = job_r.forPlainDirs->getPathName( info.path() );
         }
-        else
-          cmd.push_back( productdatapath.asString() );
+      }
+      break;
+      default:
+        ZYPP_THROW(RepoUnknownTypeException( info, _("Unhandled repository type") ));
+      break;
+    }
+  }
 
-        ExternalProgram prog( cmd, ExternalProgram::Stderr_To_Stdout );
-        std::string errdetail;
+  void RepoManager::Impl::runCacheBuild( const CacheBuildJob & job_r, const ProgressData::ReceiverFnc & progressrcv ) const
+  {
+    const Pathname & solvfile( job_r.solvfile );
 
-        for ( std::string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-          WAR << "  " << output;
-          if ( errdetail.empty() ) {
-            errdetail = prog.command();
-            errdetail += '\n';
-          }
-          errdetail += output;
-        }
+    // Take care we unlink the solvfile on exception
+    ManagedFile guard( solvfile, filesystem::unlink );
 
-        int ret = prog.close();
-        if ( ret != 0 )
-        {
-          RepoException ex(str::form( _("Failed to cache repo (%d)."), ret ));
-          ex.remember( errdetail );
-          ZYPP_THROW(ex);
+    if ( env::ZYPP_REPO2SOLV_EXTERNAL() )
+    {
+      ExternalProgram::Arguments cmd;
+      cmd.push_back( PathInfo( "/usr/bin/repo2solv" ).isFile() ? "repo2solv" : "repo2solv.sh" );
+      // repo2solv expects -o as 1st arg!
+      cmd.push_back( "-o" );
+      cmd.push_back( solvfile.asString() );
+      cmd.push_back( "-X" );	// autogenerate pattern from pattern-package
+      // bsc#1104415: no more application support // cmd.push_back( "-A" );	// autogenerate application pseudo packages
+
+      if ( job_r.repokind == RepoType::RPMPLAINDIR )
+        cmd.push_back( "-R" );	// recusive for plaindir as 2nd arg!
+      cmd.push_back( job_r.metadatapath.asString() );
+
+      ExternalProgram prog( cmd, ExternalProgram::Stderr_To_Stdout );
+      std::string errdetail;
+
+      for ( std::string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
+        WAR << "  " << output;
+        if ( errdetail.empty() ) {
+          errdetail = prog.command();
+          errdetail += '\n';
         }
+        errdetail += output;
+      }
 
-        // We keep it.
-        guard.resetDispose();
-	sat::updateSolvFileIndex( solvfile );	// content digest for zypper bash completion
+      int ret = prog.close();
+      if ( ret != 0 )
+      {
+        RepoException ex(str::form( _("Failed to cache repo (%d)."), ret ));
+        ex.remember( errdetail );
+        ZYPP_THROW(ex);
       }
-      break;
-      default:
-        ZYPP_THROW(RepoUnknownTypeException( info, _("Unhandled repository type") ));
-      break;
+      sat::updateSolvFileIndex( solvfile );	// content digest for zypper bash completion
     }
+    else
+    {
+      // autogenerates patterns from pattern-packages like 'repo2solv -X'
+      // and writes the solv.idx for zypper bash completion.
+      repo::SolvCacheBuilder( job_r.repokind, job_r.metadatapath ).build( solvfile, progressrcv );
+    }
+
+    // We keep it.
+    guard.resetDispose();
+  }
+
+  void RepoManager::Impl::buildCache( const RepoInfo & info, CacheBuildPolicy policy, const ProgressData::ReceiverFnc & progressrcv )
+  {
+    CacheBuildJob job;
+    if ( ! needsCacheBuild( info, policy, job, progressrcv ) )
+      return;
+
+    ProgressData progress(100);
+    callback::SendReport<ProgressReport> report;
+    progress.sendTo( ProgressReportAdaptor( progressrcv, report ) );
+    progress.name(str::form(_("Building repository '%s' cache"), info.label().c_str()));
+    progress.toMin();
+
+    prepareCacheBuild( job );
+    runCacheBuild( job, CombinedProgressData( progress, 100 ) );
+
     // update timestamp and checksum
-    setCacheStatus(info, raw_metadata_status);
+    setCacheStatus(info, job.rawStatus);
     MIL << "Commit cache.." << endl;
     progress.toMax();
   }
 
+  void RepoManager::Impl::buildCaches( const std::list<RepoInfo> & infos, CacheBuildPolicy policy, unsigned jobs, const ProgressData::ReceiverFnc & progressrcv )
+  {
+    if ( jobs == 0 )
+      jobs = std::max( std::thread::hardware_concurrency(), 1U );
+
+    // Up to date check, raw metadata refresh and media access are not
+    // thread safe. They are done in advance, just as the serial
+    // buildCache would do them.
+    // A failing repository does not stop the others, unless the user
+    // aborts. The 1st exception in list order is rethrown at the end.
+    std::vector<CacheBuildJob> todo;
+    todo.reserve( infos.size() );
+    std::vector<unsigned> todoPos;	// list position of the todo entries
+    std::vector<std::exception_ptr> errors( infos.size() );
+    bool aborted = false;
+    unsigned pos = 0;
+    for ( const RepoInfo & info : infos )
+    {
+      try
+      {
+	CacheBuildJob job;
+	if ( needsCacheBuild( info, policy, job, progressrcv ) )
+	{
+	  prepareCacheBuild( job );
+	  todo.push_back( std::move(job) );
+	  todoPos.push_back( pos );
+	}
+      }
+      catch ( const AbortRequestException & e )
+      {
+	ZYPP_CAUGHT( e );
+	errors[pos] = std::current_exception();
+	aborted = true;
+	break;
+      }
+      catch ( const Exception & e )
+      {
+	ZYPP_CAUGHT( e );
+	errors[pos] = std::current_exception();
+      }
+      ++pos;
+    }
+
+    if ( ! ( todo.empty() || aborted ) )
+    {
+      ProgressData progress( todo.size() * 100 );
+      callback::SendReport<ProgressReport> report;
+      progress.sendTo( ProgressReportAdaptor( progressrcv, report ) );
+      progress.name( _("Building repository caches") );
+      progress.toMin();
+
+      if ( env::ZYPP_REPO2SOLV_EXTERNAL() )
+	jobs = 1;	// ExternalProgram is not meant to be used by threads
+      else if ( jobs > todo.size() )
+	jobs = todo.size();
+      MIL << "Building " << todo.size() << " caches using " << jobs << " jobs" << endl;
+
+      std::vector<std::exception_ptr> builderrors( todo.size() );
+      if ( jobs == 1 )
+      {
+	for ( unsigned idx = 0; idx < todo.size(); ++idx )
+	{
+	  try
+	  {
+	    if ( aborted )
+	      ZYPP_THROW( AbortRequestException() );
+	    runCacheBuild( todo[idx], [&,idx]( const ProgressData & p_r )->bool {
+	      return progress.set( idx * 100 + p_r.reportValue() );
+	    } );
+	  }
+	  catch ( const AbortRequestException & e )
+	  {
+	    ZYPP_CAUGHT( e );
+	    builderrors[idx] = std::current_exception();
+	    aborted = true;
+	  }
+	  catch ( const Exception & e )
+	  {
+	    ZYPP_CAUGHT( e );
+	    builderrors[idx] = std::current_exception();
+	  }
+	}
+      }
+      else
+      {
+	// Workers just update their percent value; the main thread
+	// aggregates them and sends the progress reports.
+	std::vector<std::atomic<int>> percent( todo.size() );
+	for ( auto & val : percent )
+	  val = 0;
+	std::atomic<unsigned> next( 0 );
+	std::atomic<bool> abort( false );
+	unsigned done = 0;
+	std::mutex mutex;
+	std::condition_variable cv;
+
+	auto worker = [&]() {
+	  for ( unsigned idx = next++; idx < todo.size(); idx = next++ )
+	  {
+	    try
+	    {
+	      if ( abort )
+		ZYPP_THROW( AbortRequestException() );
+	      runCacheBuild( todo[idx], [&,idx]( const ProgressData & p_r )->bool {
+		percent[idx] = p_r.reportValue();
+		return ! abort;
+	      } );
+	    }
+	    catch ( ... )
+	    {
+	      builderrors[idx] = std::current_exception();
+	    }
+	    percent[idx] = 100;
+	    {
+	      std::lock_guard<std::mutex> lock( mutex );
+	      ++done;
+	    }
+	    cv.notify_one();
+	  }
+	};
+
+	std::vector<std::thread> workers;
+	for ( unsigned i = 0; i < jobs; ++i )
+	  workers.push_back( std::thread( worker ) );
+	{
+	  std::unique_lock<std::mutex> lock( mutex );
+	  while ( done < todo.size() )
+	  {
+	    cv.wait_for( lock, std::chrono::milliseconds( 100 ) );
+	    ProgressData::value_type sum = 0;
+	    for ( const auto & val : percent )
+	      sum += val;
+	    if ( ! progress.set( sum ) )
+	      abort = true;
+	  }
+	}
+	for ( std::thread & t : workers )
+	  t.join();
+      }
+
+      // Commit the successfully built caches.
+      bool failed = false;
+      for ( unsigned idx = 0; idx < todo.size(); ++idx )
+      {
+	if ( builderrors[idx] )
+	{
+	  errors[todoPos[idx]] = builderrors[idx];
+	  failed = true;
+	  continue;
+	}
+	setCacheStatus( todo[idx].info, todo[idx].rawStatus );
+      }
+      if ( ! failed )
+	progress.toMax();
+      MIL << "Commit caches.." << endl;
+    }
+
+    for ( const std::exception_ptr & excpt : errors )
+    {
+      if ( excpt )
+	std::rethrow_exception( excpt );
+    }
+  }
+
   ////////////////////////////////////////////////////////////////////////////
 
 
@@ -2582,6 +2824,9 @@ namespace zypp
   void RepoManager::buildCache( const RepoInfo &info, CacheBuildPolicy policy, const ProgressData::ReceiverFnc & progressrcv )
   { return _pimpl->buildCache( info, policy, progressrcv ); }
 
+  void RepoManager::buildCaches( const std::list<RepoInfo> & infos, CacheBuildPolicy policy, unsigned jobs, const ProgressData::ReceiverFnc & progressrcv )
+  { return _pimpl->buildCaches( infos, policy, jobs, progressrcv ); }
+
   void RepoManager::cleanCache( const RepoInfo &info, const ProgressData::ReceiverFnc & progressrcv )
   { return _pimpl->cleanCache( info, progressrcv ); }
 
@@ -350,6 +350,27 @@ namespace zypp
                     CacheBuildPolicy policy = BuildIfNeeded,
                     const ProgressData::ReceiverFnc & progressrcv = ProgressData::ReceiverFnc() );
 
+   /**
+    * \short Refresh local caches of several repositories
+    *
+    * Like calling \ref buildCache for each repository in \a infos, but
+    * the solv files are built concurrently by up to \a jobs worker threads
+    * (\c 0 uses one job per available CPU). Progress of all repositories
+    * is reported as one overall task.
+    *
+    * Checking, missing raw metadata refresh and cleanup are done in advance
+    * in list order. A repository failing here or while building does not
+    * stop the others, no matter how many \a jobs are used. Caches built
+    * successfully are kept, and the exception of the first repository (in
+    * list order) that failed is rethrown. Only a user abort stops it all.
+    *
+    * \throws Exception see \ref buildCache
+    */
+   void buildCaches( const std::list<RepoInfo> & infos,
+                     CacheBuildPolicy policy = BuildIfNeeded,
+                     unsigned jobs = 0,
+                     const ProgressData::ReceiverFnc & progressrcv = ProgressData::ReceiverFnc() );
+
    /**
     * \short clean local cache
     *
@@ -31,8 +31,8 @@ namespace zypp
   {
     void saveState( ResPool pool_r )
     {
-      std::for_each( pool_r.begin(), pool_r.end(),
-                     std::mem_fun_ref(&PoolItem::saveState) );
+      pool_r.begin();	// let the pool create new PoolItems first
+      PoolItem::saveStates();
     }
 
     void saveState( ResPool pool_r, const ResKind & kind_r )
@@ -43,8 +43,8 @@ namespace zypp
 
     void restoreState( ResPool pool_r )
     {
-      std::for_each( pool_r.begin(), pool_r.end(),
-                     std::mem_fun_ref(&PoolItem::restoreState) );
+      pool_r.begin();	// let the pool create new PoolItems first
+      PoolItem::restoreStates();
     }
 
     void restoreState( ResPool pool_r, const ResKind & kind_r )
@@ -318,11 +318,18 @@ namespace zypp
         , download_media_prefer_download( true )
 	, download_mediaMountdir	( "/var/adm/mount" )
         , download_max_concurrent_connections( 5 )
+        , download_max_mirrors		( 10 )
         , download_min_download_speed	( 0 )
         , download_max_download_speed	( 0 )
         , download_max_silent_tries	( 5 )
         , download_transfer_timeout	( 180 )
+        , download_use_http2		( true )
         , commit_downloadMode		( DownloadDefault )
+        , commit_prefetchPackages	( 4 )
+        , commit_prefetchMegabytes	( 256 )
+        , commit_parallelConnections	( 8 )
+        , commit_parallelConnectionsPerHost( 4 )
+        , commit_parallelConnectionsPerRepo( 4 )
 	, gpgCheck			( true )
 	, repoGpgCheck			( indeterminate )
 	, pkgGpgCheck			( indeterminate )
@@ -336,6 +343,7 @@ namespace zypp
         , solver_upgradeTestcasesToKeep	( 2 )
         , solverUpgradeRemoveDroppedPackages( true )
         , apply_locks_file		( true )
+        , rpmInstallBatchSize		( 0 )
         , pluginsPath			( "/usr/lib/zypp/plugins" )
       {
         MIL << "libzypp: " << VERSION << endl;
@@ -452,6 +460,10 @@ namespace zypp
                 {
                   str::strtonum(value, download_max_concurrent_connections);
                 }
+                else if ( entry == "download.max_mirrors" )
+                {
+                  str::strtonum(value, download_max_mirrors);
+                }
                 else if ( entry == "download.min_download_speed" )
                 {
                   str::strtonum(value, download_min_download_speed);
@@ -470,10 +482,34 @@ namespace zypp
 		  if ( download_transfer_timeout < 0 )		download_transfer_timeout = 0;
 		  else if ( download_transfer_timeout > 3600 )	download_transfer_timeout = 3600;
                 }
+                else if ( entry == "download.use_http2" )
+                {
+                  download_use_http2 = str::strToBool( value, download_use_http2 );
+                }
                 else if ( entry == "commit.downloadMode" )
                 {
                   commit_downloadMode.set( deserializeDownloadMode( value ) );
                 }
+                else if ( entry == "commit.prefetch.packages" )
+                {
+                  str::strtonum( value, commit_prefetchPackages );
+                }
+                else if ( entry == "commit.prefetch.megabytes" )
+                {
+                  str::strtonum( value, commit_prefetchMegabytes );
+                }
+                else if ( entry == "commit.parallel.max_connections" )
+                {
+                  str::strtonum( value, commit_parallelConnections );
+                }
+                else if ( entry == "commit.parallel.max_connections_per_host" )
+                {
+                  str::strtonum( value, commit_parallelConnectionsPerHost );
+                }
+                else if ( entry == "commit.parallel.max_connections_per_repo" )
+                {
+                  str::strtonum( value, commit_parallelConnectionsPerRepo );
+                }
                 else if ( entry == "gpgcheck" )
 		{
 		  gpgCheck.restoreToDefault( str::strToBool( value, gpgCheck ) );
@@ -572,6 +608,10 @@ namespace zypp
                   rpmInstallFlags.setFlag( target::rpm::RPMINST_EXCLUDEDOCS,
                                            str::strToBool( value, false ) );
                 }
+                else if ( entry == "rpm.install.batchsize" )
+                {
+                  str::strtonum( value, rpmInstallBatchSize );
+                }
                 else if ( entry == "history.logfile" )
                 {
                   history_log_path = Pathname(value);
@@ -650,12 +690,19 @@ namespace zypp
     DefaultOption<Pathname> download_mediaMountdir;
 
     int download_max_concurrent_connections;
+    int download_max_mirrors;
     int download_min_download_speed;
     int download_max_download_speed;
     int download_max_silent_tries;
     int download_transfer_timeout;
+    bool download_use_http2;
 
     Option<DownloadMode> commit_downloadMode;
+    unsigned commit_prefetchPackages;
+    unsigned commit_prefetchMegabytes;
+    unsigned commit_parallelConnections;
+    unsigned commit_parallelConnectionsPerHost;
+    unsigned commit_parallelConnectionsPerRepo;
 
     DefaultOption<bool>		gpgCheck;
     DefaultOption<TriBool>	repoGpgCheck;
@@ -680,6 +727,7 @@ namespace zypp
     bool apply_locks_file;
 
     target::rpm::RpmInstFlags rpmInstallFlags;
+    unsigned rpmInstallBatchSize;
 
     Pathname history_log_path;
     Pathname credentials_global_dir_path;
@@ -1035,6 +1083,9 @@ namespace zypp
   long ZConfig::download_max_concurrent_connections() const
   { return _pimpl->download_max_concurrent_connections; }
 
+  long ZConfig::download_max_mirrors() const
+  { return _pimpl->download_max_mirrors; }
+
   long ZConfig::download_min_download_speed() const
   { return _pimpl->download_min_download_speed; }
 
@@ -1047,6 +1098,9 @@ namespace zypp
   long ZConfig::download_transfer_timeout() const
   { return _pimpl->download_transfer_timeout; }
 
+  bool ZConfig::download_use_http2() const
+  { return _pimpl->download_use_http2; }
+
   Pathname ZConfig::download_mediaMountdir() const		{ return _pimpl->download_mediaMountdir; }
   void ZConfig::set_download_mediaMountdir( Pathname newval_r )	{ _pimpl->download_mediaMountdir.set( std::move(newval_r) ); }
   void ZConfig::set_default_download_mediaMountdir()		{ _pimpl->download_mediaMountdir.restoreToDefault(); }
@@ -1054,6 +1108,21 @@ namespace zypp
   DownloadMode ZConfig::commit_downloadMode() const
   { return _pimpl->commit_downloadMode; }
 
+  unsigned ZConfig::commit_prefetchPackages() const
+  { return _pimpl->commit_prefetchPackages; }
+
+  ByteCount ZConfig::commit_prefetchBytes() const
+  { return ByteCount( _pimpl->commit_prefetchMegabytes, ByteCount::MiB ); }
+
+  unsigned ZConfig::commit_parallelConnections() const
+  { return _pimpl->commit_parallelConnections; }
+
+  unsigned ZConfig::commit_parallelConnectionsPerHost() const
+  { return _pimpl->commit_parallelConnectionsPerHost; }
+
+  unsigned ZConfig::commit_parallelConnectionsPerRepo() const
+  { return _pimpl->commit_parallelConnectionsPerRepo; }
+
 
   bool ZConfig::gpgCheck() const			{ return _pimpl->gpgCheck; }
   TriBool ZConfig::repoGpgCheck() const			{ return _pimpl->repoGpgCheck; }
@@ -1146,6 +1215,9 @@ namespace zypp
   target::rpm::RpmInstFlags ZConfig::rpmInstallFlags() const
   { return _pimpl->rpmInstallFlags; }
 
+  unsigned ZConfig::rpmInstallBatchSize() const
+  { return _pimpl->rpmInstallBatchSize; }
+
 
   Pathname ZConfig::historyLogFile() const
   {
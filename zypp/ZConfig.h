@@ -25,6 +25,7 @@
 #include "zypp/Pathname.h"
 #include "zypp/IdString.h"
 #include "zypp/TriBool.h"
+#include "zypp/ByteCount.h"
 
 #include "zypp/DownloadMode.h"
 #include "zypp/target/rpm/RpmFlags.h"
@@ -263,6 +264,11 @@ namespace zypp
        */
       long download_max_concurrent_connections() const;
 
+      /**
+       * Maximum number of mirrors to try for a single metalink transfer
+       */
+      long download_max_mirrors() const;
+
       /**
        * Minimum download speed (bytes per second)
        * until the connection is dropped
@@ -284,6 +290,12 @@ namespace zypp
        */
       long download_transfer_timeout() const;
 
+      /** Whether to negotiate HTTP/2 for https transfers.
+       * Concurrent transfers to a host are then multiplexed on a single
+       * connection. Config option <tt>download.use_http2 (true)</tt>
+       */
+      bool download_use_http2() const;
+
 
       /** Whether to consider using a deltarpm when downloading a package.
        * Config option <tt>download.use_deltarpm (true)</tt>
@@ -328,6 +340,33 @@ namespace zypp
        */
       DownloadMode commit_downloadMode() const;
 
+      /**
+       * Number of packages to download in the background ahead of
+       * the package being installed (0 disables the prefetch).
+       */
+      unsigned commit_prefetchPackages() const;
+
+      /**
+       * Maximum size of the packages downloaded ahead but not yet installed.
+       */
+      ByteCount commit_prefetchBytes() const;
+
+      /**
+       * Maximum number of concurrent package downloads when downloading
+       * in advance (0 disables the parallel download).
+       */
+      unsigned commit_parallelConnections() const;
+
+      /**
+       * Maximum number of concurrent package downloads from the same host.
+       */
+      unsigned commit_parallelConnectionsPerHost() const;
+
+      /**
+       * Maximum number of concurrent package downloads from the same repository.
+       */
+      unsigned commit_parallelConnectionsPerRepo() const;
+
       /** \name Signature checking (repodata and packages)
        * If \ref gpgcheck is \c on (the default) we will either check the signature
        * of repo metadata (packages are secured via checksum in the metadata), or the
@@ -492,6 +531,13 @@ namespace zypp
        * \endcode
        */
       target::rpm::RpmInstFlags rpmInstallFlags() const;
+
+      /** The default batch size for \ref ZYppCommitPolicy::rpmInstallBatchSize.
+       * Up to this many packages are installed in a single rpm transaction
+       * (see rpm.install.batchsize in zypp.conf). \c 0 or \c 1 means one
+       * rpm call per package.
+       */
+      unsigned rpmInstallBatchSize() const;
       //@}
 
       /**
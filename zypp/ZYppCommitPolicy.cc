@@ -35,6 +35,7 @@ namespace zypp
       , _dryRun			( false )
       , _downloadMode		( ZConfig::instance().commit_downloadMode() )
       , _rpmInstFlags		( ZConfig::instance().rpmInstallFlags() )
+      , _rpmInstallBatchSize	( ZConfig::instance().rpmInstallBatchSize() )
       , _syncPoolAfterCommit	( true )
       {}
 
@@ -43,6 +44,7 @@ namespace zypp
       bool			_dryRun;
       DownloadMode		_downloadMode;
       target::rpm::RpmInstFlags	_rpmInstFlags;
+      unsigned			_rpmInstallBatchSize;
       bool			_syncPoolAfterCommit;
 
     private:
@@ -101,6 +103,12 @@ namespace zypp
   bool ZYppCommitPolicy::rpmExcludeDocs() const
   { return _pimpl->_rpmInstFlags.testFlag( target::rpm::RPMINST_EXCLUDEDOCS ); }
 
+  ZYppCommitPolicy & ZYppCommitPolicy::rpmInstallBatchSize( unsigned size_r )
+  { _pimpl->_rpmInstallBatchSize = size_r; return *this; }
+
+  unsigned ZYppCommitPolicy::rpmInstallBatchSize() const
+  { return _pimpl->_rpmInstallBatchSize; }
+
 
   ZYppCommitPolicy & ZYppCommitPolicy::syncPoolAfterCommit( bool yesNo_r )
   { _pimpl->_syncPoolAfterCommit = yesNo_r; return *this; }
@@ -121,6 +129,8 @@ namespace zypp
       str << " syncPoolAfterCommit";
     if ( obj.rpmInstFlags() )
       str << " rpmInstFlags{" << str::hexstring(obj.rpmInstFlags()) << "}";
+    if ( obj.rpmInstallBatchSize() > 1 )
+      str << " rpmInstallBatchSize:" << obj.rpmInstallBatchSize();
     return str << " )";
   }
 
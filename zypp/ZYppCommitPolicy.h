@@ -84,6 +84,13 @@ namespace zypp
 
       bool rpmExcludeDocs() const;
 
+      /** Install up to \a size packages in a single rpm transaction (default: zypp.conf rpm.install.batchsize).
+       * \c 0 or \c 1 calls rpm once per package. Batches are not used in \ref dryRun.
+       */
+      ZYppCommitPolicy & rpmInstallBatchSize( unsigned size_r );
+
+      unsigned rpmInstallBatchSize() const;
+
 
       /** Kepp pool in sync with the Target databases after commit (default: true) */
       ZYppCommitPolicy & syncPoolAfterCommit( bool yesNo_r );
@@ -61,6 +61,47 @@ namespace zypp
     int         _category;	///< saved category or -1 if no restore needed
     std::string _value;		///< saved category value
   };
+
+  ///////////////////////////////////////////////////////////////////
+  /// \class ThreadLocaleGuard
+  /// \brief Temorarily use a locale in the calling thread only
+  ///
+  /// Unlike \ref LocaleGuard the process wide locale is not changed
+  /// (\see <tt>man uselocale</tt>), so it is safe to use while other
+  /// threads are running.
+  /// \ingroup g_RAII
+  ///////////////////////////////////////////////////////////////////
+  class ThreadLocaleGuard
+  {
+    NON_COPYABLE(ThreadLocaleGuard);
+    NON_MOVABLE(ThreadLocaleGuard);
+
+  public:
+    /** Ctor switching the threads locale (all categories) to \a value_r. */
+    ThreadLocaleGuard( const std::string & value_r = "C" )
+    : _locale( ::newlocale( LC_ALL_MASK, value_r.c_str(), (locale_t)0 ) )
+    , _saved( _locale ? ::uselocale( _locale ) : (locale_t)0 )
+    {}
+
+    /** Dtor asserts the threads previous locale is restored. */
+    ~ThreadLocaleGuard()
+    { restore(); }
+
+    /** immediately restore the threads previous locale. */
+    void restore()
+    {
+      if ( _locale )
+      {
+	::uselocale( _saved );
+	::freelocale( _locale );
+	_locale = (locale_t)0;
+      }
+    }
+
+  private:
+    locale_t _locale;	///< the locale in use or 0 if no restore needed
+    locale_t _saved;	///< the threads previous locale
+  };
 } // namespace zypp
 ///////////////////////////////////////////////////////////////////
 #endif // ZYPP_BASE_LOCALEGUARD_H
@@ -12,6 +12,8 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <mutex>
+#include <thread>
 
 #include "zypp/base/Logger.h"
 #include "zypp/base/LogControl.h"
@@ -332,11 +334,12 @@ namespace zypp
           if ( level_r == E_XXX && !_excessive )
             return _no_stream;
 
-          if ( !_streamtable[group_r][level_r] )
+          StreamPtr & stream( streamtable()[group_r][level_r] );
+          if ( !stream )
             {
-              _streamtable[group_r][level_r].reset( new Loglinestream( group_r, level_r ) );
+              stream.reset( new Loglinestream( group_r, level_r ) );
             }
-          std::ostream & ret( _streamtable[group_r][level_r]->getStream( file_r, func_r, line_r ) );
+          std::ostream & ret( stream->getStream( file_r, func_r, line_r ) );
 	  if ( !ret )
 	  {
 	    ret.clear();
@@ -354,9 +357,13 @@ namespace zypp
                         const std::string & message_r )
         {
           if ( _lineWriter )
-            _lineWriter->writeOut( _lineFormater->format( group_r, level_r,
-                                                          file_r, func_r, line_r,
-                                                          message_r ) );
+          {
+            std::string line( _lineFormater->format( group_r, level_r,
+                                                     file_r, func_r, line_r,
+                                                     message_r ) );
+            std::lock_guard<std::mutex> guard( _writeMutex );
+            _lineWriter->writeOut( line );
+          }
         }
 
       private:
@@ -365,6 +372,22 @@ namespace zypp
         typedef std::map<std::string,StreamSet>  StreamTable;
         /** one streambuffer per group and level */
         StreamTable _streamtable;
+        /** the thread using \ref _streamtable */
+        std::thread::id _streamtableThread;
+        /** complete lines from different threads are written one at a time */
+        std::mutex _writeMutex;
+
+        /** The streambuffers to use in this thread.
+         * Besides the thread creating the singleton, threads get their own
+         * table, which is released when the thread exits.
+         */
+        StreamTable & streamtable()
+        {
+          if ( std::this_thread::get_id() == _streamtableThread )
+            return _streamtable;
+          static thread_local StreamTable threadtable;
+          return threadtable;
+        }
 
       private:
         /** Singleton ctor.
@@ -374,6 +397,7 @@ namespace zypp
         : _no_stream( NULL )
         , _excessive( getenv("ZYPP_FULLLOG") )
         , _lineFormater( new LogControl::LineFormater )
+        , _streamtableThread( std::this_thread::get_id() )
         {
           if ( getenv("ZYPP_LOGFILE") )
             logfile( getenv("ZYPP_LOGFILE") );
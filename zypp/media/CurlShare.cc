@@ -0,0 +1,121 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file zypp/media/CurlShare.cc
+ *
+*/
+#include <iostream>
+#include <unordered_map>
+
+#include "zypp/base/Logger.h"
+#include "zypp/base/String.h"
+#include "zypp/media/CurlShare.h"
+
+#undef CURLVERSION_AT_LEAST
+#define CURLVERSION_AT_LEAST(M,N,O) LIBCURL_VERSION_NUM >= ((((M)<<8)+(N))<<8)+(O)
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace media
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      /** A \c CURLSH used by a single thread, so it needs no locks. */
+      struct Share
+      {
+	Share()
+	: handle( ::curl_share_init() )
+	{
+	  if ( ! handle )
+	    return;
+	  ::curl_share_setopt( handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS );
+	  ::curl_share_setopt( handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION );
+#if CURLVERSION_AT_LEAST(7,57,0)
+	  ::curl_share_setopt( handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT );
+#endif
+	}
+
+	CURLSH * handle;
+      };
+
+      /** What a connection depends on (curl itself matches scheme, host and port). */
+      std::string shareKey( const TransferSettings & settings_r )
+      {
+	str::Str key;
+	if ( settings_r.proxyEnabled() )
+	  key << "proxy=" << settings_r.proxy() << '@' << settings_r.proxyUsername();
+	key << "|verify=" << settings_r.verifyPeerEnabled() << settings_r.verifyHostEnabled()
+	    << '|' << settings_r.certificateAuthoritiesPath()
+	    << '|' << settings_r.clientCertificatePath()
+	    << '|' << settings_r.clientKeyPath();
+	return key;
+      }
+
+      /** The shares of a thread, cleaned up when the thread exits. */
+      struct Shares
+      {
+	~Shares()
+	{
+	  for ( auto & el : shares )
+	  {
+	    // A share still used by a handle (e.g. one cleaned up later at
+	    // process exit) must outlive it, so it is left to the process exit.
+	    if ( ::curl_share_cleanup( el.second->handle ) == CURLSHE_OK )
+	      delete el.second;
+	    else
+	      DBG << "Curl share still in use: " << el.first << endl;
+	  }
+	}
+
+	CURLSH * get( const std::string & key_r )
+	{
+	  Share *& share( shares[key_r] );
+	  if ( ! share )
+	  {
+	    share = new Share;
+	    DBG << "New curl share " << key_r << endl;
+	  }
+	  return share->handle;
+	}
+
+	std::unordered_map<std::string,Share*> shares;
+      };
+
+      /** Curl's shared connection cache must not be used by concurrent
+       * threads, so each thread uses shares of its own.
+       */
+      Shares & shares()
+      {
+	static thread_local Shares _shares;
+	return _shares;
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    CURLcode CurlShare::attach( CURL * curl_r, const Url & url_r, const TransferSettings & settings_r )
+    {
+      CURLcode ret = CURLE_OK;
+      CURLSH * share = shares().get( shareKey( settings_r ) );
+      if ( share )
+	ret = ::curl_easy_setopt( curl_r, CURLOPT_SHARE, share );
+#if CURLVERSION_AT_LEAST(7,65,0)
+      if ( ret == CURLE_OK )
+	ret = ::curl_easy_setopt( curl_r, CURLOPT_MAXAGE_CONN, maxIdleTime );
+#endif
+      return ret;
+    }
+
+  } // namespace media
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
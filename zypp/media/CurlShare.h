@@ -0,0 +1,66 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file zypp/media/CurlShare.h
+ *
+*/
+#ifndef ZYPP_MEDIA_CURLSHARE_H
+#define ZYPP_MEDIA_CURLSHARE_H
+
+#include <curl/curl.h>
+
+#include "zypp/Url.h"
+#include "zypp/media/TransferSettings.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace media
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class CurlShare
+    /// \brief Process-wide transfer context shared by the curl handles.
+    ///
+    /// Curl handles share a \c CURLSH holding the open connections, the
+    /// DNS cache and the TLS sessions. So the connections and sessions
+    /// outlive a single \ref MediaCurl, and repositories on the same host
+    /// do not repeat the TCP and TLS handshakes.
+    ///
+    /// Shares are keyed by the settings a connection depends on (proxy,
+    /// TLS verification and client certificates). Curl itself matches the
+    /// connections per scheme, host and port, so the redirects and mirrors
+    /// of a \ref MediaMultiCurl transfer use the same share. Idle
+    /// connections are closed after \ref maxIdleTime. The connections per
+    /// host are limited by the multi handles running concurrent transfers
+    /// (\ref MediaCurl prefetch, \ref MediaMultiCurl), as a single handle
+    /// uses just one connection at a time.
+    ///
+    /// Curl's shared connection cache must not be used by concurrent
+    /// threads. So shares are confined to the thread attaching them, and a
+    /// handle must be used by that thread. The shares are cleaned up when
+    /// the thread exits. A share still used by a handle then, like one
+    /// cleaned up later at process exit, is left to the process exit.
+    ///////////////////////////////////////////////////////////////////
+    struct CurlShare
+    {
+      /** Max. seconds a connection may be idle to be reused. */
+      static const long maxIdleTime = 120;
+
+      /** Use the share for \a url_r and \a settings_r in \a curl_r.
+       * \return the \c curl_easy_setopt error, if any.
+       */
+      static CURLcode attach( CURL * curl_r, const Url & url_r, const TransferSettings & settings_r );
+    };
+    ///////////////////////////////////////////////////////////////////
+
+  } // namespace media
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_MEDIA_CURLSHARE_H
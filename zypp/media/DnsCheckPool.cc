@@ -0,0 +1,170 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file zypp/media/DnsCheckPool.cc
+ *
+*/
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <cstring>
+
+#include <iostream>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "zypp/base/Logger.h"
+#include "zypp/media/DnsCheckPool.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace media
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      /** Whether \a host_r resolves. */
+      bool resolves( const std::string & host_r )
+      {
+	struct addrinfo *ai, aihints;
+	memset( &aihints, 0, sizeof(aihints) );
+	aihints.ai_family = PF_UNSPEC;
+	int tstsock = socket( PF_INET6, SOCK_DGRAM | SOCK_CLOEXEC, 0 );
+	if ( tstsock == -1 )
+	  aihints.ai_family = PF_INET;
+	else
+	  close( tstsock );
+	aihints.ai_socktype = SOCK_STREAM;
+	aihints.ai_flags = AI_CANONNAME;
+	if ( getaddrinfo( host_r.c_str(), NULL, &aihints, &ai ) != 0 )
+	  return false;
+	freeaddrinfo( ai );
+	return true;
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class DnsCheckPool::Impl
+    /// \brief DnsCheckPool implementation.
+    ///////////////////////////////////////////////////////////////////
+    class DnsCheckPool::Impl : private base::NonCopyable
+    {
+      /** A queued lookup; holding the eventfd keeps it open for the result. */
+      struct Job
+      {
+	std::string host;
+	AutoDispose<int> fd;
+      };
+
+    public:
+      Impl( unsigned maxThreads_r )
+      : _maxThreads( maxThreads_r ? maxThreads_r : 1 )
+      {}
+
+      ~Impl()
+      {
+	{
+	  std::lock_guard<std::mutex> lock( _mutex );
+	  _stop = true;
+	  _jobs.clear();
+	}
+	_cond.notify_all();
+	for ( std::thread & thread : _threads )
+	  thread.join();
+      }
+
+      AutoDispose<int> check( const std::string & host_r )
+      {
+	AutoDispose<int> fd( ::eventfd( 0, EFD_CLOEXEC | EFD_NONBLOCK ), ::close );
+	if ( fd == -1 )
+	{
+	  fd.resetDispose();
+	  return fd;
+	}
+
+	std::lock_guard<std::mutex> lock( _mutex );
+	_jobs.push_back( Job{ host_r, fd } );
+	if ( _jobs.size() > _idle && _threads.size() < _maxThreads )
+	{
+	  try
+	  {
+	    _threads.push_back( std::thread( &Impl::worker, this ) );
+	  }
+	  catch ( const std::exception & excpt )
+	  {
+	    WAR << "Can't start DNS check thread: " << excpt.what() << endl;
+	    if ( _threads.empty() )
+	    {
+	      _jobs.pop_back();
+	      return AutoDispose<int>( -1 );
+	    }
+	  }
+	}
+	_cond.notify_one();
+	return fd;
+      }
+
+    private:
+      void worker()
+      {
+	std::unique_lock<std::mutex> lock( _mutex );
+	while ( true )
+	{
+	  ++_idle;
+	  _cond.wait( lock, [this]() { return _stop || ! _jobs.empty(); } );
+	  --_idle;
+	  if ( _stop )
+	    return;
+	  Job job( std::move( _jobs.front() ) );
+	  _jobs.pop_front();
+
+	  lock.unlock();
+	  uint64_t result = resolves( job.host ) ? DNS_OK : DNS_FAILED;
+	  // if this fails the caller runs into its timeout
+	  ssize_t written = ::write( job.fd, &result, sizeof(result) );
+	  (void)written;
+	  job.fd.reset();
+	  lock.lock();
+	}
+      }
+
+    private:
+      const unsigned _maxThreads;
+      std::mutex _mutex;
+      std::condition_variable _cond;
+      std::deque<Job> _jobs;
+      std::vector<std::thread> _threads;
+      unsigned _idle = 0;
+      bool _stop = false;
+    };
+    ///////////////////////////////////////////////////////////////////
+
+    DnsCheckPool::DnsCheckPool( unsigned maxThreads_r )
+    : _pimpl( new Impl( maxThreads_r ) )
+    {}
+
+    DnsCheckPool::~DnsCheckPool()
+    {}
+
+    AutoDispose<int> DnsCheckPool::check( const std::string & host_r )
+    { return _pimpl->check( host_r ); }
+
+  } // namespace media
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,66 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file zypp/media/DnsCheckPool.h
+ *
+*/
+#ifndef ZYPP_MEDIA_DNSCHECKPOOL_H
+#define ZYPP_MEDIA_DNSCHECKPOOL_H
+
+#include <string>
+
+#include "zypp/base/NonCopyable.h"
+#include "zypp/base/PtrTypes.h"
+#include "zypp/AutoDispose.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace media
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class DnsCheckPool
+    /// \brief Checks whether host names resolve, using a bounded pool of threads.
+    ///
+    /// \ref check returns an \c eventfd which becomes readable once the
+    /// lookup is done. Reading it yields \ref DNS_OK or \ref DNS_FAILED as
+    /// \c uint64_t. At most \c maxThreads_r lookups run at a time. The
+    /// threads are started on demand and joined by the destructor. Lookups
+    /// still queued are dropped then, running ones are waited for.
+    ///////////////////////////////////////////////////////////////////
+    class DnsCheckPool : private base::NonCopyable
+    {
+    public:
+      /** The result posted to the eventfd. */
+      enum Result { DNS_OK = 1, DNS_FAILED = 2 };
+
+    public:
+      /** Ctor using at most \a maxThreads_r threads. */
+      explicit DnsCheckPool( unsigned maxThreads_r = 4 );
+
+      /** Dtor joining the threads. */
+      ~DnsCheckPool();
+
+      /** Queue a lookup of \a host_r.
+       * \return the eventfd receiving the \ref Result, or \c -1 on error.
+       */
+      AutoDispose<int> check( const std::string & host_r );
+
+    public:
+      class Impl;
+    private:
+      RW_pointer<Impl> _pimpl;
+    };
+    ///////////////////////////////////////////////////////////////////
+
+  } // namespace media
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_MEDIA_DNSCHECKPOOL_H
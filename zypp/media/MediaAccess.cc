@@ -356,6 +356,26 @@ MediaAccess::setDeltafile( const Pathname & filename ) const
   _handler->setDeltafile( filename );
 }
 
+void
+MediaAccess::setChecksumType( const std::string & type_r ) const
+{
+  if ( !_handler ) {
+    ZYPP_THROW(MediaNotOpenException("setChecksumType(" + type_r + ")"));
+  }
+
+  _handler->setChecksumType( type_r );
+}
+
+void
+MediaAccess::prefetchFiles( const std::vector<OnMediaLocation> & files ) const
+{
+  if ( !_handler ) {
+    ZYPP_THROW(MediaNotOpenException("prefetchFiles"));
+  }
+
+  _handler->prefetchFiles( files );
+}
+
 void
 MediaAccess::releaseFile( const Pathname & filename ) const
 {
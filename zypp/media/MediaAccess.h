@@ -15,6 +15,7 @@
 #include <iosfwd>
 #include <map>
 #include <list>
+#include <vector>
 #include <string>
 
 #include "zypp/base/ReferenceCounted.h"
@@ -29,6 +30,7 @@
 #include "zypp/media/MediaSource.h"
 
 #include "zypp/Url.h"
+#include "zypp/OnMediaLocation.h"
 
 namespace zypp {
   namespace media {
@@ -279,6 +281,17 @@ namespace zypp {
 	 */
 	void setDeltafile( const Pathname & filename ) const;
 
+	/**
+	 * set the checksum type expected for the next download
+	 */
+	void setChecksumType( const std::string & type_r ) const;
+
+	/**
+	 * Hint that the files \a files will be provided next,
+	 * so the handler may transfer them ahead.
+	 */
+	void prefetchFiles( const std::vector<OnMediaLocation> & files ) const;
+
     public:
 
 	/**
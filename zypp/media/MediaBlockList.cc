@@ -11,6 +11,10 @@
  */
 
 #include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -18,10 +22,13 @@
 #include <vector>
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <thread>
 
 #include "zypp/media/MediaBlockList.h"
 #include "zypp/base/Logger.h"
 #include "zypp/base/String.h"
+#include "zypp/AutoDispose.h"
 
 using namespace std;
 using namespace zypp::base;
@@ -204,25 +211,6 @@ MediaBlockList::checkChecksum(size_t blkno, const unsigned char *buf, size_t buf
   return verifyDigest(blkno, dig);
 }
 
-// specialized version of checkChecksum that can deal with a "rotated" buffer
-bool
-MediaBlockList::checkChecksumRotated(size_t blkno, const unsigned char *buf, size_t bufl, size_t start) const
-{
-  if (blkno >= blocks.size() || bufl < blocks[blkno].size)
-    return false;
-  if (start == bufl)
-    start = 0;
-  Digest dig;
-  if (!createDigest(dig))
-    return false;
-  size_t size = blocks[blkno].size;
-  size_t len = bufl - start > size ? size : bufl - start;
-  dig.update((const char *)buf + start, len);
-  if (size > len)
-    dig.update((const char *)buf, size - len);
-  return verifyDigest(blkno, dig);
-}
-
 // write block to the file. can also deal with "rotated" buffers
 void
 MediaBlockList::writeBlock(size_t blkno, FILE *fp, const unsigned char *buf, size_t bufl, size_t start, vector<bool> &found) const
@@ -244,39 +232,168 @@ MediaBlockList::writeBlock(size_t blkno, FILE *fp, const unsigned char *buf, siz
   found[blocks.size()] = true;
 }
 
-static size_t
-fetchnext(FILE *fp, unsigned char *bp, size_t blksize, size_t pushback, unsigned char *pushbackp)
+///////////////////////////////////////////////////////////////////
+namespace
 {
-  size_t l = blksize;
-  int c;
+  /** Seed files smaller than this are scanned in one piece. */
+  const size_t minSliceSize = 4 * 1024 * 1024;
 
-  if (pushback)
+  /** A seed file mapped into memory. */
+  struct SeedFile
+  {
+    SeedFile(const std::string &filename_r)
+    : size(0)
     {
-      if (pushbackp != bp)
-        memmove(bp, pushbackp, pushback);
-      bp += pushback;
-      l -= pushback;
+      AutoDispose<int> fd(::open(filename_r.c_str(), O_RDONLY|O_CLOEXEC), ::close);
+      if (fd == -1)
+	{
+	  fd.resetDispose();
+	  return;
+	}
+      struct stat st;
+      if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0)
+	return;
+      size_t mapsize = st.st_size;
+      void *m = ::mmap(NULL, mapsize, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (m == MAP_FAILED)
+	return;
+      ::madvise(m, mapsize, MADV_SEQUENTIAL);
+      map = AutoDispose<void*>(m, [mapsize](void *p) { ::munmap(p, mapsize); });
+      size = mapsize;
     }
-  while (l)
+
+    const unsigned char *data() const
+    { return reinterpret_cast<const unsigned char *>(map.value()); }
+
+    AutoDispose<void*> map;
+    size_t size;
+  };
+
+  /** The \a len bytes at \a off of \a data, zero padded beyond \a size. */
+  inline const unsigned char *window(const unsigned char *data, size_t size, size_t off, size_t len, unsigned char *scratch)
+  {
+    if (off + len <= size)
+      return data + off;
+    size_t l = off < size ? size - off : 0;
+    if (l)
+      memcpy(scratch, data + off, l);
+    memset(scratch + l, 0, len - l);
+    return scratch;
+  }
+} // namespace
+///////////////////////////////////////////////////////////////////
+
+// scan the window start positions [start, end) of a seed file for blocks
+// matching the rolling checksums (hashed in ht), then verify them with the
+// strong checksum. Returns the matches as (blkno, offset in seed).
+void
+MediaBlockList::scanSeed(const unsigned char *data, size_t size, size_t start, size_t end, size_t blksize, const std::vector<unsigned int> &ht, std::vector<bool> found, std::vector<std::pair<size_t, size_t> > &matches) const
+{
+  size_t nblks = blocks.size();
+  unsigned int hm = ht.size() - 1;
+  int bshift = 0;
+  if ((blksize & (blksize - 1)) == 0)
+    for (bshift = 0; size_t(1 << bshift) != blksize; bshift++)
+      ;
+  int sql = nblks > 1 && chksumlen < 16 ? 2 : 1;
+  vector<unsigned char> buf(blksize);
+  vector<unsigned char> buf2(blksize);
+
+  unsigned short a = 0, b = 0;
+  bool init = true;
+  size_t p = start;
+  while (p < end)
     {
-      c = getc(fp);
-      if (c == EOF)
-        break;
-      *bp++ = c;
-      l--;
+      if (sql == 2 && p + blksize > size)
+	break;	// two consecutive blocks needed
+      if (init)
+	{
+	  const unsigned char *w = window(data, size, p, blksize, &buf[0]);
+	  a = b = 0;
+	  for (size_t i = 0; i < blksize; i++)
+	    {
+	      a += w[i];
+	      b += a;
+	    }
+	  init = false;
+	}
+      unsigned int r;
+      if (rsumlen == 1)
+	r = ((unsigned int)b & 255);
+      else if (rsumlen == 2)
+	r = ((unsigned int)b & 65535);
+      else if (rsumlen == 3)
+	r = ((unsigned int)a & 255) << 16 | ((unsigned int)b & 65535);
+      else
+	r = ((unsigned int)a & 65535) << 16 | ((unsigned int)b & 65535);
+      bool matched = false;
+      unsigned int h = r & hm;
+      unsigned int hh = 7;
+      for (; ht[h]; h = (h + hh++) & hm)
+	{
+	  size_t blkno = ht[h] - 1;
+	  if (rsums[blkno] != r)
+	    continue;
+	  if (found[blkno])
+	    continue;
+	  const unsigned char *w2 = 0;
+	  if (sql == 2)
+	    {
+	      if (blkno + 1 >= nblks || p + blksize >= size)
+		continue;
+	      w2 = window(data, size, p + blksize, blksize, &buf2[0]);
+	      if (!checkRsum(blkno + 1, w2, blksize))
+		continue;
+	    }
+	  if (!checkChecksum(blkno, window(data, size, p, blksize, &buf[0]), blksize))
+	    continue;
+	  if (sql == 2 && !checkChecksum(blkno + 1, w2, blksize))
+	    continue;
+	  // found! now try the following blocks
+	  size_t q = p;
+	  size_t nb = blkno;
+	  for (int i = 0; i < sql; i++, q += blksize, nb++)
+	    {
+	      matches.push_back(std::make_pair(nb, q));
+	      found[nb] = true;
+	    }
+	  for (; q < size && nb < nblks; q += blksize, nb++)
+	    {
+	      w2 = window(data, size, q, blksize, &buf2[0]);
+	      if (!checkRsum(nb, w2, blksize) || !checkChecksum(nb, w2, blksize))
+		break;
+	      matches.push_back(std::make_pair(nb, q));
+	      found[nb] = true;
+	    }
+	  p = q;
+	  init = true;
+	  matched = true;
+	  break;
+	}
+      if (matched)
+	continue;
+      // roll on
+      unsigned int oc = data[p];
+      unsigned int c = p + blksize < size ? data[p + blksize] : 0;
+      a += c - oc;
+      if (bshift)
+	b += a - (oc << bshift);
+      else
+	b += a - oc * blksize;
+      p++;
     }
-  if (l)
-    memset(bp, 0, l);
-  return blksize - l;
 }
 
-
 void
 MediaBlockList::reuseBlocks(FILE *wfp, string filename)
 {
-  FILE *fp;
+  reuseBlocks(wfp, std::vector<std::string>(1, filename));
+}
 
-  if (!chksumlen || (fp = fopen(filename.c_str(), "r")) == 0)
+void
+MediaBlockList::reuseBlocks(FILE *wfp, const std::vector<std::string> &filenames)
+{
+  if (!chksumlen)
     return;
   size_t nblks = blocks.size();
   vector<bool> found;
@@ -293,8 +410,7 @@ MediaBlockList::reuseBlocks(FILE *wfp, string filename)
       hm = hm * 2 - 1;
       if (hm < 16383)
 	hm = 16383;
-      unsigned int *ht = new unsigned int[hm + 1];
-      memset(ht, 0, (hm + 1) * sizeof(unsigned int));
+      vector<unsigned int> ht(hm + 1);
       for (unsigned int i = 0; i < rsums.size(); i++)
 	{
 	  if (blocks[i].size != blksize && (i != nblks - 1 || rsumpad != blksize))
@@ -307,154 +423,67 @@ MediaBlockList::reuseBlocks(FILE *wfp, string filename)
 	  ht[h] = i + 1;
 	}
 
-      unsigned char *buf = new unsigned char[blksize];
-      unsigned char *buf2 = new unsigned char[blksize];
-      size_t pushback = 0;
-      unsigned char *pushbackp = 0;
-      int bshift = 0;
-      if ((blksize & (blksize - 1)) == 0)
-	for (bshift = 0; size_t(1 << bshift) != blksize; bshift++)
-	  ;
-      unsigned short a, b;
-      a = b = 0;
-      memset(buf, 0, blksize);
-      bool eof = 0;
-      bool init = 1;
-      int sql = nblks > 1 && chksumlen < 16 ? 2 : 1;
-      while (!eof)
+      vector<unsigned char> buf(blksize);
+      for (const std::string & filename : filenames)
 	{
-	  for (size_t i = 0; i < blksize; i++)
+	  SeedFile seed(filename);
+	  if (!seed.size)
+	    continue;
+	  // scan slices of large files in parallel (matches may cross the slice ends)
+	  size_t nslices = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1U), seed.size / minSliceSize + 1);
+	  size_t slicesize = (seed.size + nslices - 1) / nslices;
+	  vector<vector<std::pair<size_t, size_t> > > matches(nslices);
+	  vector<std::thread> threads;
+	  for (size_t i = 0; i < nslices; i++)
 	    {
-	      int c;
-	      if (eof)
-		c = 0;
-	      else
+	      size_t start = i * slicesize;
+	      size_t end = std::min(start + slicesize, seed.size);
+	      auto scan = [=, &seed, &ht, &found, &matches]() {
+		scanSeed(seed.data(), seed.size, start, end, blksize, ht, found, matches[i]);
+	      };
+	      try
 		{
-		   if (pushback)
+		  if (i + 1 < nslices)
 		    {
-		      c = *pushbackp++;
-		      pushback--;
+		      threads.emplace_back(scan);
+		      continue;
 		    }
-		  else
-		    c = getc(fp);
-		  if (c == EOF)
-		    {
-		      eof = true;
-		      c = 0;
-		      if (!i || sql == 2)
-			break;
-		    }
-		}
-	      int oc = buf[i];
-	      buf[i] = c;
-	      a += c - oc;
-	      if (bshift)
-		b += a - (oc << bshift);
-	      else
-		b += a - oc * blksize;
-	      if (init)
-		{
-		  if (size_t(i) != blksize - 1)
-		    continue;
-		  init = 0;
-		}
-	      unsigned int r;
-	      if (rsumlen == 1)
-		r = ((unsigned int)b & 255);
-	      else if (rsumlen == 2)
-		r = ((unsigned int)b & 65535);
-	      else if (rsumlen == 3)
-		r = ((unsigned int)a & 255) << 16 | ((unsigned int)b & 65535);
-	      else
-		r = ((unsigned int)a & 65535) << 16 | ((unsigned int)b & 65535);
-	      unsigned int h = r & hm;
-	      unsigned int hh = 7;
-	      for (; ht[h]; h = (h + hh++) & hm)
-		{
-		  size_t blkno = ht[h] - 1;
-		  if (rsums[blkno] != r)
-		    continue;
-		  if (found[blkno])
-		    continue;
-		  if (sql == 2)
-		    {
-		      if (eof || blkno + 1 >= nblks)
-			continue;
-		      pushback = fetchnext(fp, buf2, blksize, pushback, pushbackp);
-		      pushbackp = buf2;
-		      if (!pushback)
-			continue;
-		      if (!checkRsum(blkno + 1, buf2, blksize))
-			continue;
-		    }
-		  if (!checkChecksumRotated(blkno, buf, blksize, i + 1))
-		    continue;
-		  if (sql == 2 && !checkChecksum(blkno + 1, buf2, blksize))
-		    continue;
-		  writeBlock(blkno, wfp, buf, blksize, i + 1, found);
-		  if (sql == 2)
-		    {
-		      writeBlock(blkno + 1, wfp, buf2, blksize, 0, found);
-		      pushback = 0;
-		      blkno++;
-		    }
-		  while (!eof)
-		    {
-		      blkno++;
-		      pushback = fetchnext(fp, buf2, blksize, pushback, pushbackp);
-		      pushbackp = buf2;
-		      if (!pushback)
-			break;
-		      if (!checkRsum(blkno, buf2, blksize))
-			break;
-		      if (!checkChecksum(blkno, buf2, blksize))
-			break;
-		      writeBlock(blkno, wfp, buf2, blksize, 0, found);
-		      pushback = 0;
-		    }
-		  init = false;
-		  memset(buf, 0, blksize);
-	 	  a = b = 0;
-		  i = size_t(-1);	// start with 0 on next iteration
-		  break;
 		}
+	      catch (const std::exception &)
+		{}
+	      scan();
 	    }
+	  for (std::thread &thread : threads)
+	    thread.join();
+
+	  size_t nfound = 0;
+	  for (const auto &slice : matches)
+	    for (const auto &match : slice)
+	      {
+		if (found[match.first])
+		  continue;
+		writeBlock(match.first, wfp, window(seed.data(), seed.size, match.second, blksize, &buf[0]), blksize, 0, found);
+		if (found[match.first])
+		  nfound++;
+	      }
+	  DBG << "reused " << nfound << " of " << nblks << " blocks from " << filename << " (" << nslices << " slices)" << endl;
 	}
-      delete[] buf2;
-      delete[] buf;
-      delete[] ht;
     }
   else if (chksumlen >= 16)
     {
       // dummy variant, just check the checksums
-      size_t bufl = 4096;
-      off_t off = 0;
-      unsigned char *buf = new unsigned char[bufl];
-      for (size_t blkno = 0; blkno < blocks.size(); ++blkno)
+      for (const std::string & filename : filenames)
 	{
-	  if (off > blocks[blkno].off)
-	    continue;
-	  size_t blksize = blocks[blkno].size;
-	  if (blksize > bufl)
-	    {
-	      delete[] buf;
-	      bufl = blksize;
-              buf = new unsigned char[bufl];
-	    }
-	  size_t skip = blocks[blkno].off - off;
-	  while (skip)
+	  SeedFile seed(filename);
+	  for (size_t blkno = 0; blkno < blocks.size(); ++blkno)
 	    {
-	      size_t l = skip > bufl ? bufl : skip;
-	      if (fread(buf, l, 1, fp) != 1)
+	      size_t off = blocks[blkno].off;
+	      size_t blksize = blocks[blkno].size;
+	      if (off + blksize > seed.size)
 		break;
-	      skip -= l;
-	      off += l;
+	      if (!found[blkno] && checkChecksum(blkno, seed.data() + off, blksize))
+		writeBlock(blkno, wfp, seed.data() + off, blksize, 0, found);
 	    }
-	  if (fread(buf, blksize, 1, fp) != 1)
-	    break;
-	  if (checkChecksum(blkno, buf, blksize))
-	    writeBlock(blkno, wfp, buf, blksize, 0, found);
-	  off += blksize;
 	}
     }
   if (!found[nblks])
@@ -13,6 +13,8 @@
 #define ZYPP_MEDIA_MEDIABLOCKLIST_H
 
 #include <sys/types.h>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "zypp/Digest.h"
@@ -114,6 +116,13 @@ public:
    **/
   void reuseBlocks(FILE *wfp, std::string filename);
 
+  /**
+   * scan several files for blocks from our blocklist, e.g. older versions
+   * of the file. Blocks are taken from the first file containing them.
+   * Large files are memory mapped and scanned in parallel slices.
+   **/
+  void reuseBlocks(FILE *wfp, const std::vector<std::string> &filenames);
+
   /**
    * return block list as string
    **/
@@ -121,7 +130,7 @@ public:
 
 private:
   void writeBlock(size_t blkno, FILE *fp, const unsigned char *buf, size_t bufl, size_t start, std::vector<bool> &found) const;
-  bool checkChecksumRotated(size_t blkno, const unsigned char *buf, size_t bufl, size_t start) const;
+  void scanSeed(const unsigned char *data, size_t size, size_t start, size_t end, size_t blksize, const std::vector<unsigned int> &ht, std::vector<bool> found, std::vector<std::pair<size_t, size_t> > &matches) const;
 
   off_t filesize;
   std::string fsumtype;
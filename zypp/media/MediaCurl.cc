@@ -18,13 +18,17 @@
 #include "zypp/base/String.h"
 #include "zypp/base/Gettext.h"
 #include "zypp/base/Sysconfig.h"
+#include "zypp/base/NonCopyable.h"
+#include "zypp/AutoDispose.h"
 #include "zypp/base/Gettext.h"
+#include "zypp/Digest.h"
 
 #include "zypp/media/MediaCurl.h"
 #include "zypp/media/ProxyInfo.h"
 #include "zypp/media/MediaUserAuth.h"
 #include "zypp/media/CredentialManager.h"
 #include "zypp/media/CurlConfig.h"
+#include "zypp/media/CurlShare.h"
 #include "zypp/thread/Once.h"
 #include "zypp/Target.h"
 #include "zypp/ZYppFactory.h"
@@ -157,6 +161,21 @@ namespace
 
     return max;
   }
+
+  /** Write the downloaded data to a file and digest it on the fly. */
+  struct HashingWriter
+  {
+    FILE * file;
+    zypp::Digest digest;
+  };
+
+  static size_t write_hashing_curl( char *ptr, size_t size, size_t nmemb, void *userdata )
+  {
+    HashingWriter * writer = reinterpret_cast<HashingWriter *>( userdata );
+    size_t written = ::fwrite( ptr, 1, size * nmemb, writer->file );
+    writer->digest.update( ptr, written );
+    return written;
+  }
 }
 
 namespace zypp {
@@ -462,6 +481,10 @@ void fillSettingsFromUrl( const Url &url, TransferSettings &s )
     param = url.getQueryParam("head_requests");
     if( !param.empty() && param == "no" )
         s.setHeadRequestsAllowed(false);
+
+    param = url.getQueryParam("http2");
+    if( !param.empty() && param == "no" )
+        s.setHttp2Enabled(false);
 }
 
 /**
@@ -599,7 +622,7 @@ MediaCurl::MediaCurl( const Url &      url_r,
   }
 }
 
-Url MediaCurl::clearQueryString(const Url &url) const
+Url MediaCurl::clearQueryString(const Url &url)
 {
   Url curlUrl (url);
   curlUrl.setUsername( "" );
@@ -621,6 +644,7 @@ Url MediaCurl::clearQueryString(const Url &url) const
   curlUrl.delQueryParam("mediahandler");
   curlUrl.delQueryParam("credentials");
   curlUrl.delQueryParam("head_requests");
+  curlUrl.delQueryParam("http2");
   return curlUrl;
 }
 
@@ -682,111 +706,165 @@ void MediaCurl::setupEasy()
     ZYPP_THROW(MediaCurlSetOptException(_url, "Error setting error buffer"));
   }
 
-  SET_OPTION(CURLOPT_FAILONERROR, 1L);
-  SET_OPTION(CURLOPT_NOSIGNAL, 1L);
-
-  // create non persistant settings
-  // so that we don't add headers twice
-  TransferSettings vol_settings(_settings);
-
-  // add custom headers for download.opensuse.org (bsc#955801)
-  if ( _url.getHost() == "download.opensuse.org" )
-  {
-    vol_settings.addHeader(anonymousIdHeader());
-    vol_settings.addHeader(distributionFlavorHeader());
-  }
-  vol_settings.addHeader("Pragma:");
-
-  _settings.setTimeout(ZConfig::instance().download_transfer_timeout());
-  _settings.setConnectTimeout(CONNECT_TIMEOUT);
-
-  _settings.setUserAgentString(agentString());
-
   // fill some settings from url query parameters
   try
   {
-      fillSettingsFromUrl(_url, _settings);
+      fillSettings(_url, _settings);
   }
   catch ( const MediaException &e )
   {
       disconnectFrom();
       ZYPP_RETHROW(e);
   }
+
+  setupEasyHandle(_curl, _url, _settings, _customHeaders);
+
+  _currentCookieFile = _cookieFile.asString();
+  if ( str::strToBool( _url.getQueryParam( "cookies" ), true ) )
+    SET_OPTION(CURLOPT_COOKIEFILE, _currentCookieFile.c_str() );
+  else
+    MIL << "No cookies requested" << endl;
+  SET_OPTION(CURLOPT_COOKIEJAR, _currentCookieFile.c_str() );
+  SET_OPTION(CURLOPT_PROGRESSFUNCTION, &progressCallback );
+  SET_OPTION(CURLOPT_NOPROGRESS, 0L);
+
+  // reuse connections, DNS and TLS sessions of other handles of this thread
+  ret = CurlShare::attach( _curl, _url, _settings );
+  if ( ret != 0 )
+    ZYPP_THROW(MediaCurlSetOptException(_url, _curlError));
+}
+
+void MediaCurl::globalInit()
+{
+  globalInitOnce();
+}
+
+void MediaCurl::fillSettings( const Url & url_r, TransferSettings & settings_r )
+{
+  settings_r.setTimeout(ZConfig::instance().download_transfer_timeout());
+  settings_r.setConnectTimeout(CONNECT_TIMEOUT);
+
+  settings_r.setUserAgentString(agentString());
+
+  // fill some settings from url query parameters
+  fillSettingsFromUrl(url_r, settings_r);
+
   // if the proxy was not set (or explicitly unset) by url, then look...
-  if ( _settings.proxy().empty() )
+  if ( settings_r.proxy().empty() )
   {
       // ...at the system proxy settings
-      fillSettingsSystemProxy(_url, _settings);
+      fillSettingsSystemProxy(url_r, settings_r);
+  }
+}
+
+long MediaCurl::httpVersion( const Url & url_r, const TransferSettings & settings_r )
+{
+#if CURLVERSION_AT_LEAST(7,60,0)	// SLE15+
+  if ( url_r.getScheme() == "https" )
+  {
+    // HTTP/2 if offered via ALPN, HTTP/1.1 otherwise
+    return settings_r.http2Enabled() ? CURL_HTTP_VERSION_2TLS : CURL_HTTP_VERSION_1_1;
+  }
+#endif
+  return CURL_HTTP_VERSION_NONE;
+}
+
+#define SET_EASY_OPTION(opt,val) do { \
+    CURLcode ret = curl_easy_setopt ( curl_r, opt, val ); \
+    if ( ret != 0) { \
+      ZYPP_THROW(MediaCurlSetOptException(url_r, curl_easy_strerror(ret))); \
+    } \
+  } while ( false )
+
+#define SET_EASY_OPTION_OFFT(opt,val) SET_EASY_OPTION(opt,(curl_off_t)val)
+
+void MediaCurl::setupEasyHandle( CURL * curl_r, const Url & url_r, const TransferSettings & settings_r, curl_slist *& headers_r )
+{
+  SET_EASY_OPTION(CURLOPT_FAILONERROR, 1L);
+  SET_EASY_OPTION(CURLOPT_NOSIGNAL, 1L);
+
+  // create non persistant settings
+  // so that we don't add headers twice
+  TransferSettings vol_settings(settings_r);
+
+  // add custom headers for download.opensuse.org (bsc#955801)
+  if ( url_r.getHost() == "download.opensuse.org" )
+  {
+    vol_settings.addHeader(anonymousIdHeader());
+    vol_settings.addHeader(distributionFlavorHeader());
   }
+  vol_settings.addHeader("Pragma:");
 
   /** Force IPv4/v6 */
   if ( env::ZYPP_MEDIA_CURL_IPRESOLVE() )
   {
     switch ( env::ZYPP_MEDIA_CURL_IPRESOLVE() )
     {
-      case 4: SET_OPTION(CURLOPT_IPRESOLVE, CURL_IPRESOLVE_V4); break;
-      case 6: SET_OPTION(CURLOPT_IPRESOLVE, CURL_IPRESOLVE_V6); break;
+      case 4: SET_EASY_OPTION(CURLOPT_IPRESOLVE, CURL_IPRESOLVE_V4); break;
+      case 6: SET_EASY_OPTION(CURLOPT_IPRESOLVE, CURL_IPRESOLVE_V6); break;
     }
   }
 
  /**
   * Connect timeout
   */
-  SET_OPTION(CURLOPT_CONNECTTIMEOUT, _settings.connectTimeout());
+  SET_EASY_OPTION(CURLOPT_CONNECTTIMEOUT, settings_r.connectTimeout());
   // If a transfer timeout is set, also set CURLOPT_TIMEOUT to an upper limit
   // just in case curl does not trigger its progress callback frequently
   // enough.
-  if ( _settings.timeout() )
+  if ( settings_r.timeout() )
   {
-    SET_OPTION(CURLOPT_TIMEOUT, 3600L);
+    SET_EASY_OPTION(CURLOPT_TIMEOUT, 3600L);
   }
 
   // follow any Location: header that the server sends as part of
   // an HTTP header (#113275)
-  SET_OPTION(CURLOPT_FOLLOWLOCATION, 1L);
+  SET_EASY_OPTION(CURLOPT_FOLLOWLOCATION, 1L);
   // 3 redirects seem to be too few in some cases (bnc #465532)
-  SET_OPTION(CURLOPT_MAXREDIRS, 6L);
+  SET_EASY_OPTION(CURLOPT_MAXREDIRS, 6L);
 
-  if ( _url.getScheme() == "https" )
+  if ( url_r.getScheme() == "https" )
   {
 #if CURLVERSION_AT_LEAST(7,19,4)
     // restrict following of redirections from https to https only
-    SET_OPTION( CURLOPT_REDIR_PROTOCOLS, CURLPROTO_HTTPS );
+    SET_EASY_OPTION( CURLOPT_REDIR_PROTOCOLS, CURLPROTO_HTTPS );
 #endif
 #if CURLVERSION_AT_LEAST(7,60,0)	// SLE15+
-    SET_OPTION( CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS );
+    long httpversion = httpVersion( url_r, settings_r );
+    SET_EASY_OPTION( CURLOPT_HTTP_VERSION, httpversion );
+    if ( httpversion == CURL_HTTP_VERSION_2TLS )
+    {
+      // concurrent transfers wait for a connection they can be multiplexed on
+      SET_EASY_OPTION( CURLOPT_PIPEWAIT, 1L );
+    }
 #endif
 
-    if( _settings.verifyPeerEnabled() ||
-        _settings.verifyHostEnabled() )
+    if( settings_r.verifyPeerEnabled() ||
+        settings_r.verifyHostEnabled() )
     {
-      SET_OPTION(CURLOPT_CAPATH, _settings.certificateAuthoritiesPath().c_str());
+      SET_EASY_OPTION(CURLOPT_CAPATH, settings_r.certificateAuthoritiesPath().c_str());
     }
 
-    if( ! _settings.clientCertificatePath().empty() )
+    if( ! settings_r.clientCertificatePath().empty() )
     {
-      SET_OPTION(CURLOPT_SSLCERT, _settings.clientCertificatePath().c_str());
+      SET_EASY_OPTION(CURLOPT_SSLCERT, settings_r.clientCertificatePath().c_str());
     }
-    if( ! _settings.clientKeyPath().empty() )
+    if( ! settings_r.clientKeyPath().empty() )
     {
-      SET_OPTION(CURLOPT_SSLKEY, _settings.clientKeyPath().c_str());
+      SET_EASY_OPTION(CURLOPT_SSLKEY, settings_r.clientKeyPath().c_str());
     }
 
 #ifdef CURLSSLOPT_ALLOW_BEAST
     // see bnc#779177
-    ret = curl_easy_setopt( _curl, CURLOPT_SSL_OPTIONS, CURLSSLOPT_ALLOW_BEAST );
-    if ( ret != 0 ) {
-      disconnectFrom();
-      ZYPP_THROW(MediaCurlSetOptException(_url, _curlError));
-    }
+    SET_EASY_OPTION(CURLOPT_SSL_OPTIONS, CURLSSLOPT_ALLOW_BEAST);
 #endif
-    SET_OPTION(CURLOPT_SSL_VERIFYPEER, _settings.verifyPeerEnabled() ? 1L : 0L);
-    SET_OPTION(CURLOPT_SSL_VERIFYHOST, _settings.verifyHostEnabled() ? 2L : 0L);
+    SET_EASY_OPTION(CURLOPT_SSL_VERIFYPEER, settings_r.verifyPeerEnabled() ? 1L : 0L);
+    SET_EASY_OPTION(CURLOPT_SSL_VERIFYHOST, settings_r.verifyHostEnabled() ? 2L : 0L);
     // bnc#903405 - POODLE: libzypp should only talk TLS
-    SET_OPTION(CURLOPT_SSLVERSION, CURL_SSLVERSION_TLSv1);
+    SET_EASY_OPTION(CURLOPT_SSLVERSION, CURL_SSLVERSION_TLSv1);
   }
 
-  SET_OPTION(CURLOPT_USERAGENT, _settings.userAgentString().c_str() );
+  SET_EASY_OPTION(CURLOPT_USERAGENT, settings_r.userAgentString().c_str() );
 
   /*---------------------------------------------------------------*
    CURLOPT_USERPWD: [user name]:[password]
@@ -795,10 +873,10 @@ void MediaCurl::setupEasy()
    If not provided, anonymous FTP identification
    *---------------------------------------------------------------*/
 
-  if ( _settings.userPassword().size() )
+  if ( settings_r.userPassword().size() )
   {
-    SET_OPTION(CURLOPT_USERPWD, _settings.userPassword().c_str());
-    string use_auth = _settings.authType();
+    SET_EASY_OPTION(CURLOPT_USERPWD, settings_r.userPassword().c_str());
+    string use_auth = settings_r.authType();
     if (use_auth.empty())
       use_auth = "digest,basic";	// our default
     long auth = CurlAuthData::auth_type_str2long(use_auth);
@@ -806,15 +884,15 @@ void MediaCurl::setupEasy()
     {
       DBG << "Enabling HTTP authentication methods: " << use_auth
 	  << " (CURLOPT_HTTPAUTH=" << auth << ")" << std::endl;
-      SET_OPTION(CURLOPT_HTTPAUTH, auth);
+      SET_EASY_OPTION(CURLOPT_HTTPAUTH, auth);
     }
   }
 
-  if ( _settings.proxyEnabled() && ! _settings.proxy().empty() )
+  if ( settings_r.proxyEnabled() && ! settings_r.proxy().empty() )
   {
-    DBG << "Proxy: '" << _settings.proxy() << "'" << endl;
-    SET_OPTION(CURLOPT_PROXY, _settings.proxy().c_str());
-    SET_OPTION(CURLOPT_PROXYAUTH, CURLAUTH_BASIC|CURLAUTH_DIGEST|CURLAUTH_NTLM );
+    DBG << "Proxy: '" << settings_r.proxy() << "'" << endl;
+    SET_EASY_OPTION(CURLOPT_PROXY, settings_r.proxy().c_str());
+    SET_EASY_OPTION(CURLOPT_PROXYAUTH, CURLAUTH_BASIC|CURLAUTH_DIGEST|CURLAUTH_NTLM );
     /*---------------------------------------------------------------*
      *    CURLOPT_PROXYUSERPWD: [user name]:[password]
      *
@@ -822,7 +900,7 @@ void MediaCurl::setupEasy()
      *  If not provided, $HOME/.curlrc is evaluated
      *---------------------------------------------------------------*/
 
-    string proxyuserpwd = _settings.proxyUserPassword();
+    string proxyuserpwd = settings_r.proxyUserPassword();
 
     if ( proxyuserpwd.empty() )
     {
@@ -838,21 +916,21 @@ void MediaCurl::setupEasy()
     }
     else
     {
-      DBG << "Proxy: using provided proxy-user '" << _settings.proxyUsername() << "'" << endl;
+      DBG << "Proxy: using provided proxy-user '" << settings_r.proxyUsername() << "'" << endl;
     }
 
     if ( ! proxyuserpwd.empty() )
     {
-      SET_OPTION(CURLOPT_PROXYUSERPWD, unEscape( proxyuserpwd ).c_str());
+      SET_EASY_OPTION(CURLOPT_PROXYUSERPWD, unEscape( proxyuserpwd ).c_str());
     }
   }
 #if CURLVERSION_AT_LEAST(7,19,4)
-  else if ( _settings.proxy() == EXPLICITLY_NO_PROXY )
+  else if ( settings_r.proxy() == EXPLICITLY_NO_PROXY )
   {
     // Explicitly disabled in URL (see fillSettingsFromUrl()).
     // This should also prevent libcurl from looking into the environment.
     DBG << "Proxy: explicitly NOPROXY" << endl;
-    SET_OPTION(CURLOPT_NOPROXY, "*");
+    SET_EASY_OPTION(CURLOPT_NOPROXY, "*");
   }
 #endif
   else
@@ -862,33 +940,24 @@ void MediaCurl::setupEasy()
   }
 
   /** Speed limits */
-  if ( _settings.minDownloadSpeed() != 0 )
+  if ( settings_r.minDownloadSpeed() != 0 )
   {
-      SET_OPTION(CURLOPT_LOW_SPEED_LIMIT, _settings.minDownloadSpeed());
+      SET_EASY_OPTION(CURLOPT_LOW_SPEED_LIMIT, settings_r.minDownloadSpeed());
       // default to 10 seconds at low speed
-      SET_OPTION(CURLOPT_LOW_SPEED_TIME, 60L);
+      SET_EASY_OPTION(CURLOPT_LOW_SPEED_TIME, 60L);
   }
 
 #if CURLVERSION_AT_LEAST(7,15,5)
-  if ( _settings.maxDownloadSpeed() != 0 )
-      SET_OPTION_OFFT(CURLOPT_MAX_RECV_SPEED_LARGE, _settings.maxDownloadSpeed());
+  if ( settings_r.maxDownloadSpeed() != 0 )
+      SET_EASY_OPTION_OFFT(CURLOPT_MAX_RECV_SPEED_LARGE, settings_r.maxDownloadSpeed());
 #endif
 
   /*---------------------------------------------------------------*
    *---------------------------------------------------------------*/
 
-  _currentCookieFile = _cookieFile.asString();
-  if ( str::strToBool( _url.getQueryParam( "cookies" ), true ) )
-    SET_OPTION(CURLOPT_COOKIEFILE, _currentCookieFile.c_str() );
-  else
-    MIL << "No cookies requested" << endl;
-  SET_OPTION(CURLOPT_COOKIEJAR, _currentCookieFile.c_str() );
-  SET_OPTION(CURLOPT_PROGRESSFUNCTION, &progressCallback );
-  SET_OPTION(CURLOPT_NOPROGRESS, 0L);
-
 #if CURLVERSION_AT_LEAST(7,18,0)
   // bnc #306272
-    SET_OPTION(CURLOPT_PROXY_TRANSFER_MODE, 1L );
+    SET_EASY_OPTION(CURLOPT_PROXY_TRANSFER_MODE, 1L );
 #endif
   // append settings custom headers to curl
   for ( TransferSettings::Headers::const_iterator it = vol_settings.headersBegin();
@@ -897,14 +966,17 @@ void MediaCurl::setupEasy()
   {
     // MIL << "HEADER " << *it << std::endl;
 
-      _customHeaders = curl_slist_append(_customHeaders, it->c_str());
-      if ( !_customHeaders )
-          ZYPP_THROW(MediaCurlInitException(_url));
+      headers_r = curl_slist_append(headers_r, it->c_str());
+      if ( !headers_r )
+          ZYPP_THROW(MediaCurlInitException(url_r));
   }
 
-  SET_OPTION(CURLOPT_HTTPHEADER, _customHeaders);
+  SET_EASY_OPTION(CURLOPT_HTTPHEADER, headers_r);
 }
 
+#undef SET_EASY_OPTION_OFFT
+#undef SET_EASY_OPTION
+
 ///////////////////////////////////////////////////////////////////
 
 
@@ -952,6 +1024,8 @@ MediaCurl::checkAttachPoint(const Pathname &apoint) const
 
 void MediaCurl::disconnectFrom()
 {
+  _prefetched.clear();
+
   if ( _customHeaders )
   {
     curl_slist_free_all(_customHeaders);
@@ -992,7 +1066,238 @@ void MediaCurl::getFile(const Pathname & filename , const ByteCount &expectedFil
 {
     // Use absolute file name to prevent access of files outside of the
     // hierarchy below the attach point.
-    getFileCopy(filename, localPath(filename).absolutename(), expectedFileSize_r);
+    Pathname dest( localPath(filename).absolutename() );
+
+    // A prefetched file is provided once, later requests check for updates.
+    // Its download was already reported by doPrefetchFiles.
+    auto prefetched( _prefetched.find( filename ) );
+    if ( prefetched != _prefetched.end() )
+    {
+      bool downloaded = prefetched->second;
+      _prefetched.erase( prefetched );
+      PathInfo pi( dest );
+      if ( pi.isFile() )
+      {
+        // same as the size check during a download
+        if ( downloaded && expectedFileSize_r > 0 && expectedFileSize_r < pi.size() )
+        {
+          filesystem::unlink( dest );
+          ZYPP_THROW( MediaFileSizeExceededException( getFileUrl(filename), expectedFileSize_r ) );
+        }
+        DBG << "prefetched: " << pi << ( downloaded ? "" : " (not modified)" ) << endl;
+        return;
+      }
+    }
+
+    getFileCopy(filename, dest, expectedFileSize_r);
+}
+
+///////////////////////////////////////////////////////////////////
+
+void MediaCurl::doPrefetchFiles( const std::vector<OnMediaLocation> & files_r ) const
+{
+#if CURLVERSION_AT_LEAST(7,32,0)
+  long connections = _settings.maxConcurrentConnections();
+  if ( ! _curl || connections < 2 || files_r.size() < 2 )
+    return;
+
+  callback::SendReport<DownloadProgressReport> report;
+
+  // A download into a temp file next to the destination.
+  struct Transfer : private base::NonCopyable
+  {
+    Transfer( const Pathname & filename_r, const Pathname & dest_r, time_t mtime_r )
+    : filename( filename_r ), dest( dest_r ), mtime( mtime_r ), file( nullptr ), curl( nullptr ), started( false )
+    {}
+    ~Transfer()
+    {
+      if ( curl )
+        curl_easy_cleanup( curl );
+      if ( file )
+      {
+        ::fclose( file );
+        filesystem::unlink( tmp );
+      }
+    }
+    Pathname filename;
+    Pathname dest;
+    time_t mtime;	///< of an existing dest, to download it only if modified
+    std::string url;
+    std::string tmp;
+    FILE * file;
+    CURL * curl;
+    Url fileurl;
+    scoped_ptr<ProgressData> progress;
+    bool started;	///< DownloadProgressReport::start was sent
+
+    /** CURLOPT_XFERINFOFUNCTION reporting the start and the progress of the transfer. */
+    static int xferinfo( void * clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow )
+    {
+      Transfer & transfer( *reinterpret_cast<Transfer *>( clientp ) );
+      if ( ! transfer.started )
+      {
+        (*transfer.progress->report)->start( transfer.fileurl, transfer.dest );
+        transfer.started = true;
+      }
+      return progressCallback( transfer.progress.get(), dltotal, dlnow, ultotal, ulnow );
+    }
+
+    void finish( DownloadProgressReport::Error error_r, const std::string & reason_r )
+    {
+      if ( ! started && error_r == DownloadProgressReport::NO_ERROR )
+      {
+        (*progress->report)->start( fileurl, dest );
+        started = true;
+      }
+      if ( started )
+        (*progress->report)->finish( fileurl, error_r, reason_r );
+      started = false;
+    }
+  };
+  std::list<Transfer> transfers;
+
+  for ( const OnMediaLocation & loc : files_r )
+  {
+    // Existing files are downloaded only if modified (IFMODSINCE like getFile)
+    const Pathname & filename( loc.filename() );
+    Pathname dest( localPath(filename).absolutename() );
+    PathInfo pi( dest );
+    if ( _prefetched.count( filename ) || ( pi.isExist() && ! pi.isFile() ) || assert_dir( dest.dirname() ) != 0 )
+      continue;
+
+    transfers.emplace_back( filename, dest, pi.isExist() ? pi.mtime() : 0 );
+    Transfer & transfer( transfers.back() );
+    transfer.fileurl = getFileUrl( filename );
+    transfer.url = clearQueryString( transfer.fileurl ).asString();
+
+    std::string tmp( dest.asString() + ".new.zypp.XXXXXX" );
+    int tmp_fd = ::mkostemp( &tmp[0], O_CLOEXEC );
+    if ( tmp_fd == -1 )
+    {
+      transfers.pop_back();
+      continue;
+    }
+    transfer.tmp = tmp;
+    transfer.file = ::fdopen( tmp_fd, "we" );
+    if ( ! transfer.file )
+    {
+      ::close( tmp_fd );
+      filesystem::unlink( transfer.tmp );
+      transfers.pop_back();
+      continue;
+    }
+
+    // Same settings as _curl, the size and progress are checked like in getFile
+    transfer.curl = curl_easy_duphandle( _curl );
+    if ( ! transfer.curl )
+    {
+      transfers.pop_back();
+      continue;
+    }
+    transfer.progress.reset( new ProgressData( transfer.curl, _settings.timeout(), transfer.fileurl, loc.downloadSize(), &report ) );
+    if ( curl_easy_setopt( transfer.curl, CURLOPT_URL, transfer.url.c_str() ) != CURLE_OK
+      || curl_easy_setopt( transfer.curl, CURLOPT_WRITEDATA, transfer.file ) != CURLE_OK
+      || curl_easy_setopt( transfer.curl, CURLOPT_HTTPHEADER, _customHeaders ) != CURLE_OK
+      || curl_easy_setopt( transfer.curl, CURLOPT_TIMECONDITION, transfer.mtime ? CURL_TIMECOND_IFMODSINCE : CURL_TIMECOND_NONE ) != CURLE_OK
+      || curl_easy_setopt( transfer.curl, CURLOPT_TIMEVALUE, (long)transfer.mtime ) != CURLE_OK
+      || curl_easy_setopt( transfer.curl, CURLOPT_MAXFILESIZE_LARGE, (curl_off_t)loc.downloadSize() ) != CURLE_OK
+      || curl_easy_setopt( transfer.curl, CURLOPT_NOPROGRESS, 0L ) != CURLE_OK
+      || curl_easy_setopt( transfer.curl, CURLOPT_XFERINFOFUNCTION, &Transfer::xferinfo ) != CURLE_OK
+      || curl_easy_setopt( transfer.curl, CURLOPT_XFERINFODATA, &transfer ) != CURLE_OK
+      || curl_easy_setopt( transfer.curl, CURLOPT_LOW_SPEED_LIMIT, 1L ) != CURLE_OK
+      || curl_easy_setopt( transfer.curl, CURLOPT_LOW_SPEED_TIME, _settings.timeout() ) != CURLE_OK
+      || curl_easy_setopt( transfer.curl, CURLOPT_PRIVATE, &transfer ) != CURLE_OK )
+    {
+      transfers.pop_back();
+      continue;
+    }
+  }
+  if ( transfers.size() < 2 )
+    return;	// nothing to gain
+
+  AutoDispose<CURLM*> multi( curl_multi_init(), curl_multi_cleanup );
+  if ( ! multi )
+    return;
+  curl_multi_setopt( multi, CURLMOPT_MAX_HOST_CONNECTIONS, connections );
+  curl_multi_setopt( multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, connections );
+#if CURLVERSION_AT_LEAST(7,43,0)
+  // HTTP/2 transfers to the same host share a connection
+  curl_multi_setopt( multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX );
+#endif
+  // Handles are started in the order they are added.
+  for ( Transfer & transfer : transfers )
+    curl_multi_add_handle( multi, transfer.curl );
+
+  MIL << "Prefetch " << transfers.size() << " files from " << _url << " (" << connections << " connections)" << endl;
+  unsigned done = 0;
+  int running = 0;
+  bool aborted = false;
+  do
+  {
+    if ( curl_multi_perform( multi, &running ) != CURLM_OK )
+      break;
+
+    int left = 0;
+    while ( CURLMsg * msg = curl_multi_info_read( multi, &left ) )
+    {
+      if ( msg->msg != CURLMSG_DONE )
+        continue;
+      char * priv = nullptr;
+      curl_easy_getinfo( msg->easy_handle, CURLINFO_PRIVATE, &priv );
+      Transfer * transfer = reinterpret_cast<Transfer *>( priv );
+      if ( ! transfer )
+        continue;
+
+      if ( msg->data.result != CURLE_OK )
+      {
+        DBG << "prefetch failed: " << transfer->filename << ": " << curl_easy_strerror( msg->data.result ) << endl;
+        if ( msg->data.result == CURLE_ABORTED_BY_CALLBACK && ! transfer->progress->reached && ! transfer->progress->fileSizeExceeded )
+          aborted = true;	// by the user
+        transfer->finish( DownloadProgressReport::ERROR, curl_easy_strerror( msg->data.result ) );
+        continue;	// transfers dtor cleans up, getFile retries
+      }
+      long conditionUnmet = 0;
+      if ( transfer->mtime && curl_easy_getinfo( msg->easy_handle, CURLINFO_CONDITION_UNMET, &conditionUnmet ) == CURLE_OK && conditionUnmet )
+      {
+        long httpReturnCode = 0;
+        transfer->finish( DownloadProgressReport::NO_ERROR, "" );
+        if ( curl_easy_getinfo( msg->easy_handle, CURLINFO_RESPONSE_CODE, &httpReturnCode ) == CURLE_OK && httpReturnCode == 200 )
+          continue;	// server clock ahead (see doGetFileCopyFile), getFile retries
+        _prefetched[transfer->filename] = false;	// not modified, dest is kept
+        ++done;
+        continue;
+      }
+      if ( ::fchmod( ::fileno( transfer->file ), filesystem::applyUmaskTo( 0644 ) ) )
+        ERR << "Failed to chmod file " << transfer->tmp << endl;
+      FILE * file = transfer->file;
+      transfer->file = nullptr;
+      if ( ::fclose( file ) != 0 || rename( transfer->tmp, transfer->dest ) != 0 )
+      {
+        filesystem::unlink( transfer->tmp );
+        transfer->finish( DownloadProgressReport::IO, "" );
+        continue;
+      }
+      transfer->finish( DownloadProgressReport::NO_ERROR, "" );
+      _prefetched[transfer->filename] = true;
+      ++done;
+    }
+
+    if ( aborted )
+    {
+      WAR << "Prefetch aborted by the user" << endl;
+      break;	// getFile will ask again
+    }
+    if ( running && curl_multi_wait( multi, nullptr, 0, 1000, nullptr ) != CURLM_OK )
+      break;
+  } while ( running );
+
+  for ( Transfer & transfer : transfers )
+  {
+    curl_multi_remove_handle( multi, transfer.curl );
+    transfer.finish( DownloadProgressReport::ERROR, _("Download aborted") );	// unfinished ones
+  }
+  MIL << "Prefetched " << done << " of " << transfers.size() << " files from " << _url << endl;
+#endif
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -1507,6 +1812,8 @@ void MediaCurl::doGetFileCopy(const Pathname & filename , const Pathname & targe
         ERR << "Rename failed" << endl;
         ZYPP_THROW(MediaWriteException(dest));
       }
+      // spare the checksum check reading the file again
+      filesystem::rememberChecksum( dest, _writtenChecksum );
     }
     else
     {
@@ -1555,10 +1862,30 @@ void MediaCurl::doGetFileCopyFile(const Pathname & filename , const Pathname & d
       ZYPP_THROW(MediaCurlSetOptException(url, _curlError));
     }
 
-    ret = curl_easy_setopt( _curl, CURLOPT_WRITEDATA, file );
+    // Compute the checksum the file is checked with while it is written.
+    // Range requests do not write the whole file.
+    _writtenChecksum = CheckSum();
+    HashingWriter writer;
+    writer.file = file;
+    bool hashing = ( ! checksumType().empty() && ! (options & OPTION_RANGE) && writer.digest.create( checksumType() ) );
+    if ( hashing )
+    {
+      if ( curl_easy_setopt( _curl, CURLOPT_WRITEFUNCTION, &write_hashing_curl ) != 0 )
+        hashing = false;
+    }
+    ret = curl_easy_setopt( _curl, CURLOPT_WRITEDATA, hashing ? (void *)&writer : (void *)file );
     if ( ret != 0 ) {
+      curl_easy_setopt( _curl, CURLOPT_WRITEFUNCTION, (void *)0 );
       ZYPP_THROW(MediaCurlSetOptException(url, _curlError));
     }
+    // Restore the default writer (fwrite to WRITEDATA) however we leave.
+    AutoDispose<void*> resetWriter( nullptr, [this,hashing,file]( void * ) {
+      if ( hashing )
+      {
+        curl_easy_setopt( _curl, CURLOPT_WRITEFUNCTION, (void *)0 );
+        curl_easy_setopt( _curl, CURLOPT_WRITEDATA, file );
+      }
+    } );
 
     // Set callback and perform.
     ProgressData progressData(_curl, _settings.timeout(), url, expectedFileSize_r, &report);
@@ -1623,6 +1950,9 @@ void MediaCurl::doGetFileCopyFile(const Pathname & filename , const Pathname & d
 	ZYPP_THROW(MediaNotAFileException(_url, filename));
       }
 #endif // DETECT_DIR_INDEX
+
+    if ( hashing )
+      _writtenChecksum = CheckSum( checksumType(), writer.digest.digest() );
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -16,6 +16,10 @@
 #include "zypp/media/TransferSettings.h"
 #include "zypp/media/MediaHandler.h"
 #include "zypp/ZYppCallbacks.h"
+#include "zypp/CheckSum.h"
+
+#include <set>
+#include <map>
 
 #include <curl/curl.h>
 
@@ -49,11 +53,11 @@ class MediaCurl : public MediaHandler
 
   protected:
 
-    Url clearQueryString(const Url &url) const;
-
     virtual void attachTo (bool next = false);
     virtual void releaseFrom( const std::string & ejectDev );
     virtual void getFile( const Pathname & filename, const ByteCount &expectedFileSize_r ) const override;
+    /** Download the files concurrently (up to \ref TransferSettings::maxConcurrentConnections per host). */
+    virtual void doPrefetchFiles( const std::vector<OnMediaLocation> & files_r ) const override;
     virtual void getDir( const Pathname & dirname, bool recurse_r ) const;
     virtual void getDirInfo( std::list<std::string> & retlist,
                              const Pathname & dirname, bool dots = true ) const;
@@ -105,6 +109,35 @@ class MediaCurl : public MediaHandler
 
     static void setCookieFile( const Pathname & );
 
+    /** The \a url without the query parameters evaluated by \ref fillSettings
+     * and without credentials, as passed to curl. */
+    static Url clearQueryString(const Url &url);
+
+    /** Initialize libcurl (once per process; never cleaned up). */
+    static void globalInit();
+
+    /** Fill \a settings_r for transfers from \a url_r like \ref setupEasy does:
+     * timeouts and user agent, \a url_r query parameters and the system proxy.
+     * \throws MediaBadUrlException if a query parameter is invalid
+     */
+    static void fillSettings( const Url & url_r, TransferSettings & settings_r );
+
+    /** Apply \a settings_r to \a curl_r for transfers from \a url_r like
+     * \ref setupEasy does (timeouts, redirects, TLS, credentials, proxy,
+     * speed limits and custom headers). The headers are appended to
+     * \a headers_r, which must be kept (and finally freed) by the caller
+     * as long as \a curl_r uses them.
+     * \throws MediaCurlSetOptException if an option can not be set
+     */
+    static void setupEasyHandle( CURL * curl_r, const Url & url_r, const TransferSettings & settings_r, curl_slist *& headers_r );
+
+    /** The \c CURLOPT_HTTP_VERSION \ref setupEasyHandle uses for \a url_r:
+     * HTTP/2 over TLS if \ref TransferSettings::http2Enabled, else HTTP/1.1.
+     * \c CURL_HTTP_VERSION_NONE (curl's choice) for other schemes or if
+     * libcurl is too old.
+     */
+    static long httpVersion( const Url & url_r, const TransferSettings & settings_r );
+
     class Callbacks
     {
       public:
@@ -171,12 +204,14 @@ class MediaCurl : public MediaHandler
     static Pathname _cookieFile;
 
     mutable std::string _lastRedirect;	///< to log/report redirections
+    mutable std::map<Pathname,bool> _prefetched;	///< files checked by \ref doPrefetchFiles, not yet provided (and whether they were downloaded)
 
   protected:
     CURL *_curl;
     char _curlError[ CURL_ERROR_SIZE ];
     curl_slist *_customHeaders;
     TransferSettings _settings;
+    mutable CheckSum _writtenChecksum;	///< of the file written by the last \ref doGetFileCopyFile (if \ref checksumType was set)
 };
 ZYPP_DECLARE_OPERATORS_FOR_FLAGS(MediaCurl::RequestOptions);
 
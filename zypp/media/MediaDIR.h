@@ -23,6 +23,10 @@ namespace zypp {
 
     /**
      * @short Implementation class for DIR MediaHandler
+     *
+     * Files are provided in place, so there is no download to compute
+     * the checksum on; checking it reads the file once. Copies made by
+     * the default \ref getFileCopy are hashed while copying.
      * @see MediaHandler
      **/
     class MediaDIR : public MediaHandler {
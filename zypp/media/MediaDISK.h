@@ -22,6 +22,10 @@ namespace zypp {
     //	CLASS NAME : MediaDISK
     /**
      * @short Implementation class for DISK MediaHandler
+     *
+     * Files are provided in place, so there is no download to compute
+     * the checksum on; checking it reads the file once. Copies made by
+     * the default \ref getFileCopy are hashed while copying.
      * @see MediaHandler
      **/
     class MediaDISK : public MediaHandler {
@@ -17,6 +17,8 @@
 #include "zypp/ZConfig.h"
 #include "zypp/TmpPath.h"
 #include "zypp/Date.h"
+#include "zypp/Digest.h"
+#include "zypp/CheckSum.h"
 #include "zypp/base/LogTools.h"
 #include "zypp/base/Gettext.h"
 #include "zypp/base/String.h"
@@ -1015,6 +1017,15 @@ void MediaHandler::provideFile(Pathname filename , const ByteCount &expectedFile
   DBG << "provideFile(" << filename << ")" << endl;
 }
 
+void MediaHandler::prefetchFiles( const std::vector<OnMediaLocation> & files_r ) const
+{
+  if ( !isAttached() || files_r.empty() )
+    return;
+
+  doPrefetchFiles( files_r ); // pass to concrete handler
+  DBG << "prefetchFiles(" << files_r.size() << " files)" << endl;
+}
+
 
 ///////////////////////////////////////////////////////////////////
 //
@@ -1246,10 +1257,46 @@ void MediaHandler::getFile(const Pathname & filename , const ByteCount &) const
 }
 
 
+namespace
+{
+  /** Copy \a file_r to \a dest_r computing its \a type_r checksum on the fly (empty on error). */
+  CheckSum hashingCopy( const Pathname & file_r, const Pathname & dest_r, const std::string & type_r )
+  {
+    Digest digest;
+    if ( ! digest.create( type_r ) )
+      return CheckSum();
+    std::ifstream in( file_r.c_str(), std::ios::binary );
+    std::ofstream out( dest_r.c_str(), std::ios::binary | std::ios::trunc );
+    char buf[65536];
+    while ( in && out )
+    {
+      in.read( buf, sizeof(buf) );
+      digest.update( buf, in.gcount() );
+      out.write( buf, in.gcount() );
+    }
+    if ( ! in.eof() || ! out.flush() )
+      return CheckSum();
+    return CheckSum( type_r, digest.digest() );
+  }
+}
+
 void MediaHandler::getFileCopy (const Pathname & srcFilename, const Pathname & targetFilename , const ByteCount &expectedFileSize_r) const
 {
   getFile(srcFilename, expectedFileSize_r);
 
+  // Compute the checksum the file is checked with while it is copied.
+  if ( ! checksumType().empty() )
+  {
+    CheckSum written( hashingCopy( localPath( srcFilename ), targetFilename, checksumType() ) );
+    if ( ! written.empty() )
+    {
+      // spare the checksum check reading the file again
+      filesystem::rememberChecksum( targetFilename, written );
+      return;
+    }
+    WAR << "Hashing copy failed, copying " << localPath( srcFilename ) << endl;
+  }
+
   if ( copy( localPath( srcFilename ), targetFilename ) != 0 ) {
     ZYPP_THROW(MediaWriteException(targetFilename));
   }
@@ -1407,6 +1454,15 @@ Pathname MediaHandler::deltafile() const {
   return _deltafile;
 }
 
+void MediaHandler::setChecksumType( const std::string & type_r ) const
+{
+  _checksumType = type_r;
+}
+
+std::string MediaHandler::checksumType() const {
+  return _checksumType;
+}
+
   } // namespace media
 } // namespace zypp
 // vim: set ts=8 sts=2 sw=2 ai noet:
@@ -16,12 +16,14 @@
 #include <iosfwd>
 #include <string>
 #include <list>
+#include <vector>
 
 #include "zypp/Pathname.h"
 #include "zypp/PathInfo.h"
 #include "zypp/base/PtrTypes.h"
 
 #include "zypp/Url.h"
+#include "zypp/OnMediaLocation.h"
 
 #include "zypp/media/MediaSource.h"
 #include "zypp/media/MediaException.h"
@@ -103,6 +105,9 @@ class MediaHandler {
 	/** file usable for delta downloads */
 	mutable Pathname _deltafile;
 
+	/** checksum type expected for the next download */
+	mutable std::string _checksumType;
+
     protected:
         /**
 	 * Url to handle
@@ -360,13 +365,29 @@ class MediaHandler {
 	 **/
 	virtual void getFile( const Pathname & filename, const ByteCount &expectedFileSize_r ) const;
 
+	/**
+	 * Call concrete handler to transfer files ahead, which are
+	 * about to be provided (in this order).
+	 *
+	 * Default implementation does nothing. Handlers downloading
+	 * files may transfer them concurrently, so the following
+	 * \ref getFile calls find them below the attach point.
+	 *
+	 * Asserted that media is attached. Must not throw; any error
+	 * is left to the following \ref getFile.
+	 **/
+	virtual void doPrefetchFiles( const std::vector<OnMediaLocation> & files_r ) const
+	{}
+
         /**
          * Call concrete handler to provide a file under a different place
          * in the file system (usually not under attach point) as a copy.
          * Media must be attached before by callee.
          *
          * Default implementation provided that calls getFile(srcFilename)
-         * and copies the result around.
+         * and copies the result around. If a \ref checksumType is set, the
+         * checksum is computed while copying and remembered for the copy
+         * (\ref filesystem::rememberChecksum).
 	 *
 	 * \throws MediaException
 	 *
@@ -586,6 +607,13 @@ class MediaHandler {
 	 **/
         void provideFileCopy( Pathname srcFilename, Pathname targetFilename, const ByteCount &expectedFileSize_r ) const;
 
+	/**
+	 * Hint that the files \a files_r will be provided next.
+	 * The handler may transfer them ahead (\see \ref doPrefetchFiles).
+	 * Does nothing if the media is not attached.
+	 **/
+	void prefetchFiles( const std::vector<OnMediaLocation> & files_r ) const;
+
 	/**
 	 * Use concrete handler to provide directory denoted
 	 * by path below 'localRoot' (not recursive!).
@@ -650,6 +678,17 @@ class MediaHandler {
 	 */
 	Pathname deltafile () const;
 
+	/*
+	 * set the checksum type the next downloaded file is checked with,
+	 * so it can be computed while downloading
+	 */
+	void setChecksumType( const std::string & type_r = std::string() ) const;
+
+	/*
+	 * return the checksum type set with setChecksumType()
+	 */
+	std::string checksumType() const;
+
     public:
 
 	/**
@@ -712,6 +712,34 @@ namespace zypp
       ref.handler->setDeltafile(filename);
     }
 
+    // ---------------------------------------------------------------
+    void
+    MediaManager::setChecksumType(MediaAccessId      accessId,
+                                  const std::string &type_r ) const
+    {
+      MutexLock glock(g_Mutex);
+
+      ManagedMedia &ref( m_impl->findMM(accessId));
+
+      ref.checkDesired(accessId);
+
+      ref.handler->setChecksumType(type_r);
+    }
+
+    // ---------------------------------------------------------------
+    void
+    MediaManager::prefetchFiles(MediaAccessId   accessId,
+                                const std::vector<OnMediaLocation> & files ) const
+    {
+      MutexLock glock(g_Mutex);
+
+      ManagedMedia &ref( m_impl->findMM(accessId));
+
+      ref.checkDesired(accessId);
+
+      ref.handler->prefetchFiles(files);
+    }
+
     // ---------------------------------------------------------------
     void
     MediaManager::provideDir(MediaAccessId   accessId,
@@ -846,6 +846,26 @@ namespace zypp
       setDeltafile(MediaAccessId   accessId,
                   const Pathname &filename ) const;
 
+      /**
+       * Set the checksum type the next file provided is checked with.
+       * Handlers downloading files may compute it while downloading.
+       */
+      void
+      setChecksumType(MediaAccessId      accessId,
+                      const std::string &type_r ) const;
+
+      /**
+       * Hint that the files \a files will be provided next.
+       * Handlers downloading files may transfer them ahead.
+       *
+       * \param accessId  The media access id to use.
+       * \param files     The files to prefetch (in the order they are provided).
+       *                  Their download size is the expected file size.
+       */
+      void
+      prefetchFiles(MediaAccessId   accessId,
+                    const std::vector<OnMediaLocation> & files ) const;
+
     public:
       /**
        * Get the modification time of the /etc/mtab file.
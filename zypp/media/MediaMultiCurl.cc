@@ -12,8 +12,7 @@
 
 #include <ctype.h>
 #include <sys/types.h>
-#include <signal.h>
-#include <sys/wait.h>
+#include <sys/epoll.h>
 #include <netdb.h>
 #include <arpa/inet.h>
 
@@ -24,6 +23,8 @@
 
 #include "zypp/ZConfig.h"
 #include "zypp/base/Logger.h"
+#include "zypp/base/LogTools.h"
+#include "zypp/AutoDispose.h"
 #include "zypp/media/MediaMultiCurl.h"
 #include "zypp/media/MetaLinkParser.h"
 
@@ -58,8 +59,9 @@ public:
   void disableCompetition();
 
   void checkdns();
-  void adddnsfd(fd_set &rset, int &maxfd);
-  void dnsevent(fd_set &rset);
+  void adddnsfd(int epollfd);
+  void dnsevent(int fd);
+  void dnstimeout(double now);
 
   int _workerno;
 
@@ -76,12 +78,16 @@ public:
   off_t  _received;
 
   double _avgspeed;
+  double _avglatency;
   double _maxspeed;
 
   double _sleepuntil;
 
 private:
   void stealjob();
+  void stopdns();
+  size_t blocksize() const;
+  double remainingtime() const;
 
   size_t writefunction(void *ptr, size_t size);
   static size_t _writefunction(void *ptr, size_t size, size_t nmemb, void *stream);
@@ -95,9 +101,10 @@ private:
   off_t _off;
   size_t _size;
   Digest _dig;
+  bool _abandoned;
 
-  pid_t _pid;
-  int _dnspipe;
+  AutoDispose<int> _dnsfd;	// eventfd receiving the DNS check result
+  double _dnsstarttime;
 };
 
 #define WORKER_STARTING 0
@@ -108,6 +115,8 @@ private:
 #define WORKER_SLEEP    5
 #define WORKER_BROKEN   6
 
+#define DNSOK_TTL	600	// seconds a successful DNS check is remembered
+
 
 
 class multifetchrequest {
@@ -117,6 +126,8 @@ public:
 
   void run(std::vector<Url> &urllist);
 
+  static int _timerfunction(CURLM *multi, long timeout_ms, void *userp);
+
 protected:
   friend class multifetchworker;
 
@@ -133,7 +144,7 @@ protected:
 
   std::list<multifetchworker *> _workers;
   bool _stealing;
-  bool _havenewjob;
+  double _curltimeout;	// when curl wants to be called again (-1: on socket activity only)
 
   size_t _blkno;
   off_t _blkoff;
@@ -158,14 +169,38 @@ public:
   double _connect_timeout;
   double _maxspeed;
   int _maxworkers;
+  size_t _maxurls;
 };
 
 #define BLKSIZE		131072
-#define MAXURLS		10
+#define MAXBLKSIZE	(16*1024*1024)
+#define BLKTIME		.5	// block fetch time aimed at (seconds)
 
 
 //////////////////////////////////////////////////////////////////////
 
+// curl socket callback: watch the sockets curl is interested in
+static int
+multi_socketfunction(CURL *easy, curl_socket_t s, int what, void *userp, void *socketp)
+{
+  int epollfd = *reinterpret_cast<int *>(userp);
+  if (what == CURL_POLL_REMOVE)
+    {
+      epoll_ctl(epollfd, EPOLL_CTL_DEL, s, NULL);
+      return 0;
+    }
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  if (what & CURL_POLL_IN)
+    ev.events |= EPOLLIN;
+  if (what & CURL_POLL_OUT)
+    ev.events |= EPOLLOUT;
+  ev.data.fd = s;
+  if (epoll_ctl(epollfd, EPOLL_CTL_MOD, s, &ev) == -1 && errno == ENOENT)
+    epoll_ctl(epollfd, EPOLL_CTL_ADD, s, &ev);
+  return 0;
+}
+
 static double
 currentTime()
 {
@@ -214,6 +249,12 @@ multifetchworker::writefunction(void *ptr, size_t size)
   if (_state == WORKER_DISCARD || !_request->_fp)
     {
       // block is no longer needed
+      if (_state == WORKER_DISCARD && _size - len > BLKSIZE && (!_request->_blklist || !_request->_blklist->haveChecksum(_blkno)))
+	{
+	  // nothing to verify, so don't waste the bandwidth on the rest of a large block
+	  _abandoned = true;
+	  return size ? 0 : 1;
+	}
       // still calculate the checksum so that we can throw out bad servers
       if (_request->_blklist)
         _dig.update((const char *)ptr, len);
@@ -306,13 +347,15 @@ multifetchworker::multifetchworker(int no, multifetchrequest &request, const Url
   _size = _blksize = 0;
   _pass = 0;
   _blkno = 0;
-  _pid = 0;
-  _dnspipe = -1;
+  _dnsfd = AutoDispose<int>(-1);
+  _dnsstarttime = 0;
   _blkreceived = 0;
   _received = 0;
   _blkstarttime = 0;
   _avgspeed = 0;
+  _avglatency = 0;
   _sleepuntil = 0;
+  _abandoned = false;
   _maxspeed = _request->_maxspeed;
   _noendrange = false;
 
@@ -396,20 +439,8 @@ multifetchworker::~multifetchworker()
         curl_easy_cleanup(_curl);
       _curl = 0;
     }
-  if (_pid)
-    {
-      kill(_pid, SIGKILL);
-      int status;
-      while (waitpid(_pid, &status, 0) == -1)
-        if (errno != EINTR)
-	  break;
-      _pid = 0;
-    }
-  if (_dnspipe != -1)
-    {
-      close(_dnspipe);
-      _dnspipe = -1;
-    }
+  // a pending DNS check keeps its eventfd open
+  stopdns();
   // the destructor in MediaCurl doesn't call disconnect() if
   // the media is not attached, so we do it here manually
   disconnectFrom();
@@ -454,89 +485,63 @@ multifetchworker::checkdns()
 	return;
     }
 
+  // no need to do dns checking if curl resolves asynchronously, as a
+  // failing lookup does not block the other transfers then
+  if (curl_version_info(CURLVERSION_NOW)->features & CURL_VERSION_ASYNCHDNS)
+    return;
+
   XXX << "checking DNS lookup of " << host << endl;
-  int pipefds[2];
-  if (pipe(pipefds))
+  // The result is posted to an eventfd watched by the request.
+  AutoDispose<int> dnsfd( _request->_context->_dnscheck.check(host) );
+  if (dnsfd == -1)
     {
       _state = WORKER_BROKEN;
-      strncpy(_curlError, "DNS pipe creation failed", CURL_ERROR_SIZE);
+      strncpy(_curlError, "DNS check failed to start", CURL_ERROR_SIZE);
       return;
     }
-  _pid = fork();
-  if (_pid == pid_t(-1))
-    {
-      close(pipefds[0]);
-      close(pipefds[1]);
-      _pid = 0;
-      _state = WORKER_BROKEN;
-      strncpy(_curlError, "DNS checker fork failed", CURL_ERROR_SIZE);
-      return;
-    }
-  else if (_pid == 0)
-    {
-      close(pipefds[0]);
-      // XXX: close all other file descriptors
-      struct addrinfo *ai, aihints;
-      memset(&aihints, 0, sizeof(aihints));
-      aihints.ai_family = PF_UNSPEC;
-      int tstsock = socket(PF_INET6, SOCK_DGRAM | SOCK_CLOEXEC, 0);
-      if (tstsock == -1)
-	aihints.ai_family = PF_INET;
-      else
-	close(tstsock);
-      aihints.ai_socktype = SOCK_STREAM;
-      aihints.ai_flags = AI_CANONNAME;
-      unsigned int connecttimeout = _request->_connect_timeout;
-      if (connecttimeout)
-	alarm(connecttimeout);
-      signal(SIGALRM, SIG_DFL);
-      if (getaddrinfo(host.c_str(), NULL, &aihints, &ai))
-        _exit(1);
-      _exit(0);
-    }
-  close(pipefds[1]);
-  _dnspipe = pipefds[0];
+  _dnsfd = dnsfd;
+  _dnsstarttime = currentTime();
   _state = WORKER_LOOKUP;
 }
 
 void
-multifetchworker::adddnsfd(fd_set &rset, int &maxfd)
+multifetchworker::adddnsfd(int epollfd)
 {
   if (_state != WORKER_LOOKUP)
     return;
-  FD_SET(_dnspipe, &rset);
-  if (maxfd < _dnspipe)
-    maxfd = _dnspipe;
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.fd = _dnsfd;
+  if (epoll_ctl(epollfd, EPOLL_CTL_ADD, _dnsfd, &ev))
+    {
+      _dnsfd = AutoDispose<int>(-1);
+      _state = WORKER_BROKEN;
+      strncpy(_curlError, "DNS eventfd registration failed", CURL_ERROR_SIZE);
+      _request->_activeworkers--;
+    }
 }
 
 void
-multifetchworker::dnsevent(fd_set &rset)
+multifetchworker::stopdns()
 {
+  if (_dnsfd == -1)
+    return;
+  epoll_ctl(_request->_context->_epollfd, EPOLL_CTL_DEL, _dnsfd, NULL);
+  _dnsfd = AutoDispose<int>(-1);
+}
 
-  if (_state != WORKER_LOOKUP || !FD_ISSET(_dnspipe, &rset))
+void
+multifetchworker::dnsevent(int fd)
+{
+  if (_state != WORKER_LOOKUP || fd != _dnsfd)
     return;
-  int status;
-  while (waitpid(_pid, &status, 0) == -1)
-    {
-      if (errno != EINTR)
-        return;
-    }
-  _pid = 0;
-  if (_dnspipe != -1)
-    {
-      close(_dnspipe);
-      _dnspipe = -1;
-    }
-  if (!WIFEXITED(status))
-    {
-      _state = WORKER_BROKEN;
-      strncpy(_curlError, "DNS lookup failed", CURL_ERROR_SIZE);
-      _request->_activeworkers--;
-      return;
-    }
-  int exitcode = WEXITSTATUS(status);
-  XXX << "#" << _workerno << ": DNS lookup returned " << exitcode << endl;
-  if (exitcode != 0)
+  uint64_t result = 0;
+  if (read(_dnsfd, &result, sizeof(result)) != sizeof(result))
+    return;	// not yet
+  stopdns();
+  XXX << "#" << _workerno << ": DNS lookup returned " << result << endl;
+  if (result != DnsCheckPool::DNS_OK)
     {
       _state = WORKER_BROKEN;
       strncpy(_curlError, "DNS lookup failed", CURL_ERROR_SIZE);
@@ -547,6 +552,18 @@ multifetchworker::dnsevent(fd_set &rset)
   nextjob();
 }
 
+void
+multifetchworker::dnstimeout(double now)
+{
+  if (_state != WORKER_LOOKUP || !_request->_connect_timeout || now < _dnsstarttime + _request->_connect_timeout)
+    return;
+  stopdns();
+  XXX << "#" << _workerno << ": DNS lookup timed out" << endl;
+  _state = WORKER_BROKEN;
+  strncpy(_curlError, "DNS lookup failed", CURL_ERROR_SIZE);
+  _request->_activeworkers--;
+}
+
 bool
 multifetchworker::checkChecksum()
 {
@@ -616,12 +633,12 @@ multifetchworker::stealjob()
       // if it is the same block, we want to know the best worker, otherwise the worst
       if (worker->_blkstart == best->_blkstart)
 	{
-	  if ((worker->_blksize - worker->_blkreceived) * best->_avgspeed < (best->_blksize - best->_blkreceived) * worker->_avgspeed)
+	  if (worker->remainingtime() < best->remainingtime())
 	    best = worker;
 	}
       else
 	{
-	  if ((worker->_blksize - worker->_blkreceived) * best->_avgspeed > (best->_blksize - best->_blkreceived) * worker->_avgspeed)
+	  if (worker->remainingtime() > best->remainingtime())
 	    best = worker;
 	}
     }
@@ -643,15 +660,16 @@ multifetchworker::stealjob()
 	    _avgspeed = _blkreceived / (now - _blkstarttime);
 	}
 
-      // lets see if we should sleep a bit
-      XXX << "me #" << _workerno << ": " << _avgspeed << ", size " << best->_blksize << endl;
+      // lets see if we should sleep a bit: no use in stealing a block
+      // the other worker finishes before we could fetch it
+      XXX << "me #" << _workerno << ": " << _avgspeed << ", latency " << _avglatency << ", size " << best->_blksize << endl;
       XXX << "best #" << best->_workerno << ": " << best->_avgspeed << ", size " << (best->_blksize - best->_blkreceived) << endl;
       if (_avgspeed && best->_avgspeed && best->_blksize - best->_blkreceived > 0 &&
-          (best->_blksize - best->_blkreceived) * _avgspeed < best->_blksize * best->_avgspeed)
+          best->remainingtime() < _avglatency + best->_blksize / _avgspeed)
 	{
 	  if (!now)
 	    now = currentTime();
-	  double sl = (best->_blksize - best->_blkreceived) / best->_avgspeed * 2;
+	  double sl = best->remainingtime() * 2;
 	  if (sl > 1)
 	    sl = 1;
 	  XXX << "#" << _workerno << ": going to sleep for " << sl * 1000 << " ms" << endl;
@@ -691,6 +709,24 @@ multifetchworker::disableCompetition()
 }
 
 
+size_t
+multifetchworker::blocksize() const
+{
+  off_t left = off_t(-1);
+  if (_request->_filesize != off_t(-1))
+    left = _request->_filesize > _request->_blkoff ? _request->_filesize - _request->_blkoff : 0;
+  return MediaMultiCurl::blockSize(_avgspeed, left, _request->_activeworkers);
+}
+
+double
+multifetchworker::remainingtime() const
+{
+  // time this worker needs to finish its block
+  if (!_avgspeed)
+    return _blkreceived < _blksize ? 1e9 : 0;
+  return (_blksize - _blkreceived) / _avgspeed;
+}
+
 void
 multifetchworker::nextjob()
 {
@@ -702,9 +738,10 @@ multifetchworker::nextjob()
     }
 
   MediaBlockList *blklist = _request->_blklist;
+  size_t maxblksize = blocksize();
   if (!blklist)
     {
-      _blksize = BLKSIZE;
+      _blksize = maxblksize;
       if (_request->_filesize != off_t(-1))
 	{
 	  if (_request->_blkoff >= _request->_filesize)
@@ -713,8 +750,8 @@ multifetchworker::nextjob()
 	      return;
 	    }
 	  _blksize = _request->_filesize - _request->_blkoff;
-	  if (_blksize > BLKSIZE)
-	    _blksize = BLKSIZE;
+	  if (_blksize > maxblksize)
+	    _blksize = maxblksize;
 	}
     }
   else
@@ -731,8 +768,8 @@ multifetchworker::nextjob()
 	  _request->_blkoff = blk.off;
 	}
       _blksize = blk.off + blk.size - _request->_blkoff;
-      if (_blksize > BLKSIZE && !blklist->haveChecksum(_request->_blkno))
-	_blksize = BLKSIZE;
+      if (_blksize > maxblksize && !blklist->haveChecksum(_request->_blkno))
+	_blksize = maxblksize;
     }
   _blkno = _request->_blkno;
   _blkstart = _request->_blkoff;
@@ -766,9 +803,9 @@ multifetchworker::run()
       strncpy(_curlError, "curl_multi_add_handle failed", CURL_ERROR_SIZE);
       return;
     }
-  _request->_havenewjob = true;
   _off = _blkstart;
   _size = _blksize;
+  _abandoned = false;
   if (_request->_blklist)
     _request->_blklist->createDigest(_dig);	// resets digest
   _state = WORKER_FETCH;
@@ -790,7 +827,7 @@ multifetchrequest::multifetchrequest(const MediaMultiCurl *context, const Pathna
   _filesize = filesize;
   _multi = multi;
   _stealing = false;
-  _havenewjob = false;
+  _curltimeout = -1;
   _blkno = 0;
   if (_blklist)
     _blkoff = _blklist->getBlock(0).off;
@@ -811,6 +848,8 @@ multifetchrequest::multifetchrequest(const MediaMultiCurl *context, const Pathna
   _connect_timeout = 0;
   _maxspeed = 0;
   _maxworkers = 0;
+  _maxurls = 0;
+  curl_multi_setopt(_multi, CURLMOPT_TIMERDATA, this);
   if (blklist)
     {
       for (size_t blkno = 0; blkno < blklist->numBlocks(); blkno++)
@@ -832,6 +871,16 @@ multifetchrequest::~multifetchrequest()
       delete worker;
     }
   _workers.clear();
+  curl_multi_setopt(_multi, CURLMOPT_TIMERDATA, (void *)0);
+}
+
+int
+multifetchrequest::_timerfunction(CURLM *multi, long timeout_ms, void *userp)
+{
+  multifetchrequest *me = reinterpret_cast<multifetchrequest *>(userp);
+  if (me)
+    me->_curltimeout = timeout_ms < 0 ? -1 : currentTime() + timeout_ms / 1000.;
+  return 0;
 }
 
 void
@@ -839,10 +888,10 @@ multifetchrequest::run(std::vector<Url> &urllist)
 {
   int workerno = 0;
   std::vector<Url>::iterator urliter = urllist.begin();
+  struct epoll_event events[16];
   for (;;)
     {
-      fd_set rset, wset, xset;
-      int maxfd, nqueue;
+      int nqueue;
 
       if (_finished)
 	{
@@ -850,7 +899,7 @@ multifetchrequest::run(std::vector<Url> &urllist)
 	  break;
 	}
 
-      if ((int)_activeworkers < _maxworkers && urliter != urllist.end() && _workers.size() < MAXURLS)
+      if ((int)_activeworkers < _maxworkers && urliter != urllist.end() && _workers.size() < _maxurls)
 	{
 	  // spawn another worker!
 	  multifetchworker *worker = new multifetchworker(workerno++, *this, *urliter);
@@ -863,7 +912,11 @@ multifetchrequest::run(std::vector<Url> &urllist)
 		  worker->nextjob();
 		}
 	      else
-	        _lookupworkers++;
+		{
+		  worker->adddnsfd(_context->_epollfd);
+		  if (worker->_state == WORKER_LOOKUP)
+		    _lookupworkers++;
+		}
 	    }
 	  ++urliter;
 	  continue;
@@ -881,22 +934,14 @@ multifetchrequest::run(std::vector<Url> &urllist)
 	  break;
 	}
 
-      FD_ZERO(&rset);
-      FD_ZERO(&wset);
-      FD_ZERO(&xset);
-
-      curl_multi_fdset(_multi, &rset, &wset, &xset, &maxfd);
-
-      if (_lookupworkers)
-        for (std::list<multifetchworker *>::iterator workeriter = _workers.begin(); workeriter != _workers.end(); ++workeriter)
-	  (*workeriter)->adddnsfd(rset, maxfd);
-
-      timeval tv;
-      // if we added a new job we have to call multi_perform once
-      // to make it show up in the fd set. do not sleep in this case.
-      tv.tv_sec = 0;
-      tv.tv_usec = _havenewjob ? 0 : 200000;
-      if (_sleepworkers && !_havenewjob)
+      // Wait for socket activity, curls next timeout or the next sleeping
+      // worker to wake up. Wake up at least every .5 seconds to report
+      // progress and check the transfer timeout.
+      double now = currentTime();
+      double waituntil = now + .5;
+      if (_curltimeout >= 0 && _curltimeout < waituntil)
+	waituntil = _curltimeout;
+      if (_sleepworkers)
 	{
 	  if (_minsleepuntil == 0)
 	    {
@@ -909,44 +954,66 @@ multifetchrequest::run(std::vector<Url> &urllist)
 		    _minsleepuntil = worker->_sleepuntil;
 		}
 	    }
-	  double sl = _minsleepuntil - currentTime();
-	  if (sl < 0)
-	    {
-	      sl = 0;
-	      _minsleepuntil = 0;
-	    }
-	  if (sl < .2)
-	    tv.tv_usec = sl * 1000000;
+	  if (_minsleepuntil < waituntil)
+	    waituntil = _minsleepuntil;
 	}
-      int r = select(maxfd + 1, &rset, &wset, &xset, &tv);
+      int timeout = waituntil > now ? int((waituntil - now) * 1000) + 1 : 0;
+      int r = epoll_wait(_context->_epollfd, events, sizeof(events) / sizeof(*events), timeout);
       if (r == -1 && errno != EINTR)
-	ZYPP_THROW(MediaCurlException(_baseurl, "select() failed", "unknown error"));
-      if (r != 0 && _lookupworkers)
-	for (std::list<multifetchworker *>::iterator workeriter = _workers.begin(); workeriter != _workers.end(); ++workeriter)
-	  {
-	    multifetchworker *worker = *workeriter;
-	    if (worker->_state != WORKER_LOOKUP)
-	      continue;
-	    (*workeriter)->dnsevent(rset);
-	    if (worker->_state != WORKER_LOOKUP)
-	      _lookupworkers--;
-	  }
-      _havenewjob = false;
+	ZYPP_THROW(MediaCurlException(_baseurl, "epoll_wait() failed", "unknown error"));
 
       // run curl
-      for (;;)
-        {
-          CURLMcode mcode;
-	  int tasks;
-          mcode = curl_multi_perform(_multi, &tasks);
-          if (mcode == CURLM_CALL_MULTI_PERFORM)
-            continue;
-	  if (mcode != CURLM_OK)
-	    ZYPP_THROW(MediaCurlException(_baseurl, "curl_multi_perform", "unknown error"));
-	  break;
-        }
+      int running = 0;
+      for (int i = 0; i < r; i++)
+	{
+	  int fd = events[i].data.fd;
+	  if (_lookupworkers)
+	    {
+	      bool dnsevent = false;
+	      for (std::list<multifetchworker *>::iterator workeriter = _workers.begin(); workeriter != _workers.end(); ++workeriter)
+		{
+		  multifetchworker *worker = *workeriter;
+		  if (worker->_state != WORKER_LOOKUP || worker->_dnsfd != fd)
+		    continue;
+		  dnsevent = true;
+		  worker->dnsevent(fd);
+		  if (worker->_state != WORKER_LOOKUP)
+		    _lookupworkers--;
+		}
+	      if (dnsevent)
+		continue;
+	    }
+	  int action = 0;
+	  if (events[i].events & EPOLLIN)
+	    action |= CURL_CSELECT_IN;
+	  if (events[i].events & EPOLLOUT)
+	    action |= CURL_CSELECT_OUT;
+	  if (events[i].events & (EPOLLERR|EPOLLHUP))
+	    action |= CURL_CSELECT_ERR;
+	  if (curl_multi_socket_action(_multi, fd, action, &running) != CURLM_OK)
+	    ZYPP_THROW(MediaCurlException(_baseurl, "curl_multi_socket_action", "unknown error"));
+	}
+      if (_lookupworkers)
+	{
+	  now = currentTime();
+	  for (std::list<multifetchworker *>::iterator workeriter = _workers.begin(); workeriter != _workers.end(); ++workeriter)
+	    {
+	      multifetchworker *worker = *workeriter;
+	      if (worker->_state != WORKER_LOOKUP)
+		continue;
+	      worker->dnstimeout(now);
+	      if (worker->_state != WORKER_LOOKUP)
+		_lookupworkers--;
+	    }
+	}
+      if (_curltimeout >= 0 && currentTime() >= _curltimeout)
+	{
+	  _curltimeout = -1;
+	  if (curl_multi_socket_action(_multi, CURL_SOCKET_TIMEOUT, 0, &running) != CURLM_OK)
+	    ZYPP_THROW(MediaCurlException(_baseurl, "curl_multi_socket_action", "unknown error"));
+	}
 
-      double now = currentTime();
+      now = currentTime();
 
       // update periodavg
       if (now > _lastperiodstart + .5)
@@ -996,8 +1063,17 @@ multifetchrequest::run(std::vector<Url> &urllist)
 	      else
 		worker->_avgspeed = worker->_blkreceived / (now - worker->_blkstarttime);
 	    }
-	  XXX << "#" << worker->_workerno << ": BLK " << worker->_blkno << " done code " << cc << " speed " << worker->_avgspeed << endl;
+	  double latency = 0;
+	  if (cc == 0 && curl_easy_getinfo(easy, CURLINFO_STARTTRANSFER_TIME, &latency) == CURLE_OK && latency > 0)
+	    worker->_avglatency = worker->_avglatency ? (worker->_avglatency + latency) / 2 : latency;
+	  XXX << "#" << worker->_workerno << ": BLK " << worker->_blkno << " done code " << cc << " speed " << worker->_avgspeed << " latency " << worker->_avglatency << endl;
 	  curl_multi_remove_handle(_multi, easy);
+	  if (cc == CURLE_WRITE_ERROR && worker->_abandoned)
+	    {
+	      XXX << "#" << worker->_workerno << ": abandoned discarded block" << endl;
+	      worker->nextjob();
+	      continue;
+	    }
 	  if (cc == CURLE_HTTP_RETURNED_ERROR)
 	    {
 	      long statuscode = 0;
@@ -1113,7 +1189,7 @@ multifetchrequest::run(std::vector<Url> &urllist)
 	    {
 	      worker->_state = WORKER_BROKEN;
 	      _activeworkers--;
-	      if (!_activeworkers && !(urliter != urllist.end() && _workers.size() < MAXURLS))
+	      if (!_activeworkers && !(urliter != urllist.end() && _workers.size() < _maxurls))
 		{
 		  // end of workers reached! goodbye!
 		  worker->evaluateCurlCode(Pathname(), cc, false);
@@ -1149,7 +1225,7 @@ multifetchrequest::run(std::vector<Url> &urllist)
   for (std::list<multifetchworker *>::iterator workeriter = _workers.begin(); workeriter != _workers.end(); ++workeriter)
     {
       multifetchworker *worker = *workeriter;
-      WAR << "#" << worker->_workerno << ": state: " << worker->_state << " received: " << worker->_received << " url: " << worker->_url << endl;
+      WAR << "#" << worker->_workerno << ": state: " << worker->_state << " received: " << worker->_received << " speed: " << worker->_avgspeed << " latency: " << worker->_avglatency << " url: " << worker->_url << endl;
     }
 }
 
@@ -1162,6 +1238,7 @@ MediaMultiCurl::MediaMultiCurl(const Url &url_r, const Pathname & attach_point_h
 {
   MIL << "MediaMultiCurl::MediaMultiCurl(" << url_r << ", " << attach_point_hint_r << ")" << endl;
   _multi = 0;
+  _epollfd = -1;
   _customHeadersMetalink = 0;
 }
 
@@ -1177,6 +1254,11 @@ MediaMultiCurl::~MediaMultiCurl()
       curl_multi_cleanup(_multi);
       _multi = 0;
     }
+  if (_epollfd != -1)
+    {
+      close(_epollfd);
+      _epollfd = -1;
+    }
   std::map<std::string, CURL *>::iterator it;
   for (it = _easypool.begin(); it != _easypool.end(); it++)
     {
@@ -1418,26 +1500,25 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
 	  file = fopen(destNew.c_str(), "w+e");
 	  if (!file)
 	    ZYPP_THROW(MediaWriteException(destNew));
+	  // scan all seed files at once, earlier files win
+	  vector<string> seeds;
 	  if (PathInfo(target).isExist())
-	    {
-	      XXX << "reusing blocks from file " << target << endl;
-	      bl.reuseBlocks(file, target.asString());
-	      XXX << bl << endl;
-	    }
-	  if (bl.haveChecksum(1) && PathInfo(failedFile).isExist())
-	    {
-	      XXX << "reusing blocks from file " << failedFile << endl;
-	      bl.reuseBlocks(file, failedFile.asString());
-	      XXX << bl << endl;
-	      filesystem::unlink(failedFile);
-	    }
+	    seeds.push_back(target.asString());
+	  bool failedSeed = bl.haveChecksum(1) && PathInfo(failedFile).isExist();
+	  if (failedSeed)
+	    seeds.push_back(failedFile.asString());
 	  Pathname df = deltafile();
 	  if (!df.empty())
+	    seeds.push_back(df.asString());
+	  if (!seeds.empty())
 	    {
-	      XXX << "reusing blocks from file " << df << endl;
-	      bl.reuseBlocks(file, df.asString());
+	      dumpRange(XXX << "reusing blocks from files ", seeds.begin(), seeds.end()) << endl;
+	      bl.reuseBlocks(file, seeds);
 	      XXX << bl << endl;
 	    }
+	  if (failedSeed)
+	    filesystem::unlink(failedFile);
+	  _writtenChecksum = CheckSum();	// we wrote the metalink file
 	  try
 	    {
 	      multifetch(filename, file, &urls, &report, &bl, expectedFileSize_r);
@@ -1489,6 +1570,8 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
       ERR << "Rename failed" << endl;
       ZYPP_THROW(MediaWriteException(dest));
     }
+  // spare the checksum check reading the file again (unless it was multifetched)
+  filesystem::rememberChecksum( dest, _writtenChecksum );
   DBG << "done: " << PathInfo(dest) << endl;
 }
 
@@ -1524,18 +1607,35 @@ void MediaMultiCurl::multifetch(const Pathname & filename, FILE *fp, std::vector
     return;
   if (!_multi)
     {
+      if (_epollfd == -1)
+	_epollfd = epoll_create1(EPOLL_CLOEXEC);
+      if (_epollfd == -1)
+	ZYPP_THROW(MediaCurlInitException(baseurl));
       _multi = curl_multi_init();
       if (!_multi)
 	ZYPP_THROW(MediaCurlInitException(baseurl));
+      curl_multi_setopt(_multi, CURLMOPT_SOCKETFUNCTION, &multi_socketfunction);
+      curl_multi_setopt(_multi, CURLMOPT_SOCKETDATA, &_epollfd);
+      curl_multi_setopt(_multi, CURLMOPT_TIMERFUNCTION, &multifetchrequest::_timerfunction);
+#if CURLVERSION_AT_LEAST(7,43,0)
+      // multiplex the range requests to a HTTP/2 mirror on one connection
+      curl_multi_setopt(_multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif
     }
+#if CURLVERSION_AT_LEAST(7,30,0)
+  // the settings may differ per file (0: no limit)
+  long maxhostconns = _settings.maxConcurrentConnections();
+  curl_multi_setopt(_multi, CURLMOPT_MAX_HOST_CONNECTIONS, maxhostconns > 0 ? maxhostconns : 0L);
+#endif
 
   multifetchrequest req(this, filename, baseurl, _multi, fp, report, blklist, filesize);
   req._timeout = _settings.timeout();
   req._connect_timeout = _settings.connectTimeout();
   req._maxspeed = _settings.maxDownloadSpeed();
   req._maxworkers = _settings.maxConcurrentConnections();
-  if (req._maxworkers > MAXURLS)
-    req._maxworkers = MAXURLS;
+  req._maxurls = _settings.maxMirrors() > 0 ? _settings.maxMirrors() : 1;
+  if (req._maxworkers > (int)req._maxurls)
+    req._maxworkers = req._maxurls;
   if (req._maxworkers <= 0)
     req._maxworkers = 1;
   std::vector<Url> myurllist;
@@ -1560,6 +1660,27 @@ void MediaMultiCurl::multifetch(const Pathname & filename, FILE *fp, std::vector
   checkFileDigest(baseurl, fp, blklist);
 }
 
+size_t MediaMultiCurl::blockSize(double avgspeed_r, off_t left_r, size_t workers_r)
+{
+  // Aim at blocks taking BLKTIME at the speed of the worker, so fast
+  // mirrors are not slowed down by the per request overhead...
+  if (!avgspeed_r)
+    return BLKSIZE;
+  double size = avgspeed_r * BLKTIME;
+  // ...but leave some work for the other workers at the end of the file.
+  if (left_r > 0 && workers_r > 1)
+    {
+      double share = double(left_r) / workers_r;
+      if (size > share)
+	size = share;
+    }
+  if (size <= BLKSIZE)
+    return BLKSIZE;
+  if (size >= MAXBLKSIZE)
+    return MAXBLKSIZE;
+  return size_t(size / BLKSIZE) * BLKSIZE;
+}
+
 void MediaMultiCurl::checkFileDigest(Url &url, FILE *fp, MediaBlockList *blklist) const
 {
   if (!blklist || !blklist->haveFileChecksum())
@@ -1578,12 +1699,20 @@ void MediaMultiCurl::checkFileDigest(Url &url, FILE *fp, MediaBlockList *blklist
 
 bool MediaMultiCurl::isDNSok(const string &host) const
 {
-  return _dnsok.find(host) == _dnsok.end() ? false : true;
+  std::map<std::string, double>::iterator it = _dnsok.find(host);
+  if (it == _dnsok.end())
+    return false;
+  if (currentTime() - it->second > DNSOK_TTL)
+    {
+      _dnsok.erase(it);
+      return false;
+    }
+  return true;
 }
 
 void MediaMultiCurl::setDNSok(const string &host) const
 {
-  _dnsok.insert(host);
+  _dnsok[host] = currentTime();
 }
 
 CURL *MediaMultiCurl::fromEasyPool(const string &host) const
@@ -16,10 +16,12 @@
 #include <vector>
 #include <list>
 #include <set>
+#include <map>
 
 #include "zypp/media/MediaHandler.h"
 #include "zypp/media/MediaCurl.h"
 #include "zypp/media/MediaBlockList.h"
+#include "zypp/media/DnsCheckPool.h"
 #include "zypp/media/TransferSettings.h"
 #include "zypp/ZYppCallbacks.h"
 
@@ -49,6 +51,17 @@ public:
 
   void multifetch(const Pathname &filename, FILE *fp, std::vector<Url> *urllist, callback::SendReport<DownloadProgressReport> *report = 0, MediaBlockList *blklist = 0, off_t filesize = off_t(-1)) const;
 
+  /**
+   * The size of the next block for a worker downloading at \a avgspeed_r
+   * bytes per second (0 if not yet known).
+   *
+   * A block is aimed at taking .5s, but none of the \a workers_r active
+   * workers takes more than its share of the \a left_r bytes not yet
+   * assigned (-1 if the filesize is unknown). The result is a multiple
+   * of 128 KiB, at least 128 KiB and at most 16 MiB.
+   */
+  static size_t blockSize(double avgspeed_r, off_t left_r, size_t workers_r);
+
 protected:
 
   bool isDNSok(const std::string &host) const;
@@ -65,7 +78,9 @@ private:
   // the custom headers from MediaCurl plus a "Accept: metalink" header
   curl_slist *_customHeadersMetalink;
   mutable CURLM *_multi;	// reused for all fetches so we can make use of the dns cache
-  mutable std::set<std::string> _dnsok;
+  mutable int _epollfd;		// watching the sockets of _multi
+  mutable std::map<std::string, double> _dnsok;	// host to time of the successful DNS check
+  mutable DnsCheckPool _dnscheck;	// resolving the hosts not in _dnsok
   mutable std::map<std::string, CURL *> _easypool;
 };
 
@@ -27,6 +27,7 @@ public:
         , _timeout(0)
         , _connect_timeout(0)
         , _maxConcurrentConnections(ZConfig::instance().download_max_concurrent_connections())
+        , _maxMirrors(ZConfig::instance().download_max_mirrors())
         , _minDownloadSpeed(ZConfig::instance().download_min_download_speed())
         , _maxDownloadSpeed(ZConfig::instance().download_max_download_speed())
         , _maxSilentTries(ZConfig::instance().download_max_silent_tries())
@@ -34,6 +35,7 @@ public:
         , _verify_peer(false)
         , _ca_path("/etc/ssl/certs")
         , _head_requests_allowed(true)
+        , _use_http2(ZConfig::instance().download_use_http2())
     {}
 
     virtual ~Impl()
@@ -68,6 +70,7 @@ public:
     Pathname _targetdir;
 
     long _maxConcurrentConnections;
+    long _maxMirrors;
     long _minDownloadSpeed;
     long _maxDownloadSpeed;
     long _maxSilentTries;
@@ -80,6 +83,7 @@ public:
 
     // workarounds
     bool _head_requests_allowed;
+    bool _use_http2;
 };
 
 TransferSettings::TransferSettings()
@@ -234,6 +238,16 @@ void TransferSettings::setMaxConcurrentConnections(long v)
     _impl->_maxConcurrentConnections = v;
 }
 
+long TransferSettings::maxMirrors() const
+{
+    return _impl->_maxMirrors;
+}
+
+void TransferSettings::setMaxMirrors(long v)
+{
+    _impl->_maxMirrors = v;
+}
+
 long TransferSettings::minDownloadSpeed() const
 {
     return _impl->_minDownloadSpeed;
@@ -335,6 +349,16 @@ bool TransferSettings::headRequestsAllowed() const
     return _impl->_head_requests_allowed;
 }
 
+void TransferSettings::setHttp2Enabled(bool enabled)
+{
+    _impl->_use_http2 = enabled;
+}
+
+bool TransferSettings::http2Enabled() const
+{
+    return _impl->_use_http2;
+}
+
 } // ns media
 } // ns zypp
 
@@ -171,6 +171,16 @@ public:
    */
   void setMaxConcurrentConnections(long v);
 
+  /**
+   * Maximum number of mirrors to try for a single metalink transfer
+   */
+  long maxMirrors() const;
+
+  /**
+   * Set maximum number of mirrors to try for a single metalink transfer
+   */
+  void setMaxMirrors(long v);
+
   /**
    * Minimum download speed (bytes per second)
    * until the connection is dropped
@@ -254,6 +264,16 @@ public:
    */
   bool headRequestsAllowed() const;
 
+  /**
+   * Sets whether to negotiate HTTP/2 for https transfers
+   */
+  void setHttp2Enabled(bool enabled);
+
+  /**
+   * Whether to negotiate HTTP/2 for https transfers
+   */
+  bool http2Enabled() const;
+
   /**
    * SSL client certificate file
    */
@@ -13,18 +13,20 @@
 #include <fstream>
 #include <unordered_set>
 #include <iterator>
+#include <thread>
 #include <stdio.h>
+#include <string.h>
+#include <pwd.h>
 #include "zypp/base/LogTools.h"
 #include "zypp/base/String.h"
 #include "zypp/base/Gettext.h"
 #include "zypp/base/Exception.h"
 
 #include "zypp/PathInfo.h"
-#include "zypp/ExternalProgram.h"
+#include "zypp/base/ExternalDataSource.h"
 #include "zypp/base/Regex.h"
 #include "zypp/base/IOStream.h"
 #include "zypp/base/InputStream.h"
-#include "zypp/target/rpm/librpmDb.h"
 
 #include "zypp/misc/CheckAccessDeleted.h"
 
@@ -76,28 +78,109 @@ namespace zypp
       ino_t pidNS;
     };
 
-    /** bsc#1099847: Check for lsof version < 4.90 which does not support '-K i'
-     * Just a quick check to allow code15 libzypp runnig in a code12 environment.
-     * bsc#1036304: '-K i' was backported to older lsof versions, indicated by
-     * lsof providing 'backported-option-Ki'.
-     */
-    bool lsofNoOptKi()
+    /////////////////////////////////////////////////////////////////
+    // Scanning /proc
+    //
+    // The data are composed as lsof output lines, so they pass the
+    // same filter and can be written to and replayed from a debug file.
+    // Reported are the process executable (txt) and the memory mapped
+    // files (DEL). Open filedescriptors are not scanned, as the filter
+    // would drop them anyway.
+    /////////////////////////////////////////////////////////////////
+
+    const std::string deletedSuffix( " (deleted)" );
+
+    /** Processes scanned by one thread. */
+    const size_t minPidsPerThread = 64;
+
+    inline void addField( std::string & line_r, char type_r, const std::string & value_r )
+    {
+      line_r += type_r;
+      line_r += value_r;
+      line_r += '\0';
+    }
+
+    /** Login name of \a uid_r or the numeric id (like lsof). */
+    const std::string & loginName( uid_t uid_r, std::map<uid_t,std::string> & cache_r )
+    {
+      auto it = cache_r.find( uid_r );
+      if ( it != cache_r.end() )
+        return it->second;
+
+      std::string & ret( cache_r[uid_r] );
+      struct passwd pwd;
+      struct passwd * result = nullptr;
+      std::vector<char> buf( 16384 );
+      if ( ::getpwuid_r( uid_r, &pwd, &buf[0], buf.size(), &result ) == 0 && result )
+        ret = result->pw_name;
+      else
+        ret = str::numstring( uid_r );
+      return ret;
+    }
+
+    /** The lsof output lines for \a pid_r (empty if no deleted file is accessed). */
+    std::vector<std::string> scanPid( pid_t pid_r, std::map<uid_t,std::string> & logins_r )
     {
-      using target::rpm::librpmDb;
-      // RpmDb access is blocked while the Target is not initialized.
-      // Launching the Target just for this query would be an overkill.
-      struct TmpUnblock {
-	TmpUnblock()
-	: _wasBlocked( librpmDb::isBlocked() )
-	{ if ( _wasBlocked ) librpmDb::unblockAccess(); }
-	~TmpUnblock()
-	{ if ( _wasBlocked ) librpmDb::blockAccess(); }
-      private:
-	bool _wasBlocked;
-      } tmpUnblock;
-
-      librpmDb::db_const_iterator it;
-      return( it.findPackage( "lsof" ) && it->tag_edition() < Edition("4.90") && !it->tag_provides().count( Capability("backported-option-Ki") ) );
+      std::vector<std::string> ret( 1 );	// [0] is the process line
+      std::unordered_set<std::string> names;
+      auto addFile = [&]( const char * fd_r, const char * type_r, std::string name_r )
+      {
+        if ( ! names.insert( name_r ).second )
+          return;
+        std::string line;
+        addField( line, 'f', fd_r );
+        addField( line, 't', type_r );
+        if ( *type_r == 'R' )
+          addField( line, 'k', "0" );
+        addField( line, 'n', name_r );
+        line += '\n';
+        ret.push_back( std::move(line) );
+      };
+
+      Pathname proc( Pathname("/proc")/str::numstring( pid_r ) );
+      std::string exe( filesystem::readlink( proc/"exe" ).asString() );
+      if ( str::hasSuffix( exe, deletedSuffix ) )
+        addFile( "txt", "REG", exe.substr( 0, exe.size() - deletedSuffix.size() ) );
+
+      std::ifstream maps( (proc/"maps").c_str() );
+      for ( std::string line; std::getline( maps, line ); )
+      {
+        // address perms offset dev inode pathname
+        if ( ! str::hasSuffix( line, deletedSuffix ) )
+          continue;
+        std::string::size_type pos = line.find( '/' );
+        if ( pos != std::string::npos )
+          addFile( "DEL", "DEL", line.substr( pos, line.size() - pos - deletedSuffix.size() ) );
+      }
+
+      if ( ret.size() == 1 )
+        return std::vector<std::string>();
+
+      // pid (comm) state ppid ...
+      std::string stat;
+      std::getline( std::ifstream( (proc/"stat").c_str() ), stat );
+      std::string comm;
+      std::string ppid;
+      std::string::size_type lpar = stat.find( '(' );
+      std::string::size_type rpar = stat.rfind( ')' );
+      if ( lpar != std::string::npos && rpar != std::string::npos && lpar < rpar )
+      {
+        comm = stat.substr( lpar+1, rpar-lpar-1 );
+        std::vector<std::string> words;
+        str::split( stat.substr( rpar+1 ), std::back_inserter(words) );
+        if ( words.size() > 1 )
+          ppid = words[1];
+      }
+
+      std::string & pline( ret[0] );
+      addField( pline, 'p', str::numstring( pid_r ) );
+      addField( pline, 'R', ppid );
+      addField( pline, 'c', exe.empty() ? comm : Pathname( exe ).basename() );
+      uid_t uid = PathInfo( proc ).owner();
+      addField( pline, 'u', str::numstring( uid ) );
+      addField( pline, 'L', loginName( uid, logins_r ) );
+      pline += '\n';
+      return ret;
     }
 
   } //namespace
@@ -111,7 +194,8 @@ namespace zypp
     bool addDataIf( const CacheEntry & cache_r, std::vector<std::string> *debMap = nullptr );
     void addCacheIf( CacheEntry & cache_r, const std::string & line_r, std::vector<std::string> *debMap = nullptr );
 
-    std::map<pid_t,CacheEntry> filterInput( externalprogram::ExternalDataSource &source );
+    std::map<pid_t,CacheEntry> filterInput( const std::function<std::string()> & nextLine_r );
+    std::map<pid_t,CacheEntry> scanProc();
     CheckAccessDeleted::size_type createProcInfo( const std::map<pid_t,CacheEntry> &in );
 
     std::vector<CheckAccessDeleted::ProcInfo> _data;
@@ -145,7 +229,6 @@ namespace zypp
     pinfo.files.insert( pinfo.files.begin(), filelist.begin(), filelist.end() );
 
     const std::string & pline( cache_r.first );
-    std::string commandname;	// pinfo.command if still needed...
     std::ostringstream pLineStr; //rewrite the first line in debug cache
     for_( ch, pline.begin(), pline.end() )
     {
@@ -173,12 +256,8 @@ namespace zypp
           break;
         case 'c':
           if ( pinfo.command.empty() ) {
-            commandname = &*(ch+1);
-            // the lsof command name might be truncated, so we prefer /proc/<pid>/exe
-            if (!_fromLsofFileMode)
-              pinfo.command = filesystem::readlink( Pathname("/proc")/pinfo.pid/"exe" ).basename();
-            if ( pinfo.command.empty() )
-              pinfo.command = std::move(commandname);
+            // already the /proc/<pid>/exe basename, if available
+            pinfo.command = &*(ch+1);
             if ( debMap )
               pLineStr <<'c'<<pinfo.command<<'\0';
           }
@@ -295,11 +374,11 @@ namespace zypp
 
     //inFile is closed by ExternalDataSource
     externalprogram::ExternalDataSource inSource( inFile, nullptr );
-    auto cache = _pimpl->filterInput( inSource );
+    auto cache = _pimpl->filterInput( [&inSource]() { return inSource.receiveLine(); } );
     return _pimpl->createProcInfo( cache );
   }
 
-  std::map<pid_t,CacheEntry> CheckAccessDeleted::Impl::filterInput( externalprogram::ExternalDataSource &source )
+  std::map<pid_t,CacheEntry> CheckAccessDeleted::Impl::filterInput( const std::function<std::string()> & nextLine_r )
   {
     // cachemap: PID => (deleted files)
     // NOTE: omit PIDs running in a (lxc/docker) container
@@ -309,7 +388,7 @@ namespace zypp
 
     pid_t cachepid = 0;
     FilterRunsInLXC runsInLXC;
-    for( std::string line = source.receiveLine(); ! line.empty(); line = source.receiveLine() )
+    for( std::string line = nextLine_r(); ! line.empty(); line = nextLine_r() )
     {
       // NOTE: line contains '\0' separeated fields!
       if ( line[0] == 'p' )
@@ -337,31 +416,69 @@ namespace zypp
     return cachemap;
   }
 
-  CheckAccessDeleted::size_type CheckAccessDeleted::check( bool verbose_r  )
+  std::map<pid_t,CacheEntry> CheckAccessDeleted::Impl::scanProc()
   {
-    static const char* argv[] = { "lsof", "-n", "-FpcuLRftkn0", "-K", "i", NULL };
-    if ( lsofNoOptKi() )
-      argv[3] = NULL;
-
-    _pimpl->_verbose = verbose_r;
-    _pimpl->_fromLsofFileMode = false;
-
-    ExternalProgram prog( argv, ExternalProgram::Discard_Stderr );
-    std::map<pid_t,CacheEntry> cachemap = _pimpl->filterInput( prog );
-
-    int ret = prog.close();
-    if ( ret != 0 )
+    std::vector<pid_t> pids;
+    int res = filesystem::dirForEach( "/proc",
+				      [&pids]( const Pathname &, const char *const name_r )->bool
+				      {
+					if ( *name_r && name_r[::strspn( name_r, "0123456789" )] == '\0' )
+					  pids.push_back( str::strtonum<pid_t>( name_r ) );
+					return true;
+				      } );
+    if ( res != 0 )
+      ZYPP_THROW( Exception( str::Format("Reading /proc failed (%1%).") % res ) );
+
+    // Scan the processes in parallel; each thread fills its own slots.
+    std::vector<std::vector<std::string>> found( pids.size() );
+    size_t nthreads = std::min<size_t>( std::max( std::thread::hardware_concurrency(), 1U ), pids.size() / minPidsPerThread + 1 );
+    FilterRunsInLXC runsInLXC;
+    auto scan = [&]( size_t first_r )
     {
-      if ( ret == 129 )
+      std::map<uid_t,std::string> logins;
+      for ( size_t i = first_r; i < pids.size(); i += nthreads )
       {
-        ZYPP_THROW( Exception(_("Please install package 'lsof' first.") ) );
+        if ( ! runsInLXC( pids[i] ) )
+          found[i] = scanPid( pids[i], logins );
       }
-      Exception err( str::Format("Executing 'lsof' failed (%1%).") % ret );
-      err.remember( prog.execError() );
-      ZYPP_THROW( err );
+    };
+    std::vector<std::thread> threads;
+    for ( size_t i = 0; i < nthreads; ++i )
+    {
+      try
+      {
+        if ( i + 1 < nthreads )
+        {
+          threads.emplace_back( scan, i );
+          continue;
+        }
+      }
+      catch ( const std::exception & )
+      {}
+      scan( i );
     }
+    for ( std::thread & thread : threads )
+      thread.join();
+    DBG << "Scanned " << pids.size() << " processes (" << nthreads << " threads)" << endl;
 
-    return _pimpl->createProcInfo( cachemap );
+    size_t pidIdx = 0;
+    size_t lineIdx = 0;
+    return filterInput( [&]()->std::string
+    {
+      for ( ; pidIdx < found.size(); ++pidIdx, lineIdx = 0 )
+      {
+        if ( lineIdx < found[pidIdx].size() )
+          return std::move( found[pidIdx][lineIdx++] );
+      }
+      return std::string();
+    } );
+  }
+
+  CheckAccessDeleted::size_type CheckAccessDeleted::check( bool verbose_r  )
+  {
+    _pimpl->_verbose = verbose_r;
+    _pimpl->_fromLsofFileMode = false;
+    return _pimpl->createProcInfo( _pimpl->scanProc() );
   }
 
   CheckAccessDeleted::size_type CheckAccessDeleted::Impl::createProcInfo(const std::map<pid_t,CacheEntry> &in)
@@ -31,7 +31,8 @@ namespace zypp
    * Per default upon construction or explicit call to \ref check,
    * information about running processes which access deleted files
    * or libraries is collected and provided as a \ref ProcInfo
-   * container.
+   * container. The data are read from \c /proc (executables and memory
+   * mapped files), scanning the processes in parallel.
    *
    * Provides support for reproducing check results from a foreign system by
    * creating a debug output file containing all required information,
@@ -85,14 +86,15 @@ namespace zypp
        * any deleted file.
        *
        * \return the number of processes found.
-       * \throws Exception On error collecting the data (e.g. no lsof installed)
+       * \throws Exception On error collecting the data (e.g. \c /proc not readable)
        */
       size_type check( bool verbose_r = false );
 
       /**
        * \overload
        * Performs the same checks but instead of investigating the current system it
-       * uses information from \a lsofOutput_r to support debugging.
+       * uses information from \a lsofOutput_r (\c lsof \c -FpcuLRftkn0 output
+       * or a debug output file) to support debugging.
        *
        * \sa setDebugOutputFile
        */
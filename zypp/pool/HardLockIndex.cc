@@ -0,0 +1,117 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/pool/HardLockIndex.cc
+ *
+*/
+#include <cstring>
+#include <iostream>
+#include "zypp/base/LogTools.h"
+
+#include "zypp/pool/HardLockIndex.h"
+#include "zypp/RelCompare.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace pool
+  {
+    HardLockIndex::HardLockIndex( const PoolTraits::HardLockQueries & queries_r )
+    {
+      for ( const PoolQuery & query : queries_r )
+      {
+	if ( compile( query, _byName ) )
+	  ++_simpleSize;
+	else
+	  _complex.push_back( query );
+      }
+    }
+
+    bool HardLockIndex::compile( const PoolQuery & query_r, Index & index_r )
+    {
+      if ( ! query_r.strings().empty() || ! query_r.repos().empty() )
+	return false;
+
+      const Match flags( query_r.flags() );
+      if ( ! ( flags.isModeString() || flags.isModeGlob() )
+	|| flags.test( Match::NOCASE )
+	|| ! flags.test( Match::SKIP_KIND ) )
+	return false;
+
+      const PoolQuery::AttrRawStrMap & attrs( query_r.attributes() );
+      if ( attrs.size() != 1 || attrs.begin()->first != sat::SolvAttr::name || attrs.begin()->second.empty() )
+	return false;
+
+      // Plain names only (no kind prefix, no wildcards)
+      const PoolQuery::StrContainer & names( attrs.begin()->second );
+      for ( const std::string & name : names )
+      {
+	if ( name.empty() || name.find_first_of( flags.isModeGlob() ? ":*?[\\" : ":" ) != std::string::npos )
+	  return false;
+      }
+
+      // There must be nothing else (e.g. predicated name dependencies),
+      // so the query must equal the one built from what we evaluate.
+      PoolQuery plain;
+      plain.setFlags( flags );
+      for ( const std::string & name : names )
+	plain.addAttribute( sat::SolvAttr::name, name );
+      for ( const ResKind & kind : query_r.kinds() )
+	plain.addKind( kind );
+      if ( query_r.editionRel() != Rel::ANY )
+	plain.setEdition( query_r.edition(), query_r.editionRel() );
+      plain.setStatusFilterFlags( query_r.statusFilterFlags() );
+      if ( plain != query_r )
+	return false;
+
+      Lock lock = { query_r.kinds(), query_r.editionRel(), query_r.edition(), query_r.statusFilterFlags() };
+      for ( const std::string & name : names )
+	index_r[IdString(name)].push_back( lock );
+      return true;
+    }
+
+    bool HardLockIndex::matches( sat::Solvable solv_r ) const
+    {
+      if ( _byName.empty() || ! solv_r )
+	return false;
+
+      // SKIP_KIND: match the name without kind prefix
+      IdString name( solv_r.ident() );
+      if ( ::strchr( name.c_str(), ':' ) )
+	name = IdString( solv_r.name() );
+
+      Index::const_iterator it( _byName.find( name ) );
+      return( it != _byName.end() && matches( it->second, solv_r ) );
+    }
+
+    bool HardLockIndex::matches( const std::vector<Lock> & locks_r, sat::Solvable solv_r )
+    {
+      for ( const Lock & lock : locks_r )
+      {
+	if ( lock.status != PoolQuery::ALL
+	  && ( lock.status == PoolQuery::INSTALLED_ONLY ) != solv_r.isSystem() )
+	  continue;
+	if ( lock.op != Rel::ANY && ! compareByRel( lock.op, solv_r.edition(), lock.edition, Edition::Match() ) )
+	  continue;
+	if ( ! lock.kinds.empty() && ! solv_r.isKind( lock.kinds.begin(), lock.kinds.end() ) )
+	  continue;
+	return true;
+      }
+      return false;
+    }
+
+    std::ostream & operator<<( std::ostream & str, const HardLockIndex & obj )
+    { return str << "HardLockIndex(" << obj._simpleSize << " simple, " << obj._complex.size() << " complex)"; }
+
+  } // namespace pool
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
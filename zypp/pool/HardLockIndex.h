@@ -0,0 +1,96 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/pool/HardLockIndex.h
+ *
+*/
+#ifndef ZYPP_POOL_HARDLOCKINDEX_H
+#define ZYPP_POOL_HARDLOCKINDEX_H
+
+#include <iosfwd>
+#include <vector>
+#include <unordered_map>
+
+#include "zypp/pool/PoolTraits.h"
+#include "zypp/PoolQuery.h"
+#include "zypp/Edition.h"
+#include "zypp/Rel.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace pool
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class HardLockIndex
+    /// \brief The \ref PoolTraits::HardLockQueries compiled for fast evaluation.
+    ///
+    /// Most locks (e.g. from /etc/zypp/locks) just name a package, optionally
+    /// restricted to kinds, an edition range or the installed status. Those
+    /// \e simple queries are compiled into a hash lookup by name, so testing
+    /// a solvable does not depend on the number of locks. All other queries
+    /// are kept as \ref complex and must be evaluated as usual.
+    ///
+    /// A query is simple if it searches \ref sat::SolvAttr::name only,
+    /// case sensitive and either exact or as glob without wildcards, and
+    /// neither restricts repositories nor uses predicated (versioned)
+    /// name dependencies.
+    ///////////////////////////////////////////////////////////////////
+    class HardLockIndex
+    {
+      friend std::ostream & operator<<( std::ostream & str, const HardLockIndex & obj );
+
+    public:
+      /** Default ctor: no locks. */
+      HardLockIndex()
+      {}
+
+      /** Ctor compiling \a queries_r. */
+      explicit HardLockIndex( const PoolTraits::HardLockQueries & queries_r );
+
+    public:
+      /** Whether a simple query matches \a solv_r. */
+      bool matches( sat::Solvable solv_r ) const;
+
+      /** The queries which are not compiled. */
+      const std::vector<PoolQuery> & complex() const
+      { return _complex; }
+
+      /** Number of compiled queries. */
+      unsigned simpleSize() const
+      { return _simpleSize; }
+
+    private:
+      /** A name lock restricted by kind, edition and status. */
+      struct Lock
+      {
+	PoolQuery::Kinds kinds;
+	Rel op;
+	Edition edition;
+	PoolQuery::StatusFilter status;
+      };
+      typedef std::unordered_map<IdString, std::vector<Lock>> Index;
+
+      static bool compile( const PoolQuery & query_r, Index & index_r );
+      static bool matches( const std::vector<Lock> & locks_r, sat::Solvable solv_r );
+
+    private:
+      Index _byName;	///< simple locks by name (without kind prefix)
+      std::vector<PoolQuery> _complex;
+      unsigned _simpleSize = 0;
+    };
+
+    /** \relates HardLockIndex Stream output */
+    std::ostream & operator<<( std::ostream & str, const HardLockIndex & obj );
+
+  } // namespace pool
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_POOL_HARDLOCKINDEX_H
@@ -20,6 +20,7 @@
 #include "zypp/APIConfig.h"
 
 #include "zypp/pool/PoolTraits.h"
+#include "zypp/pool/HardLockIndex.h"
 #include "zypp/ResPoolProxy.h"
 #include "zypp/PoolQueryResult.h"
 
@@ -222,22 +223,49 @@ namespace zypp
         const HardLockQueries & hardLockQueries() const
         { return _hardLockQueries; }
 
-        void reapplyHardLocks() const
+        void reapplyHardLocks( const std::vector<PoolItem> & addedItems_r ) const
         {
           // It is assumed that reapplyHardLocks is called after new
           // items were added to the pool, but the _hardLockQueries
           // did not change since. Action is to be performed only on
           // those items that gained the bit in the UserLockQueryField.
-          MIL << "Re-apply " << _hardLockQueries.size() << " HardLockQueries" << endl;
+          // As a query match depends on the item only, just the
+          // added items need to be checked.
+          if ( _hardLockQueries.empty() || addedItems_r.empty() )
+            return;
+          MIL << "Re-apply " << _hardLockIndex << " to " << addedItems_r.size() << " added items" << endl;
           PoolQueryResult locked;
-          for_( it, _hardLockQueries.begin(), _hardLockQueries.end() )
+          if ( ! _hardLockIndex.complex().empty() )
           {
-            locked += *it;
+            // restrict the complex queries to the repos of the added items
+            std::set<std::string> repos;
+            for ( const PoolItem & pi : addedItems_r )
+              repos.insert( pi.repository().alias() );
+            for ( const PoolQuery & query : _hardLockIndex.complex() )
+            {
+              if ( query.repos().empty() )
+              {
+                PoolQuery q( query );
+                for ( const std::string & repo : repos )
+                  q.addRepo( repo );
+                locked += q;
+              }
+              else
+              {
+                for ( const std::string & repo : repos )
+                {
+                  if ( query.repos().count( repo ) )
+                  {
+                    locked += query;
+                    break;
+                  }
+                }
+              }
+            }
           }
-          MIL << "HardLockQueries match " << locked.size() << " Solvables." << endl;
-          for_( it, begin(), end() )
+          for ( const PoolItem & pi : addedItems_r )
           {
-            resstatus::UserLockQueryManip::reapplyLock( it->status(), locked.contains( *it ) );
+            resstatus::UserLockQueryManip::reapplyLock( pi.status(), _hardLockIndex.matches( pi.satSolvable() ) || locked.contains( pi ) );
           }
         }
 
@@ -245,16 +273,17 @@ namespace zypp
         {
           MIL << "Apply " << newLocks_r.size() << " HardLockQueries" << endl;
           _hardLockQueries = newLocks_r;
+          _hardLockIndex = HardLockIndex( _hardLockQueries );
+          MIL << _hardLockIndex << endl;
           // now adjust the pool status
           PoolQueryResult locked;
-          for_( it, _hardLockQueries.begin(), _hardLockQueries.end() )
+          for ( const PoolQuery & query : _hardLockIndex.complex() )
           {
-            locked += *it;
+            locked += query;
           }
-          MIL << "HardLockQueries match " << locked.size() << " Solvables." << endl;
           for_( it, begin(), end() )
           {
-            resstatus::UserLockQueryManip::setLock( it->status(), locked.contains( *it ) );
+            resstatus::UserLockQueryManip::setLock( it->status(), _hardLockIndex.matches( it->satSolvable() ) || locked.contains( *it ) );
           }
         }
 
@@ -305,7 +334,7 @@ namespace zypp
           if ( _storeDirty )
           {
             sat::Pool pool( satpool() );
-            bool addedItems = false;
+            std::vector<PoolItem> addedItems;
 	    bool reusedIDs = _watcherIDs.remember( pool.serialIDs() );
             std::list<PoolItem> addedProducts;
 
@@ -320,6 +349,7 @@ namespace zypp
                 if ( ! s &&  pi )
                 {
                   // the PoolItem got invalidated (e.g unloaded repo)
+                  PoolItem::dropPoolItem( i );
                   pi = PoolItem();
                 }
                 else if ( reusedIDs || (s && ! pi) )
@@ -329,8 +359,7 @@ namespace zypp
                   // remember products for buddy processing (requires clean store)
                   if ( s.isKind( ResKind::product ) )
                     addedProducts.push_back( pi );
-                  if ( !addedItems )
-                    addedItems = true;
+                  addedItems.push_back( pi );
                 }
               }
             }
@@ -348,9 +377,9 @@ namespace zypp
             }
 
             // .... we must reapply those query based hard locks.
-            if ( addedItems )
+            if ( ! addedItems.empty() )
             {
-              reapplyHardLocks();
+              reapplyHardLocks( addedItems );
             }
           }
           return _store;
@@ -412,6 +441,8 @@ namespace zypp
       private:
         /** Set of queries that define hardlocks. */
         HardLockQueries                       _hardLockQueries;
+        /** The \ref _hardLockQueries compiled. */
+        HardLockIndex                         _hardLockIndex;
     };
     ///////////////////////////////////////////////////////////////////
 
@@ -10,6 +10,7 @@
  *
 */
 #include <iostream>
+#include <mutex>
 
 #include "zypp/base/Logger.h"
 #include "zypp/base/String.h"
@@ -35,6 +36,32 @@ namespace zypp
       const Pathname   applydeltarpm_prog( "/usr/bin/applydeltarpm" );
       const str::regex applydeltarpm_tick ( "([0-9]+) percent finished" );
 
+      /** Measured download and re-creation rates (bytes per second, 0 if unknown). */
+      struct Rates
+      {
+        /** Weight of a new sample in the moving average. */
+        static constexpr double weight = 0.3;
+
+        void note( double & rate_r, const ByteCount & size_r, double seconds_r )
+        {
+          if ( size_r <= 0 || seconds_r <= 0 )
+            return;
+          double sample = size_r / seconds_r;
+          std::lock_guard<std::mutex> lock( mutex );
+          rate_r = rate_r ? ( 1 - weight ) * rate_r + weight * sample : sample;
+        }
+
+        std::mutex mutex;
+        double download = 0;
+        double apply = 0;
+      };
+
+      Rates & rates()
+      {
+        static Rates _rates;
+        return _rates;
+      }
+
       /******************************************************************
        **
        **	FUNCTION NAME : applydeltarpm
@@ -185,6 +212,62 @@ namespace zypp
       return true;
     }
 
+    void noteDownload( const ByteCount & size_r, double seconds_r )
+    { rates().note( rates().download, size_r, seconds_r ); }
+
+    void DownloadTimer::tick( std::chrono::steady_clock::time_point time_r )
+    {
+      _last = time_r;
+      if ( ! _ticked )
+      {
+        _first = _last;
+        _ticked = true;
+      }
+    }
+
+    void DownloadTimer::note( const ByteCount & size_r ) const
+    {
+      if ( _ticked )
+        noteDownload( size_r, std::chrono::duration<double>( _last - _first ).count() );
+    }
+
+    void noteApply( const ByteCount & size_r, double seconds_r )
+    { rates().note( rates().apply, size_r, seconds_r ); }
+
+    /******************************************************************
+     **
+     **	FUNCTION NAME : worthwhile
+     **	FUNCTION TYPE : bool
+    */
+    bool worthwhile( const ByteCount & deltaSize_r, const ByteCount & rpmSize_r, unsigned workers_r )
+    {
+      double download;
+      double apply;
+      {
+        std::lock_guard<std::mutex> lock( rates().mutex );
+        download = rates().download;
+        apply = rates().apply;
+      }
+      if ( ! download || ! apply )
+        return true;
+
+      double full = rpmSize_r / download;
+      double delta = deltaSize_r / download + rpmSize_r / ( apply * std::max( workers_r, 1U ) );
+      if ( delta < full )
+        return true;
+
+      DBG << "Full download expected to be faster: " << full << "s vs. " << delta << "s ("
+          << ByteCount( download ) << "/s download, " << ByteCount( apply ) << "/s apply)" << endl;
+      return false;
+    }
+
+    void resetRates()
+    {
+      std::lock_guard<std::mutex> lock( rates().mutex );
+      rates().download = 0;
+      rates().apply = 0;
+    }
+
     /////////////////////////////////////////////////////////////////
   } // namespace applydeltarpm
   ///////////////////////////////////////////////////////////////////
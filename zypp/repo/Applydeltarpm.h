@@ -14,8 +14,10 @@
 
 #include <iosfwd>
 #include <string>
+#include <chrono>
 
 #include "zypp/base/Function.h"
+#include "zypp/ByteCount.h"
 #include "zypp/Pathname.h"
 
 ///////////////////////////////////////////////////////////////////
@@ -74,6 +76,55 @@ namespace zypp
                   const Progress & report_r = Progress() );
     //@}
 
+    /** \name Whether using a deltarpm pays.
+     * Re-creating an rpm is CPU bound, so on a fast link downloading the
+     * full rpm may be faster. The download and re-creation rates are
+     * measured from the transfers and re-creations noted here (moving
+     * average). As long as a rate is not known, deltas are used.
+    */
+    //@{
+    /** Note \a size_r bytes downloaded in \a seconds_r. */
+    void noteDownload( const ByteCount & size_r, double seconds_r );
+
+    /** Times a download to be noted by \ref noteDownload.
+     * The transfer is timed from the first to the last progress report
+     * passed to \ref tick, so time spent connecting to the media, checking
+     * the file or asking the user afterwards does not count. Files provided
+     * without progress reports (local media, cached files) are not noted.
+    */
+    class DownloadTimer
+    {
+    public:
+      /** Note a progress report of the download. */
+      void tick()
+      { tick( std::chrono::steady_clock::now() ); }
+
+      /** Note a progress report of the download received at \a time_r. */
+      void tick( std::chrono::steady_clock::time_point time_r );
+
+      /** Note the timed download of \a size_r bytes (if any and if the size is known). */
+      void note( const ByteCount & size_r ) const;
+
+    private:
+      std::chrono::steady_clock::time_point _first;
+      std::chrono::steady_clock::time_point _last;
+      bool _ticked = false;
+    };
+
+    /** Note an rpm of \a size_r bytes re-created in \a seconds_r. */
+    void noteApply( const ByteCount & size_r, double seconds_r );
+
+    /** Whether downloading a delta of \a deltaSize_r and re-creating the rpm
+     * of \a rpmSize_r is expected to be faster than downloading the rpm.
+     * With \a workers_r re-creations running concurrently, the re-creation
+     * time of a single rpm counts only partially.
+    */
+    bool worthwhile( const ByteCount & deltaSize_r, const ByteCount & rpmSize_r, unsigned workers_r = 1 );
+
+    /** Forget the measured rates (for testing). */
+    void resetRates();
+    //@}
+
     /////////////////////////////////////////////////////////////////
   } // namespace applydeltarpm
   ///////////////////////////////////////////////////////////////////
@@ -12,7 +12,10 @@ extern "C"
 }
 
 #include <iostream>
+#include <unordered_map>
+#include <vector>
 #include "zypp/base/Logger.h"
+#include "zypp/base/SerialNumber.h"
 #include "zypp/Repository.h"
 #include "zypp/repo/DeltaCandidates.h"
 #include "zypp/sat/Pool.h"
@@ -28,6 +31,58 @@ namespace zypp
   namespace repo
   { /////////////////////////////////////////////////////////////////
 
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      /////////////////////////////////////////////////////////////////
+      /// \class DeltaIndex
+      /// \brief The repositories deltarpms indexed by package name.
+      ///
+      /// A repositories index is built when first used, parsing all its
+      /// deltainfo entries once. All indices are dropped whenever the pool
+      /// changes (e.g. a repository is (re)loaded).
+      /////////////////////////////////////////////////////////////////
+      class DeltaIndex
+      {
+      public:
+        typedef std::unordered_map<IdString,std::vector<DeltaRpm>> NameIndex;
+
+        /** The deltarpms in \a repo_r by name. */
+        const NameIndex & nameIndex( const Repository & repo_r )
+        {
+          if ( _watcher.remember( sat::Pool::instance().serial() ) )
+            _repos.clear();
+
+          auto found = _repos.find( repo_r.id() );
+          if ( found != _repos.end() )
+            return found->second;
+
+          NameIndex & ret( _repos[repo_r.id()] );
+          unsigned count = 0;
+          sat::LookupRepoAttr q( sat::SolvAttr::repositoryDeltaInfo, repo_r );
+          for_( it, q.begin(), q.end() )
+          {
+            ret[it.subFind( sat::SolvAttr(DELTA_PACKAGE_NAME) ).idStr()].push_back( DeltaRpm( it ) );
+            ++count;
+          }
+          if ( count )
+            DBG << "Indexed " << count << " deltas for " << ret.size() << " packages in " << repo_r << endl;
+          return ret;
+        }
+
+        static DeltaIndex & instance()
+        {
+          static DeltaIndex _index;
+          return _index;
+        }
+
+      private:
+        std::unordered_map<sat::detail::RepoIdType,NameIndex> _repos;
+        SerialNumberWatcher _watcher;
+      };
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
     /** DeltaCandidates implementation. */
     struct DeltaCandidates::Impl
     {
@@ -80,16 +135,15 @@ namespace zypp
       std::list<DeltaRpm> candidates;
 
       DBG << "package: " << package << endl;
+      IdString name( ! _pimpl->pkgname.empty() ? IdString( _pimpl->pkgname )
+                                              : package ? IdString( package->name() ) : IdString() );
       for_( rit, _pimpl->repos.begin(), _pimpl->repos.end() )
       {
-        sat::LookupRepoAttr q( sat::SolvAttr::repositoryDeltaInfo, *rit );
-        for_( it, q.begin(), q.end() )
+        const DeltaIndex::NameIndex & index( DeltaIndex::instance().nameIndex( *rit ) );
+        auto addIf = [&]( const std::vector<DeltaRpm> & deltas_r )
         {
-          if ( _pimpl->pkgname.empty()
-               || it.subFind( sat::SolvAttr(DELTA_PACKAGE_NAME) ).asString() == _pimpl->pkgname )
+          for ( const DeltaRpm & delta : deltas_r )
           {
-            DeltaRpm delta( it );
-            //DBG << "checking delta: " << delta << endl;
             if ( ! package
                    || (    package->name()    == delta.name()
                         && package->edition() == delta.edition()
@@ -99,6 +153,18 @@ namespace zypp
               candidates.push_back( delta );
             }
           }
+        };
+
+        if ( name.empty() )
+        {
+          for ( const auto & entry : index )
+            addIf( entry.second );
+        }
+        else
+        {
+          auto it = index.find( name );
+          if ( it != index.end() )
+            addIf( it->second );
         }
       }
       return candidates;
@@ -12,6 +12,7 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <chrono>
 #include "zypp/repo/PackageDelta.h"
 #include "zypp/base/Logger.h"
 #include "zypp/base/Gettext.h"
@@ -164,17 +165,20 @@ namespace zypp
        * \endcode
        *
        * \note The provided default implementation retrieves the packages default
-       * location.
+       * location. The transfer is timed for the deltarpm cost model.
        */
       virtual ManagedFile doProvidePackage() const
       {
 	ManagedFile ret;
 	OnMediaLocation loc = _package->location();
 
+	applydeltarpm::DownloadTimer timer;
 	ProvideFilePolicy policy;
-	policy.progressCB( bind( &Base::progressPackageDownload, this, _1 ) );
+	policy.progressCB( [this,&timer]( int value_r ) { timer.tick(); return progressPackageDownload( value_r ); } );
 	policy.fileChecker( bind( &Base::rpmSigFileChecker, this, _1 ) );
-	return _access.provideFile( _package->repoInfo(), loc, policy );
+	ret = _access.provideFile( _package->repoInfo(), loc, policy );
+	timer.note( loc.downloadSize() );
+	return ret;
       }
 
     protected:
@@ -386,7 +390,7 @@ namespace zypp
 	  if ( ! loc.checksum().empty() )	// no cache hit without checksum
 	  {
 	    PathInfo pi( topCache.repoPackagesCachePath / info.packagesPath().basename() / info.path() / loc.filename() );
-	    if ( pi.isExist() && loc.checksum() == CheckSum( loc.checksum().type(), std::ifstream( pi.c_str() ) ) )
+	    if ( pi.isExist() && filesystem::is_checksum( pi.path(), loc.checksum() ) )
 	    {
 	      report()->start( _package, pi.path().asFileUrl() );
 	      const Pathname & dest( info.packagesPath() / info.path() / loc.filename() );
@@ -535,6 +539,11 @@ namespace zypp
 
     private:
       typedef packagedelta::DeltaRpm	DeltaRpm;
+      typedef std::chrono::steady_clock	Clock;
+
+      /** Seconds elapsed since \a start_r (for the deltarpm cost model). */
+      static double seconds( Clock::time_point start_r )
+      { return std::chrono::duration<double>( Clock::now() - start_r ).count(); }
 
       ManagedFile tryDelta( const DeltaRpm & delta_r ) const;
 
@@ -584,6 +593,9 @@ namespace zypp
            && ! queryInstalled( delta_r.baseversion().edition() ) )
         return ManagedFile();
 
+      if ( ! applydeltarpm::worthwhile( delta_r.location().downloadSize(), _package->location().downloadSize() ) )
+        return ManagedFile();
+
       if ( ! applydeltarpm::quickcheck( delta_r.baseversion().sequenceinfo() ) )
         return ManagedFile();
 
@@ -592,9 +604,11 @@ namespace zypp
       ManagedFile delta;
       try
         {
+          applydeltarpm::DownloadTimer timer;
           ProvideFilePolicy policy;
-          policy.progressCB( bind( &RpmPackageProvider::progressDeltaDownload, this, _1 ) );
+          policy.progressCB( [this,&timer]( int value_r ) { timer.tick(); return progressDeltaDownload( value_r ); } );
           delta = _access.provideFile( delta_r.repository().info(), delta_r.location(), policy );
+          timer.note( delta_r.location().downloadSize() );
         }
       catch ( const Exception & excpt )
         {
@@ -614,12 +628,14 @@ namespace zypp
       Pathname cachedest( _package->repoInfo().packagesPath() / _package->repoInfo().path() / _package->location().filename() );
       Pathname builddest( cachedest.extend( ".drpm" ) );
 
+      Clock::time_point start( Clock::now() );
       if ( ! applydeltarpm::provide( delta, builddest,
                                      bind( &RpmPackageProvider::progressDeltaApply, this, _1 ) ) )
         {
           report()->problemDeltaApply( _("applydeltarpm failed.") );
           return ManagedFile();
         }
+      applydeltarpm::noteApply( _package->location().downloadSize(), seconds( start ) );
       ManagedFile builddestCleanup( builddest, filesystem::unlink );
       report()->finishDeltaApply();
 
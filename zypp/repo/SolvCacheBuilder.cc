@@ -0,0 +1,370 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/repo/SolvCacheBuilder.cc
+ *
+*/
+extern "C"
+{
+#include <solv/pool.h>
+#include <solv/repo.h>
+#include <solv/repodata.h>
+#include <solv/knownid.h>
+#include <solv/repo_write.h>
+#include <solv/repo_rpmmd.h>
+#include <solv/repo_repomdxml.h>
+#include <solv/repo_updateinfoxml.h>
+#include <solv/repo_deltainfoxml.h>
+#include <solv/repo_susetags.h>
+#include <solv/repo_content.h>
+#include <solv/repo_rpmdb.h>
+#include <solv/repo_autopattern.h>
+#include <solv/solv_xfopen.h>
+}
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/Gettext.h"
+#include "zypp/base/String.h"
+#include "zypp/base/Errno.h"
+#include "zypp/base/UserRequestException.h"
+#include "zypp/AutoDispose.h"
+#include "zypp/ManagedFile.h"
+#include "zypp/PathInfo.h"
+
+#include "zypp/repo/SolvCacheBuilder.h"
+#include "zypp/repo/RepoException.h"
+#include "zypp/parser/yum/RepomdFileReader.h"
+#include "zypp/parser/susetags/ContentFileReader.h"
+#include "zypp/parser/susetags/RepoIndex.h"
+#include "zypp/sat/Pool.h"
+
+using std::endl;
+
+#undef  ZYPP_BASE_LOGGER_LOGGROUP
+#define ZYPP_BASE_LOGGER_LOGGROUP "zypp::repo2solv"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace repo
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      typedef sat::detail::CPool CPool;
+      typedef sat::detail::CRepo CRepo;
+
+      ///////////////////////////////////////////////////////////////////
+      /// \class Input
+      /// \brief A metadata file and the libsolv reader to feed it to.
+      ///
+      /// The \c Kind defines the order files are processed: solvables
+      /// must be created (primary, packages) before they can be extended.
+      ///////////////////////////////////////////////////////////////////
+      struct Input
+      {
+	enum Kind
+	{
+	  REPOMD,	///< repomd.xml (repo timestamp, keywords, revision)
+	  CONTENT,	///< susetags content file
+	  RPMMD,	///< primary.xml and suse extensions creating solvables
+	  RPMMD_EXT,	///< susedata[.LANG] extending solvables
+	  UPDATEINFO,
+	  DELTAINFO,
+	  SUSETAGS,	///< packages creating solvables
+	  SUSETAGS_EXT,	///< packages.DU, packages.LANG extending solvables
+	  SUSETAGS_PAT,	///< *.pat
+	  RPM		///< plaindir rpm
+	};
+
+	Input( Kind kind_r, const Pathname & file_r, const std::string & lang_r = std::string() )
+	: _kind( kind_r ), _file( file_r ), _lang( lang_r )
+	{}
+
+	bool operator<( const Input & rhs ) const
+	{ return _kind < rhs._kind; }
+
+	Kind _kind;
+	Pathname _file;
+	std::string _lang;
+      };
+
+      inline std::ostream & operator<<( std::ostream & str, const Input & obj )
+      { return str << "[" << obj._kind << "]" << obj._file << ( obj._lang.empty() ? "" : "(" ) << obj._lang << ( obj._lang.empty() ? "" : ")" ); }
+
+      /** Strip a trailing compression suffix, so we can match the basename. */
+      inline std::string stripCompressionSuffix( const std::string & name_r )
+      {
+	for ( const char * suffix : { ".gz", ".xz", ".zst", ".bz2", ".lzma" } )
+	{
+	  if ( str::hasSuffix( name_r, suffix ) )
+	    return str::stripSuffix( name_r, suffix );
+	}
+	return name_r;
+      }
+
+      /** Collect the rpmmd files listed in repomd.xml and available in the raw cache. */
+      void collectRpmmd( const Pathname & metadata_r, std::vector<Input> & inputs_r )
+      {
+	Pathname repomd( metadata_r / "repodata/repomd.xml" );
+	if ( ! PathInfo( repomd ).isFile() )
+	  ZYPP_THROW( RepoException( str::form( _("Can't open file '%s' for reading."), repomd.c_str() ) ) );
+
+	inputs_r.push_back( Input( Input::REPOMD, repomd ) );
+	parser::yum::RepomdFileReader( repomd, parser::yum::RepomdFileReader::ProcessResource2( [&]( const OnMediaLocation & loc_r, const yum::ResourceType & dtype_r, const std::string & typestr_r )->bool {
+	  Pathname file( metadata_r / loc_r.filename() );
+	  if ( ! PathInfo( file ).isFile() )
+	    return true;	// not downloaded (filelists, other, unwanted translations)
+
+	  if ( typestr_r == "primary" || typestr_r == "patterns" || typestr_r == "product" || typestr_r == "products" )
+	    inputs_r.push_back( Input( Input::RPMMD, file ) );
+	  else if ( typestr_r == "susedata" )
+	    inputs_r.push_back( Input( Input::RPMMD_EXT, file ) );
+	  else if ( str::hasPrefix( typestr_r, "susedata." ) )
+	    inputs_r.push_back( Input( Input::RPMMD_EXT, file, typestr_r.substr( 9 ) ) );
+	  else if ( typestr_r == "updateinfo" )
+	    inputs_r.push_back( Input( Input::UPDATEINFO, file ) );
+	  else if ( typestr_r == "deltainfo" || typestr_r == "prestodelta" )
+	    inputs_r.push_back( Input( Input::DELTAINFO, file ) );
+	  else
+	    DBG << "Ignore " << typestr_r << ": " << file << endl;	// bsc#1104415: appdata no longer supported
+	  return true;
+	} ) );
+      }
+
+      /** Collect the susetags files available in the raw cache. */
+      void collectSusetags( const Pathname & metadata_r, std::vector<Input> & inputs_r )
+      {
+	Pathname content( metadata_r / "content" );
+	if ( ! PathInfo( content ).isFile() )
+	  ZYPP_THROW( RepoException( str::form( _("Can't open file '%s' for reading."), content.c_str() ) ) );
+
+	inputs_r.push_back( Input( Input::CONTENT, content ) );
+
+	Pathname descrdir( "suse/setup/descr" );
+	{
+	  parser::susetags::ContentFileReader reader;
+	  reader.setRepoIndexConsumer( [&descrdir]( const parser::susetags::RepoIndex_Ptr & data_r ) {
+	    if ( ! data_r->descrdir.empty() )
+	      descrdir = data_r->descrdir;
+	  } );
+	  reader.parse( content );
+	}
+	descrdir = metadata_r / descrdir;
+
+	std::list<std::string> entries;
+	if ( filesystem::readdir( entries, descrdir, false ) != 0 )
+	  ZYPP_THROW( RepoException( str::form( _("Can't open file '%s' for reading."), descrdir.c_str() ) ) );
+
+	for ( const std::string & entry : entries )
+	{
+	  std::string name( stripCompressionSuffix( entry ) );
+	  if ( name == "packages" )
+	    inputs_r.push_back( Input( Input::SUSETAGS, descrdir / entry ) );
+	  else if ( name == "packages.DU" )
+	    inputs_r.push_back( Input( Input::SUSETAGS_EXT, descrdir / entry ) );
+	  else if ( str::hasPrefix( name, "packages." ) && name != "packages.FL" )
+	    inputs_r.push_back( Input( Input::SUSETAGS_EXT, descrdir / entry, name.substr( 9 ) ) );
+	  else if ( str::hasSuffix( name, ".pat" ) )
+	    inputs_r.push_back( Input( Input::SUSETAGS_PAT, descrdir / entry ) );
+	}
+      }
+
+      /** Recursively collect the rpms below \a dir_r (relative to \a root_r). */
+      void collectPlaindir( const Pathname & root_r, const Pathname & dir_r, std::vector<Input> & inputs_r )
+      {
+	filesystem::dirForEach( root_r / dir_r, [&]( const Pathname & dir, const char *const entry )->bool {
+	  if ( entry[0] == '.' )
+	    return true;
+	  PathInfo pi( dir / entry );
+	  if ( pi.isDir() )
+	    collectPlaindir( root_r, dir_r / entry, inputs_r );
+	  else if ( pi.isFile() && str::hasSuffix( entry, ".rpm" ) )
+	    inputs_r.push_back( Input( Input::RPM, dir_r / entry ) );	// relative to root_r!
+	  return true;
+	} );
+      }
+
+      /** Feed \a input_r to the appropriate libsolv reader. Returns \c false on error. */
+      bool addInput( CRepo * repo_r, const Pathname & metadata_r, const Input & input_r )
+      {
+	static const int flags = REPO_REUSE_REPODATA|REPO_NO_INTERNALIZE;
+
+	if ( input_r._kind == Input::RPM )
+	{
+	  // location must be relative to the repos baseurl
+	  Pathname rpm( metadata_r / input_r._file );
+	  Id p = ::repo_add_rpm( repo_r, rpm.c_str(), flags|REPO_NO_LOCATION|RPM_ADD_WITH_PKGID );
+	  if ( ! p )
+	    return false;
+	  ::repodata_set_location( ::repo_last_repodata( repo_r ), p, 0, 0, input_r._file.c_str() );
+	  return true;
+	}
+
+	AutoDispose<FILE*> file( ::solv_xfopen( input_r._file.c_str(), "r" ), ::fclose );
+	if ( file == nullptr )
+	{
+	  file.resetDispose();
+	  ::pool_error( repo_r->pool, -1, "%s: %s", input_r._file.c_str(), Errno().asString().c_str() );
+	  return false;
+	}
+
+	const char * lang = input_r._lang.empty() ? nullptr : input_r._lang.c_str();
+	int ret = 0;
+	switch ( input_r._kind )
+	{
+	  case Input::REPOMD:
+	    ret = ::repo_add_repomdxml( repo_r, file, flags );
+	    break;
+	  case Input::CONTENT:
+	    ret = ::repo_add_content( repo_r, file, flags );
+	    break;
+	  case Input::RPMMD:
+	    ret = ::repo_add_rpmmd( repo_r, file, lang, flags );
+	    break;
+	  case Input::RPMMD_EXT:
+	    ret = ::repo_add_rpmmd( repo_r, file, lang, flags|REPO_EXTEND_SOLVABLES );
+	    break;
+	  case Input::UPDATEINFO:
+	    ret = ::repo_add_updateinfoxml( repo_r, file, flags );
+	    break;
+	  case Input::DELTAINFO:
+	    ret = ::repo_add_deltainfoxml( repo_r, file, flags );
+	    break;
+	  case Input::SUSETAGS:
+	  case Input::SUSETAGS_PAT:
+	  case Input::SUSETAGS_EXT:
+	  {
+	    Id defvendor = ::repo_lookup_id( repo_r, SOLVID_META, SUSETAGS_DEFAULTVENDOR );
+	    int sflags = flags|SUSETAGS_RECORD_SHARES;
+	    if ( input_r._kind == Input::SUSETAGS_EXT )
+	      sflags |= REPO_EXTEND_SOLVABLES;
+	    ret = ::repo_add_susetags( repo_r, file, defvendor, lang, sflags );
+	  }
+	  break;
+	  case Input::RPM:
+	    break;	// handled above
+	}
+	return( ret == 0 );
+      }
+
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	class SolvCacheBuilder
+    //
+    ///////////////////////////////////////////////////////////////////
+
+    SolvCacheBuilder::SolvCacheBuilder( const RepoType & type_r, const Pathname & metadata_r )
+    : _type( type_r )
+    , _metadata( metadata_r )
+    , _autopatterns( true )
+    {}
+
+    void SolvCacheBuilder::build( const Pathname & solvfile_r, const ProgressData::ReceiverFnc & progress_r ) const
+    {
+      MIL << "Building " << solvfile_r << " from " << *this << endl;
+
+      std::vector<Input> inputs;
+      switch ( _type.toEnum() )
+      {
+	case RepoType::RPMMD_e:
+	  collectRpmmd( _metadata, inputs );
+	  break;
+	case RepoType::YAST2_e:
+	  collectSusetags( _metadata, inputs );
+	  break;
+	case RepoType::RPMPLAINDIR_e:
+	  collectPlaindir( _metadata, Pathname(), inputs );
+	  break;
+	default:
+	  ZYPP_THROW( RepoException( _("Unhandled repository type") ) );
+	  break;
+      }
+      std::stable_sort( inputs.begin(), inputs.end() );
+
+      ProgressData progress( inputs.size() + 1 );	// +1 for writing
+      progress.sendTo( progress_r );
+      progress.toMin();
+
+      AutoDispose<CPool*> pool( ::pool_create(), ::pool_free );
+      CRepo * repo = ::repo_create( pool, "" );	// freed along with the pool
+      ::repo_add_repodata( repo, 0 );		// to be reused by all readers
+
+      for ( const Input & input : inputs )
+      {
+	if ( ! addInput( repo, _metadata, input ) )
+	{
+	  if ( input._kind == Input::RPM )
+	  {
+	    // repo2solv does not fail on a single bad rpm either
+	    WAR << "Skip " << input._file << ": " << ::pool_errstr( pool ) << endl;
+	  }
+	  else
+	  {
+	    RepoException ex( str::form( _("Failed to cache repo (%d)."), 1 ) );
+	    ex.remember( str::Str() << input._file << ": " << ::pool_errstr( pool ) );
+	    ZYPP_THROW( ex );
+	  }
+	}
+	if ( ! progress.incr() )
+	  ZYPP_THROW( AbortRequestException() );
+      }
+
+      ::repo_internalize( repo );
+      if ( _autopatterns )
+	::repo_add_autopattern( repo, 0 );
+
+      // Write to a temporary sibling and rename, so a
+      // half-written solv file can never be found.
+      Pathname tmpfile( solvfile_r.extend( ".new" ) );
+      ManagedFile guard( tmpfile, filesystem::unlink );
+      {
+	AutoDispose<FILE*> file( ::fopen( tmpfile.c_str(), "we" ), ::fclose );
+	if ( file == nullptr )
+	{
+	  file.resetDispose();
+	  ZYPP_THROW( RepoException( str::form( _("Can't create cache at %s - no writing permissions."), solvfile_r.dirname().c_str() ) ) );
+	}
+	if ( ::repo_write( repo, file ) != 0 )
+	{
+	  RepoException ex( str::form( _("Failed to cache repo (%d)."), 2 ) );
+	  ex.remember( str::Str() << tmpfile << ": " << ::pool_errstr( pool ) );
+	  ZYPP_THROW( ex );
+	}
+	file.resetDispose();
+	if ( ::fclose( file ) != 0 )
+	{
+	  RepoException ex( str::form( _("Failed to cache repo (%d)."), 2 ) );
+	  ex.remember( str::Str() << tmpfile << ": " << Errno() );
+	  ZYPP_THROW( ex );
+	}
+      }
+      if ( filesystem::rename( tmpfile, solvfile_r ) != 0 )
+	ZYPP_THROW( RepoException( str::form( _("Failed to cache repo (%d)."), 3 ) ) );
+      guard.resetDispose();
+
+      sat::updateSolvFileIndex( solvfile_r );	// content digest for zypper bash completion
+      progress.toMax();
+      MIL << "Built " << solvfile_r << " (" << repo->nsolvables << " solvables)" << endl;
+    }
+
+    std::ostream & operator<<( std::ostream & str, const SolvCacheBuilder & obj )
+    { return str << "SolvCacheBuilder(" << obj.type() << ")" << obj.metadata(); }
+
+  } // namespace repo
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,89 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/repo/SolvCacheBuilder.h
+ *
+*/
+#ifndef ZYPP_REPO_SOLVCACHEBUILDER_H
+#define ZYPP_REPO_SOLVCACHEBUILDER_H
+
+#include <iosfwd>
+
+#include "zypp/Pathname.h"
+#include "zypp/ProgressData.h"
+#include "zypp/repo/RepoType.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace repo
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class SolvCacheBuilder
+    /// \brief Build a repositories solv file in-process.
+    ///
+    /// Replaces forking \c repo2solv. The raw metadata are read by the
+    /// same libsolv readers \c repo2solv uses (rpmmd, susetags, rpm headers
+    /// for plaindir repos). Compressed metadata are streamed from the raw
+    /// cache, progress is reported per metadata file processed.
+    ///
+    /// \code
+    ///   SolvCacheBuilder( RepoType::RPMMD, rawcache/alias ).build( solvcache/alias/solv );
+    /// \endcode
+    ///
+    /// On success the \c solv file and its \c solv.idx are written. On error
+    /// a \ref RepoException is thrown and no \c solv file is left behind.
+    ///////////////////////////////////////////////////////////////////
+    class SolvCacheBuilder
+    {
+      friend std::ostream & operator<<( std::ostream & str, const SolvCacheBuilder & obj );
+
+    public:
+      /** Ctor taking the repo type and the product data directory in the raw cache.
+       * For \ref RepoType::RPMPLAINDIR \a metadata_r is the directory to scan for rpms.
+       */
+      SolvCacheBuilder( const RepoType & type_r, const Pathname & metadata_r );
+
+    public:
+      /** The repo type to build. */
+      const RepoType & type() const
+      { return _type; }
+
+      /** The metadata directory to read. */
+      const Pathname & metadata() const
+      { return _metadata; }
+
+      /** Whether to autogenerate patterns from pattern-packages (\c repo2solv -X; default \c true). */
+      bool autopatterns() const
+      { return _autopatterns; }
+
+      /** Set whether to autogenerate patterns from pattern-packages. */
+      void setAutopatterns( bool yesno_r )
+      { _autopatterns = yesno_r; }
+
+    public:
+      /** Build \a solvfile_r and the corresponding \c solv.idx.
+       * \throws RepoException if the metadata can not be read or the file can not be written.
+       */
+      void build( const Pathname & solvfile_r, const ProgressData::ReceiverFnc & progress_r = ProgressData::ReceiverFnc() ) const;
+
+    private:
+      RepoType _type;
+      Pathname _metadata;
+      bool _autopatterns;
+    };
+
+    /** \relates SolvCacheBuilder Stream output */
+    std::ostream & operator<<( std::ostream & str, const SolvCacheBuilder & obj );
+
+  } // namespace repo
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_REPO_SOLVCACHEBUILDER_H
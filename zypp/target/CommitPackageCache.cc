@@ -16,6 +16,8 @@
 #include "zypp/target/CommitPackageCache.h"
 #include "zypp/target/CommitPackageCacheImpl.h"
 #include "zypp/target/CommitPackageCacheReadAhead.h"
+#include "zypp/target/CommitPackageCachePrefetch.h"
+#include "zypp/ZConfig.h"
 
 using std::endl;
 
@@ -121,6 +123,17 @@ namespace zypp
           MIL << "$ZYPP_COMMIT_NO_PACKAGE_CACHE is set." << endl;
           _pimpl.reset( new Impl( packageProvider_r ) ); // no cache
         }
+      else if ( ZConfig::instance().commit_prefetchPackages() || ZConfig::instance().commit_parallelConnections() )
+        {
+          const ZConfig & zconfig( ZConfig::instance() );
+          CommitPackageCachePrefetch::Limits limits;
+          limits.lookahead	= zconfig.commit_prefetchPackages();
+          limits.budget		= zconfig.commit_prefetchBytes();
+          limits.connections	= zconfig.commit_parallelConnections();
+          limits.connectionsPerHost = zconfig.commit_parallelConnectionsPerHost();
+          limits.connectionsPerRepo = zconfig.commit_parallelConnectionsPerRepo();
+          _pimpl.reset( new CommitPackageCachePrefetch( packageProvider_r, limits ) );
+        }
       else
         {
           _pimpl.reset( new CommitPackageCacheReadAhead( packageProvider_r ) );
@@ -142,6 +155,12 @@ namespace zypp
     ManagedFile CommitPackageCache::get( const PoolItem & citem_r )
     { return _pimpl->get( citem_r ); }
 
+    void CommitPackageCache::prefetch()
+    { _pimpl->prefetch(); }
+
+    void CommitPackageCache::verifySignatures()
+    { _pimpl->verifySignatures(); }
+
     bool CommitPackageCache::preloaded() const
     { return _pimpl->preloaded(); }
 
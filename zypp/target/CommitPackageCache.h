@@ -88,6 +88,20 @@ namespace zypp
       ManagedFile get( sat::Solvable citem_r )
       { return get( PoolItem(citem_r) ); }
 
+      /** Download the packages of the commit list in advance.
+       * Implementations may download many packages concurrently.
+       * Packages not downloaded here are provided by \ref get as usual.
+       * \throws AbortRequestException if the user aborted the download.
+       */
+      void prefetch();
+
+      /** Check the rpm signatures of the packages to install in advance.
+       * The packages available locally are checked concurrently, so the
+       * checks done by \ref get are cheap. Nothing is reported here, failures
+       * are reported by \ref get as usual.
+       */
+      void verifySignatures();
+
       /** Whether preloaded hint is set.
        * If preloaded the cache tries to avoid trigering the infoInCache CB,
        * based on the assumption this was already done when preloading the cache.
@@ -13,6 +13,12 @@
 #include "zypp/base/Logger.h"
 
 #include "zypp/target/CommitPackageCacheImpl.h"
+#include "zypp/target/rpm/RpmDb.h"
+#include "zypp/Package.h"
+#include "zypp/PathInfo.h"
+#include "zypp/RepoInfo.h"
+#include "zypp/Target.h"
+#include "zypp/ZYppFactory.h"
 
 using std::endl;
 
@@ -23,7 +29,51 @@ namespace zypp
   namespace target
   { /////////////////////////////////////////////////////////////////
 
+    void CommitPackageCache::Impl::verifySignatures()
+    {
+      Target_Ptr target( getZYpp()->getTarget() );
+      if ( ! target )
+	return;
 
+      // Rpms in local directories are not copied into the cache but checked
+      // in place when they are provided. Packages found in the cache are
+      // not checked again (they were checked when downloaded).
+      std::vector<Pathname> paths;
+      for ( const sat::Solvable & solv : commitList() )
+      {
+	PoolItem pi( solv );
+	if ( ! ( pi.status().isToBeInstalled() && pi->isKind<Package>() ) )
+	  continue;
+
+	RepoInfo info( pi->repoInfo() );
+	if ( ! info.pkgGpgCheck() || info.baseUrlsEmpty() )
+	  continue;
+	const Url & url( *info.baseUrlsBegin() );
+	if ( url.getScheme() != "dir" && url.getScheme() != "file" )
+	  continue;
+
+	const OnMediaLocation & loc( pi->asKind<Package>()->location() );
+	if ( PathInfo( info.packagesPath() / info.path() / loc.filename() ).isExist() )
+	  continue;	// maybe a cache hit
+	Pathname path( url.getPathName() / info.path() / loc.filename() );
+	if ( PathInfo( path ).isFile() )
+	  paths.push_back( path );
+      }
+      if ( paths.size() < 2 )
+	return;	// nothing to gain
+
+      std::vector<rpm::RpmDb::CheckPackageResult> results( target->rpmDb().checkPackageSignatures( paths ) );
+      unsigned failed = 0;
+      for ( unsigned idx = 0; idx < results.size(); ++idx )
+      {
+	if ( results[idx] != rpm::RpmDb::CHK_OK )
+	{
+	  DBG << "Signature check in advance: " << paths[idx] << " " << results[idx] << endl;
+	  ++failed;
+	}
+      }
+      MIL << "Checked " << paths.size() << " package signatures in advance (" << failed << " not OK)" << endl;
+    }
 
     /////////////////////////////////////////////////////////////////
   } // namespace target
@@ -58,9 +58,26 @@ namespace zypp
         return sourceProvidePackage( citem_r );
       }
 
-      void setCommitList( std::vector<sat::Solvable> commitList_r )
+      /** Set the download(commit) sequence.
+       * Derived classes may overload this to prepare read ahead.
+      */
+      virtual void setCommitList( std::vector<sat::Solvable> commitList_r )
       { _commitList = commitList_r; }
 
+      /** Download the packages of the commit list in advance.
+       * Derived classes may overload this. By default packages are
+       * downloaded one by one via \ref get.
+      */
+      virtual void prefetch()
+      {}
+
+      /** Check the rpm signatures of the packages to install concurrently.
+       * This is a warm-up for the checks done when the packages are provided
+       * (see \ref rpm::RpmDb::checkPackageSignatures). Failures are reported
+       * by \ref get as usual.
+      */
+      virtual void verifySignatures();
+
       const std::vector<sat::Solvable> & commitList() const
       { return _commitList; }
 
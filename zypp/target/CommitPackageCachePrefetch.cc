@@ -0,0 +1,644 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/target/CommitPackageCachePrefetch.cc
+ *
+*/
+#include <curl/curl.h>
+
+#include <cstdio>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+#include "zypp/base/Logger.h"
+#include "zypp/base/String.h"
+#include "zypp/base/UserRequestException.h"
+#include "zypp/AutoDispose.h"
+#include "zypp/Digest.h"
+#include "zypp/PathInfo.h"
+#include "zypp/RepoInfo.h"
+#include "zypp/Package.h"
+#include "zypp/ResPool.h"
+#include "zypp/ZConfig.h"
+#include "zypp/ZYppCallbacks.h"
+#include "zypp/media/MediaCurl.h"
+#include "zypp/media/CredentialManager.h"
+#include "zypp/media/TransferSettings.h"
+#include "zypp/repo/Applydeltarpm.h"
+#include "zypp/repo/DeltaCandidates.h"
+#include "zypp/target/CommitPackageCachePrefetch.h"
+
+using std::endl;
+
+#undef  ZYPP_BASE_LOGGER_LOGGROUP
+#define ZYPP_BASE_LOGGER_LOGGROUP "zypp::commit::prefetch"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace target
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      /** Keep this much disk space free in the package cache. */
+      const ByteCount diskReserve( 100, ByteCount::MiB );
+
+      /** Returned by \ref CommitPackageCachePrefetch::nextStartable if nothing can be started. */
+      const unsigned noJob = unsigned(-1);
+
+      /** Whether \a url_r is downloaded (rather than mounted or local). */
+      inline bool isDownloadUrl( const Url & url_r )
+      {
+	const std::string & scheme( url_r.getScheme() );
+	return( scheme == "http" || scheme == "https" || scheme == "ftp" );
+      }
+
+      /** Whether another connection for \a key_r is within \a limit_r (0 is unlimited). */
+      inline bool withinLimit( const std::unordered_map<std::string,unsigned> & connections_r, const std::string & key_r, unsigned limit_r )
+      {
+	if ( ! limit_r )
+	  return true;
+	auto it = connections_r.find( key_r );
+	return( it == connections_r.end() || it->second < limit_r );
+      }
+
+      /** curl write callback data. */
+      struct WriteData
+      {
+	FILE * file;
+	std::atomic<long long> * received;
+	long long written;	///< by this transfer
+	Digest * digest;	///< checksum computed while writing (if not NULL)
+      };
+
+      /** curl write callback. */
+      size_t writeCB( char * ptr_r, size_t size_r, size_t nmemb_r, void * data_r )
+      {
+	WriteData * data = reinterpret_cast<WriteData*>(data_r);
+	size_t ret = ::fwrite( ptr_r, size_r, nmemb_r, data->file );
+	*data->received += ret * size_r;
+	data->written += ret * size_r;
+	if ( data->digest )
+	  data->digest->update( ptr_r, ret * size_r );
+	return ret;
+      }
+
+      /** curl progress callback; abort the transfer if the prefetch is stopped. */
+      int progressCB( void * stop_r, double, double, double, double )
+      { return *reinterpret_cast<std::atomic<bool>*>(stop_r) ? 1 : 0; }
+
+      /** Whether \a pi_r is installed in edition \a ed_r (any edition if \c noedition). */
+      bool baseInstalled( const PoolItem & pi_r, const Edition & ed_r )
+      {
+	for ( const PoolItem & inst : ResPool::instance().byIdent( pi_r ) )
+	{
+	  if ( inst.satSolvable().isSystem() && inst->arch() == pi_r->arch()
+	       && ( ed_r == Edition::noedition || inst->edition() == ed_r ) )
+	    return true;
+	}
+	return false;
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    struct CommitPackageCachePrefetch::Server
+    {
+      Url url;				///< the repositories base url
+      media::TransferSettings settings;	///< as the media layer would use them
+    };
+
+    CommitPackageCachePrefetch::CommitPackageCachePrefetch( const PackageProvider & packageProvider_r, const Limits & limits_r )
+    : CommitPackageCacheReadAhead( packageProvider_r )
+    , _limits( limits_r )
+    , _advance( false )
+    , _next( 0 )
+    , _consumed( 0 )
+    , _running( 0 )
+    , _fetching( 0 )
+    , _haveDeltas( false )
+    , _applyWorkers( 0 )
+    , _stop( false )
+    , _received( 0 )
+    {}
+
+    CommitPackageCachePrefetch::~CommitPackageCachePrefetch()
+    {
+      stopWorkers();
+      // Remove prefetched files which were not requested.
+      for ( const Job & job : _jobs )
+      {
+	if ( job.state == Job::DONE && ! job.handedOver && ! job.keepPackages )
+	  filesystem::unlink( job.dest );
+      }
+    }
+
+    void CommitPackageCachePrefetch::startWorkers( unsigned count_r )
+    {
+      media::MediaCurl::globalInit();
+      _running = _fetching = count_r;
+      _applyWorkers = _haveDeltas ? std::max( std::thread::hardware_concurrency(), 1U ) : 0;
+      _running += _applyWorkers;
+      for ( unsigned i = 0; i < count_r; ++i )
+	_threads.push_back( std::thread( &CommitPackageCachePrefetch::worker, this ) );
+      for ( unsigned i = 0; i < _applyWorkers; ++i )
+	_threads.push_back( std::thread( &CommitPackageCachePrefetch::applyWorker, this ) );
+    }
+
+    void CommitPackageCachePrefetch::stopWorkers()
+    {
+      if ( ! _threads.empty() )
+      {
+	{
+	  std::lock_guard<std::mutex> lock( _mutex );	// don't miss the workers wait
+	  _stop = true;
+	}
+	_cv.notify_all();
+	for ( std::thread & thread : _threads )
+	  thread.join();
+	_threads.clear();
+      }
+    }
+
+    void CommitPackageCachePrefetch::setCommitList( std::vector<sat::Solvable> commitList_r )
+    {
+      stopWorkers();
+      CommitPackageCacheReadAhead::setCommitList( commitList_r );
+
+      // Queue the uncached packages to install from network repos.
+      _jobs.clear();
+      _jobIndex.clear();
+      _next = _consumed = 0;
+      _pending = 0;
+      _stop = false;
+      _advance = false;
+      _haveDeltas = false;
+      _applyQueue.clear();
+      _servers.clear();
+
+      std::list<Repository> repos;
+      if ( ZConfig::instance().download_use_deltarpm() && applydeltarpm::haveApplydeltarpm() )
+	repos.assign( ResPool::instance().knownRepositoriesBegin(), ResPool::instance().knownRepositoriesEnd() );
+      for ( const sat::Solvable & solv : commitList() )
+      {
+	PoolItem pi( solv );
+	if ( ! ( pi.status().isToBeInstalled() && pi->isKind<Package>() ) )
+	  continue;
+
+	RepoInfo info( pi->repoInfo() );
+	if ( info.pkgGpgCheck() )
+	  continue;
+
+	OnMediaLocation loc( pi->asKind<Package>()->location() );
+	if ( loc.checksum().empty() )
+	  continue;	// no cache hit without checksum
+
+	Job job;
+	job.servers	= servers( info );
+	if ( job.servers.empty() )
+	  continue;
+	job.path	= info.path() / loc.filename();
+	job.host	= job.servers.front()->url.getHost();
+	job.repo	= info.alias();
+	job.dest	= info.packagesPath() / info.path() / loc.filename();
+	job.checksum	= loc.checksum();
+	job.size	= loc.downloadSize();
+	job.keepPackages = info.keepPackages();
+	job.state	= PathInfo( job.dest ).isExist() ? Job::SKIPPED : Job::PENDING;
+	job.handedOver	= false;
+
+	if ( ! repos.empty() && job.state == Job::PENDING )
+	{
+	  // The first delta for an installed base version; the sequence is checked when fetching.
+	  for ( const packagedelta::DeltaRpm & delta : repo::DeltaCandidates( repos, pi.name() ).deltaRpms( pi->asKind<Package>() ) )
+	  {
+	    if ( delta.location().checksum().empty() || ! baseInstalled( pi, delta.baseversion().edition() ) )
+	      continue;
+	    RepoInfo dinfo( delta.repository().info() );
+	    job.delta.servers	= servers( dinfo );
+	    if ( job.delta.servers.empty() )
+	      continue;
+
+	    job.delta.path	= dinfo.path() / delta.location().filename();
+	    job.delta.dest	= job.dest.extend( ".delta" );
+	    job.delta.checksum	= delta.location().checksum();
+	    job.delta.size	= delta.location().downloadSize();
+	    job.sequenceinfo	= delta.baseversion().sequenceinfo();
+	    _haveDeltas = true;
+	    break;
+	  }
+	}
+
+	_jobIndex[solv.id()] = _jobs.size();
+	_jobs.push_back( job );
+      }
+
+      MIL << "Prefetch " << _jobs.size() << " packages (lookahead " << _limits.lookahead << ", budget " << _limits.budget
+          << ", connections " << _limits.connections << "/" << _limits.connectionsPerHost << "/" << _limits.connectionsPerRepo << ")" << endl;
+      // The background download starts with the first request.
+    }
+
+    void CommitPackageCachePrefetch::prefetch()
+    {
+      if ( ! _limits.connections || ! _threads.empty() )
+	return;	// disabled or too late
+
+      const Job * first = nullptr;
+      unsigned count = 0;
+      ByteCount total;
+      for ( const Job & job : _jobs )
+      {
+	if ( job.state != Job::PENDING )
+	  continue;
+	if ( ! first )
+	  first = &job;
+	++count;
+	total += job.size;
+      }
+      if ( ! count )
+	return;
+
+      MIL << "Download " << count << " packages (" << total << ") in advance using up to "
+          << std::min( count, _limits.connections ) << " connections" << endl;
+      _advance = true;
+      _received = 0;
+      startWorkers( std::min( count, _limits.connections ) );
+
+      // The aggregated progress is reported against the (first) server.
+      Url url( media::MediaCurl::clearQueryString( first->servers.front()->url ) );
+      url.setPathName( "/" );
+      callback::SendReport<media::DownloadProgressReport> report;
+      report->start( url, Pathname() );
+
+      typedef std::chrono::steady_clock Clock;
+      Clock::time_point start( Clock::now() );
+      Clock::time_point last( start );
+      long long lastReceived = 0;
+      bool aborted = false;
+      {
+	std::unique_lock<std::mutex> lock( _mutex );
+	while ( ! _cv.wait_for( lock, std::chrono::milliseconds( 500 ), [this]{ return _running == 0; } ) )
+	{
+	  Clock::time_point now( Clock::now() );
+	  long long received = _received;
+	  double elapsed  = std::chrono::duration<double>( now - start ).count();
+	  double interval = std::chrono::duration<double>( now - last ).count();
+	  int percent = total ? std::min( received * 100 / total, 100LL ) : 100;
+	  last = now;
+
+	  lock.unlock();
+	  bool goOn = report->progress( percent, url,
+					elapsed > 0 ? received / elapsed : -1,
+					interval > 0 ? ( received - lastReceived ) / interval : -1 );
+	  lastReceived = received;
+	  lock.lock();
+	  if ( ! goOn )
+	  {
+	    WAR << "Download in advance aborted by the user" << endl;
+	    aborted = true;
+	    _stop = true;
+	    _cv.notify_all();
+	  }
+	}
+      }
+      stopWorkers();
+      _stop = false;
+      _advance = false;
+
+      if ( aborted )
+      {
+	report->finish( url, media::DownloadProgressReport::ERROR, "Aborted by the user." );
+	ZYPP_THROW( AbortRequestException( "Download in advance aborted by the user." ) );
+      }
+
+      unsigned done = 0;
+      for ( const Job & job : _jobs )
+      {
+	if ( job.state == Job::DONE )
+	  ++done;
+      }
+      MIL << "Downloaded " << done << " of " << count << " packages in advance" << endl;
+      report->progress( 100, url );
+      report->finish( url, media::DownloadProgressReport::NO_ERROR, "" );
+    }
+
+    ManagedFile CommitPackageCachePrefetch::get( const PoolItem & citem_r )
+    {
+      std::unique_lock<std::mutex> lock( _mutex );
+      auto it = _jobIndex.find( citem_r.satSolvable().id() );
+      if ( it != _jobIndex.end() )
+      {
+	Job & job( _jobs[it->second] );
+	if ( _consumed <= it->second )
+	  _consumed = it->second + 1;
+	if ( job.state == Job::RUNNING )
+	{
+	  MIL << "Waiting for prefetch of " << citem_r << endl;
+	  _cv.wait( lock, [&job]{ return job.state != Job::RUNNING; } );
+	}
+	if ( job.state == Job::DONE && ! job.handedOver )
+	  _pending -= job.size;
+	job.handedOver = true;
+      }
+      if ( _threads.empty() && _limits.lookahead && _next < _jobs.size() )
+	startWorkers( 1 );	// start the background download
+      lock.unlock();
+      _cv.notify_all();	// window moved
+
+      // Either a cache hit now, or provided as usual.
+      return CommitPackageCacheReadAhead::get( citem_r );
+    }
+
+    unsigned CommitPackageCachePrefetch::nextStartable() const
+    {
+      if ( _advance )
+      {
+	// Any pending package within the connection limits.
+	for ( unsigned idx = _next; idx < _jobs.size(); ++idx )
+	{
+	  const Job & job( _jobs[idx] );
+	  if ( job.state == Job::PENDING
+	       && withinLimit( _hostConnections, job.host, _limits.connectionsPerHost )
+	       && withinLimit( _repoConnections, job.repo, _limits.connectionsPerRepo ) )
+	    return idx;
+	}
+	return noJob;
+      }
+
+      // In the background the packages are fetched in order within the lookahead window.
+      if ( _next >= _jobs.size() || _next >= _consumed + _limits.lookahead )
+	return noJob;
+      // The package requested next is always fetched, later ones only within the budget.
+      return( _next == _consumed || _pending + _jobs[_next].size <= _limits.budget ) ? _next : noJob;
+    }
+
+    void CommitPackageCachePrefetch::worker()
+    {
+      // The handle is reused for all downloads, so connections are kept alive.
+      AutoDispose<CURL*> curl( ::curl_easy_init(), ::curl_easy_cleanup );
+      std::unique_lock<std::mutex> lock( _mutex );
+      while ( curl != nullptr )
+      {
+	// Drop jobs already requested or not pending.
+	while ( _next < _jobs.size() && ( _next < _consumed || _jobs[_next].state != Job::PENDING ) )
+	{
+	  if ( _jobs[_next].state == Job::PENDING )
+	    _jobs[_next].state = Job::SKIPPED;
+	  ++_next;
+	}
+	if ( _stop || _next >= _jobs.size() )
+	  break;
+
+	unsigned idx = nextStartable();
+	if ( idx == noJob )
+	{
+	  _cv.wait( lock );
+	  continue;
+	}
+
+	Job & job( _jobs[idx] );
+	job.state = Job::RUNNING;
+	++_hostConnections[job.host];
+	++_repoConnections[job.repo];
+	bool viaDelta = ! job.delta.servers.empty() && applydeltarpm::worthwhile( job.delta.size, job.size, _applyWorkers );
+	lock.unlock();
+	// Fall back to the full rpm if the delta is not applicable or not available.
+	bool ok = false;
+	if ( viaDelta )
+	  viaDelta = applydeltarpm::quickcheck( job.sequenceinfo ) && fetch( curl, job.delta );
+	if ( ! viaDelta )
+	  ok = fetch( curl, job );
+	lock.lock();
+	--_hostConnections[job.host];
+	--_repoConnections[job.repo];
+	if ( viaDelta )
+	  _applyQueue.push_back( idx );	// still RUNNING until re-created
+	else
+	{
+	  job.state = ok ? Job::DONE : Job::FAILED;
+	  if ( ok && ! job.handedOver )
+	    _pending += job.size;
+	}
+	_cv.notify_all();
+      }
+      --_fetching;
+      --_running;
+      _cv.notify_all();
+      DBG << "Prefetch thread done." << endl;
+    }
+
+    void CommitPackageCachePrefetch::applyWorker()
+    {
+      std::unique_lock<std::mutex> lock( _mutex );
+      while ( true )
+      {
+	_cv.wait( lock, [this]{ return _stop || ! _applyQueue.empty() || ! _fetching; } );
+	if ( _stop || _applyQueue.empty() )
+	  break;
+
+	Job & job( _jobs[_applyQueue.front()] );
+	_applyQueue.pop_front();
+	lock.unlock();
+	bool ok = apply( job );
+	lock.lock();
+	job.state = ok ? Job::DONE : Job::FAILED;
+	if ( ok && ! job.handedOver )
+	  _pending += job.size;
+	_cv.notify_all();
+      }
+      // Stopped: drop the deltas not yet applied.
+      for ( unsigned idx : _applyQueue )
+      {
+	filesystem::unlink( _jobs[idx].delta.dest );
+	_jobs[idx].state = Job::FAILED;
+      }
+      _applyQueue.clear();
+      --_running;
+      _cv.notify_all();
+      DBG << "Applydeltarpm thread done." << endl;
+    }
+
+    std::vector<CommitPackageCachePrefetch::ServerPtr> CommitPackageCachePrefetch::servers( const RepoInfo & info_r )
+    {
+      auto it = _servers.find( info_r.alias() );
+      if ( it != _servers.end() )
+	return it->second;
+
+      std::vector<ServerPtr> & ret( _servers[info_r.alias()] );
+      media::CredentialManager cm( media::CredManagerOptions( ZConfig::instance().repoManagerRoot() ) );
+      for ( const Url & url : info_r.baseUrls() )
+      {
+	if ( ! isDownloadUrl( url ) )
+	  continue;
+
+	std::shared_ptr<Server> server( new Server );
+	server->url = url;
+	try
+	{
+	  media::MediaCurl::fillSettings( url, server->settings );
+	}
+	catch ( const Exception & excpt_r )
+	{
+	  ZYPP_CAUGHT( excpt_r );
+	  WAR << "Not prefetching from " << url << endl;
+	  continue;
+	}
+	// Unlike MediaCurl we can't ask on demand, so use stored credentials up front.
+	if ( server->settings.password().empty() )
+	{
+	  media::AuthData_Ptr cred( cm.getCred( url ) );
+	  if ( cred && cred->valid() )
+	  {
+	    server->settings.setUsername( cred->username() );
+	    server->settings.setPassword( cred->password() );
+	  }
+	}
+	ret.push_back( server );
+      }
+      return ret;
+    }
+
+    bool CommitPackageCachePrefetch::fetch( void * curl_r, const Download & job_r )
+    {
+      if ( filesystem::assert_dir( job_r.dest.dirname() ) != 0 )
+	return false;
+
+      ByteCount avail( filesystem::df( job_r.dest.dirname() ) );
+      if ( avail < job_r.size + diskReserve )
+      {
+	MIL << "Not enough disk space to prefetch " << job_r.path << " (" << avail << " available)" << endl;
+	return false;
+      }
+
+      Pathname tmp( job_r.dest.extend( ".prefetch" ) );
+      CheckSum written;
+      bool ok = false;
+      for ( const ServerPtr & server : job_r.servers )
+      {
+	if ( _stop )
+	  break;
+	if ( ( ok = fetchFrom( curl_r, *server, job_r, tmp, written ) ) )
+	  break;
+      }
+      if ( ok && filesystem::rename( tmp, job_r.dest ) != 0 )
+	ok = false;
+      if ( ok )
+	filesystem::rememberChecksum( job_r.dest, written );
+      else
+	filesystem::unlink( tmp );
+      return ok;
+    }
+
+    bool CommitPackageCachePrefetch::fetchFrom( void * curl_r, const Server & server_r, const Download & job_r, const Pathname & tmp_r, CheckSum & written_r )
+    {
+      Url url( server_r.url );
+      url.appendPathName( job_r.path );
+
+      bool ok = false;
+      Digest digest;
+      bool hashing = digest.create( job_r.checksum.type() );
+      {
+	AutoDispose<FILE*> file( ::fopen( tmp_r.c_str(), "we" ), ::fclose );
+	if ( file == nullptr )
+	{
+	  file.resetDispose();
+	  return false;
+	}
+	WriteData data = { file, &_received, 0, hashing ? &digest : nullptr };
+
+	// Drop the options of the previous transfer; connections and caches are kept.
+	CURL * curl = reinterpret_cast<CURL*>(curl_r);
+	::curl_easy_reset( curl );
+	curl_slist * headers = nullptr;
+	AutoDispose<curl_slist**> headersDispose( &headers, []( curl_slist ** headers_r ) { ::curl_slist_free_all( *headers_r ); } );
+	try
+	{
+	  media::MediaCurl::setupEasyHandle( curl, url, server_r.settings, headers );
+	}
+	catch ( const Exception & excpt_r )
+	{
+	  ZYPP_CAUGHT( excpt_r );
+	  MIL << "Prefetch failed: " << url << ": " << excpt_r.asUserString() << endl;
+	  return false;
+	}
+	::curl_easy_setopt( curl, CURLOPT_URL, media::MediaCurl::clearQueryString( url ).asString().c_str() );
+	if ( server_r.settings.timeout() )
+	{
+	  // MediaCurl checks the transfer timeout in its progress callback
+	  ::curl_easy_setopt( curl, CURLOPT_LOW_SPEED_LIMIT, 1L );
+	  ::curl_easy_setopt( curl, CURLOPT_LOW_SPEED_TIME, server_r.settings.timeout() );
+	}
+	::curl_easy_setopt( curl, CURLOPT_WRITEFUNCTION, writeCB );
+	::curl_easy_setopt( curl, CURLOPT_WRITEDATA, &data );
+	::curl_easy_setopt( curl, CURLOPT_NOPROGRESS, 0L );
+	::curl_easy_setopt( curl, CURLOPT_PROGRESSFUNCTION, progressCB );
+	::curl_easy_setopt( curl, CURLOPT_PROGRESSDATA, &_stop );
+
+	CURLcode res = ::curl_easy_perform( curl );
+	ok = ( res == CURLE_OK && ::fflush( file ) == 0 );
+	if ( ! ok )
+	{
+	  MIL << "Prefetch failed: " << url << ": " << ::curl_easy_strerror( res ) << endl;
+	  _received -= data.written;	// progress of the next try starts over
+	}
+	else if ( job_r.size && url.schemeIsDownloading() )	// a real transfer of known size
+	{
+	  double seconds = 0;
+	  ::curl_easy_getinfo( curl, CURLINFO_TOTAL_TIME, &seconds );
+	  applydeltarpm::noteDownload( job_r.size, seconds );
+	}
+      }
+
+      if ( ok )
+      {
+	written_r = hashing ? CheckSum( job_r.checksum.type(), digest.digest() )
+	                    : CheckSum( job_r.checksum.type(), std::ifstream( tmp_r.c_str() ) );
+	if ( job_r.checksum != written_r )
+	{
+	  WAR << "Prefetch checksum mismatch: " << url << endl;
+	  ok = false;
+	}
+	else
+	  DBG << "Prefetched " << url << endl;
+      }
+      return ok;
+    }
+
+    bool CommitPackageCachePrefetch::apply( const Job & job_r )
+    {
+      AutoDispose<const Pathname> delta( job_r.delta.dest, filesystem::unlink );
+      Pathname tmp( job_r.dest.extend( ".prefetch" ) );
+
+      typedef std::chrono::steady_clock Clock;
+      Clock::time_point start( Clock::now() );
+      if ( ! ( applydeltarpm::check( job_r.sequenceinfo ) && applydeltarpm::provide( job_r.delta.dest, tmp ) ) )
+      {
+	MIL << "Prefetch failed: applydeltarpm " << job_r.delta.path << endl;
+	return false;
+      }
+      applydeltarpm::noteApply( job_r.size, std::chrono::duration<double>( Clock::now() - start ).count() );
+
+      CheckSum built( job_r.checksum.type(), std::ifstream( tmp.c_str() ) );
+      if ( job_r.checksum != built || filesystem::rename( tmp, job_r.dest ) != 0 )
+      {
+	WAR << "Prefetch failed: rpm re-created from " << job_r.delta.path << " does not match" << endl;
+	filesystem::unlink( tmp );
+	return false;
+      }
+      filesystem::rememberChecksum( job_r.dest, built );
+      _received += job_r.size - job_r.delta.size;	// progress as if the rpm was downloaded
+      DBG << "Prefetched " << job_r.path << " from " << job_r.delta.path << endl;
+      return true;
+    }
+
+  } // namespace target
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
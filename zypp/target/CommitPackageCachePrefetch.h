@@ -0,0 +1,172 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/target/CommitPackageCachePrefetch.h
+ *
+*/
+#ifndef ZYPP_TARGET_COMMITPACKAGECACHEPREFETCH_H
+#define ZYPP_TARGET_COMMITPACKAGECACHEPREFETCH_H
+
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+
+#include "zypp/ByteCount.h"
+#include "zypp/CheckSum.h"
+#include "zypp/RepoInfo.h"
+#include "zypp/target/CommitPackageCacheReadAhead.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace target
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class CommitPackageCachePrefetch
+    /// \brief CommitPackageCache downloading packages ahead in background threads.
+    ///
+    /// When the commit list is set, the packages to install from network
+    /// repositories are queued. Starting with the first request, a
+    /// background thread downloads up to \c lookahead of them ahead of the
+    /// package currently requested by \ref get, bound by a byte budget and
+    /// the free disk space in the packages cache. Downloaded files are
+    /// checksum verified and moved into the repositories package cache.
+    ///
+    /// If the packages are downloaded in advance, \ref prefetch downloads
+    /// all queued packages at once, using up to \c connections worker
+    /// threads limited per host and per repository. Each worker keeps its
+    /// curl handle, so connections to the same server are reused. The
+    /// aggregated progress is sent as \ref media::DownloadProgressReport.
+    ///
+    /// The handles are set up like the media layer does (\ref media::MediaCurl::setupEasyHandle),
+    /// using the repositories url parameters, the system proxy and the
+    /// credentials stored in the \ref media::CredentialManager. If a
+    /// download fails, the repositories other download urls are tried.
+    ///
+    /// Apart from this progress the prefetch is a pure cache warm-up. It
+    /// never asks the user. Whatever fails is silently left to \ref get,
+    /// which provides the package as usual. So error and skip handling is
+    /// unchanged. Packages needing an rpm signature check
+    /// (\ref RepoInfo::pkgGpgCheck) are not prefetched, as a cache hit would
+    /// bypass the check.
+    ///
+    /// If deltarpms are enabled and a delta for an installed base version
+    /// is available, the delta is downloaded instead, unless the full
+    /// download is expected to be faster (\ref applydeltarpm::worthwhile).
+    /// The rpms are re-created by a pool of worker threads, concurrently to
+    /// the downloads.
+    ///////////////////////////////////////////////////////////////////
+    class CommitPackageCachePrefetch : public CommitPackageCacheReadAhead
+    {
+    public:
+      /** Download limits. */
+      struct Limits
+      {
+	unsigned lookahead;		///< packages to download in the background (0 disables it)
+	ByteCount budget;		///< max. size of packages downloaded in the background
+	unsigned connections;		///< max. concurrent downloads in \ref prefetch (0 disables it)
+	unsigned connectionsPerHost;	///< max. concurrent downloads from one host (0 is unlimited)
+	unsigned connectionsPerRepo;	///< max. concurrent downloads from one repository (0 is unlimited)
+      };
+
+    public:
+      CommitPackageCachePrefetch( const PackageProvider & packageProvider_r, const Limits & limits_r );
+
+      /** Dtor stops the download thread and removes unused prefetched files. */
+      virtual ~CommitPackageCachePrefetch();
+
+    public:
+      /** Queue the packages to prefetch. */
+      virtual void setCommitList( std::vector<sat::Solvable> commitList_r );
+
+      /** Download all queued packages concurrently and wait for them.
+       * \throws AbortRequestException if the user aborted the download.
+       */
+      virtual void prefetch();
+
+      /** Provide the package. Waits for a running prefetch of the package.
+       * The first call starts the background download.
+       */
+      virtual ManagedFile get( const PoolItem & citem_r );
+
+    private:
+      /** A repository url and its transfer settings. */
+      struct Server;
+      typedef std::shared_ptr<const Server> ServerPtr;
+
+      /** A file to download (plain data, the threads must not access the pool). */
+      struct Download
+      {
+	std::vector<ServerPtr> servers;	///< the repositories download urls, tried in order
+	Pathname path;		///< file path below the servers url
+	Pathname dest;		///< where to store the file
+	CheckSum checksum;
+	ByteCount size;
+      };
+
+      /** A package to prefetch. */
+      struct Job : public Download
+      {
+	enum State { PENDING, RUNNING, DONE, FAILED, SKIPPED };
+
+	std::string host;	///< for the per host limit (the first servers host)
+	std::string repo;	///< for the per repository limit
+	bool keepPackages;
+	State state;
+	bool handedOver;	///< \ref get was called for it
+	Download delta;		///< deltarpm to re-create the package from (if url is not empty)
+	std::string sequenceinfo;	///< of the deltas base version
+      };
+
+      void startWorkers( unsigned count_r );
+      void stopWorkers();
+      void worker();
+      void applyWorker();
+      unsigned nextStartable() const;
+      std::vector<ServerPtr> servers( const RepoInfo & info_r );
+      bool fetch( void * curl_r, const Download & download_r );
+      bool fetchFrom( void * curl_r, const Server & server_r, const Download & download_r, const Pathname & tmp_r, CheckSum & written_r );
+      bool apply( const Job & job_r );
+
+    private:
+      Limits _limits;
+      bool _advance;		///< \ref prefetch is running
+
+      std::vector<Job> _jobs;
+      std::unordered_map<sat::detail::SolvableIdType,unsigned> _jobIndex;
+      unsigned _next;		///< next job to start
+      unsigned _consumed;	///< jobs before this index were requested by \ref get
+      ByteCount _pending;	///< size of prefetched but not yet requested packages
+      std::unordered_map<std::string,unsigned> _hostConnections;
+      std::unordered_map<std::string,unsigned> _repoConnections;
+      std::unordered_map<std::string,std::vector<ServerPtr>> _servers;	///< per repository (alias)
+      unsigned _running;	///< worker threads not yet done
+      unsigned _fetching;	///< download threads not yet done
+      bool _haveDeltas;		///< some job may use a deltarpm
+      unsigned _applyWorkers;	///< threads re-creating rpms from deltas
+      std::deque<unsigned> _applyQueue;	///< jobs with the delta downloaded
+      std::atomic<bool> _stop;
+      std::atomic<long long> _received;	///< bytes received (for progress)
+
+      std::mutex _mutex;
+      std::condition_variable _cv;
+      std::vector<std::thread> _threads;
+    };
+    ///////////////////////////////////////////////////////////////////
+
+  } // namespace target
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_TARGET_COMMITPACKAGECACHEPREFETCH_H
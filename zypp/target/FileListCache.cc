@@ -0,0 +1,289 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/target/FileListCache.cc
+ *
+*/
+#include "zypp/target/rpm/librpm.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "zypp/base/Logger.h"
+#include "zypp/base/String.h"
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+#include "zypp/Date.h"
+
+#include "zypp/target/FileListCache.h"
+#include "zypp/target/rpm/librpmDb.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace target
+  {
+    /** Cache file header. */
+    struct FileListCache::FileHead
+    {
+      char magic[8];
+      uint64_t count;	///< number of \ref Entry following the header
+    };
+
+    /** Cache file index entry (sorted by hdrNum). */
+    struct FileListCache::Entry
+    {
+      uint32_t hdrNum;
+      uint32_t identSize;
+      uint64_t identOffset;
+      uint64_t blobOffset;
+      uint64_t blobSize;
+    };
+
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      const char fileMagic[8] = { 'Z', 'Y', 'P', 'P', 'F', 'L', 'C', '1' };
+
+      /** The tags libsolv reads when iterating a file list (plus the package NEVRA). */
+      const std::vector<rpm::BinHeader::tag> & fileListTags()
+      {
+	static const std::vector<rpm::BinHeader::tag> tags = {
+	  RPMTAG_NAME, RPMTAG_EPOCH, RPMTAG_VERSION, RPMTAG_RELEASE, RPMTAG_ARCH,
+	  RPMTAG_OLDFILENAMES, RPMTAG_BASENAMES, RPMTAG_DIRNAMES, RPMTAG_DIRINDEXES,
+	  RPMTAG_FILEMODES, RPMTAG_FILEFLAGS, RPMTAG_FILESTATES, RPMTAG_FILECOLORS,
+	  RPMTAG_FILESIZES, RPMTAG_LONGFILESIZES, RPMTAG_FILEDIGESTS, RPMTAG_FILEDIGESTALGO,
+	  RPMTAG_FILELINKTOS, RPMTAG_FILEUSERNAME, RPMTAG_FILEGROUPNAME,
+	};
+	return tags;
+      }
+
+      /** Wrap \a header_r as rpm file, as expected by \c rpm_byfp. */
+      std::string rpmFileBlob( const std::string & header_r )
+      {
+	if ( header_r.empty() )
+	  return std::string();
+	// lead (magic and signature type 5) and an empty signature header
+	std::string ret( 96 + 16, '\0' );
+	const char leadMagic[] = { '\xed', '\xab', '\xee', '\xdb' };
+	const char sigMagic[]  = { '\x8e', '\xad', '\xe8', '\x01' };
+	ret.replace( 0, sizeof(leadMagic), leadMagic, sizeof(leadMagic) );
+	ret[79] = 5;
+	ret.replace( 96, sizeof(sigMagic), sigMagic, sizeof(sigMagic) );
+	ret += header_r;
+	return ret;
+      }
+
+      /** The file list header of \a hdrNum_r read from the rpmdb. */
+      std::string rpmdbHeader( unsigned hdrNum_r )
+      {
+	rpm::librpmDb::db_const_iterator it;
+	if ( it.findByHdrNum( hdrNum_r ) && *it )
+	  return (*it)->exportTags( fileListTags() );
+	return std::string();
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    FileListCache::FileListCache( const Pathname & file_r, Installed installed_r, HeaderReader reader_r )
+    : _file( file_r )
+    , _installed( std::move(installed_r) )
+    , _reader( reader_r ? std::move(reader_r) : HeaderReader( &rpmdbHeader ) )
+    , _mapSize( 0 )
+    , _entries( nullptr )
+    , _count( 0 )
+    {
+      AutoDispose<int> fd( ::open( _file.c_str(), O_RDONLY|O_CLOEXEC ), ::close );
+      if ( fd < 0 )
+      {
+	fd.resetDispose();
+	MIL << "No file list cache " << _file << endl;
+	return;
+      }
+
+      struct stat st;
+      if ( ::fstat( fd, &st ) != 0 || size_t(st.st_size) < sizeof(FileHead) )
+      {
+	WAR << "Ignore invalid file list cache " << _file << endl;
+	return;
+      }
+      size_t size = st.st_size;
+      void * map = ::mmap( nullptr, size, PROT_READ, MAP_SHARED, fd, 0 );
+      if ( map == MAP_FAILED )
+      {
+	WAR << "Can't map file list cache " << _file << endl;
+	return;
+      }
+      _map = AutoDispose<void*>( map, [size]( void * p ) { ::munmap( p, size ); } );
+      _mapSize = size;
+
+      const FileHead * head = reinterpret_cast<const FileHead *>(map);
+      if ( ::memcmp( head->magic, fileMagic, sizeof(fileMagic) ) != 0
+	|| head->count > ( _mapSize - sizeof(FileHead) ) / sizeof(Entry) )
+      {
+	WAR << "Ignore invalid file list cache " << _file << endl;
+	return;
+      }
+      _entries = reinterpret_cast<const Entry *>( reinterpret_cast<const char *>(map) + sizeof(FileHead) );
+      _count = head->count;
+      MIL << "File list cache " << _file << ": " << _count << " packages" << endl;
+    }
+
+    FileListCache::~FileListCache()
+    {}
+
+    std::string FileListCache::ident( sat::Solvable solv_r )
+    {
+      return str::Str() << solv_r.name() << '-' << solv_r.edition() << '.' << solv_r.arch()
+                        << '@' << Date::ValueType(solv_r.buildtime());
+    }
+
+    const FileListCache::Entry * FileListCache::find( unsigned hdrNum_r ) const
+    {
+      const Entry * end = _entries + _count;
+      const Entry * it = std::lower_bound( _entries, end, hdrNum_r,
+					   []( const Entry & lhs, unsigned rhs ) { return lhs.hdrNum < rhs; } );
+      return( it != end && it->hdrNum == hdrNum_r ? it : nullptr );
+    }
+
+    bool FileListCache::valid( const Entry & entry_r, const std::string & ident_r ) const
+    {
+      if ( entry_r.identOffset > _mapSize || entry_r.identSize > _mapSize - entry_r.identOffset
+	|| entry_r.blobOffset > _mapSize || entry_r.blobSize > _mapSize - entry_r.blobOffset )
+	return false;
+      const char * base = reinterpret_cast<const char *>(_map.value());
+      return( ident_r.size() == entry_r.identSize
+	      && ::memcmp( base + entry_r.identOffset, ident_r.data(), entry_r.identSize ) == 0 );
+    }
+
+    FileListCache::Blob FileListCache::get( unsigned hdrNum_r )
+    {
+      auto inst = _installed.find( hdrNum_r );
+      if ( inst == _installed.end() )
+	return Blob();
+
+      auto added = _added.find( hdrNum_r );
+      if ( added != _added.end() )
+	return Blob( added->second.data(), added->second.size() );
+
+      const Entry * entry = find( hdrNum_r );
+      if ( entry && valid( *entry, inst->second ) )
+	return Blob( reinterpret_cast<const char *>(_map.value()) + entry->blobOffset, entry->blobSize );
+
+      // cache miss: read from the rpmdb
+      std::string blob( rpmFileBlob( _reader( hdrNum_r ) ) );
+      if ( blob.empty() )
+      {
+	WAR << "Can't read rpmdb header " << hdrNum_r << " (" << inst->second << ")" << endl;
+	return Blob();
+      }
+      std::string & ret( _added[hdrNum_r] );	// node based: stays valid
+      ret.swap( blob );
+      return Blob( ret.data(), ret.size() );
+    }
+
+    void FileListCache::save()
+    {
+      struct Out
+      {
+	unsigned hdrNum;
+	const std::string * ident;
+	const char * blob;
+	size_t blobSize;
+      };
+      std::vector<Out> out;
+      out.reserve( _installed.size() );
+
+      // Keep the old entries still valid
+      const char * base = reinterpret_cast<const char *>(_map.value());
+      for ( const Entry * entry = _entries; entry != _entries + _count; ++entry )
+      {
+	auto inst = _installed.find( entry->hdrNum );
+	if ( inst != _installed.end() && ! _added.count( entry->hdrNum ) && valid( *entry, inst->second ) )
+	  out.push_back( { entry->hdrNum, &inst->second, base + entry->blobOffset, entry->blobSize } );
+      }
+      unsigned dropped = _count - out.size();
+      if ( _added.empty() && ! dropped )
+	return;	// up to date
+
+      for ( const auto & added : _added )
+	out.push_back( { added.first, &_installed[added.first], added.second.data(), added.second.size() } );
+      std::sort( out.begin(), out.end(), []( const Out & lhs, const Out & rhs ) { return lhs.hdrNum < rhs.hdrNum; } );
+
+      // Header, index, then identities and blobs
+      FileHead head;
+      ::memcpy( head.magic, fileMagic, sizeof(fileMagic) );
+      head.count = out.size();
+      std::vector<Entry> entries;
+      entries.reserve( out.size() );
+      uint64_t offset = sizeof(FileHead) + out.size() * sizeof(Entry);
+      for ( const Out & el : out )
+      {
+	Entry entry;
+	entry.hdrNum		= el.hdrNum;
+	entry.identSize		= el.ident->size();
+	entry.identOffset	= offset;
+	offset += entry.identSize;
+	entry.blobOffset	= offset;
+	entry.blobSize		= el.blobSize;
+	offset += entry.blobSize;
+	entries.push_back( entry );
+      }
+
+      filesystem::TmpFile tmpfile( filesystem::TmpFile::makeSibling( _file ) );
+      if ( ! tmpfile )
+      {
+	WAR << "Can't create temporary file for " << _file << endl;
+	return;
+      }
+      {
+	AutoDispose<FILE*> fp( ::fopen( tmpfile.path().c_str(), "we" ), ::fclose );
+	if ( fp == nullptr )
+	{
+	  fp.resetDispose();
+	  WAR << "Can't write " << tmpfile.path() << endl;
+	  return;
+	}
+	bool ok = ( ::fwrite( &head, sizeof(head), 1, fp ) == 1 );
+	if ( ok && ! entries.empty() )
+	  ok = ( ::fwrite( entries.data(), sizeof(Entry), entries.size(), fp ) == entries.size() );
+	for ( auto it = out.begin(); ok && it != out.end(); ++it )
+	{
+	  ok = ( ::fwrite( it->ident->data(), 1, it->ident->size(), fp ) == it->ident->size()
+	      && ::fwrite( it->blob, 1, it->blobSize, fp ) == it->blobSize );
+	}
+	if ( ! ok || ::fflush( fp ) != 0 )
+	{
+	  WAR << "Can't write " << tmpfile.path() << endl;
+	  return;
+	}
+      }
+      if ( filesystem::rename( tmpfile, _file ) != 0 )
+      {
+	WAR << "Can't move " << tmpfile.path() << " to " << _file << endl;
+	return;
+      }
+      filesystem::chmod( _file, 0644 );
+      MIL << "Updated file list cache " << _file << ": " << out.size() << " packages (+" << _added.size() << " -" << dropped << ")" << endl;
+    }
+
+  } // namespace target
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,117 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/target/FileListCache.h
+ *
+*/
+#ifndef ZYPP_TARGET_FILELISTCACHE_H
+#define ZYPP_TARGET_FILELISTCACHE_H
+
+#include <string>
+#include <unordered_map>
+#include <functional>
+
+#include "zypp/base/NonCopyable.h"
+#include "zypp/AutoDispose.h"
+#include "zypp/Pathname.h"
+#include "zypp/sat/Solvable.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace target
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class FileListCache
+    /// \brief On-disk cache of the installed packages file list headers.
+    ///
+    /// Used by the file conflict check to avoid reading the same headers
+    /// from the rpmdb on every commit. For each installed package the
+    /// cache stores an rpm header reduced to the file list tags, wrapped
+    /// as an rpm file, so it can be passed to libsolvs \c rpm_byfp.
+    ///
+    /// Entries are keyed by the rpmdb header number and are valid only
+    /// as long as the package identity (name, edition, arch and buildtime)
+    /// stored with them matches the installed package. The cache file is
+    /// memory mapped. Missing or outdated entries are read from the rpmdb
+    /// and written back by \ref save, which also drops the entries of
+    /// packages no longer installed.
+    ///////////////////////////////////////////////////////////////////
+    class FileListCache : private base::NonCopyable
+    {
+    public:
+      /** rpmdb header number to installed package identity. */
+      typedef std::unordered_map<unsigned,std::string> Installed;
+
+      /** Read the file list header (as exported by \ref rpm::BinHeader::exportTags)
+       * of an rpmdb header number; empty if it is not readable.
+       */
+      typedef std::function<std::string(unsigned)> HeaderReader;
+
+      /** A cached rpm file (lead, empty signature and reduced header). */
+      struct Blob
+      {
+	Blob( const char * data_r = nullptr, size_t size_r = 0 )
+	: data( data_r ), size( size_r )
+	{}
+	explicit operator bool() const
+	{ return data; }
+
+	const char * data;
+	size_t size;
+      };
+
+    public:
+      /** Ctor mapping the cache \a file_r (if it exists).
+       * Cache misses are read by \a reader_r, by default from the rpmdb.
+       */
+      FileListCache( const Pathname & file_r, Installed installed_r, HeaderReader reader_r = HeaderReader() );
+
+      /** Dtor */
+      ~FileListCache();
+
+    public:
+      /** The file list headers of the installed package \a hdrNum_r.
+       * On a cache miss they are read from the rpmdb. Empty if the package
+       * is not installed or not readable. The data stay valid as long as
+       * the cache exists.
+       */
+      Blob get( unsigned hdrNum_r );
+
+      /** Write the cache file if entries were added or dropped. */
+      void save();
+
+    public:
+      /** The identity of an installed package as checked by the cache. */
+      static std::string ident( sat::Solvable solv_r );
+
+    private:
+      struct FileHead;
+      struct Entry;
+
+      const Entry * find( unsigned hdrNum_r ) const;
+      bool valid( const Entry & entry_r, const std::string & ident_r ) const;
+
+    private:
+      Pathname _file;
+      Installed _installed;
+      HeaderReader _reader;
+      AutoDispose<void*> _map;
+      size_t _mapSize;
+      const Entry * _entries;
+      size_t _count;
+      std::unordered_map<unsigned,std::string> _added;	///< entries read from the rpmdb
+    };
+    ///////////////////////////////////////////////////////////////////
+
+  } // namespace target
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_TARGET_FILELISTCACHE_H
@@ -0,0 +1,153 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/target/RpmHeaderPreload.cc
+ *
+*/
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+#include "zypp/AutoDispose.h"
+#include "zypp/target/RpmHeaderPreload.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace target
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      /** Size of the rpm header structure at \a p_r, or 0 if there is none within \a avail_r bytes. */
+      inline size_t rpmHeaderSize( const unsigned char * p_r, size_t avail_r )
+      {
+	static const unsigned char magic[] = { 0x8e, 0xad, 0xe8, 0x01 };
+	if ( avail_r < 16 || ::memcmp( p_r, magic, sizeof(magic) ) != 0 )
+	  return 0;
+	size_t il = ( size_t(p_r[8])  << 24 ) | ( size_t(p_r[9])  << 16 ) | ( size_t(p_r[10]) << 8 ) | p_r[11];
+	size_t dl = ( size_t(p_r[12]) << 24 ) | ( size_t(p_r[13]) << 16 ) | ( size_t(p_r[14]) << 8 ) | p_r[15];
+	if ( il > 0x10000 || dl > 0x10000000 )	// rpms own sanity limits
+	  return 0;
+	size_t ret = 16 + il * 16 + dl;
+	return( ret <= avail_r ? ret : 0 );
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    bool RpmHeaderPreload::readHeaders( const Pathname & file_r, std::string & blob_r )
+    {
+      static const size_t leadSize = 96;
+
+      AutoDispose<int> fd( ::open( file_r.c_str(), O_RDONLY|O_CLOEXEC ), ::close );
+      if ( fd < 0 )
+      {
+	fd.resetDispose();
+	return false;
+      }
+      struct stat st;
+      if ( ::fstat( fd, &st ) != 0 || size_t(st.st_size) <= leadSize )
+	return false;
+
+      size_t size = st.st_size;
+      void * map = ::mmap( nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+      if ( map == MAP_FAILED )
+	return false;
+      AutoDispose<void*> unmap( map, [size]( void * p ) { ::munmap( p, size ); } );
+
+      const unsigned char * data = reinterpret_cast<const unsigned char *>(map);
+      size_t sigSize = rpmHeaderSize( data + leadSize, size - leadSize );
+      if ( ! sigSize )
+	return false;
+      size_t hdrOffset = leadSize + ( ( sigSize + 7 ) & ~size_t(7) );	// signature is padded to 8
+      if ( hdrOffset >= size )
+	return false;
+      size_t hdrSize = rpmHeaderSize( data + hdrOffset, size - hdrOffset );
+      if ( ! hdrSize )
+	return false;
+
+      blob_r.assign( reinterpret_cast<const char *>(data), hdrOffset + hdrSize );
+      return true;
+    }
+
+    void RpmHeaderPreload::load( unsigned jobs_r, ProgressData & progress_r )
+    {
+      std::vector<Header*> todo;
+      todo.reserve( _headers.size() );
+      for ( auto & el : _headers )
+	todo.push_back( &el.second );
+      if ( jobs_r > todo.size() )
+	jobs_r = todo.size();
+      if ( ! jobs_r )
+	return;
+
+      std::atomic<unsigned> next( 0 );
+      std::atomic<bool> abort( false );
+      unsigned done = 0;
+      std::mutex mutex;
+      std::condition_variable cv;
+
+      auto worker = [&]() {
+	for ( unsigned idx = next++; idx < todo.size() && ! abort; idx = next++ )
+	{
+	  if ( ! readHeaders( todo[idx]->file, todo[idx]->blob ) )
+	    todo[idx]->blob.clear();
+	  {
+	    std::lock_guard<std::mutex> lock( mutex );
+	    ++done;
+	  }
+	  cv.notify_one();
+	}
+      };
+
+      std::vector<std::thread> workers;
+      for ( unsigned i = 0; i < jobs_r; ++i )
+	workers.push_back( std::thread( worker ) );
+      try
+      {
+	ProgressData::value_type base = progress_r.val();
+	std::unique_lock<std::mutex> lock( mutex );
+	while ( true )
+	{
+	  progress_r.set( base + done );	// may throw on user abort
+	  if ( done == todo.size() )
+	    break;
+	  cv.wait_for( lock, std::chrono::milliseconds( 100 ) );
+	}
+      }
+      catch ( ... )
+      {
+	abort = true;
+	for ( std::thread & t : workers )
+	  t.join();
+	throw;
+      }
+      for ( std::thread & t : workers )
+	t.join();
+    }
+
+    const RpmHeaderPreload::Header * RpmHeaderPreload::find( sat::detail::IdType id_r ) const
+    {
+      auto it = _headers.find( id_r );
+      return( it != _headers.end() && ! it->second.blob.empty() ? &it->second : nullptr );
+    }
+
+  } // namespace target
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
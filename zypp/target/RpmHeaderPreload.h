@@ -0,0 +1,80 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/target/RpmHeaderPreload.h
+ *
+*/
+#ifndef ZYPP_TARGET_RPMHEADERPRELOAD_H
+#define ZYPP_TARGET_RPMHEADERPRELOAD_H
+
+#include <string>
+#include <unordered_map>
+
+#include "zypp/base/NonCopyable.h"
+#include "zypp/sat/detail/PoolMember.h"
+#include "zypp/Pathname.h"
+#include "zypp/ProgressData.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace target
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class RpmHeaderPreload
+    /// \brief The headers of rpm files, as far as libsolvs \c rpm_byfp reads them.
+    ///
+    /// Used by the file conflict check to read the new packages headers
+    /// in parallel ahead. Only the lead, the signature and the main header
+    /// are loaded into memory, the payload is not touched.
+    ///////////////////////////////////////////////////////////////////
+    class RpmHeaderPreload : private base::NonCopyable
+    {
+    public:
+      /** A preloaded rpm file. */
+      struct Header
+      {
+	Pathname file;
+	std::string blob;	///< lead, signature and main header; empty if not loaded
+      };
+
+    public:
+      /** Queue \a file_r to be loaded as \a id_r. */
+      void add( sat::detail::IdType id_r, const Pathname & file_r )
+      { _headers[id_r].file = file_r; }
+
+      /** Number of queued files. */
+      size_t size() const
+      { return _headers.size(); }
+
+      /** Load the queued files using up to \a jobs_r threads.
+       * \a progress_r is advanced by one per file. An exception thrown
+       * by its receiver (user abort) stops the threads and is rethrown.
+       */
+      void load( unsigned jobs_r, ProgressData & progress_r );
+
+      /** The loaded headers of \a id_r (\c nullptr if not loaded). */
+      const Header * find( sat::detail::IdType id_r ) const;
+
+    public:
+      /** Read the leading part of the rpm \a file_r up to the end of its main header.
+       * \return \c false if \a file_r is not an rpm.
+       */
+      static bool readHeaders( const Pathname & file_r, std::string & blob_r );
+
+    private:
+      std::unordered_map<sat::detail::IdType,Header> _headers;
+    };
+    ///////////////////////////////////////////////////////////////////
+
+  } // namespace target
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_TARGET_RPMHEADERPRELOAD_H
@@ -843,7 +843,7 @@ namespace zypp
       bool build_rpm_solv = true;
       // lets see if the rpm solv cache exists
 
-      RepoStatus rpmstatus( RepoStatus(_root/"var/lib/rpm/Name") && RepoStatus(_root/"etc/products.d") );
+      RepoStatus rpmstatus( rpmDbStatus() );
 
       bool solvexisted = PathInfo(rpmsolv).isExist();
       if ( solvexisted )
@@ -1173,6 +1173,18 @@ namespace zypp
       }
       MIL << "Todo: " << result << endl;
 
+      // Remember whether the @System solv file matches the rpmdb. If so (and
+      // /etc/products.d stays unchanged) it can be patched after commit rather
+      // than being rebuilt from scratch.
+      bool cacheUpToDate = false;
+      RepoStatus productsStatus;
+      if ( ! policy_r.dryRun() )
+      {
+        productsStatus = productsDirStatus();
+        Pathname base = solvfilesPath();
+        cacheUpToDate = ( PathInfo(base/"solv").isFile() && RepoStatus::fromCookieFile( base/"cookie" ) == rpmDbStatus() );
+      }
+
       ///////////////////////////////////////////////////////////////////
       // Prepare execution of commit plugins:
       ///////////////////////////////////////////////////////////////////
@@ -1269,10 +1281,23 @@ namespace zypp
 	// Prepare the package cache. Pass all items requiring download.
         CommitPackageCache packageCache;
 	packageCache.setCommitList( steps.begin(), steps.end() );
+	packageCache.verifySignatures();
 
         bool miss = false;
         if ( policy_r.downloadMode() != DownloadAsNeeded )
         {
+          // Download what can be downloaded in parallel first.
+          try
+          {
+            packageCache.prefetch();
+          }
+          catch ( const AbortRequestException & exp )
+          {
+            ZYPP_CAUGHT( exp );
+            WAR << "commit cache prefetch aborted by the user" << endl;
+            ZYPP_THROW( TargetAbortedException( ) );
+          }
+
           // Preload the cache. Until now this means pre-loading all packages.
           // Once DownloadInHeaps is fully implemented, this will change and
           // we may actually have more than one heap.
@@ -1365,7 +1390,8 @@ namespace zypp
       ///////////////////////////////////////////////////////////////////
       if ( ! policy_r.dryRun() )
       {
-        buildCache();
+        if ( ! ( cacheUpToDate && productsStatus == productsDirStatus() && updateCache( result ) ) )
+          buildCache();
       }
 
       MIL << "TargetImpl::commit(<pool>, " << policy_r << ") returns: " << result << endl;
@@ -1429,6 +1455,14 @@ namespace zypp
           Package::constPtr p = citem->asKind<Package>();
           if ( citem.status().isToBeInstalled() )
           {
+	    if ( policy_r.rpmInstallBatchSize() > 1 && ! policy_r.dryRun() )
+	    {
+	      if ( ! commitInstallBatch( policy_r, packageCache_r, step, steps.end(),
+					 successfullyInstalledPackages, abort, boost::ref(attemptToModify) ) )
+		break;
+	      continue;
+	    }
+
             ManagedFile localfile;
             try
             {
@@ -1666,6 +1700,166 @@ namespace zypp
       }
     }
 
+
+    bool TargetImpl::commitInstallBatch( const ZYppCommitPolicy & policy_r,
+					 CommitPackageCache & packageCache_r,
+					 ZYppCommitResult::TransactionStepList::iterator & step_r,
+					 ZYppCommitResult::TransactionStepList::iterator end_r,
+					 std::vector<sat::Solvable> & successfullyInstalledPackages_r,
+					 bool & abort_r,
+					 const function<void()> & attemptToModify_r )
+    {
+      struct BatchEntry
+      {
+	ZYppCommitResult::TransactionStepList::iterator step;
+	PoolItem citem;
+	ManagedFile localfile;
+	shared_ptr<RpmInstallPackageReceiver> progress;
+	bool success;
+      };
+      std::vector<BatchEntry> batch;
+      bool stop = false;	// stop collecting (and the commit after this batch)
+
+      // Collect and download the package installs starting at step_r.
+      for ( ZYppCommitResult::TransactionStepList::iterator step = step_r;
+	    step != end_r && batch.size() < policy_r.rpmInstallBatchSize();
+	    ++step )
+      {
+	PoolItem citem( *step );
+	if ( ! citem->isKind<Package>() )
+	  break;
+	if ( step->stepType() == sat::Transaction::TRANSACTION_IGNORE )
+	{
+	  // obsoleted (by rpm), no additional action is needed.
+	  step->stepStage( sat::Transaction::STEP_DONE );
+	  step_r = step;
+	  continue;
+	}
+	if ( ! citem.status().isToBeInstalled() )
+	  break;
+
+	step_r = step;
+	ManagedFile localfile;
+	try
+	{
+	  localfile = packageCache_r.get( citem );
+	}
+	catch ( const AbortRequestException &e )
+	{
+	  WAR << "commit aborted by the user" << endl;
+	  abort_r = stop = true;
+	  step->stepStage( sat::Transaction::STEP_ERROR );
+	  break;
+	}
+	catch ( const SkipRequestException &e )
+	{
+	  ZYPP_CAUGHT( e );
+	  WAR << "Skipping package " << citem << " in commit" << endl;
+	  step->stepStage( sat::Transaction::STEP_ERROR );
+	  continue;
+	}
+	catch ( const Exception &e )
+	{
+	  ZYPP_CAUGHT( e );
+	  INT << "Unexpected Error: Skipping package " << citem << " in commit" << endl;
+	  step->stepStage( sat::Transaction::STEP_ERROR );
+	  continue;
+	}
+
+	BatchEntry entry;
+	entry.step = step;
+	entry.citem = citem;
+	entry.localfile = localfile;
+	entry.progress.reset( new RpmInstallPackageReceiver( citem.resolvable() ) );
+	entry.progress->tryLevel( target::rpm::InstallResolvableReport::RPM_NODEPS_FORCE );
+	entry.success = false;
+	batch.push_back( entry );
+      }
+
+      if ( batch.empty() )
+	return ! stop;
+
+      MIL << "Installing batch of " << batch.size() << " packages" << endl;
+
+      // See the single package install in commit for the flags in use.
+      rpm::RpmInstFlags flags( policy_r.rpmInstFlags() & rpm::RPMINST_JUSTDB );
+      flags |= rpm::RPMINST_NODEPS;
+      flags |= rpm::RPMINST_FORCE;
+      if (policy_r.rpmExcludeDocs()) flags |= rpm::RPMINST_EXCLUDEDOCS;
+      if (policy_r.rpmNoSignature()) flags |= rpm::RPMINST_NOSIGNATURE;
+
+      std::vector<rpm::RpmDb::InstallItem> items;
+      items.reserve( batch.size() );
+      for ( const BatchEntry & entry : batch )
+	items.push_back( rpm::RpmDb::InstallItem( entry.localfile, entry.citem->asKind<Package>()->multiversionInstall() ) );
+
+      attemptToModify_r();
+      try
+      {
+	rpm().installPackages( items, flags,
+			       [&]( unsigned idx_r ) { batch[idx_r].progress->connect(); },
+			       [&]( unsigned idx_r, bool success_r ) { batch[idx_r].success = success_r; } );
+      }
+      catch ( const rpm::RpmException & excpt_r )
+      {
+	// The transaction could not be set up, nothing was installed.
+	ZYPP_CAUGHT( excpt_r );
+	WAR << "Batch install failed, installing the packages one by one." << endl;
+	for ( BatchEntry & entry : batch )
+	{
+	  entry.progress->connect();
+	  try
+	  {
+	    rpm().installPackage( entry.localfile, ( entry.citem->asKind<Package>()->multiversionInstall() ? flags|rpm::RPMINST_NOUPGRADE : flags ) );
+	    entry.success = true;
+	  }
+	  catch ( const Exception & excpt_r )
+	  {
+	    ZYPP_CAUGHT( excpt_r );
+	    break;
+	  }
+	  if ( entry.progress->aborted() )
+	    break;
+	}
+      }
+
+      // Account the batch in commit order.
+      for ( BatchEntry & entry : batch )
+      {
+	entry.progress->disconnect();
+	if ( entry.success )
+	  HistoryLog().install( entry.citem );	// rpm installed it, even if aborted afterwards (like the single package install)
+
+	if ( entry.success && ! entry.progress->aborted() )
+	{
+	  if ( entry.citem.isNeedreboot() ) {
+	    auto rebootNeededFile = root() / "/var/run/reboot-needed";
+	    if ( filesystem::assert_file( rebootNeededFile ) == EEXIST)
+	      filesystem::touch( rebootNeededFile );
+	  }
+	  entry.citem.status().resetTransact( ResStatus::USER );
+	  successfullyInstalledPackages_r.push_back( entry.citem.satSolvable() );
+	  entry.step->stepStage( sat::Transaction::STEP_DONE );
+	}
+	else
+	{
+	  entry.localfile.resetDispose(); // keep the package file in the cache
+	  if ( entry.progress->aborted() )
+	  {
+	    WAR << "commit aborted by the user" << endl;
+	    abort_r = true;
+	  }
+	  else
+	  {
+	    WAR << "Install failed: " << entry.citem << endl;
+	  }
+	  entry.step->stepStage( sat::Transaction::STEP_ERROR );
+	  stop = true;
+	}
+      }
+      return ! stop;
+    }
+
     ///////////////////////////////////////////////////////////////////
 
     rpm::RpmDb & TargetImpl::rpm()
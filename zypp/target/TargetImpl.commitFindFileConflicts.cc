@@ -21,6 +21,7 @@ extern "C"
 #include <iostream>
 #include <unordered_set>
 #include <string>
+#include <thread>
 
 #include "zypp/base/LogTools.h"
 #include "zypp/base/Gettext.h"
@@ -33,6 +34,8 @@ extern "C"
 
 #include "zypp/target/TargetImpl.h"
 #include "zypp/target/CommitPackageCache.h"
+#include "zypp/target/FileListCache.h"
+#include "zypp/target/RpmHeaderPreload.h"
 
 #include "zypp/ZYppCallbacks.h"
 
@@ -47,11 +50,38 @@ namespace zypp
     ///////////////////////////////////////////////////////////////////
     namespace
     {
+      /** The rpmdb header number of an installed package (0 if unknown). */
+      inline unsigned rpmdbid( const sat::Solvable & solv_r )
+      {
+	Solvable * s = solv_r.get();
+	if ( ! s->repo->rpmdbid )
+	  return 0;
+	return s->repo->rpmdbid[solv_r.id() - s->repo->start];
+      }
+
+      /** The installed packages as expected by \ref FileListCache. */
+      FileListCache::Installed installedPackages()
+      {
+	FileListCache::Installed ret;
+	Repository system( sat::Pool::instance().findSystemRepo() );
+	if ( ! system )
+	  return ret;
+	for ( const sat::Solvable & solv : system.solvables() )
+	{
+	  unsigned hdrNum = rpmdbid( solv );
+	  if ( hdrNum )
+	    ret[hdrNum] = FileListCache::ident( solv );
+	}
+	return ret;
+      }
+
       /** libsolv::pool_findfileconflicts callback providing package header. */
       struct FileConflictsCB
       {
-	FileConflictsCB( sat::detail::CPool * pool_r, ProgressData & progress_r )
+	FileConflictsCB( sat::detail::CPool * pool_r, ProgressData & progress_r, const RpmHeaderPreload & headers_r, FileListCache & fileLists_r )
 	: _progress( progress_r )
+	, _headers( headers_r )
+	, _fileLists( fileLists_r )
 	, _state( ::rpm_state_create( pool_r, ::pool_get_rootdir(pool_r) ), ::rpm_state_free )
 	{}
 
@@ -88,16 +118,29 @@ namespace zypp
 	  sat::Solvable solv( id_r );
 	  if ( solv.isSystem() )
 	  {
-	    Solvable * s = solv.get();
-	    if ( ! s->repo->rpmdbid )
-	      return nullptr;
-	    sat::detail::IdType rpmdbid = s->repo->rpmdbid[id_r - s->repo->start];
-	    if ( ! rpmdbid )
+	    unsigned hdrNum = rpmdbid( solv );
+	    if ( ! hdrNum )
 	      return nullptr;
-	    return ::rpm_byrpmdbid( _state, rpmdbid );
+	    FileListCache::Blob blob( _fileLists.get( hdrNum ) );
+	    if ( blob )
+	    {
+	      void * ret = fromMemory( blob.data, blob.size, solv.asString() );
+	      if ( ret )
+		return ret;
+	    }
+	    return ::rpm_byrpmdbid( _state, hdrNum );
 	  }
 	  else
 	  {
+	    const RpmHeaderPreload::Header * header( _headers.find( id_r ) );
+	    if ( header )
+	    {
+	      // parse the preloaded headers from memory
+	      void * ret = fromMemory( header->blob.data(), header->blob.size(), header->file.asString() );
+	      if ( ret )
+		return ret;
+	    }
+
 	    Package::Ptr pkg( make<Package>( solv ) );
 	    if ( ! pkg )
 	      return nullptr;
@@ -109,8 +152,22 @@ namespace zypp
 	  }
 	}
 
+	/** Parse rpm headers (as in an rpm file) from memory. */
+	void * fromMemory( const char * data_r, size_t size_r, const std::string & name_r )
+	{
+	  AutoDispose<FILE*> fp( ::fmemopen( const_cast<char *>(data_r), size_r, "r" ), ::fclose );
+	  if ( fp == nullptr )
+	  {
+	    fp.resetDispose();
+	    return nullptr;
+	  }
+	  return ::rpm_byfp( _state, fp, name_r.c_str() );
+	}
+
       private:
 	ProgressData & _progress;
+	const RpmHeaderPreload & _headers;
+	FileListCache & _fileLists;
 	AutoDispose<void*> _state;
 	std::unordered_set<sat::detail::IdType> _visited;
 	sat::Queue _noFilelist;
@@ -128,13 +185,32 @@ namespace zypp
       if ( ! newpkgs )
 	return;
 
+      // The new packages headers are read from the package cache in
+      // parallel ahead. Pool access is not thread safe, so the cached
+      // locations are looked up here.
+      RpmHeaderPreload headers;
+      for ( int idx = 0; idx < newpkgs; ++idx )
+      {
+	sat::Solvable solv( todo[idx] );
+	if ( solv.isSystem() )
+	  continue;
+	Package::Ptr pkg( make<Package>( solv ) );
+	if ( ! pkg )
+	  continue;
+	Pathname localfile( pkg->cachedLocation() );
+	if ( ! localfile.empty() )
+	  headers.add( todo[idx], localfile );
+      }
+
       try {
 	callback::SendReport<FindFileConflictstReport> report;
-	ProgressData progress( todo.size() );
+	ProgressData progress( headers.size() + todo.size() );
 	if ( ! report->start( progress ) )
 	  ZYPP_THROW( AbortRequestException() );
 
-	FileConflictsCB cb( sat::Pool::instance().get(), progress );
+	// The installed packages file lists are taken from the cache next to the @System solv file.
+	FileListCache fileLists( solvfilesPath() / "filelists", installedPackages() );
+	FileConflictsCB cb( sat::Pool::instance().get(), progress, headers, fileLists );
 	// lambda receives progress trigger and translates into report
 	auto sendProgress = [&]( const ProgressData & progress_r )->bool {
 	  if ( ! report->progress( progress_r, cb.noFilelist() ) )
@@ -146,6 +222,9 @@ namespace zypp
 	};
 	progress.sendTo( sendProgress );
 
+	headers.load( std::max( std::thread::hardware_concurrency(), 1U ), progress );
+	MIL << "Preloaded headers of " << headers.size() << " packages." << endl;
+
 	unsigned count =
 	  ::pool_findfileconflicts( sat::Pool::instance().get(),
 				    todo,
@@ -156,6 +235,7 @@ namespace zypp
 				    &cb );
 	progress.toMax();
 	progress.noSend();
+	fileLists.save();
 
 	(count?WAR:MIL) << "Found " << count << " file conflicts." << endl;
 	if ( ! report->result( progress, cb.noFilelist(), conflicts ) )
@@ -14,6 +14,7 @@
 
 #include <iosfwd>
 #include <set>
+#include <vector>
 
 #include "zypp/base/ReferenceCounted.h"
 #include "zypp/base/NonCopyable.h"
@@ -22,6 +23,7 @@
 #include "zypp/ZYppCommit.h"
 
 #include "zypp/Pathname.h"
+#include "zypp/RepoStatus.h"
 #include "zypp/media/MediaAccess.h"
 #include "zypp/Target.h"
 #include "zypp/target/rpm/RpmDb.h"
@@ -98,6 +100,32 @@ namespace zypp
 
       Pathname _tmpSolvfilesPath;
 
+      /** The rpm database status the \c @System solv file is built from. */
+      RepoStatus rpmDbStatus() const;
+
+      /** The \c /etc/products.d status (part of \ref rpmDbStatus). */
+      RepoStatus productsDirStatus() const;
+
+      /** Patch the \c @System solv file after commit.
+       * Re-reads from the rpm database just the packages touched by
+       * \a result_r, instead of running \c rpmdb2solv on the whole
+       * database. Returns \c false if a full \ref buildCache is needed
+       * (e.g. packages providing autogenerated patterns or products
+       * were touched, or the solv file can not be read or written).
+       * \note Only valid if the solv file was up to date when the commit started.
+       */
+      bool updateCache( const ZYppCommitResult & result_r );
+
+    public:
+      /** Re-read the packages named \a names_r from the rpm database below
+       * \a root_r into the solv file \a rpmsolv_r (the \ref updateCache
+       * workhorse). All solvables of these names are dropped and the headers
+       * currently installed are added, so the result equals what \c rpmdb2solv
+       * would build. Returns \c false if the solv file can not be read or
+       * written, or a header can not be read.
+       */
+      static bool patchSolvFile( const Pathname & root_r, const Pathname & rpmsolv_r, const std::set<std::string> & names_r );
+
     public:
       void load( bool force = true );
 
@@ -208,6 +236,20 @@ namespace zypp
 
       /** Commit helper checking for file conflicts after download. */
       void commitFindFileConflicts( const ZYppCommitPolicy & policy_r, ZYppCommitResult & result_r );
+
+      /** Commit helper installing consecutive packages in a single rpm transaction.
+       * Starting at \a step_r (a package to install) up to \ref ZYppCommitPolicy::rpmInstallBatchSize
+       * package installs are downloaded and passed to \ref rpm::RpmDb::installPackages.
+       * \a step_r is advanced to the last step processed. Returns \c false if the
+       * commit must stop (install failed or user abort, see \a abort_r).
+       */
+      bool commitInstallBatch( const ZYppCommitPolicy & policy_r,
+			       CommitPackageCache & packageCache_r,
+			       ZYppCommitResult::TransactionStepList::iterator & step_r,
+			       ZYppCommitResult::TransactionStepList::iterator end_r,
+			       std::vector<sat::Solvable> & successfullyInstalledPackages_r,
+			       bool & abort_r,
+			       const function<void()> & attemptToModify_r );
     protected:
       /** Path to the target */
       Pathname _root;
@@ -0,0 +1,215 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file zypp/target/TargetImpl.updateCache.cc
+ */
+extern "C"
+{
+#include <solv/pool.h>
+#include <solv/repo.h>
+#include <solv/solvable.h>
+#include <solv/repo_solv.h>
+#include <solv/repo_write.h>
+#include <solv/repo_rpmdb.h>
+#include <solv/knownid.h>
+}
+#include <cstdio>
+#include <iostream>
+#include <set>
+#include <unordered_set>
+#include <string>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/String.h"
+#include "zypp/AutoDispose.h"
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+#include "zypp/RepoStatus.h"
+#include "zypp/ResObjects.h"
+#include "zypp/Capabilities.h"
+#include "zypp/ZConfig.h"
+#include "zypp/PluginExecutor.h"
+
+#include "zypp/sat/Pool.h"
+#include "zypp/sat/Queue.h"
+#include "zypp/sat/Transaction.h"
+
+#include "zypp/target/TargetImpl.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace target
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      /** Whether rpmdb2solv -X derives pattern/product solvables from this package. */
+      inline bool providesPatternOrProduct( const sat::Solvable & solv_r )
+      {
+	for ( const Capability & cap : solv_r.provides() )
+	{
+	  const char * name = cap.detail().name().c_str();
+	  if ( str::hasPrefix( name, "pattern()" ) || str::hasPrefix( name, "product()" ) )
+	    return true;
+	}
+	return false;
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    RepoStatus TargetImpl::rpmDbStatus() const
+    { return RepoStatus( _root/"var/lib/rpm/Name" ) && productsDirStatus(); }
+
+    RepoStatus TargetImpl::productsDirStatus() const
+    { return RepoStatus( _root/"etc/products.d" ); }
+
+    bool TargetImpl::patchSolvFile( const Pathname & root_r, const Pathname & rpmsolv_r, const std::set<std::string> & names_r )
+    {
+      AutoDispose<sat::detail::CPool *> pool( ::pool_create(), ::pool_free );
+      sat::detail::CRepo * repo = ::repo_create( pool, sat::Pool::instance().systemRepoAlias().c_str() );
+      {
+	AutoDispose<FILE*> fp( ::fopen( rpmsolv_r.c_str(), "re" ), ::fclose );
+	if ( fp == nullptr )
+	{
+	  fp.resetDispose();
+	  WAR << "Full rebuild: can't open " << rpmsolv_r << endl;
+	  return false;
+	}
+	if ( ::repo_add_solv( repo, fp, 0 ) != 0 )
+	{
+	  WAR << "Full rebuild: can't read " << rpmsolv_r << ": " << ::pool_errstr( pool ) << endl;
+	  return false;
+	}
+      }
+
+      // Drop the outdated solvables (backwards, so freeing at the end of the repo is cheap)
+      std::unordered_set<sat::detail::IdType> nameIds;
+      for ( const std::string & name : names_r )
+      {
+	sat::detail::IdType id = ::pool_str2id( pool, name.c_str(), /*create*/0 );
+	if ( id )
+	  nameIds.insert( id );
+      }
+      unsigned dropped = 0;
+      for ( sat::detail::SolvableIdType p = repo->end; p-- > sat::detail::SolvableIdType(repo->start); )
+      {
+	::Solvable * s = ::pool_id2solvable( pool, p );
+	if ( s->repo == repo && nameIds.count( s->name ) )
+	{
+	  ::repo_free_solvable( repo, p, /*reuseids*/1 );
+	  ++dropped;
+	}
+      }
+
+      // Add the headers now installed. Use the same flags rpmdb2solv
+      // (repo_add_rpmdb) applies, so the result equals a full rebuild.
+      unsigned added = 0;
+      {
+	AutoDispose<void *> state( ::rpm_state_create( pool, root_r.c_str() ), ::rpm_state_free );
+	::repo_add_repodata( repo, 0 );	// fresh repodata for the new solvables (picked by REPO_REUSE_REPODATA)
+	sat::Queue rpmdbids;
+	for ( const std::string & name : names_r )
+	{
+	  rpmdbids.clear();
+	  ::rpm_installedrpmdbids( state, "Name", name.c_str(), rpmdbids );
+	  for ( sat::detail::IdType rpmdbid : rpmdbids )
+	  {
+	    void * handle = ::rpm_byrpmdbid( state, rpmdbid );
+	    sat::detail::SolvableIdType p = handle ? ::repo_add_rpm_handle( repo, handle, REPO_REUSE_REPODATA|REPO_NO_INTERNALIZE|RPM_ADD_TRIGGERS ) : 0;
+	    if ( ! p )
+	    {
+	      WAR << "Full rebuild: can't read rpmdb header " << rpmdbid << " (" << name << "): " << ::pool_errstr( pool ) << endl;
+	      return false;
+	    }
+	    ::repo_set_num( repo, p, RPM_RPMDBID, rpmdbid );
+	    ++added;
+	  }
+	}
+      }
+      ::repo_internalize( repo );
+
+      // Write and move in place like buildCache does
+      filesystem::TmpFile tmpsolv( filesystem::TmpFile::makeSibling( rpmsolv_r ) );
+      if ( ! tmpsolv )
+      {
+	WAR << "Full rebuild: can't create temporary file under " << rpmsolv_r.dirname() << endl;
+	return false;
+      }
+      {
+	AutoDispose<FILE*> fp( ::fopen( tmpsolv.path().c_str(), "we" ), ::fclose );
+	if ( fp == nullptr || ::repo_write( repo, fp ) != 0 || ::fflush( fp ) != 0 )
+	{
+	  if ( fp == nullptr )
+	    fp.resetDispose();
+	  WAR << "Full rebuild: can't write " << tmpsolv.path() << ": " << ::pool_errstr( pool ) << endl;
+	  return false;
+	}
+      }
+      if ( filesystem::rename( tmpsolv, rpmsolv_r ) != 0 )
+      {
+	WAR << "Full rebuild: can't move " << tmpsolv.path() << " to " << rpmsolv_r << endl;
+	return false;
+      }
+      // if this fails, don't bother throwing exceptions
+      filesystem::chmod( rpmsolv_r, 0644 );
+
+      MIL << "Updated " << rpmsolv_r << " for " << names_r.size() << " package names: -" << dropped << " +" << added << endl;
+      return true;
+    }
+
+    bool TargetImpl::updateCache( const ZYppCommitResult & result_r )
+    {
+      Pathname base = solvfilesPath();
+      Pathname rpmsolv       = base/"solv";
+      Pathname rpmsolvcookie = base/"cookie";
+
+      // Collect the names of all packages touched by the commit. Whatever
+      // the outcome of the individual steps, the rpmdb is the reference:
+      // all old solvables of these names are dropped and the headers now
+      // installed are re-read.
+      std::set<std::string> names;
+      for ( const sat::Transaction::Step & step : result_r.transactionStepList() )
+      {
+	sat::Solvable solv( step.satSolvable() );
+	if ( ! solv.isKind<Package>() )
+	  continue;
+	if ( providesPatternOrProduct( solv ) )
+	{
+	  MIL << "Full rebuild: " << solv << " provides autogenerated pattern/product." << endl;
+	  return false;
+	}
+	names.insert( solv.name() );
+      }
+      if ( names.empty() )
+	return false;	// nothing to patch; let buildCache sort it out
+
+      if ( ! patchSolvFile( _root, rpmsolv, names ) )
+	return false;
+
+      rpmDbStatus().saveToCookieFile( rpmsolvcookie );
+      sat::updateSolvFileIndex( rpmsolv );	// content digest for zypper bash completion
+
+      // system-hook: Finally send notification to plugins
+      if ( root() == "/" )
+      {
+	PluginExecutor plugins;
+	plugins.load( ZConfig::instance().pluginsPath()/"system" );
+	if ( plugins )
+	  plugins.send( PluginFrame( "PACKAGESETCHANGED" ) );
+      }
+      return true;
+    }
+
+  } // namespace target
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -19,6 +19,7 @@ typedef rpmuint32_t rpm_count_t;
 #endif
 }
 
+#include <cstdlib>
 #include <iostream>
 
 #include "zypp/base/Logger.h"
@@ -406,6 +407,44 @@ std::list<std::string> BinHeader::stringList_val( tag tag_r ) const
   return ret;
 }
 
+///////////////////////////////////////////////////////////////////
+//
+//
+//        METHOD NAME : BinHeader::exportTags
+//        METHOD TYPE : std::string
+//
+//        DESCRIPTION :
+//
+std::string BinHeader::exportTags( const std::vector<tag> & tags_r ) const
+{
+  std::string ret;
+#ifndef _RPM_5
+  if ( empty() )
+    return ret;
+
+  AutoDispose<Header> h( ::headerNew(), ::headerFree );
+  for ( tag tag_r : tags_r )
+  {
+    AutoDispose<rpmtd> td( ::rpmtdNew(), []( rpmtd td_r ) { ::rpmtdFreeData( td_r ); ::rpmtdFree( td_r ); } );
+    if ( ::headerGet( _h, tag_r, td, HEADERGET_MINMEM ) )
+      ::headerPut( h, td, HEADERPUT_DEFAULT );
+  }
+
+  unsigned size = 0;
+  AutoDispose<void*> blob( ::headerExport( h, &size ), ::free );
+  if ( blob && size )
+  {
+    static const char magic[] = { '\x8e', '\xad', '\xe8', '\x01', 0, 0, 0, 0 };
+    ret.reserve( sizeof(magic) + size );
+    ret.append( magic, sizeof(magic) );
+    ret.append( reinterpret_cast<const char *>(blob.value()), size );
+  }
+#else
+  INT << "Not supported with RPM5" << endl;
+#endif
+  return ret;
+}
+
 ///////////////////////////////////////////////////////////////////
 //
 //
@@ -94,6 +94,12 @@ public:
 
   std::list<std::string> stringList_val( tag tag_r ) const;
 
+  /**
+   * A copy of the header reduced to \a tags_r, in the format used in an
+   * rpm file (header magic, index and data). Empty on error.
+   **/
+  std::string exportTags( const std::vector<tag> & tags_r ) const;
+
 public:
 
   virtual std::ostream & dumpOn( std::ostream & str ) const;
@@ -0,0 +1,332 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/target/rpm/PackageSigCache.cc
+ *
+*/
+#include <sys/stat.h>
+#include <unistd.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "zypp/base/Logger.h"
+#include "zypp/base/String.h"
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+
+#include "zypp/target/rpm/PackageSigCache.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace target
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace rpm
+    {
+      namespace
+      {
+	const char fileMagic[] = "ZYPPSIGCACHE2";
+	const unsigned keySize = 32;
+
+	/** Whether \a pi_r is owned by the user and has none of the \a badperm_r bits. */
+	bool isTrusted( const PathInfo & pi_r, mode_t badperm_r = S_IWGRP|S_IWOTH )
+	{ return pi_r.owner() == ::geteuid() && ! ( pi_r.perm() & badperm_r ); }
+      } // namespace
+
+      PackageSigCache::PackageSigCache( Pathname file_r )
+      : _file( std::move(file_r) )
+      , _dirty( false )
+      {
+	PathInfo pi( _file, PathInfo::LSTAT );
+	if ( ! pi.isExist() )
+	{
+	  MIL << "No signature cache " << _file << endl;
+	  return;
+	}
+	PathInfo dir( _file.dirname() );
+	if ( ! ( pi.isFile() && isTrusted( pi ) && dir.isDir() && isTrusted( dir ) ) )
+	{
+	  WAR << "Ignore signature cache " << pi << " in " << dir << endl;
+	  return;
+	}
+	_key = readKey();
+	if ( _key.empty() )
+	{
+	  WAR << "Ignore signature cache " << _file << " without key" << endl;
+	  return;
+	}
+	std::ifstream in( _file.c_str() );
+
+	// magic and keyring state, then per entry:
+	//   digest res ino size mtime ctime loglen mac path\n<log>\n
+	std::string line;
+	if ( ! std::getline( in, line ) || ! str::hasPrefix( line, fileMagic ) )
+	{
+	  WAR << "Ignore invalid signature cache " << _file << endl;
+	  return;
+	}
+	_keyring = str::stripPrefix( line, std::string(fileMagic) + " " );
+
+	unsigned rejected = 0;
+	while ( std::getline( in, line ) )
+	{
+	  std::vector<std::string> words;
+	  str::split( line, std::back_inserter(words), " " );
+	  if ( words.size() < 9 )
+	    break;
+	  Entry entry;
+	  entry.result.res = str::strtonum<int>( words[1] );
+	  entry.id.ino     = str::strtonum<unsigned long long>( words[2] );
+	  entry.id.size    = str::strtonum<unsigned long long>( words[3] );
+	  entry.id.mtime   = str::strtonum<unsigned long long>( words[4] );
+	  entry.id.ctime   = str::strtonum<unsigned long long>( words[5] );
+	  size_t loglen    = str::strtonum<size_t>( words[6] );
+	  // the path is the remaining part of the line (may contain blanks)
+	  std::string::size_type pos = std::string::npos;
+	  for ( unsigned i = 0; i < 8; ++i )
+	    pos = line.find( ' ', pos + 1 );
+	  if ( pos == std::string::npos )
+	    break;
+	  entry.path = line.substr( pos + 1 );
+
+	  entry.result.log.resize( loglen );
+	  if ( loglen && ! in.read( &entry.result.log[0], loglen ) )
+	    break;
+	  in.ignore( 1 );	// '\n'
+	  std::string expected( mac( words[0], entry ) );
+	  if ( expected.empty() || expected != words[7] )
+	  {
+	    ++rejected;
+	    continue;
+	  }
+	  _byPath[entry.path] = words[0];
+	  _entries[words[0]] = std::move(entry);
+	}
+	if ( rejected )
+	  WAR << "Signature cache " << _file << ": ignored " << rejected << " entries failing to verify" << endl;
+	MIL << "Signature cache " << _file << ": " << _entries.size() << " packages" << endl;
+      }
+
+      PackageSigCache::~PackageSigCache()
+      { save(); }
+
+      bool PackageSigCache::fileId( const Pathname & path_r, FileId & id_r )
+      {
+	struct stat st;
+	if ( ::stat( path_r.c_str(), &st ) != 0 || ! S_ISREG( st.st_mode ) )
+	  return false;
+	id_r.ino   = st.st_ino;
+	id_r.size  = st.st_size;
+	id_r.mtime = st.st_mtim.tv_sec * 1000000000ULL + st.st_mtim.tv_nsec;
+	id_r.ctime = st.st_ctim.tv_sec * 1000000000ULL + st.st_ctim.tv_nsec;
+	return true;
+      }
+
+      std::string PackageSigCache::mac( const std::string & digest_r, const Entry & entry_r ) const
+      {
+	if ( _key.empty() )
+	  return std::string();
+	std::string data( str::Str() << _keyring << '\n' << digest_r << ' ' << entry_r.result.res
+	                             << ' ' << entry_r.id.ino << ' ' << entry_r.id.size << ' ' << entry_r.id.mtime << ' ' << entry_r.id.ctime
+	                             << ' ' << entry_r.path << '\n' << entry_r.result.log );
+	unsigned char md[EVP_MAX_MD_SIZE];
+	unsigned mdlen = 0;
+	if ( ! ::HMAC( ::EVP_sha256(), _key.data(), _key.size(),
+	               reinterpret_cast<const unsigned char *>( data.data() ), data.size(), md, &mdlen ) )
+	  return std::string();
+	std::string ret;
+	for ( unsigned i = 0; i < mdlen; ++i )
+	  ret += str::form( "%02x", md[i] );
+	return ret;
+      }
+
+      std::string PackageSigCache::readKey() const
+      {
+	Pathname keyfile( _file.extend( ".key" ) );
+	PathInfo pi( keyfile, PathInfo::LSTAT );
+	if ( ! ( pi.isFile() && isTrusted( pi, S_IRWXG|S_IRWXO ) ) )
+	{
+	  WAR << "Ignore signature cache key " << pi << endl;
+	  return std::string();
+	}
+	std::string ret( keySize, '\0' );
+	std::ifstream in( keyfile.c_str() );
+	if ( ! in.read( &ret[0], keySize ) )
+	  return std::string();
+	return ret;
+      }
+
+      bool PackageSigCache::makeKey()
+      {
+	std::string key( keySize, '\0' );
+	if ( ::RAND_bytes( reinterpret_cast<unsigned char *>( &key[0] ), keySize ) != 1 )
+	{
+	  WAR << "Can't create a signature cache key" << endl;
+	  return false;
+	}
+	Pathname keyfile( _file.extend( ".key" ) );
+	filesystem::TmpFile tmpfile( filesystem::TmpFile::makeSibling( keyfile ) );
+	if ( ! tmpfile )
+	  return false;
+	filesystem::chmod( tmpfile.path(), 0600 );
+	{
+	  std::ofstream out( tmpfile.path().c_str() );
+	  out << key;
+	  out.flush();
+	  if ( ! out )
+	  {
+	    WAR << "Can't write " << tmpfile.path() << endl;
+	    return false;
+	  }
+	}
+	if ( filesystem::rename( tmpfile, keyfile ) != 0 )
+	{
+	  WAR << "Can't move " << tmpfile.path() << " to " << keyfile << endl;
+	  return false;
+	}
+	_key.swap( key );
+	return true;
+      }
+
+      void PackageSigCache::setKeyring( const std::string & keyring_r )
+      {
+	std::lock_guard<std::mutex> lock( _mutex );
+	if ( keyring_r == _keyring )
+	  return;
+	if ( ! _entries.empty() )
+	{
+	  MIL << "Rpm keyring changed: drop " << _entries.size() << " signature cache entries" << endl;
+	  _entries.clear();
+	  _byPath.clear();
+	  _dirty = true;
+	}
+	_keyring = keyring_r;
+      }
+
+      std::string PackageSigCache::digest( const Pathname & path_r ) const
+      {
+	FileId id;
+	if ( ! fileId( path_r, id ) )
+	  return std::string();
+	{
+	  std::lock_guard<std::mutex> lock( _mutex );
+	  auto known = _byPath.find( path_r.asString() );
+	  if ( known != _byPath.end() )
+	  {
+	    auto entry = _entries.find( known->second );
+	    if ( entry != _entries.end() && entry->second.path == path_r.asString() && entry->second.id == id )
+	      return known->second;
+	  }
+	}
+	return filesystem::checksum( path_r, "sha256" );
+      }
+
+      bool PackageSigCache::lookup( const std::string & digest_r, Result & result_r ) const
+      {
+	if ( digest_r.empty() )
+	  return false;
+	std::lock_guard<std::mutex> lock( _mutex );
+	auto entry = _entries.find( digest_r );
+	if ( entry == _entries.end() )
+	  return false;
+	result_r = entry->second.result;
+	return true;
+      }
+
+      void PackageSigCache::store( const Pathname & path_r, const std::string & digest_r, Result result_r )
+      {
+	FileId id;
+	if ( digest_r.empty() || ! fileId( path_r, id ) || path_r.asString().find( '\n' ) != std::string::npos )
+	  return;
+	std::lock_guard<std::mutex> lock( _mutex );
+	Entry & entry( _entries[digest_r] );
+	// keep the file we know as long as it exists (e.g. the package cache vs. a temporary copy)
+	FileId knownId;
+	if ( entry.path.empty() || ! fileId( entry.path, knownId ) || ! ( knownId == entry.id ) )
+	{
+	  entry.path = path_r.asString();
+	  entry.id = id;
+	}
+	entry.result = std::move(result_r);
+	_byPath[path_r.asString()] = digest_r;
+	_dirty = true;
+      }
+
+      void PackageSigCache::save()
+      {
+	std::lock_guard<std::mutex> lock( _mutex );
+	if ( ! _dirty )
+	  return;
+	_dirty = false;	// don't retry on error
+
+	// drop the entries of files no longer present
+	unsigned dropped = 0;
+	for ( auto it = _entries.begin(); it != _entries.end(); )
+	{
+	  FileId id;
+	  if ( fileId( it->second.path, id ) )
+	    ++it;
+	  else
+	  {
+	    _byPath.erase( it->second.path );
+	    it = _entries.erase( it );
+	    ++dropped;
+	  }
+	}
+
+	if ( _key.empty() && ! makeKey() )
+	  return;
+
+	filesystem::TmpFile tmpfile( filesystem::TmpFile::makeSibling( _file ) );
+	if ( ! tmpfile )
+	{
+	  WAR << "Can't create temporary file for " << _file << endl;
+	  return;
+	}
+	{
+	  std::ofstream out( tmpfile.path().c_str() );
+	  out << fileMagic << " " << _keyring << '\n';
+	  for ( const auto & el : _entries )
+	  {
+	    const Entry & entry( el.second );
+	    out << el.first << ' ' << entry.result.res
+	        << ' ' << entry.id.ino << ' ' << entry.id.size << ' ' << entry.id.mtime << ' ' << entry.id.ctime
+	        << ' ' << entry.result.log.size() << ' ' << mac( el.first, entry ) << ' ' << entry.path << '\n'
+	        << entry.result.log << '\n';
+	  }
+	  out.flush();
+	  if ( ! out )
+	  {
+	    WAR << "Can't write " << tmpfile.path() << endl;
+	    return;
+	  }
+	}
+	if ( filesystem::rename( tmpfile, _file ) != 0 )
+	{
+	  WAR << "Can't move " << tmpfile.path() << " to " << _file << endl;
+	  return;
+	}
+	filesystem::chmod( _file, 0644 );
+	MIL << "Updated signature cache " << _file << ": " << _entries.size() << " packages (-" << dropped << ")" << endl;
+      }
+
+    } // namespace rpm
+    ///////////////////////////////////////////////////////////////////
+  } // namespace target
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
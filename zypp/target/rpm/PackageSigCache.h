@@ -0,0 +1,135 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/target/rpm/PackageSigCache.h
+ *
+*/
+#ifndef ZYPP_TARGET_RPM_PACKAGESIGCACHE_H
+#define ZYPP_TARGET_RPM_PACKAGESIGCACHE_H
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "zypp/base/NonCopyable.h"
+#include "zypp/Pathname.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace target
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace rpm
+    {
+      ///////////////////////////////////////////////////////////////////
+      /// \class PackageSigCache
+      /// \brief On-disk cache of rpm package signature check results.
+      ///
+      /// Results are stored per package content (sha256 digest of the
+      /// whole file, which includes the signature header) and are valid
+      /// only for the rpm keyring state they were computed with. Setting
+      /// a different \ref setKeyring state drops all entries.
+      ///
+      /// Files still unchanged since their entry was stored (same path,
+      /// inode, size, mtime and ctime) are recognized without computing
+      /// the digest again. Methods are thread safe.
+      ///
+      /// The cache file is read only if it and its directory are owned by
+      /// the user and not writable by group or others. Each entry carries a
+      /// HMAC-SHA256 over the entry and the keyring state, keyed by a secret
+      /// kept in \c <file>.key (mode 0600). Entries failing to verify are
+      /// ignored.
+      ///////////////////////////////////////////////////////////////////
+      class PackageSigCache : private base::NonCopyable
+      {
+      public:
+	/** A cached \c rpmVerifySignatures result. */
+	struct Result
+	{
+	  int res = 0;		///< return value
+	  std::string log;	///< captured rpm log output
+	};
+
+      public:
+	/** Ctor reading the cache \a file_r (if it exists). */
+	explicit PackageSigCache( Pathname file_r );
+
+	/** Dtor (\ref save). */
+	~PackageSigCache();
+
+      public:
+	/** The cache file. */
+	const Pathname & file() const
+	{ return _file; }
+
+	/** Use entries computed with rpm keyring state \a keyring_r only. */
+	void setKeyring( const std::string & keyring_r );
+
+	/** The cache key for \a path_r (sha256 digest); empty if not readable. */
+	std::string digest( const Pathname & path_r ) const;
+
+	/** Lookup the result stored for \a digest_r. */
+	bool lookup( const std::string & digest_r, Result & result_r ) const;
+
+	/** Remember \a result_r for \a path_r with content \a digest_r. */
+	void store( const Pathname & path_r, const std::string & digest_r, Result result_r );
+
+	/** Write the cache file if entries were added or dropped. */
+	void save();
+
+      private:
+	/** Identifies an unchanged file. */
+	struct FileId
+	{
+	  unsigned long long ino = 0;
+	  unsigned long long size = 0;
+	  unsigned long long mtime = 0;	///< ns
+	  unsigned long long ctime = 0;	///< ns
+	  bool operator==( const FileId & rhs ) const
+	  { return ino == rhs.ino && size == rhs.size && mtime == rhs.mtime && ctime == rhs.ctime; }
+	};
+
+	struct Entry
+	{
+	  std::string path;	///< file the result was stored for
+	  FileId id;		///< and its identity at that time
+	  Result result;
+	};
+
+	/** Identity of \a path_r; \c false if it does not exist. */
+	static bool fileId( const Pathname & path_r, FileId & id_r );
+
+	/** The MAC authenticating \a entry_r for \a digest_r; empty on error. */
+	std::string mac( const std::string & digest_r, const Entry & entry_r ) const;
+
+	/** Read the MAC key; empty if missing or not trusted. */
+	std::string readKey() const;
+
+	/** Create and write a new MAC key. */
+	bool makeKey();
+
+      private:
+	Pathname _file;
+	std::string _key;		///< MAC key
+	std::string _keyring;
+	std::unordered_map<std::string,Entry> _entries;		///< by digest
+	std::unordered_map<std::string,std::string> _byPath;	///< path to digest
+	bool _dirty;
+	mutable std::mutex _mutex;
+      };
+      ///////////////////////////////////////////////////////////////////
+
+    } // namespace rpm
+    ///////////////////////////////////////////////////////////////////
+  } // namespace target
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_TARGET_RPM_PACKAGESIGCACHE_H
@@ -14,10 +14,12 @@ extern "C"
 {
 #include <rpm/rpmcli.h>
 #include <rpm/rpmlog.h>
+#include <rpm/rpmkeyring.h>
 }
 #include <cstdlib>
 #include <cstdio>
 #include <ctime>
+#include <unistd.h>
 
 #include <iostream>
 #include <fstream>
@@ -28,6 +30,9 @@ extern "C"
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 #include "zypp/base/Logger.h"
 #include "zypp/base/String.h"
@@ -35,6 +40,7 @@ extern "C"
 #include "zypp/base/LocaleGuard.h"
 
 #include "zypp/Date.h"
+#include "zypp/Digest.h"
 #include "zypp/Pathname.h"
 #include "zypp/PathInfo.h"
 #include "zypp/PublicKey.h"
@@ -45,7 +51,9 @@ extern "C"
 #include "zypp/HistoryLog.h"
 #include "zypp/target/rpm/librpmDb.h"
 #include "zypp/target/rpm/RpmException.h"
+#include "zypp/target/rpm/PackageSigCache.h"
 #include "zypp/TmpPath.h"
+#include "zypp/AutoDispose.h"
 #include "zypp/KeyRing.h"
 #include "zypp/ZYppFactory.h"
 #include "zypp/ZConfig.h"
@@ -212,7 +220,65 @@ std::ostream & operator<<( std::ostream & str, const RpmDb::DbStateInfoBits & ob
   return str;
 }
 
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  ///////////////////////////////////////////////////////////////////
+  /// \class SigCache
+  /// \brief The persistent \ref PackageSigCache and the rpm keyring state it is used for.
+  ///////////////////////////////////////////////////////////////////
+  struct SigCache
+  {
+    /** The cache, valid for the keyring (gpg-pubkey packages) in \a rpmdb_r. */
+    static PackageSigCache & get( const RpmDb & rpmdb_r )
+    {
+      std::lock_guard<std::mutex> lock( _mutex );
+      Pathname file( ZConfig::instance().repoPackagesPath()/".sigcache" );
+      if ( _cache && _cache->file() != file )
+      {
+	delete _cache;	// saves it
+	_cache = nullptr;
+	_keyringDirty = true;
+      }
+      if ( ! _cache )
+	_cache = new PackageSigCache( file );	// not freed at exit; saved by closeDatabase
+      if ( _keyringDirty )
+      {
+	str::Str keyring;
+	keyring << rpmdb_r.root();
+	for ( const Edition & ed : rpmdb_r.pubkeyEditions() )
+	  keyring << " " << ed;
+	_cache->setKeyring( keyring );
+	_keyringDirty = false;
+      }
+      return *_cache;
+    }
 
+    /** Recompute the keyring state on next use. */
+    static void setKeyringDirty()
+    {
+      std::lock_guard<std::mutex> lock( _mutex );
+      _keyringDirty = true;
+    }
+
+    static void save()
+    {
+      std::lock_guard<std::mutex> lock( _mutex );
+      if ( _cache )
+	_cache->save();
+    }
+
+  private:
+    static std::mutex _mutex;
+    static PackageSigCache * _cache;
+    static bool _keyringDirty;
+  };
+
+  std::mutex SigCache::_mutex;
+  PackageSigCache * SigCache::_cache = nullptr;
+  bool SigCache::_keyringDirty = true;
+} // namespace
+///////////////////////////////////////////////////////////////////
 
 ///////////////////////////////////////////////////////////////////
 //
@@ -758,6 +824,8 @@ void RpmDb::closeDatabase()
   ///////////////////////////////////////////////////////////////////
   _root = _dbPath = Pathname();
   _dbStateInfo = DbSI_NO_INIT;
+  SigCache::save();
+  SigCache::setKeyringDirty();
 
   MIL << "closeDatabase: " << *this << endl;
 }
@@ -953,6 +1021,54 @@ namespace
     rpmKeys_r.swap( rpmKeys );
     zyppKeys_r.swap( zyppKeys );
   }
+
+  /** Digest of the armored key material of rpm key \a edition_r (empty if not in the rpm database). */
+  std::string rpmKeyDigest( const RpmDb & rpmdb_r, const Edition & edition_r )
+  {
+    RpmHeader::constPtr result;
+    rpmdb_r.getData( "gpg-pubkey", edition_r, result );
+    return result ? Digest::digest( Digest::sha256(), result->tag_description() ) : std::string();
+  }
+
+  /** The digests of the rpm keys the keys in a saved trusted keyring were exported from (by fingerprint). */
+  std::map<std::string,std::string> readRpmKeyDigests( const Pathname & file_r )
+  {
+    std::map<std::string,std::string> ret;
+    PathInfo pi( file_r, PathInfo::LSTAT );
+    if ( ! ( pi.isFile() && pi.owner() == ::geteuid() && ! ( pi.perm() & (S_IWGRP|S_IWOTH) ) ) )
+    {
+      WAR << "Ignore rpm key digests " << pi << endl;
+      return ret;
+    }
+    std::ifstream in( file_r.c_str() );
+    std::string fingerprint;
+    std::string digest;
+    while ( in >> fingerprint >> digest )
+      ret[fingerprint] = digest;
+    return ret;
+  }
+
+  /** Remember the digests of the rpm keys the trusted keys were exported from. */
+  void writeRpmKeyDigests( const RpmDb & rpmdb_r, const Pathname & file_r )
+  {
+    filesystem::TmpFile tmp( filesystem::TmpFile::makeSibling( file_r ) );
+    filesystem::chmod( tmp.path(), 0644 );
+    {
+      std::ofstream out( tmp.path().c_str() );
+      for ( const PublicKeyData & keyData : getZYpp()->keyRing()->trustedPublicKeyData() )
+      {
+	std::string digest( rpmKeyDigest( rpmdb_r, keyData.gpgPubkeyEdition() ) );
+	if ( ! digest.empty() )
+	  out << keyData.fingerprint() << ' ' << digest << endl;
+      }
+      if ( ! out )
+      {
+	WAR << "Can't write " << file_r << endl;
+	return;
+      }
+    }
+    filesystem::rename( tmp.path(), file_r );
+  }
 } // namespace
 ///////////////////////////////////////////////////////////////////
 
@@ -961,6 +1077,32 @@ void RpmDb::syncTrustedKeys( SyncTrustedKeyBits mode_r )
   MIL << "Going to sync trusted keys..." << endl;
   std::set<Edition> rpmKeys( pubkeyEditions() );
   std::list<PublicKeyData> zyppKeys( getZYpp()->keyRing()->trustedPublicKeyData() );
+  // The trusted keyring saved by a previous sync, so a new process does not
+  // need to export and import all rpm keys again. The rpm database stays
+  // authoritative: A restored key is kept only if the rpm key it was exported
+  // from still has the same armored key material. Others are removed, and
+  // the missing ones exported below.
+  Pathname savedKeyRing( ZConfig::instance().repoCachePath()/"keyring" );
+  Pathname savedDigests( savedKeyRing/"rpmkeys" );
+  bool keyRingChanged = false;
+
+  if ( (mode_r & SYNC_TO_KEYRING) && zyppKeys.empty() && ! rpmKeys.empty()
+    && getZYpp()->keyRing()->restoreTrustedKeyRing( savedKeyRing ) )
+  {
+    std::map<std::string,std::string> digests( readRpmKeyDigests( savedDigests ) );
+    callback::TempConnect<KeyRingSignals> tempDisconnect;
+    for ( const PublicKeyData & keyData : getZYpp()->keyRing()->trustedPublicKeyData() )
+    {
+      auto it = digests.find( keyData.fingerprint() );
+      if ( it == digests.end() || it->second != rpmKeyDigest( *this, keyData.gpgPubkeyEdition() ) )
+      {
+	DBG << "Saved key does not match the rpm database: gpg-pubkey-" << keyData.gpgPubkeyEdition() << " " << keyData.fingerprint() << endl;
+	getZYpp()->keyRing()->deleteKey( keyData.id(), /*trusted*/true );
+	keyRingChanged = true;
+      }
+    }
+    zyppKeys = getZYpp()->keyRing()->trustedPublicKeyData();
+  }
 
   if ( ! ( mode_r & SYNC_FROM_KEYRING ) )
   {
@@ -986,7 +1128,10 @@ void RpmDb::syncTrustedKeys( SyncTrustedKeyBits mode_r )
       }
     }
     if ( dirty )
+    {
       zyppKeys = getZYpp()->keyRing()->trustedPublicKeyData();
+      keyRingChanged = true;
+    }
   }
 
   computeKeyRingSync( rpmKeys, zyppKeys );
@@ -1016,6 +1161,7 @@ void RpmDb::syncTrustedKeys( SyncTrustedKeyBits mode_r )
     try
     {
       getZYpp()->keyRing()->multiKeyImport( tmpfile.path(), true /*trusted*/);
+      keyRingChanged = true;
       // bsc#1096217: Try to spot and report legacy V3 keys found in the rpm database.
       // Modern rpm does not import those keys, but when migrating a pre SLE12 system
       // we may find them. rpm>4.13 even complains on sderr if sucha key is present.
@@ -1054,6 +1200,11 @@ void RpmDb::syncTrustedKeys( SyncTrustedKeyBits mode_r )
       }
     }
   }
+  if ( keyRingChanged && (mode_r & SYNC_TO_KEYRING) )
+  {
+    getZYpp()->keyRing()->saveTrustedKeyRing( savedKeyRing );
+    writeRpmKeyDigests( *this, savedDigests );
+  }
   MIL << "Trusted keys synced." << endl;
 }
 
@@ -1072,6 +1223,7 @@ void RpmDb::exportTrustedKeysInZyppKeyRing()
 void RpmDb::importPubkey( const PublicKey & pubkey_r )
 {
   FAILIFNOTINITIALIZED;
+  SigCache::setKeyringDirty();
 
   // bnc#828672: On the fly key import in READONLY
   if ( zypp_readonly_hack::IGotIt() )
@@ -1190,6 +1342,7 @@ void RpmDb::importPubkey( const PublicKey & pubkey_r )
 void RpmDb::removePubkey( const PublicKey & pubkey_r )
 {
   FAILIFNOTINITIALIZED;
+  SigCache::setKeyringDirty();
 
   // check if the key is in the rpm database and just
   // return if it does not.
@@ -1493,19 +1646,19 @@ void RpmDb::getData( const std::string & name_r, const Edition & ed_r,
 ///////////////////////////////////////////////////////////////////
 namespace
 {
+  /** Capture the rpm log output of the current thread. */
   struct RpmlogCapture : public std::string
   {
     RpmlogCapture()
-    { rpmlog()._cap = this; }
+    { rpmlog(); _cap = this; }
 
     ~RpmlogCapture()
-    { rpmlog()._cap = nullptr; }
+    { _cap = nullptr; }
 
   private:
     struct Rpmlog
     {
       Rpmlog()
-      : _cap( nullptr )
       {
 	rpmlogSetCallback( rpmLogCB, this );
 	rpmSetVerbosity( RPMLOG_INFO );
@@ -1526,17 +1679,22 @@ namespace
       }
 
       FILE * _f;
-      std::string * _cap;
     };
 
     static Rpmlog & rpmlog()
     { static Rpmlog _rpmlog; return _rpmlog; }
+
+    static thread_local std::string * _cap;
   };
 
+  thread_local std::string * RpmlogCapture::_cap = nullptr;
+
   RpmDb::CheckPackageResult doCheckPackageSig( const Pathname & path_r,			// rpm file to check
 					       const Pathname & root_r,			// target root
 					       bool  requireGPGSig_r,			// whether no gpg signature is to be reported
-					       RpmDb::CheckPackageDetail & detail_r )	// detailed result
+					       RpmDb::CheckPackageDetail & detail_r,	// detailed result
+					       PackageSigCache & cache_r,		// results of previous checks
+					       rpmKeyring keyring_r = nullptr )		// shared keyring (else loaded by rpm)
   {
     PathInfo file( path_r );
     if ( ! file.isFile() )
@@ -1545,29 +1703,52 @@ namespace
       return RpmDb::CHK_ERROR;
     }
 
-    FD_t fd = ::Fopen( file.asString().c_str(), "r.ufdio" );
-    if ( fd == 0 || ::Ferror(fd) )
+    int res = 0;
+    std::string vresult;
+    std::string digest( cache_r.digest( path_r ) );
+    PackageSigCache::Result cached;
+    if ( cache_r.lookup( digest, cached ) )
     {
-      ERR << "Can't open file for reading: " << file << " (" << ::Fstrerror(fd) << ")" << endl;
-      if ( fd )
-	::Fclose( fd );
-      return RpmDb::CHK_ERROR;
+      DBG << "Signature check of " << path_r << " from cache" << endl;
+      res = cached.res;
+      vresult.swap( cached.log );
+    }
+    else
+    {
+      FD_t fd = ::Fopen( file.asString().c_str(), "r.ufdio" );
+      if ( fd == 0 || ::Ferror(fd) )
+      {
+	ERR << "Can't open file for reading: " << file << " (" << ::Fstrerror(fd) << ")" << endl;
+	if ( fd )
+	  ::Fclose( fd );
+	return RpmDb::CHK_ERROR;
+      }
+      rpmts ts = ::rpmtsCreate();
+      ::rpmtsSetRootDir( ts, root_r.c_str() );
+      ::rpmtsSetVSFlags( ts, RPMVSF_DEFAULT );
+      if ( keyring_r )
+	::rpmtsSetKeyring( ts, keyring_r );
+
+      rpmQVKArguments_s qva;
+      memset( &qva, 0, sizeof(rpmQVKArguments_s) );
+      qva.qva_flags = (VERIFY_DIGEST|VERIFY_SIGNATURE);
+
+      RpmlogCapture vlog;
+      ThreadLocaleGuard guard;	// bsc#1076415: rpm log output is localized, but we need to parse it :(
+      res = ::rpmVerifySignatures( &qva, ts, fd, path_r.basename().c_str() );
+      guard.restore();
+
+      ts = rpmtsFree(ts);
+      ::Fclose( fd );
+      vresult = vlog;
+
+      if ( res == 0 )	// failures are checked again
+      {
+	PackageSigCache::Result result;
+	result.log = vresult;
+	cache_r.store( path_r, digest, std::move(result) );
+      }
     }
-    rpmts ts = ::rpmtsCreate();
-    ::rpmtsSetRootDir( ts, root_r.c_str() );
-    ::rpmtsSetVSFlags( ts, RPMVSF_DEFAULT );
-
-    rpmQVKArguments_s qva;
-    memset( &qva, 0, sizeof(rpmQVKArguments_s) );
-    qva.qva_flags = (VERIFY_DIGEST|VERIFY_SIGNATURE);
-
-    RpmlogCapture vresult;
-    LocaleGuard guard( LC_ALL, "C" );	// bsc#1076415: rpm log output is localized, but we need to parse it :(
-    int res = ::rpmVerifySignatures( &qva, ts, fd, path_r.basename().c_str() );
-    guard.restore();
-
-    ts = rpmtsFree(ts);
-    ::Fclose( fd );
 
     // results per line...
     //     Header V3 RSA/SHA256 Signature, key ID 3dbdc284: OK
@@ -1642,13 +1823,57 @@ namespace
 //	METHOD TYPE : RpmDb::CheckPackageResult
 //
 RpmDb::CheckPackageResult RpmDb::checkPackage( const Pathname & path_r, CheckPackageDetail & detail_r )
-{ return doCheckPackageSig( path_r, root(), false/*requireGPGSig_r*/, detail_r ); }
+{ return doCheckPackageSig( path_r, root(), false/*requireGPGSig_r*/, detail_r, SigCache::get( *this ) ); }
 
 RpmDb::CheckPackageResult RpmDb::checkPackage( const Pathname & path_r )
 { CheckPackageDetail dummy; return checkPackage( path_r, dummy ); }
 
 RpmDb::CheckPackageResult RpmDb::checkPackageSignature( const Pathname & path_r, RpmDb::CheckPackageDetail & detail_r )
-{ return doCheckPackageSig( path_r, root(), true/*requireGPGSig_r*/, detail_r ); }
+{ return doCheckPackageSig( path_r, root(), true/*requireGPGSig_r*/, detail_r, SigCache::get( *this ) ); }
+
+std::vector<RpmDb::CheckPackageResult> RpmDb::checkPackageSignatures( const std::vector<Pathname> & paths_r )
+{
+  std::vector<CheckPackageResult> ret( paths_r.size(), CHK_ERROR );
+  if ( paths_r.empty() )
+    return ret;
+
+  // Shared by all threads: the cache with its keyring state computed and the
+  // rpm keyring loaded from the database once. Each check uses its own rpmts
+  // and switches the locale of its thread only.
+  PackageSigCache & cache( SigCache::get( *this ) );
+  rpmts ts = ::rpmtsCreate();
+  ::rpmtsSetRootDir( ts, root().c_str() );
+  rpmKeyring keyring = ::rpmtsGetKeyring( ts, 1 );
+
+  std::atomic<unsigned> next( 0 );
+  auto worker = [&]() {
+    for ( unsigned idx = next++; idx < paths_r.size(); idx = next++ )
+    {
+      CheckPackageDetail detail;
+      ret[idx] = doCheckPackageSig( paths_r[idx], root(), true/*requireGPGSig_r*/, detail, cache, keyring );
+    }
+  };
+
+  unsigned threads = std::min<unsigned>( std::max( std::thread::hardware_concurrency(), 1U ), paths_r.size() );
+  if ( ! keyring )
+    threads = 1;	// don't let each thread open the database
+  // Before rpm-4.16 the shared keyring (its refcount and key lookup) is not
+  // guarded by a lock, so checks must not run concurrently.
+  static const bool rpmThreadSafe = ( Edition( ::RPMVERSION ) >= Edition( "4.16" ) );
+  if ( ! rpmThreadSafe )
+    threads = 1;
+  MIL << "Check " << paths_r.size() << " package signatures using " << threads << " threads" << endl;
+  std::vector<std::thread> pool;
+  for ( unsigned i = 1; i < threads; ++i )
+    pool.emplace_back( worker );
+  worker();
+  for ( std::thread & thread : pool )
+    thread.join();
+
+  ::rpmKeyringFree( keyring );
+  ts = rpmtsFree( ts );
+  return ret;
+}
 
 
 // determine changed files of installed package
@@ -2132,6 +2357,411 @@ void RpmDb::doInstallPackage( const Pathname & filename, RpmInstFlags flags, cal
   }
 }
 
+///////////////////////////////////////////////////////////////////
+namespace
+{
+#ifndef _RPM_5
+  /** The problems reported by an rpm transaction as string. */
+  std::string rpmtsProblemsString( rpmts ts_r )
+  {
+    std::string ret;
+    rpmps ps = ::rpmtsProblems( ts_r );
+    rpmpsi psi = ::rpmpsInitIterator( ps );
+    while ( ::rpmpsNextIterator( psi ) >= 0 )
+    {
+      char * msg = ::rpmProblemString( ::rpmpsGetProblem( psi ) );
+      if ( msg )
+      {
+	ret += msg;
+	ret += '\n';
+	::free( msg );
+      }
+    }
+    ::rpmpsFreeIterator( psi );
+    ::rpmpsFree( ps );
+    return ret;
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  /// \class InstallBatch
+  /// \brief rpmts notify callback for \ref RpmDb::installPackages
+  ///
+  /// Install elements are keyed by their 1-based index in the batch.
+  /// Callbacks for erasing the replaced packages are ignored.
+  ///////////////////////////////////////////////////////////////////
+  struct InstallBatch
+  {
+    struct Item
+    {
+      Item()
+      : fd( nullptr ), started( false ), done( false ), failed( false ), logpos( 0 )
+      {}
+      FD_t fd;
+      bool started;			///< rpm started processing the item
+      bool done;			///< rpm finished processing the item
+      bool failed;			///< rpm reported an error for the item
+      std::string::size_type logpos;	///< start of the items output in the rpmlog capture
+      std::string rpmmsg;		///< rpm output while processing the item
+    };
+
+    typedef function<void ( unsigned idx_r )> ItemFnc;
+
+    InstallBatch( const std::vector<RpmDb::InstallItem> & items_r, const std::string & rpmlog_r,
+		  const ItemFnc & startItem_r, const ItemFnc & progressItem_r, const ItemFnc & endItem_r )
+    : _items( items_r )
+    , _state( items_r.size() )
+    , _rpmlog( rpmlog_r )
+    , _startItem( startItem_r )
+    , _progressItem( progressItem_r )
+    , _endItem( endItem_r )
+    , _percent( 0 )
+    {}
+
+    static void * notifyCB( const void * h_r, const rpmCallbackType what_r, const rpm_loff_t amount_r, const rpm_loff_t total_r,
+			    fnpyKey key_r, rpmCallbackData data_r )
+    { return reinterpret_cast<InstallBatch*>(data_r)->notify( what_r, amount_r, total_r, key_r ); }
+
+    void * notify( rpmCallbackType what_r, rpm_loff_t amount_r, rpm_loff_t total_r, fnpyKey key_r )
+    {
+      if ( ! ( what_r & ( RPMCALLBACK_INST_OPEN_FILE|RPMCALLBACK_INST_CLOSE_FILE|RPMCALLBACK_INST_PROGRESS
+			|RPMCALLBACK_UNPACK_ERROR|RPMCALLBACK_CPIO_ERROR|RPMCALLBACK_SCRIPT_ERROR ) ) )
+	return nullptr;
+
+      uintptr_t key = reinterpret_cast<uintptr_t>( key_r );
+      if ( key == 0 || key > _state.size() )
+	return nullptr;	// not one of ours (e.g. an erased old version)
+      unsigned idx = key - 1;
+      Item & item( _state[idx] );
+
+      switch ( what_r )
+      {
+	case RPMCALLBACK_INST_OPEN_FILE:
+	  item.fd = ::Fopen( _items[idx].filename.c_str(), "r.ufdio" );
+	  if ( item.fd == nullptr || ::Ferror( item.fd ) )
+	  {
+	    ERR << "Can't open file for reading: " << _items[idx].filename << endl;
+	    if ( item.fd )
+	      ::Fclose( item.fd );
+	    item.fd = nullptr;
+	    item.failed = true;
+	    return nullptr;
+	  }
+	  item.started = true;
+	  item.logpos = _rpmlog.size();
+	  _percent = 0;
+	  _startItem( idx );
+	  return item.fd;
+	  break;
+
+	case RPMCALLBACK_INST_PROGRESS:
+	  if ( total_r )
+	  {
+	    _percent = amount_r * 100 / total_r;
+	    _progressItem( idx );
+	  }
+	  break;
+
+	case RPMCALLBACK_UNPACK_ERROR:
+	case RPMCALLBACK_CPIO_ERROR:
+	  item.failed = true;
+	  break;
+
+	case RPMCALLBACK_SCRIPT_ERROR:
+	  if ( total_r != RPMRC_OK )	// critical scriptlet failed; otherwise just a warning
+	    item.failed = true;
+	  break;
+
+	case RPMCALLBACK_INST_CLOSE_FILE:
+	  if ( item.fd )
+	  {
+	    ::Fclose( item.fd );
+	    item.fd = nullptr;
+	  }
+	  item.done = true;
+	  item.rpmmsg = _rpmlog.substr( std::min( item.logpos, _rpmlog.size() ) );
+	  _endItem( idx );
+	  break;
+
+	default:
+	  break;
+      }
+      return nullptr;
+    }
+
+    const Item & operator[]( unsigned idx_r ) const
+    { return _state[idx_r]; }
+
+    unsigned percent() const
+    { return _percent; }
+
+  private:
+    const std::vector<RpmDb::InstallItem> & _items;
+    std::vector<Item> _state;
+    const std::string & _rpmlog;
+    ItemFnc _startItem;
+    ItemFnc _progressItem;
+    ItemFnc _endItem;
+    unsigned _percent;
+  };
+#endif // _RPM_5
+} // namespace
+///////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////
+//
+//
+//	METHOD NAME : RpmDb::installPackages
+//	METHOD TYPE : void
+//
+void RpmDb::installPackages( const std::vector<InstallItem> & items_r, RpmInstFlags flags,
+                             const InstallItemBeginFnc & beginItem_r, const InstallItemEndFnc & endItem_r )
+{
+  FAILIFNOTINITIALIZED;
+  MIL << "RpmDb::installPackages(" << items_r.size() << " items," << flags << ")" << endl;
+  if ( items_r.empty() )
+    return;
+
+#ifdef _RPM_5
+  ZYPP_THROW(RpmSubprocessException("Batched install is not supported with rpm-5."));
+#else
+  if ( ! librpmDb::globalInit() )
+    ZYPP_THROW(GlobalRpmInitException());
+  ::addMacro( NULL, "_dbpath", NULL, _dbPath.asString().c_str(), RMIL_CMDLINE );
+
+  AutoDispose<rpmts> ts( ::rpmtsCreate(), ::rpmtsFree );
+  ::rpmtsSetRootDir( ts, _root.c_str() );
+
+  rpmVSFlags vsflags = ::rpmtsVSFlags( ts );
+  if ( flags & RPMINST_NODIGEST )
+    vsflags |= _RPMVSF_NODIGESTS;
+  if ( flags & RPMINST_NOSIGNATURE )
+    vsflags |= _RPMVSF_NOSIGNATURES;
+  ::rpmtsSetVSFlags( ts, vsflags );
+
+  rpmtransFlags transflags = RPMTRANS_FLAG_NONE;
+  if ( flags & RPMINST_EXCLUDEDOCS )
+    transflags |= RPMTRANS_FLAG_NODOCS;
+  if ( flags & RPMINST_NOSCRIPTS )
+    transflags |= RPMTRANS_FLAG_NOSCRIPTS;
+  if ( flags & RPMINST_JUSTDB )
+    transflags |= RPMTRANS_FLAG_JUSTDB;
+  if ( flags & RPMINST_TEST )
+    transflags |= RPMTRANS_FLAG_TEST;
+  if ( flags & RPMINST_NOPOSTTRANS )
+    transflags |= RPMTRANS_FLAG_NOPOSTTRANS;
+  ::rpmtsSetFlags( ts, transflags );
+
+  rpmprobFilterFlags probfilter = RPMPROB_FILTER_NONE;
+  if ( flags & RPMINST_FORCE )
+    probfilter |= RPMPROB_FILTER_REPLACEPKG | RPMPROB_FILTER_REPLACEOLDFILES | RPMPROB_FILTER_REPLACENEWFILES | RPMPROB_FILTER_OLDPACKAGE;
+  if ( flags & RPMINST_IGNORESIZE )
+    probfilter |= RPMPROB_FILTER_DISKSPACE | RPMPROB_FILTER_DISKNODES;
+  // ZConfig defines cross-arch installation
+  if ( ! ZConfig::instance().systemArchitecture().compatibleWith( ZConfig::instance().defaultSystemArchitecture() ) )
+    probfilter |= RPMPROB_FILTER_IGNOREARCH | RPMPROB_FILTER_IGNOREOS;
+
+  // Add the packages in the given order. The item index (1-based)
+  // is passed as key, so the notify callback knows the item.
+  for ( unsigned idx = 0; idx < items_r.size(); ++idx )
+  {
+    const InstallItem & item( items_r[idx] );
+    FD_t fd = ::Fopen( item.filename.c_str(), "r.ufdio" );
+    if ( fd == nullptr || ::Ferror( fd ) )
+    {
+      if ( fd )
+	::Fclose( fd );
+      ZYPP_THROW(RpmSubprocessException(str::form("Can't open file for reading: %s", item.filename.c_str())));
+    }
+    Header h = nullptr;
+    rpmRC rc = ::rpmReadPackageFile( ts, fd, item.filename.c_str(), &h );
+    ::Fclose( fd );
+    if ( ! h || ( rc != RPMRC_OK && rc != RPMRC_NOTTRUSTED && rc != RPMRC_NOKEY ) )
+    {
+      if ( h )
+	::headerFree( h );
+      ZYPP_THROW(RpmSubprocessException(str::form("Can't read package header: %s", item.filename.c_str())));
+    }
+    int res = ::rpmtsAddInstallElement( ts, h, reinterpret_cast<fnpyKey>( uintptr_t( idx+1 ) ), item.noupgrade ? 0 : 1, nullptr );
+    ::headerFree( h );
+    if ( res != 0 )
+      ZYPP_THROW(RpmSubprocessException(str::form("Can't add package to the transaction: %s", item.filename.c_str())));
+  }
+
+  // No rpmtsOrder: the items are installed in the callers order (the
+  // commit order computed by the solver). Without ordering rpmtsRun
+  // processes the elements as they were added.
+  if ( ! ( flags & RPMINST_NODEPS ) )
+  {
+    if ( ::rpmtsCheck( ts ) != 0 )
+      ZYPP_THROW(RpmSubprocessException("rpm dependency check failed."));
+    std::string problems( rpmtsProblemsString( ts ) );
+    if ( ! problems.empty() )
+      ZYPP_THROW(RpmSubprocessException(_("RPM failed: ") + problems));
+  }
+
+  // backup
+  if ( _packagebackups )
+  {
+    for ( const InstallItem & item : items_r )
+    {
+      if ( ! backupPackage( item.filename ) )
+      {
+        ERR << "backup of " << item.filename.asString() << " failed" << endl;
+      }
+    }
+  }
+
+  HistoryLog historylog;
+  callback::SendReport<RpmInstallReport> report;
+  RpmlogCapture rpmlog;
+
+  // Per item reports for items processed by rpm. Failed items are
+  // reported after the transaction is done.
+  InstallBatch * batchp = nullptr;
+  InstallBatch batch( items_r, rpmlog,
+    [&]( unsigned idx_r )	// start
+    {
+      if ( beginItem_r )
+	beginItem_r( idx_r );
+      report->start( items_r[idx_r].filename );
+    },
+    [&]( unsigned )	// progress
+    {
+      report->progress( batchp->percent() );
+    },
+    [&]( unsigned idx_r )	// end
+    {
+      const InstallBatch::Item & item( (*batchp)[idx_r] );
+      const Pathname & filename( items_r[idx_r].filename );
+
+      std::vector<std::string> lines;
+      str::split( item.rpmmsg, std::back_inserter(lines), "\n" );
+      for ( const std::string & line : lines )
+      {
+	std::string warning( "warning: " + line );	// processConfigFiles expects rpms warning prefix
+	processConfigFiles( warning, Pathname::basename(filename), " saved as ",
+			    // %s = filenames
+			    _("rpm saved %s as %s, but it was impossible to determine the difference"),
+			    // %s = filenames
+			    _("rpm saved %s as %s.\nHere are the first 25 lines of difference:\n"));
+	processConfigFiles( warning, Pathname::basename(filename), " created as ",
+			    // %s = filenames
+			    _("rpm created %s as %s, but it was impossible to determine the difference"),
+			    // %s = filenames
+			    _("rpm created %s as %s.\nHere are the first 25 lines of difference:\n"));
+      }
+
+      if ( item.failed )
+	return;	// reported after the transaction
+
+      if ( ! item.rpmmsg.empty() )
+      {
+	historylog.comment(
+	    str::form("%s installed ok", Pathname::basename(filename).c_str()),
+	    true /*timestamp*/);
+	std::ostringstream sstr;
+	sstr << "Additional rpm output:" << endl << item.rpmmsg << endl;
+	historylog.comment(sstr.str());
+
+	// report additional rpm output in finish
+	// TranslatorExplanation Text is followed by a ':'  and the actual output.
+	report->finishInfo(str::form( "%s:\n%s\n", _("Additional rpm output"),  item.rpmmsg.c_str() ));
+      }
+      report->finish();
+      if ( endItem_r )
+	endItem_r( idx_r, true );
+    } );
+  batchp = &batch;
+
+  modifyDatabase(); // BEFORE rpmtsRun
+  // Invalidate all outstanding database handles as the database gets modified.
+  librpmDb::dbRelease( true );
+
+  ::rpmtsSetNotifyCallback( ts, InstallBatch::notifyCB, &batch );
+  int res = ::rpmtsRun( ts, nullptr, probfilter );
+  std::string problems( res > 0 ? rpmtsProblemsString( ts ) : std::string() );
+  std::string errmsg( problems.empty() ? rpmlog.substr( 0, rpmlog.find( '\n' ) ) : problems );
+  ts.reset();	// close the database before any retry
+  MIL << "rpmtsRun returned " << res << endl;
+
+  bool started = false;
+  for ( unsigned idx = 0; idx < items_r.size(); ++idx )
+    started = started || batch[idx].started;
+  if ( ! started && res != 0 )
+  {
+    historylog.comment( str::form("rpm transaction of %zu packages failed", items_r.size()), true /*timestamp*/ );
+    historylog.comment( "rpm output:\n" + errmsg );
+    // TranslatorExplanation the colon is followed by an error message
+    ZYPP_THROW(RpmSubprocessException(_("RPM failed: ") + errmsg));
+  }
+
+  // Now report the failed items like installPackage does.
+  bool aborted = false;
+  for ( unsigned idx = 0; idx < items_r.size(); ++idx )
+  {
+    const InstallBatch::Item & item( batch[idx] );
+    if ( item.done && ! item.failed )
+      continue;
+
+    const InstallItem & installItem( items_r[idx] );
+    if ( aborted )
+    {
+      if ( endItem_r )
+	endItem_r( idx, false );
+      continue;
+    }
+
+    if ( beginItem_r )
+      beginItem_r( idx );
+    if ( ! item.started )
+      report->start( installItem.filename );
+
+    std::string rpmmsg( item.rpmmsg.empty() ? errmsg : item.rpmmsg );
+    historylog.comment(
+        str::form("%s install failed", Pathname::basename(installItem.filename).c_str()),
+        true /*timestamp*/);
+    std::ostringstream sstr;
+    sstr << "rpm output:" << endl << rpmmsg << endl;
+    historylog.comment(sstr.str());
+
+    // TranslatorExplanation the colon is followed by an error message
+    RpmException excpt( _("RPM failed: ") + rpmmsg );
+    bool success = false;
+    do
+    {
+      RpmInstallReport::Action user = report->problem( excpt );
+      if ( user == RpmInstallReport::ABORT )
+      {
+        report->finish( excpt );
+        aborted = true;
+        break;
+      }
+      else if ( user == RpmInstallReport::IGNORE )
+      {
+        success = true;
+        break;
+      }
+      // RETRY as single package install
+      try
+      {
+        doInstallPackage( installItem.filename, ( installItem.noupgrade ? flags|RPMINST_NOUPGRADE : flags ), report );
+        report->finish();
+        success = true;
+        break;
+      }
+      catch ( RpmException & excpt_r )
+      {
+        ZYPP_CAUGHT( excpt_r );
+        excpt = excpt_r;
+      }
+    } while ( true );
+
+    if ( endItem_r )
+      endItem_r( idx, success );
+  }
+#endif // _RPM_5
+}
+
 ///////////////////////////////////////////////////////////////////
 //
 //
@@ -20,6 +20,7 @@
 #include <vector>
 #include <string>
 
+#include "zypp/base/Function.h"
 #include "zypp/Pathname.h"
 #include "zypp/ExternalProgram.h"
 
@@ -470,6 +471,19 @@ public:
    */
   CheckPackageResult checkPackageSignature( const Pathname & path_r, CheckPackageDetail & detail_r );
 
+  /**
+   * Check the signatures of many rpm files concurrently (strict check like \ref checkPackageSignature).
+   *
+   * Successful results are remembered, so checking an unchanged package
+   * again (e.g. when it is provided for the commit) is cheap. Failures are
+   * not remembered and are checked and reported again by the caller.
+   *
+   * @param paths_r which files to check
+   *
+   * @return CheckPackageResult per file
+   */
+  std::vector<CheckPackageResult> checkPackageSignatures( const std::vector<Pathname> & paths_r );
+
   /** install rpm package
    *
    * @param filename file to install
@@ -495,6 +509,50 @@ public:
   void removePackage( const std::string & name_r, RpmInstFlags flags = RPMINST_NONE );
   void removePackage( Package::constPtr package, RpmInstFlags flags = RPMINST_NONE );
 
+  /** A package to install via \ref installPackages. */
+  struct InstallItem
+  {
+    InstallItem( const Pathname & filename_r, bool noupgrade_r = false )
+    : filename( filename_r ), noupgrade( noupgrade_r )
+    {}
+    Pathname filename;	///< the rpm file
+    bool     noupgrade;	///< install rather than update (like \ref RPMINST_NOUPGRADE)
+  };
+
+  /** \ref installPackages callback receiving the index of an \ref InstallItem about to be reported. */
+  typedef function<void ( unsigned idx_r )> InstallItemBeginFnc;
+
+  /** \ref installPackages callback receiving the index of a processed \ref InstallItem and whether it was installed. */
+  typedef function<void ( unsigned idx_r, bool success_r )> InstallItemEndFnc;
+
+  /** install a batch of rpm packages in a single rpm transaction
+   *
+   * Unlike \ref installPackage no rpm process is run per package. The
+   * items are installed in one transaction, so database setup, locking,
+   * triggers and syncing are done once per batch. \c %posttrans scripts
+   * run at the end of the batch.
+   *
+   * The items are installed in the given order; rpm does not reorder
+   * them. Unless \ref RPMINST_NODEPS is set, the dependencies of the
+   * batch are checked, but an order violating them is not corrected.
+   *
+   * For each item the usual \ref RpmInstallReport (start, progress,
+   * problem, finish) is sent. \a beginItem_r is called before, so the
+   * caller is able to connect a per package receiver. \a endItem_r is
+   * called when the item is done. Items failing inside the transaction
+   * are reported after the transaction is complete, \ref RpmInstallReport::RETRY
+   * then installs the single package via \ref installPackage.
+   *
+   * @param items_r the packages to install
+   * @param flags which rpm options to use (\ref RPMINST_NOUPGRADE is taken from the items)
+   *
+   * \throws RpmException if the transaction can not be set up. Nothing was installed then.
+   *
+   * */
+  void installPackages( const std::vector<InstallItem> & items_r, RpmInstFlags flags,
+                        const InstallItemBeginFnc & beginItem_r = InstallItemBeginFnc(),
+                        const InstallItemEndFnc & endItem_r = InstallItemEndFnc() );
+
   /**
    * get backup dir for rpm config files
    *
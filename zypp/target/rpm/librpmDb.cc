@@ -864,6 +864,20 @@ bool librpmDb::db_const_iterator::findByName( const string & name_r )
   return _d.init( RPMTAG_NAME, name_r.c_str() );
 }
 
+///////////////////////////////////////////////////////////////////
+//
+//
+//	METHOD NAME : librpmDb::db_const_iterator::findByHdrNum
+//	METHOD TYPE : bool
+//
+bool librpmDb::db_const_iterator::findByHdrNum( unsigned hdrNum_r )
+{
+  if ( ! hdrNum_r )
+    return _d.destroy();
+
+  return _d.set( hdrNum_r );
+}
+
 ///////////////////////////////////////////////////////////////////
 //
 //
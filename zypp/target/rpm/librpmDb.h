@@ -595,6 +595,11 @@ public:
    **/
   bool findByName( const std::string & name_r );
 
+  /**
+   * Reset to the package at a certain database index (see @ref dbHdrNum).
+   **/
+  bool findByHdrNum( unsigned hdrNum_r );
+
 public:
 
   /**